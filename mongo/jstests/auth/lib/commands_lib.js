@@ -1210,6 +1210,30 @@ var authCommandsLib = {
               }
           ]
         },
+        {
+          testname: "aggregate_planCacheStats",
+          command: {aggregate: "foo", pipeline: [{$planCacheStats: {}}], cursor: {}},
+          setup: function(db) {
+              db.createCollection("foo");
+          },
+          teardown: function(db) {
+              db.foo.drop();
+          },
+          testcases: [
+              {
+                runOnDb: firstDbName,
+                roles: roles_readDbAdmin,
+                privileges:
+                    [{resource: {db: firstDbName, collection: "foo"}, actions: ["planCacheRead"]}]
+              },
+              {
+                runOnDb: secondDbName,
+                roles: roles_readDbAdminAny,
+                privileges:
+                    [{resource: {db: secondDbName, collection: "foo"}, actions: ["planCacheRead"]}]
+              }
+          ]
+        },
         {
           testname: "aggregate_currentOp_allUsers_true",
           command: {aggregate: 1, pipeline: [{$currentOp: {allUsers: true}}], cursor: {}},
@@ -1242,6 +1266,31 @@ var authCommandsLib = {
                   {clusterAdmin: 1, clusterMonitor: 1, clusterManager: 1, root: 1, __system: 1}
           }],
         },
+        {
+          testname: "aggregate_queryStats",
+          command: {aggregate: 1, pipeline: [{$queryStats: {}}], cursor: {}},
+          testcases: [
+              {
+                runOnDb: adminDbName,
+                roles: roles_monitoring,
+                privileges: [{resource: {cluster: true}, actions: ["serverStatus"]}]
+              },
+          ],
+          skipSharded: true
+        },
+        {
+          testname: "aggregate_queryStats_clear",
+          command: {aggregate: 1, pipeline: [{$queryStats: {clear: true}}], cursor: {}},
+          testcases: [
+              {
+                runOnDb: adminDbName,
+                roles: {clusterAdmin: 1, root: 1, __system: 1},
+                privileges:
+                    [{resource: {cluster: true}, actions: ["serverStatus", "setParameter"]}]
+              },
+          ],
+          skipSharded: true
+        },
         {
           testname: "aggregate_listLocalSessions_allUsers_true",
           command: {aggregate: 1, pipeline: [{$listLocalSessions: {allUsers: true}}], cursor: {}},
@@ -4354,6 +4403,32 @@ var authCommandsLib = {
               },
           ]
         },
+        {
+          testname: "analyze",
+          command: {analyze: "x"},
+          skipSharded: true,
+          setup: function(db) {
+              db.x.save({a: 1});
+              db.x.createIndex({a: 1});
+          },
+          teardown: function(db) {
+              db.x.drop();
+          },
+          testcases: [
+              {
+                runOnDb: firstDbName,
+                roles: roles_dbAdmin,
+                privileges:
+                    [{resource: {db: firstDbName, collection: "x"}, actions: ["planCacheWrite"]}],
+              },
+              {
+                runOnDb: secondDbName,
+                roles: roles_dbAdminAny,
+                privileges:
+                    [{resource: {db: secondDbName, collection: "x"}, actions: ["planCacheWrite"]}],
+              },
+          ]
+        },
         {
           testname: "planCacheWrite",
           command: {planCacheClear: "x"},
@@ -0,0 +1,53 @@
+// @tags: [does_not_support_stepdowns]
+
+// Test the $planCacheStats aggregation stage, which returns the usage counters of the plan cache of
+// a collection, per query shape or in total.
+(function() {
+    "use strict";
+
+    var t = db.jstests_plan_cache_stats;
+    t.drop();
+
+    function getStats(spec) {
+        return t.aggregate([{$planCacheStats: spec}]).toArray();
+    }
+
+    // A non-existent collection has no plan cache statistics.
+    assert.eq(0, getStats({}).length);
+
+    assert.writeOK(t.insert({a: 1, b: 1}));
+    assert.writeOK(t.insert({a: 1, b: 2}));
+    assert.writeOK(t.insert({a: 2, b: 2}));
+
+    // Two indexes, so that the multi planner runs.
+    assert.commandWorked(t.createIndex({a: 1}));
+    assert.commandWorked(t.createIndex({a: 1, b: 1}));
+
+    // The first run misses the cache and multi plans, the second is answered from the cache.
+    assert.eq(1, t.find({a: 1, b: 1}).itcount());
+    assert.eq(1, t.find({a: 1, b: 1}).itcount());
+
+    var shapes = getStats({});
+    assert.eq(1, shapes.length, tojson(shapes));
+    assert.eq({a: 1, b: 1}, shapes[0].query, tojson(shapes));
+    assert.eq(1, shapes[0].misses, tojson(shapes));
+    assert.eq(1, shapes[0].hits, tojson(shapes));
+    assert.eq(1, shapes[0].multiPlans, tojson(shapes));
+    assert.gt(shapes[0].trialWorks, 0, tojson(shapes));
+    assert(shapes[0].hasOwnProperty("host"), tojson(shapes));
+
+    // The counters of a shape survive clearing the cache.
+    assert.commandWorked(t.runCommand("planCacheClear"));
+    assert.eq(1, getStats({}).length);
+
+    var totals = getStats({totals: true});
+    assert.eq(1, totals.length, tojson(totals));
+    assert.eq(1, totals[0].hits, tojson(totals));
+    assert.eq(1, totals[0].multiPlans, tojson(totals));
+    assert.eq({worksExceeded: 0, planFailed: 0}, totals[0].replans, tojson(totals));
+
+    assert.commandFailedWithCode(
+        db.runCommand(
+            {aggregate: t.getName(), pipeline: [{$planCacheStats: {foo: 1}}], cursor: {}}),
+        50601);
+})();
@@ -94,6 +94,7 @@
         addShard: {skip: isUnrelated},
         addShardToZone: {skip: isUnrelated},
         aggregate: {command: {aggregate: "view", pipeline: [{$match: {}}], cursor: {}}},
+        analyze: {command: {analyze: "view"}, expectFailure: true, skipSharded: true},
         appendOplogNote: {skip: isUnrelated},
         applyOps: {
             command: {applyOps: [{op: "i", o: {_id: 1}, ns: "test.view"}]},
@@ -38,6 +38,7 @@
             '$geoNear',
             '$indexStats',
             '$out',
+            '$planCacheStats',
         ];
         for (let stageSpec of originalPipeline) {
             // Skip wrapping the pipeline in a $facet stage if it has an invalid stage
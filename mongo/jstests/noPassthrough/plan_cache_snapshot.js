@@ -0,0 +1,59 @@
+// Test that the winning plans saved to local.system.plan_cache are loaded back into the plan cache
+// when mongod restarts, unless the indexes they use have changed.
+(function() {
+    "use strict";
+
+    load("jstests/libs/check_log.js");
+
+    const options = {
+        setParameter: {planCacheSnapshotEnabled: true, planCacheSnapshotIntervalSecs: 1}
+    };
+    let conn = MongoRunner.runMongod(options);
+    assert.neq(null, conn, "mongod failed to start");
+    let coll = conn.getDB("test").plan_cache_snapshot;
+
+    for (let i = 0; i < 100; ++i) {
+        assert.writeOK(coll.insert({a: i, b: i % 10}));
+    }
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({b: 1}));
+
+    // Two candidate plans, so the winner gets cached.
+    assert.eq(1, coll.find({a: 5, b: 5}).itcount());
+    assert.eq(1, coll.getPlanCache().listQueryShapes().length);
+
+    const savedPlans = conn.getDB("local").system.plan_cache;
+    assert.soon(() => savedPlans.find({ns: coll.getFullName()}).itcount() === 1,
+                "plan cache was not saved");
+    const saved = savedPlans.findOne({ns: coll.getFullName()});
+    assert.eq({a: 5, b: 5}, saved.query, tojson(saved));
+
+    // The plan cache is loaded back after a restart.
+    MongoRunner.stopMongod(conn);
+    conn = MongoRunner.runMongod(Object.merge(options, {restart: conn, cleanData: false}));
+    assert.neq(null, conn, "mongod failed to restart");
+    coll = conn.getDB("test").plan_cache_snapshot;
+    assert.soon(() => coll.getPlanCache().listQueryShapes().length === 1,
+                "plan cache was not loaded");
+    assert.eq({a: 5, b: 5}, coll.getPlanCache().listQueryShapes()[0].query);
+
+    // A saved plan whose index has since been replaced by one of the same name but another key
+    // pattern is not loaded. Change the index while snapshots are off, so the saved plan stays.
+    MongoRunner.stopMongod(conn);
+    conn = MongoRunner.runMongod({restart: conn, cleanData: false});
+    assert.neq(null, conn, "mongod failed to restart");
+    coll = conn.getDB("test").plan_cache_snapshot;
+    assert.commandWorked(coll.dropIndex({a: 1}));
+    assert.commandWorked(coll.dropIndex({b: 1}));
+    assert.commandWorked(coll.createIndex({a: 1, b: 1}, {name: "a_1"}));
+    assert.commandWorked(coll.createIndex({b: 1, a: 1}, {name: "b_1"}));
+
+    MongoRunner.stopMongod(conn);
+    conn = MongoRunner.runMongod(Object.merge(options, {restart: conn, cleanData: false}));
+    assert.neq(null, conn, "mongod failed to restart");
+    coll = conn.getDB("test").plan_cache_snapshot;
+    checkLog.contains(conn, "loaded 0 of 1 plans saved in local.system.plan_cache");
+    assert.eq(0, coll.getPlanCache().listQueryShapes().length);
+
+    MongoRunner.stopMongod(conn);
+})();
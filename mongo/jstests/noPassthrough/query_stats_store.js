@@ -0,0 +1,69 @@
+// Test that $queryStats accumulates the cost of the operations of each query shape, and that
+// {clear: true} forgets the shapes once read.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod failed to start");
+    const db = conn.getDB("test");
+    const admin = conn.getDB("admin");
+    const coll = db.query_stats_store;
+
+    for (let i = 0; i < 20; ++i) {
+        assert.writeOK(coll.insert({a: i, b: i % 2}));
+    }
+    assert.commandWorked(coll.createIndex({a: 1}));
+
+    function shapeStats(query) {
+        return admin
+            .aggregate([
+                {$queryStats: {}},
+                {$match: {ns: coll.getFullName(), query: query}},
+            ])
+            .toArray();
+    }
+
+    // Different values of the same shape are aggregated together.
+    assert.eq(1, coll.find({a: 3}).itcount());
+    assert.eq(1, coll.find({a: 7}).itcount());
+    let stats = shapeStats({a: 3});
+    assert.eq(1, stats.length, tojson(stats));
+    assert.eq(2, stats[0].execCount, tojson(stats));
+    assert.eq(2, stats[0].keysExamined, tojson(stats));
+    assert.eq(2, stats[0].docsExamined, tojson(stats));
+    assert.eq(2, stats[0].nreturned, tojson(stats));
+    assert.gt(stats[0].bytesReturned, 0, tojson(stats));
+    assert.eq("IXSCAN { a: 1 }", stats[0].planSummary, tojson(stats));
+    assert.eq(2, stats[0].latency.reads.ops, tojson(stats));
+
+    // getMores are charged to the shape of their cursor's query.
+    assert.eq(10, coll.find({b: 1}).batchSize(2).itcount());
+    stats = shapeStats({b: 1});
+    assert.eq(1, stats.length, tojson(stats));
+    assert.gte(stats[0].execCount, 5, tojson(stats));
+    assert.eq(10, stats[0].nreturned, tojson(stats));
+    assert.eq("COLLSCAN", stats[0].planSummary, tojson(stats));
+
+    // Clearing returns the stats one last time.
+    assert.eq(2,
+              admin
+                  .aggregate([
+                      {$queryStats: {clear: true}},
+                      {$match: {ns: coll.getFullName()}},
+                  ])
+                  .itcount());
+    assert.eq(0, shapeStats({a: 3}).length);
+
+    // Nothing is recorded while the store is disabled.
+    assert.commandWorked(
+        admin.runCommand({setParameter: 1, internalQueryStatsStoreEnabled: false}));
+    assert.eq(1, coll.find({a: 3}).itcount());
+    assert.eq(0, shapeStats({a: 3}).length);
+
+    // The stage only runs against the database.
+    assert.commandFailedWithCode(
+        db.runCommand({aggregate: coll.getName(), pipeline: [{$queryStats: {}}], cursor: {}}),
+        ErrorCodes.InvalidNamespace);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "mongo/db/collection_index_usage_tracker.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
@@ -38,6 +39,7 @@ namespace mongo {
 class Collection;
 class IndexDescriptor;
 class OperationContext;
+struct PlanSummaryStats;
 
 /**
  * this is for storing things that you want to cache about a single collection
@@ -56,6 +58,8 @@ public:
 
         virtual QuerySettings* getQuerySettings() const = 0;
 
+        virtual CollectionStatistics* getCollectionStatistics() const = 0;
+
         virtual const UpdateIndexData& getIndexKeys(OperationContext* opCtx) const = 0;
 
         virtual CollectionIndexUsageMap getIndexUsageStats() const = 0;
@@ -69,7 +73,7 @@ public:
         virtual void clearQueryCache() = 0;
 
         virtual void notifyOfQuery(OperationContext* opCtx,
-                                   const std::set<std::string>& indexesUsed) = 0;
+                                   const PlanSummaryStats& summaryStats) = 0;
     };
 
 private:
@@ -108,6 +112,13 @@ public:
         return this->_impl().getQuerySettings();
     }
 
+    /**
+     * Get the index statistics collected by the analyze command for this collection.
+     */
+    inline CollectionStatistics* getCollectionStatistics() const {
+        return this->_impl().getCollectionStatistics();
+    }
+
     /* get set of index keys for this namespace.  handy to quickly check if a given
        field is indexed (Note it might be a secondary component of a compound index.)
     */
@@ -154,12 +165,12 @@ public:
     }
 
     /**
-     * Signal to the cache that a query operation has completed.  'indexesUsed' should list the
-     * set of indexes used by the winning plan, if any.
+     * Signal to the cache that a query operation has completed.  'summaryStats' should list the
+     * set of indexes used by the winning plan, if any, and what the plan did with them.
      */
     inline void notifyOfQuery(OperationContext* const opCtx,
-                              const std::set<std::string>& indexesUsed) {
-        return this->_impl().notifyOfQuery(opCtx, indexesUsed);
+                              const PlanSummaryStats& summaryStats) {
+        return this->_impl().notifyOfQuery(opCtx, summaryStats);
     }
 
     //explicit inline CollectionInfoCache(Collection* const collection, const NamespaceString& ns)
@@ -36,10 +36,13 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/query/index_bounds.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/ttl_collection_cache.h"
@@ -57,6 +60,22 @@ MONGO_INITIALIZER(InitializeCollectionInfoCacheFactory)(InitializerContext* cons
         });
     return Status::OK();
 }
+
+/**
+ * Serializes 'bounds' for the key ranges of the index usage statistics. Bounds with more intervals
+ * than could fit in CollectionIndexUsageTracker::kMaxKeyRangeBytes aren't tracked, so they are
+ * left empty without paying for their serialization.
+ */
+BSONObj keyRangeFromBounds(const IndexBounds& bounds) {
+    size_t numIntervals = 0;
+    for (auto&& oil : bounds.fields) {
+        numIntervals += oil.intervals.size();
+    }
+    if (numIntervals > CollectionIndexUsageTracker::kMaxKeyRangeBytes / 8) {
+        return BSONObj();
+    }
+    return bounds.toBSON();
+}
 }  // namespace
 
 CollectionInfoCacheImpl::CollectionInfoCacheImpl(Collection* collection, const NamespaceString& ns)
@@ -65,6 +84,7 @@ CollectionInfoCacheImpl::CollectionInfoCacheImpl(Collection* collection, const N
       _keysComputed(false),
       _planCache(stdx::make_unique<PlanCache>(ns.ns())),
       _querySettings(stdx::make_unique<QuerySettings>()),
+      _collectionStatistics(stdx::make_unique<CollectionStatistics>()),
       _indexUsageTracker(getGlobalServiceContext()->getPreciseClockSource()) {}
 
 CollectionInfoCacheImpl::~CollectionInfoCacheImpl() {
@@ -176,15 +196,31 @@ Write_ops_exec.cpp (mongo\src\mongo\db\ops):        collection.getCollection()->
 //db.collection.aggregate({"$indexStats":{}})жͳ
 //ǰʹõͳ
 void CollectionInfoCacheImpl::notifyOfQuery(OperationContext* opCtx,
-                                            const std::set<std::string>& indexesUsed) {
+                                            const PlanSummaryStats& summaryStats) {
+    const long long latencyMicros =
+        durationCount<Microseconds>(CurOp::get(opCtx)->elapsedTimeTotal());
+
     // Record indexes used to fulfill query.
-    for (auto it = indexesUsed.begin(); it != indexesUsed.end(); ++it) {
+    for (auto it = summaryStats.indexesUsed.begin(); it != summaryStats.indexesUsed.end(); ++it) {
         // This index should still exist, since the PlanExecutor would have been killed if the
         // index was dropped (and we would not get here).
         dassert(NULL != _collection->getIndexCatalog()->findIndexByName(opCtx, *it));
 
+        CollectionIndexUsageTracker::IndexAccess access;
+        access.latencyMicros = latencyMicros;
+        auto accessStats = summaryStats.indexAccesses.find(*it);
+        if (accessStats != summaryStats.indexAccesses.end()) {
+            access.keysExamined = accessStats->second.keysExamined;
+            access.docsExamined = accessStats->second.docsExamined;
+            access.seeks = accessStats->second.seeks;
+            // Only the sampled accesses pay for serializing their bounds.
+            if (const IndexBounds* bounds = accessStats->second.indexBounds) {
+                access.bounds = [bounds] { return keyRangeFromBounds(*bounds); };
+            }
+        }
+
 		//CollectionIndexUsageTracker::recordIndexAccess
-        _indexUsageTracker.recordIndexAccess(*it);
+        _indexUsageTracker.recordIndexAccess(*it, access);
     }
 }
 
@@ -204,6 +240,10 @@ QuerySettings* CollectionInfoCacheImpl::getQuerySettings() const {
     return _querySettings.get();
 }
 
+CollectionStatistics* CollectionInfoCacheImpl::getCollectionStatistics() const {
+    return _collectionStatistics.get();
+}
+
 //CollectionInfoCacheImpl::rebuildIndexDataе
 //CollectionInfoCacheImpl::updatePlanCacheIndexEntriesIndexEntryIndexDescriptorת
 void CollectionInfoCacheImpl::updatePlanCacheIndexEntries(OperationContext* opCtx) {
@@ -275,6 +315,7 @@ void CollectionInfoCacheImpl::droppedIndex(OperationContext* opCtx, StringData i
 
     rebuildIndexData(opCtx);
     _indexUsageTracker.unregisterIndex(indexName);
+    _collectionStatistics->remove(indexName);
 }
 
 //CollectionInfoCacheImpl::init   CollectionInfoCacheImpl::addedIndex   
@@ -40,6 +40,7 @@ namespace mongo {
 class Collection;
 class IndexDescriptor;
 class OperationContext;
+struct PlanSummaryStats;
 
 /**
  * this is for storing things that you want to cache about a single collection
@@ -62,6 +63,11 @@ public:
      */
     QuerySettings* getQuerySettings() const;
 
+    /**
+     * Get the index statistics collected by the analyze command for this collection.
+     */
+    CollectionStatistics* getCollectionStatistics() const;
+
     /* get set of index keys for this namespace.  handy to quickly check if a given
        field is indexed (Note it might be a secondary component of a compound index.)
     */
@@ -103,10 +109,10 @@ public:
     void clearQueryCache();
 
     /**
-     * Signal to the cache that a query operation has completed.  'indexesUsed' should list the
-     * set of indexes used by the winning plan, if any.
+     * Signal to the cache that a query operation has completed.  'summaryStats' should list the
+     * set of indexes used by the winning plan, if any, and what the plan did with them.
      */
-    void notifyOfQuery(OperationContext* opCtx, const std::set<std::string>& indexesUsed);
+    void notifyOfQuery(OperationContext* opCtx, const PlanSummaryStats& summaryStats);
 
 private:
     void computeIndexKeys(OperationContext* opCtx);
@@ -135,6 +141,9 @@ private:
     // Includes index filters.
     std::unique_ptr<QuerySettings> _querySettings;
 
+    // Index statistics, used to estimate the cost of query plans.
+    std::unique_ptr<CollectionStatistics> _collectionStatistics;
+
     // Tracks index usage statistics for this collection.
     CollectionIndexUsageTracker _indexUsageTracker;
 
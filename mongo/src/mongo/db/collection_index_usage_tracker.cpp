@@ -31,12 +31,65 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/collection_index_usage_tracker.h"
+
+#include <algorithm>
+
 #include "mongo/util/assert_util.h"
 #include "mongo/util/clock_source.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
 
+const size_t CollectionIndexUsageTracker::kLatencyBuckets;
+const std::array<long long, CollectionIndexUsageTracker::kLatencyBuckets>
+    CollectionIndexUsageTracker::kLatencyBucketLowerBoundsMicros = {
+        {0, 100, 1000, 10 * 1000, 100 * 1000, 1000 * 1000}};
+const long long CollectionIndexUsageTracker::kKeyRangeSamplePeriod;
+const size_t CollectionIndexUsageTracker::kMaxKeyRanges;
+const int CollectionIndexUsageTracker::kMaxKeyRangeBytes;
+
+namespace {
+
+/**
+ * Counts a sampled access to 'bounds' in 'keyRanges' using the space-saving algorithm: once
+ * 'keyRanges' is full, a range not tracked yet replaces the least accessed one and inherits its
+ * count, which then becomes the bound on how much the new range is overcounted.
+ */
+void sampleKeyRange(std::vector<CollectionIndexUsageTracker::KeyRangeStats>* keyRanges,
+                    const BSONObj& bounds) {
+    auto it = std::find_if(
+        keyRanges->begin(),
+        keyRanges->end(),
+        [&](const CollectionIndexUsageTracker::KeyRangeStats& range) {
+            return range.bounds.binaryEqual(bounds);
+        });
+    if (it != keyRanges->end()) {
+        ++it->sampledAccesses;
+        return;
+    }
+
+    if (keyRanges->size() < CollectionIndexUsageTracker::kMaxKeyRanges) {
+        CollectionIndexUsageTracker::KeyRangeStats range;
+        range.bounds = bounds.getOwned();
+        range.sampledAccesses = 1;
+        keyRanges->push_back(std::move(range));
+        return;
+    }
+
+    auto leastAccessed = std::min_element(
+        keyRanges->begin(),
+        keyRanges->end(),
+        [](const CollectionIndexUsageTracker::KeyRangeStats& lhs,
+           const CollectionIndexUsageTracker::KeyRangeStats& rhs) {
+            return lhs.sampledAccesses < rhs.sampledAccesses;
+        });
+    leastAccessed->bounds = bounds.getOwned();
+    leastAccessed->maxOvercount = leastAccessed->sampledAccesses;
+    ++leastAccessed->sampledAccesses;
+}
+
+}  // namespace
+
 CollectionIndexUsageTracker::CollectionIndexUsageTracker(ClockSource* clockSource)
     : _clockSource(clockSource) {
     invariant(_clockSource);
@@ -50,6 +103,36 @@ void CollectionIndexUsageTracker::recordIndexAccess(StringData indexName) {
     _indexUsageMap[indexName].accesses.fetchAndAdd(1);
 }
 
+void CollectionIndexUsageTracker::recordIndexAccess(StringData indexName,
+                                                    const IndexAccess& access) {
+    invariant(!indexName.empty());
+    dassert(_indexUsageMap.find(indexName) != _indexUsageMap.end());
+
+    IndexUsageStats& stats = _indexUsageMap[indexName];
+    const long long accessNumber = stats.accesses.addAndFetch(1);
+    stats.keysExamined.fetchAndAdd(access.keysExamined);
+    stats.docsExamined.fetchAndAdd(access.docsExamined);
+    stats.seeks.fetchAndAdd(access.seeks);
+
+    size_t bucket = kLatencyBuckets - 1;
+    while (bucket > 0 && access.latencyMicros < kLatencyBucketLowerBoundsMicros[bucket]) {
+        --bucket;
+    }
+    stats.latencyHistogram[bucket].fetchAndAdd(1);
+
+    if (accessNumber % kKeyRangeSamplePeriod != 0 || !access.bounds) {
+        return;
+    }
+
+    const BSONObj bounds = access.bounds();
+    if (bounds.isEmpty() || bounds.objsize() > kMaxKeyRangeBytes) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_keyRangesMutex);
+    sampleKeyRange(&stats.keyRanges, bounds);
+}
+
 //CollectionInfoCacheImpl::addedIndexе
 void CollectionIndexUsageTracker::registerIndex(StringData indexName, const BSONObj& indexKey) {
     invariant(!indexName.empty());
@@ -67,6 +150,7 @@ void CollectionIndexUsageTracker::unregisterIndex(StringData indexName) {
 
 //CollectionInfoCacheImpl::getIndexUsageStats()
 CollectionIndexUsageMap CollectionIndexUsageTracker::getUsageStats() const {
+    stdx::lock_guard<stdx::mutex> lk(_keyRangesMutex);
     return _indexUsageMap;
 }
 
@@ -28,10 +28,15 @@
 
 #pragma once
 
+#include <array>
+#include <vector>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/string_map.h"
 #include "mongo/util/time_support.h"
 
@@ -44,24 +49,71 @@ class ClockSource;
  * considered "used" when it appears as part of a winning plan for an operation that uses the
  * query system.
  *
+ * Besides the number of operations, each index accumulates the keys, documents and seeks those
+ * operations spent in it, a histogram of their latencies and the key ranges they scanned most
+ * often. The key ranges are sampled from one in every kKeyRangeSamplePeriod accesses and ranked
+ * with the space-saving algorithm, keeping at most kMaxKeyRanges of them per index.
+ *
  * Indexes must be registered and deregistered on creation/destruction.
  */
 class CollectionIndexUsageTracker {
     MONGO_DISALLOW_COPYING(CollectionIndexUsageTracker);
 
 public:
+    // Lower bounds, in microseconds, of the buckets of the per-index latency histogram.
+    static const size_t kLatencyBuckets = 6;
+    static const std::array<long long, kLatencyBuckets> kLatencyBucketLowerBoundsMicros;
+
+    static const long long kKeyRangeSamplePeriod = 16;
+    static const size_t kMaxKeyRanges = 10;
+
+    // Bounds larger than this, such as those of a long $in list, are not tracked as key ranges.
+    static const int kMaxKeyRangeBytes = 512;
+
+    /**
+     * What a single operation did with an index.
+     */
+    struct IndexAccess {
+        long long keysExamined = 0;
+        long long docsExamined = 0;
+        long long seeks = 0;
+        long long latencyMicros = 0;
+
+        // Serializes the bounds scanned. Unset if the access was not a bounded index scan. Only
+        // called for the accesses whose key range is sampled.
+        stdx::function<BSONObj()> bounds;
+    };
+
+    /**
+     * A range of keys among the most accessed ones of an index.
+     */
+    struct KeyRangeStats {
+        BSONObj bounds;
+
+        // How many sampled accesses scanned 'bounds'. May overcount by at most 'maxOvercount'
+        // when the range replaced a less accessed one.
+        long long sampledAccesses = 0;
+        long long maxOvercount = 0;
+    };
+
     struct IndexUsageStats {
         IndexUsageStats() = default;
         explicit IndexUsageStats(Date_t now, const BSONObj& key)
             : trackerStartTime(now), indexKey(key.getOwned()) {}
 
-        IndexUsageStats(const IndexUsageStats& other)
-            : accesses(other.accesses.load()),
-              trackerStartTime(other.trackerStartTime),
-              indexKey(other.indexKey) {}
+        IndexUsageStats(const IndexUsageStats& other) {
+            *this = other;
+        }
 
         IndexUsageStats& operator=(const IndexUsageStats& other) {
             accesses.store(other.accesses.load());
+            keysExamined.store(other.keysExamined.load());
+            docsExamined.store(other.docsExamined.load());
+            seeks.store(other.seeks.load());
+            for (size_t i = 0; i < kLatencyBuckets; ++i) {
+                latencyHistogram[i].store(other.latencyHistogram[i].load());
+            }
+            keyRanges = other.keyRanges;
             trackerStartTime = other.trackerStartTime;
             indexKey = other.indexKey;
             return *this;
@@ -70,6 +122,17 @@ public:
         // Number of operations that have used this index.
         AtomicInt64 accesses;
 
+        // Totals over the operations that reported what they did with this index.
+        AtomicInt64 keysExamined;
+        AtomicInt64 docsExamined;
+        AtomicInt64 seeks;
+
+        // Number of those operations whose latency falls in each bucket.
+        std::array<AtomicInt64, kLatencyBuckets> latencyHistogram;
+
+        // The most accessed key ranges. Guarded by the tracker's '_keyRangesMutex'.
+        std::vector<KeyRangeStats> keyRanges;
+
         // Date/Time that we started tracking index usage.
         Date_t trackerStartTime;
 
@@ -91,6 +154,12 @@ public:
      */
     void recordIndexAccess(StringData indexName);
 
+    /**
+     * Record that an operation used index 'indexName' as described by 'access'. Safe to be called
+     * by multiple threads concurrently.
+     */
+    void recordIndexAccess(StringData indexName, const IndexAccess& access);
+
     /**
      * Add map entry for 'indexName' stats collection. Must be called under exclusive collection
      * lock.
@@ -114,6 +183,9 @@ private:
     // Map from index name to usage statistics.
     StringMap<CollectionIndexUsageTracker::IndexUsageStats> _indexUsageMap;
 
+    // Guards the 'keyRanges' of every entry of '_indexUsageMap'. Only sampled accesses take it.
+    mutable stdx::mutex _keyRangesMutex;
+
     // Clock source. Used when the 'trackerStartTime' time for an IndexUsageStats object needs to
     // be set.
     ClockSource* _clockSource;
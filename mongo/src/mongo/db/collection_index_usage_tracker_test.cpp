@@ -148,6 +148,88 @@ TEST_F(CollectionIndexUsageTrackerTest, DateTimeAfterDeregister) {
     ASSERT(statsMap.find("foo") != statsMap.end());
     ASSERT_EQUALS(statsMap["foo"].trackerStartTime, getClockSource()->now());
 }
+
+// Test that what each access did with the index is accumulated and bucketed by latency.
+TEST_F(CollectionIndexUsageTrackerTest, AccessDetailsAccumulate) {
+    getTracker()->registerIndex("foo", BSON("foo" << 1));
+
+    CollectionIndexUsageTracker::IndexAccess fast;
+    fast.keysExamined = 10;
+    fast.docsExamined = 4;
+    fast.seeks = 1;
+    fast.latencyMicros = 50;
+    getTracker()->recordIndexAccess("foo", fast);
+
+    CollectionIndexUsageTracker::IndexAccess slow;
+    slow.keysExamined = 100;
+    slow.docsExamined = 90;
+    slow.seeks = 3;
+    slow.latencyMicros = 20 * 1000;
+    getTracker()->recordIndexAccess("foo", slow);
+
+    CollectionIndexUsageMap statsMap = getTracker()->getUsageStats();
+    ASSERT(statsMap.find("foo") != statsMap.end());
+    ASSERT_EQUALS(2, statsMap["foo"].accesses.loadRelaxed());
+    ASSERT_EQUALS(110, statsMap["foo"].keysExamined.loadRelaxed());
+    ASSERT_EQUALS(94, statsMap["foo"].docsExamined.loadRelaxed());
+    ASSERT_EQUALS(4, statsMap["foo"].seeks.loadRelaxed());
+    ASSERT_EQUALS(1, statsMap["foo"].latencyHistogram[0].loadRelaxed());
+    ASSERT_EQUALS(1, statsMap["foo"].latencyHistogram[3].loadRelaxed());
+}
+
+// Test that sampled key ranges are counted and that the least accessed one is evicted when full.
+TEST_F(CollectionIndexUsageTrackerTest, KeyRangesKeepHottest) {
+    getTracker()->registerIndex("foo", BSON("foo" << 1));
+
+    const long long period = CollectionIndexUsageTracker::kKeyRangeSamplePeriod;
+    auto recordRange = [&](int i) {
+        CollectionIndexUsageTracker::IndexAccess access;
+        access.bounds = [i] { return BSON("foo" << BSON_ARRAY(BSON_ARRAY(i << i))); };
+        for (long long j = 0; j < period; ++j) {
+            getTracker()->recordIndexAccess("foo", access);
+        }
+    };
+
+    // The first range is sampled twice, every other range once.
+    recordRange(0);
+    recordRange(0);
+    for (size_t i = 1; i <= CollectionIndexUsageTracker::kMaxKeyRanges; ++i) {
+        recordRange(i);
+    }
+
+    CollectionIndexUsageMap statsMap = getTracker()->getUsageStats();
+    const auto& keyRanges = statsMap["foo"].keyRanges;
+    ASSERT_EQUALS(CollectionIndexUsageTracker::kMaxKeyRanges, keyRanges.size());
+    ASSERT_BSONOBJ_EQ(BSON("foo" << BSON_ARRAY(BSON_ARRAY(0 << 0))), keyRanges[0].bounds);
+    ASSERT_EQUALS(2, keyRanges[0].sampledAccesses);
+    ASSERT_EQUALS(0, keyRanges[0].maxOvercount);
+
+    // The last range replaced the range sampled once first.
+    ASSERT_BSONOBJ_EQ(BSON("foo" << BSON_ARRAY(BSON_ARRAY(10 << 10))), keyRanges[1].bounds);
+    ASSERT_EQUALS(2, keyRanges[1].sampledAccesses);
+    ASSERT_EQUALS(1, keyRanges[1].maxOvercount);
+}
+
+// Test that the bounds are only serialized for the accesses whose key range is sampled.
+TEST_F(CollectionIndexUsageTrackerTest, BoundsOnlySerializedWhenSampled) {
+    getTracker()->registerIndex("foo", BSON("foo" << 1));
+
+    int numSerialized = 0;
+    CollectionIndexUsageTracker::IndexAccess access;
+    access.bounds = [&numSerialized] {
+        ++numSerialized;
+        return BSON("foo" << BSON_ARRAY(BSON_ARRAY(1 << 1)));
+    };
+    const long long period = CollectionIndexUsageTracker::kKeyRangeSamplePeriod;
+    for (long long i = 0; i < 2 * period; ++i) {
+        getTracker()->recordIndexAccess("foo", access);
+    }
+
+    ASSERT_EQUALS(2, numSerialized);
+    CollectionIndexUsageMap statsMap = getTracker()->getUsageStats();
+    ASSERT_EQUALS(1U, statsMap["foo"].keyRanges.size());
+    ASSERT_EQUALS(2, statsMap["foo"].keyRanges[0].sampledAccesses);
+}
 }  // namespace
 }  // namespace mongo
 
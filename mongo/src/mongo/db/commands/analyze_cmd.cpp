@@ -0,0 +1,196 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * The sampled leading fields of the keys of an index.
+ */
+struct IndexSample {
+    const IndexDescriptor* descriptor;
+    const IndexAccessMethod* accessMethod;
+    std::vector<BSONObj> leadingValues;
+};
+
+/**
+ * { analyze: <collection> [, sampleSize: <n>] }
+ *
+ * Samples the documents of a collection to build statistics about its btree indexes, which the
+ * query planner then uses to estimate the cost of candidate plans. Replaces any statistics
+ * collected earlier and clears the plan cache of the collection.
+ */
+class AnalyzeCmd : public BasicCommand {
+public:
+    AnalyzeCmd() : BasicCommand("analyze") {}
+
+    virtual bool slaveOk() const {
+        return true;
+    }
+
+    virtual void help(std::stringstream& h) const {
+        h << "Build statistics about the indexes of a collection from a random sample of its "
+             "documents, for the query planner to estimate the cost of plans.\n"
+             "{ analyze: <collection>, sampleSize: <number of documents> }";
+    }
+
+    virtual bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    virtual void addRequiredPrivileges(const std::string& dbname,
+                                       const BSONObj& cmdObj,
+                                       std::vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(ActionType::planCacheWrite);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) {
+        const NamespaceString nss(parseNsCollectionRequired(dbname, cmdObj));
+
+        long long sampleSize = internalQueryStatsSampleSize.load();
+        if (BSONElement sampleSizeElt = cmdObj["sampleSize"]) {
+            if (!sampleSizeElt.isNumber() || sampleSizeElt.numberLong() <= 0) {
+                return appendCommandStatus(
+                    result, {ErrorCodes::BadValue, "sampleSize must be a positive number"});
+            }
+            sampleSize = sampleSizeElt.numberLong();
+        }
+
+        AutoGetCollectionForReadCommand ctx(opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        if (!collection) {
+            if (ctx.getDb() && ctx.getDb()->getViewCatalog()->lookup(opCtx, nss.ns())) {
+                return appendCommandStatus(
+                    result, {ErrorCodes::CommandNotSupportedOnView, "Cannot analyze a view"});
+            }
+            return appendCommandStatus(result, {ErrorCodes::NamespaceNotFound, "ns not found"});
+        }
+
+        // Statistics are built for btree indexes only. The keys of a partial index would need
+        // the documents to be filtered first.
+        std::vector<IndexSample> samples;
+        IndexCatalog* indexCatalog = collection->getIndexCatalog();
+        IndexCatalog::IndexIterator ii = indexCatalog->getIndexIterator(opCtx, false);
+        while (ii.more()) {
+            const IndexDescriptor* desc = ii.next();
+            if (desc->getAccessMethodName() != IndexNames::BTREE || desc->isPartial()) {
+                continue;
+            }
+            samples.push_back({desc, indexCatalog->getIndex(desc), std::vector<BSONObj>()});
+        }
+
+        // Read the whole collection when it is no larger than the sample. Otherwise, read random
+        // documents if the storage engine can, or else the first ones.
+        const long long numRecords = collection->numRecords(opCtx);
+        std::unique_ptr<RecordCursor> cursor;
+        if (numRecords > sampleSize) {
+            cursor = collection->getRecordStore()->getRandomCursor(opCtx);
+        }
+        if (!cursor) {
+            cursor = collection->getCursor(opCtx);
+        }
+
+        long long numDocsSampled = 0;
+        while (numDocsSampled < sampleSize) {
+            auto record = cursor->next();
+            if (!record) {
+                break;
+            }
+            opCtx->checkForInterrupt();
+
+            const BSONObj doc = record->data.toBson();
+            for (auto&& sample : samples) {
+                BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+                sample.accessMethod->getKeys(
+                    doc, IndexAccessMethod::GetKeysMode::kRelaxConstraints, &keys, nullptr);
+                for (auto&& key : keys) {
+                    sample.leadingValues.push_back(key.firstElement().wrap(""));
+                }
+            }
+            ++numDocsSampled;
+        }
+
+        result.appendNumber("numRecords", numRecords);
+        result.appendNumber("numDocsSampled", numDocsSampled);
+
+        CollectionStatistics* collStats = collection->infoCache()->getCollectionStatistics();
+        const size_t maxBuckets =
+            static_cast<size_t>(std::max(1, internalQueryStatsMaxHistogramBuckets.load()));
+        BSONObjBuilder indexesBuilder(result.subobjStart("indexes"));
+        for (auto&& sample : samples) {
+            auto stats = std::make_shared<IndexStatistics>(
+                IndexStatistics::make(sample.descriptor->keyPattern(),
+                                      std::move(sample.leadingValues),
+                                      numDocsSampled,
+                                      numRecords,
+                                      maxBuckets));
+            indexesBuilder.append(sample.descriptor->indexName(), stats->toBSON());
+            collStats->set(sample.descriptor->indexName(), std::move(stats));
+        }
+        indexesBuilder.doneFast();
+
+        // Plans were cached without regard to the statistics.
+        collection->infoCache()->clearQueryCache();
+
+        LOG(1) << "Analyzed " << samples.size() << " indexes of " << nss.ns() << " from "
+               << numDocsSampled << " of " << numRecords << " documents";
+        return true;
+    }
+
+} analyzeCmd;
+
+}  // namespace
+}  // namespace mongo
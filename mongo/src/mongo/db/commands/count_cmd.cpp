@@ -239,7 +239,7 @@ public:
         PlanSummaryStats summaryStats;
         Explain::getSummaryStats(*exec, &summaryStats);
         if (collection) {
-            collection->infoCache()->notifyOfQuery(opCtx, summaryStats.indexesUsed);
+            collection->infoCache()->notifyOfQuery(opCtx, summaryStats);
         }
         curOp->debug().setPlanSummaryMetrics(summaryStats);
 
@@ -256,6 +256,10 @@ public:
             static_cast<const CountStats*>(countStage->getSpecificStats());
 
         result.appendNumber("n", countStats->nCounted);
+        if (countStats->approximate) {
+            result.appendBool("approximate", true);
+            result.appendNumber("errorBound", countStats->errorBound);
+        }
         return true;
     }
 
@@ -49,6 +49,7 @@
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_stats_store.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/service_context.h"
@@ -320,6 +321,12 @@ public:
             }
         }
 
+        // Charge the batch to the shape of the cursor's query.
+        if (readLock && readLock->getCollection() && exec->getCanonicalQuery()) {
+            const PlanCache* planCache = readLock->getCollection()->infoCache()->getPlanCache();
+            QueryStatsStore::noteQueryShape(opCtx, *planCache, *exec->getCanonicalQuery());
+        }
+
         CursorId respondWithId = 0;
         CursorResponseBuilder nextBatch(/*isInitialResponse*/ false, &result);
         BSONObj obj;
@@ -40,6 +40,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/plan_cache_commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
@@ -292,6 +293,26 @@ MONGO_INITIALIZER_WITH_PREREQUISITES(SetupPlanCacheCommands, MONGO_NO_PREREQUISI
     return Status::OK();
 }
 
+//
+// Usage of the plan caches of all collections, in serverStatus().metrics.query.planCache.
+//
+
+const PlanCacheCounters& planCacheCounters = PlanCache::getGlobalCounters();
+ServerStatusMetricField<Counter64> displayPlanCacheHits("query.planCache.hits",
+                                                        &planCacheCounters.hits);
+ServerStatusMetricField<Counter64> displayPlanCacheMisses("query.planCache.misses",
+                                                          &planCacheCounters.misses);
+ServerStatusMetricField<Counter64> displayPlanCacheReplansWorksExceeded(
+    "query.planCache.replans.worksExceeded", &planCacheCounters.replansWorksExceeded);
+ServerStatusMetricField<Counter64> displayPlanCacheReplansPlanFailed(
+    "query.planCache.replans.planFailed", &planCacheCounters.replansPlanFailed);
+ServerStatusMetricField<Counter64> displayPlanCacheMultiPlans("query.planCache.multiPlans",
+                                                              &planCacheCounters.multiPlans);
+ServerStatusMetricField<Counter64> displayPlanCacheMultiPlanningMicros(
+    "query.planCache.multiPlanningMicros", &planCacheCounters.multiPlanningMicros);
+ServerStatusMetricField<Counter64> displayPlanCacheTrialWorks("query.planCache.trialWorks",
+                                                              &planCacheCounters.trialWorks);
+
 }  // namespace
 
 namespace mongo {
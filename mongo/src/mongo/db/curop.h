@@ -105,6 +105,12 @@ public:
     // True if a replan was triggered during the execution of this operation.
     bool replanned{false};
 
+    // Identifies the shape of the first query planned by this operation, see
+    // QueryStatsStore::noteQueryShape(). 'queryStatsShape' describes the shape only if it wasn't
+    // in the store yet.
+    std::string queryStatsKey;
+    BSONObj queryStatsShape;
+
     //ͳƼrecordCurOpMetrics
     long long nMatched{-1};   // number of records that match the query
     long long nModified{-1};  // number of records written (no no-ops)
@@ -92,6 +92,7 @@
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/op_observer_impl.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/plan_cache_snapshot.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
@@ -1000,6 +1001,8 @@ ExitCode _initAndListen(int listenPort) {
             startTTLBackgroundJob();
         }
 
+        startPlanCacheSnapshotBackgroundJob();
+
         if (replSettings.usingReplSets() || (!replSettings.isMaster() && replSettings.isSlave()) ||
             !internalValidateFeaturesAsMaster) {
             serverGlobalParams.validateFeaturesAsMaster.store(false);
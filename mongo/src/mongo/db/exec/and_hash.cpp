@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/and_hash.h"
 
+#include <algorithm>
+
 #include "mongo/db/exec/and_common-inl.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
@@ -97,7 +99,7 @@ bool AndHashStage::isEOF() {
     // Or we're streaming in results from the last child.
 
     // If there's nothing to probe against, we're EOF.
-    if (_dataMap.empty()) {
+    if (0 == intersectionSize()) {
         return true;
     }
 
@@ -177,7 +179,12 @@ PlanStage::StageState AndHashStage::doWork(WorkingSetID* out) {
 
     // We read the first child into our hash table.
     if (_hashingChildren) {
-        // Check memory usage of previously hashed results.
+        // Check memory usage of previously hashed results. If our consumer only needs RecordIds,
+        // drop everything else we've buffered before giving up.
+        if (_memUsage > _maxMemUsage && _canHoldRecordIdsOnly && !_recordIdsOnly) {
+            holdRecordIdsOnly();
+        }
+
         if (_memUsage > _maxMemUsage) {
             mongoutils::str::stream ss;
             ss << "hashed AND stage buffered data usage of " << _memUsage
@@ -202,8 +209,8 @@ PlanStage::StageState AndHashStage::doWork(WorkingSetID* out) {
     // Returning results.  We read from the last child and return the results that are in our
     // hash map.
 
-    // We should be EOF if we're not hashing results and the dataMap is empty.
-    verify(!_dataMap.empty());
+    // We should be EOF if we're not hashing results and the intersection is empty.
+    verify(intersectionSize() > 0);
 
     // We probe _dataMap with the last child.
     verify(_currentChild == _children.size() - 1);
@@ -224,6 +231,26 @@ PlanStage::StageState AndHashStage::doWork(WorkingSetID* out) {
         return PlanStage::NEED_TIME;
     }
 
+    if (_filter && !_filter->mayContain(member->recordId)) {
+        ++_specificStats.filterRejects;
+        _ws->free(*out);
+        return PlanStage::NEED_TIME;
+    }
+
+    if (_recordIdsOnly) {
+        // Return the last child's result as is, unless it's not in every previous child or we've
+        // already returned it.
+        auto pos = findRecordId(member->recordId);
+        if (!pos || _recordIdFlags[*pos]) {
+            _ws->free(*out);
+            return PlanStage::NEED_TIME;
+        }
+
+        _recordIdFlags[*pos] = true;
+        --_numLiveRecordIds;
+        return PlanStage::ADVANCED;
+    }
+
     DataMap::iterator it = _dataMap.find(member->recordId);
     if (_dataMap.end() == it) {
         // Child's output wasn't in every previous child.  Throw it out.
@@ -253,6 +280,61 @@ PlanStage::StageState AndHashStage::workChild(size_t childNo, WorkingSetID* out)
     }
 }
 
+size_t AndHashStage::intersectionSize() const {
+    return _recordIdsOnly ? _numLiveRecordIds : _dataMap.size();
+}
+
+void AndHashStage::holdRecordIdsOnly() {
+    invariant(!_recordIdsOnly);
+    _recordIdsOnly = true;
+    _specificStats.recordIdsOnly = true;
+
+    _recordIds.reserve(_dataMap.size());
+    for (auto&& entry : _dataMap) {
+        _recordIds.push_back(entry.first);
+        _ws->free(entry.second);
+    }
+    _dataMap.clear();
+    sortRecordIds();
+
+    // Carry over what the child currently being hashed has seen so far.
+    for (auto&& recordId : _seenMap) {
+        if (auto pos = findRecordId(recordId)) {
+            _recordIdFlags[*pos] = true;
+        }
+    }
+    _seenMap.clear();
+}
+
+void AndHashStage::sortRecordIds() {
+    std::sort(_recordIds.begin(), _recordIds.end());
+    _recordIds.erase(std::unique(_recordIds.begin(), _recordIds.end()), _recordIds.end());
+    _recordIdFlags.assign(_recordIds.size(), false);
+    _numLiveRecordIds = _recordIds.size();
+    _memUsage = _recordIds.capacity() * sizeof(RecordId);
+}
+
+boost::optional<size_t> AndHashStage::findRecordId(const RecordId& recordId) const {
+    auto it = std::lower_bound(_recordIds.begin(), _recordIds.end(), recordId);
+    if (it == _recordIds.end() || *it != recordId) {
+        return boost::none;
+    }
+    return static_cast<size_t>(it - _recordIds.begin());
+}
+
+void AndHashStage::buildFilter() {
+    _filter.emplace(intersectionSize());
+    if (_recordIdsOnly) {
+        for (auto&& recordId : _recordIds) {
+            _filter->insert(recordId);
+        }
+    } else {
+        for (auto&& entry : _dataMap) {
+            _filter->insert(entry.first);
+        }
+    }
+}
+
 PlanStage::StageState AndHashStage::readFirstChild(WorkingSetID* out) {
     verify(_currentChild == 0);
 
@@ -269,6 +351,14 @@ PlanStage::StageState AndHashStage::readFirstChild(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        if (_recordIdsOnly) {
+            // Duplicates are removed once we've read the whole child.
+            _recordIds.push_back(member->recordId);
+            _memUsage += sizeof(RecordId);
+            _ws->free(id);
+            return PlanStage::NEED_TIME;
+        }
+
         if (!_dataMap.insert(std::make_pair(member->recordId, id)).second) {
             // Didn't insert because we already had this RecordId inside the map. This should only
             // happen if we're seeing a newer copy of the same doc in a more recent snapshot.
@@ -288,13 +378,18 @@ PlanStage::StageState AndHashStage::readFirstChild(WorkingSetID* out) {
         // Done reading child 0.
         _currentChild = 1;
 
+        if (_recordIdsOnly) {
+            sortRecordIds();
+        }
+
         // If our first child was empty, don't scan any others, no possible results.
-        if (_dataMap.empty()) {
+        if (0 == intersectionSize()) {
             _hashingChildren = false;
             return PlanStage::IS_EOF;
         }
 
-        _specificStats.mapAfterChild.push_back(_dataMap.size());
+        _specificStats.mapAfterChild.push_back(intersectionSize());
+        buildFilter();
 
         return PlanStage::NEED_TIME;
     } else if (PlanStage::FAILURE == childStatus || PlanStage::DEAD == childStatus) {
@@ -335,7 +430,14 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         }
 
         verify(member->hasRecordId());
-        if (_dataMap.end() == _dataMap.find(member->recordId)) {
+        if (_filter && !_filter->mayContain(member->recordId)) {
+            // Ignore. It's not in any previous child.
+            ++_specificStats.filterRejects;
+        } else if (_recordIdsOnly) {
+            if (auto pos = findRecordId(member->recordId)) {
+                _recordIdFlags[*pos] = true;
+            }
+        } else if (_dataMap.end() == _dataMap.find(member->recordId)) {
             // Ignore.  It's not in any previous child.
         } else {
             // We have a hit.  Copy data into the WSM we already have.
@@ -355,6 +457,18 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         // Finished with a child.
         ++_currentChild;
 
+        if (_recordIdsOnly) {
+            // Keep the RecordIds this child has seen.
+            size_t kept = 0;
+            for (size_t i = 0; i < _recordIds.size(); ++i) {
+                if (_recordIdFlags[i]) {
+                    _recordIds[kept++] = _recordIds[i];
+                }
+            }
+            _recordIds.resize(kept);
+            sortRecordIds();
+        }
+
         // Keep elements of _dataMap that are in _seenMap.
         DataMap::iterator it = _dataMap.begin();
         while (it != _dataMap.end()) {
@@ -373,18 +487,20 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
             }
         }
 
-        _specificStats.mapAfterChild.push_back(_dataMap.size());
+        _specificStats.mapAfterChild.push_back(intersectionSize());
 
         _seenMap.clear();
 
         // _dataMap is now the intersection of the first _currentChild nodes.
 
         // If we have nothing to AND with after finishing any child, stop.
-        if (_dataMap.empty()) {
+        if (0 == intersectionSize()) {
             _hashingChildren = false;
             return PlanStage::IS_EOF;
         }
 
+        buildFilter();
+
         // We've finished scanning all children.  Return results with the next call to work().
         if (_currentChild == _children.size()) {
             _hashingChildren = false;
@@ -439,6 +555,42 @@ void AndHashStage::doInvalidate(OperationContext* opCtx,
     // If it's a mutation the predicates implied by the AND-ing may no longer be true.
     //
     // So, we flag and try to pick it up later.
+    if (_recordIdsOnly) {
+        if (0 == _currentChild) {
+            // We're still reading the first child, so '_recordIds' isn't sorted yet.
+            auto newEnd = std::remove(_recordIds.begin(), _recordIds.end(), dl);
+            if (newEnd == _recordIds.end()) {
+                return;
+            }
+            _recordIds.erase(newEnd, _recordIds.end());
+            ++_specificStats.flaggedInProgress;
+        } else {
+            auto pos = findRecordId(dl);
+            if (!pos || (!_hashingChildren && _recordIdFlags[*pos])) {
+                return;
+            }
+
+            if (_hashingChildren) {
+                ++_specificStats.flaggedInProgress;
+                _recordIds.erase(_recordIds.begin() + *pos);
+                _recordIdFlags.erase(_recordIdFlags.begin() + *pos);
+            } else {
+                ++_specificStats.flaggedButPassed;
+                _recordIdFlags[*pos] = true;
+            }
+            --_numLiveRecordIds;
+        }
+
+        // We no longer have a WorkingSetMember for this RecordId, so make one to flag.
+        WorkingSetID id = _ws->allocate();
+        WorkingSetMember* member = _ws->get(id);
+        member->recordId = dl;
+        _ws->transitionToRecordIdAndIdx(id);
+        WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+        _ws->flagForReview(id);
+        return;
+    }
+
     DataMap::iterator it = _dataMap.find(dl);
     if (_dataMap.end() != it) {
         WorkingSetID id = it->second;
@@ -28,9 +28,11 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_bloom_filter.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
@@ -110,6 +112,16 @@ public:
 
     void addChild(PlanStage* child);
 
+    /**
+     * Declares that the consumer of this stage fetches every result and applies the full query
+     * predicate to the fetched document, so it needs nothing from a result but its RecordId. If
+     * the buffered intersection then exceeds the memory limit, the stage discards the children's
+     * index keys and documents and keeps going with RecordIds alone, instead of failing.
+     */
+    void allowRecordIdsOnly() {
+        _canHoldRecordIdsOnly = true;
+    }
+
     /**
      * Returns memory usage.
      * For testing only.
@@ -138,6 +150,32 @@ private:
     StageState hashOtherChildren(WorkingSetID* out);
     StageState workChild(size_t childNo, WorkingSetID* out);
 
+    /**
+     * Returns the number of RecordIds still in the intersection.
+     */
+    size_t intersectionSize() const;
+
+    /**
+     * Replaces '_dataMap' and '_seenMap' with '_recordIds' and '_recordIdFlags', freeing every
+     * buffered WorkingSetMember.
+     */
+    void holdRecordIdsOnly();
+
+    /**
+     * Sorts '_recordIds', removing duplicates, and clears '_recordIdFlags'.
+     */
+    void sortRecordIds();
+
+    /**
+     * Returns the position of 'recordId' in the sorted '_recordIds', or boost::none if absent.
+     */
+    boost::optional<size_t> findRecordId(const RecordId& recordId) const;
+
+    /**
+     * Rebuilds '_filter' over the current intersection.
+     */
+    void buildFilter();
+
     // Not owned by us.
     const Collection* _collection;
 
@@ -159,6 +197,25 @@ private:
     typedef unordered_set<RecordId, RecordId::Hasher> SeenMap;
     SeenMap _seenMap;
 
+    // Whether allowRecordIdsOnly() was called, and whether we have since switched to holding the
+    // intersection in '_recordIds' rather than '_dataMap'.
+    bool _canHoldRecordIdsOnly = false;
+    bool _recordIdsOnly = false;
+
+    // The intersection, once '_recordIdsOnly' is set. Sorted from the end of the first child on.
+    std::vector<RecordId> _recordIds;
+
+    // Parallel to '_recordIds'. While hashing, marks the RecordIds seen by the current child.
+    // While probing with the last child, marks the RecordIds already returned or invalidated.
+    std::vector<bool> _recordIdFlags;
+
+    // How many entries of '_recordIds' have not been returned or invalidated while probing.
+    size_t _numLiveRecordIds = 0;
+
+    // Rejects most RecordIds which are not in the intersection without a hash table lookup.
+    // Built after each child we hash.
+    boost::optional<RecordIdBloomFilter> _filter;
+
     // True if we're still intersecting _children[0..._children.size()-1].
     bool _hashingChildren;
 
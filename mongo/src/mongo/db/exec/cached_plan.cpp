@@ -162,6 +162,9 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
                    << " planSummary: " << redact(Explain::getPlanSummary(child().get()))
                    << " status: " << redact(statusObj);
 
+            _collection->infoCache()->getPlanCache()->notifyOfReplan(
+                *_canonicalQuery, PlanCache::ReplanReason::PlanFailed);
+
             const bool shouldCache = false;
             return replan(yieldPolicy, shouldCache);
         } else if (PlanStage::DEAD == state) {
@@ -187,6 +190,9 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
            << redact(_canonicalQuery->toStringShort())
            << " plan summary before replan: " << redact(Explain::getPlanSummary(child().get()));
 
+    _collection->infoCache()->getPlanCache()->notifyOfReplan(
+        *_canonicalQuery, PlanCache::ReplanReason::WorksExceeded);
+
     const bool shouldCache = true;
     return replan(yieldPolicy, shouldCache);
 }
@@ -315,6 +321,25 @@ PlanStage::StageState CachedPlanStage::doWork(WorkingSetID* out) {
     return child()->work(out);
 }
 
+PlanStage::StageState CachedPlanStage::doWorkBatch(size_t maxWorks, Batch* batch) {
+    if (isEOF()) {
+        ++batch->works;
+        return PlanStage::IS_EOF;
+    }
+
+    // The results buffered during the trial period are owned, so hand them out as a batch.
+    if (!_results.empty()) {
+        for (size_t i = 0; i < maxWorks && !_results.empty(); ++i) {
+            ++batch->works;
+            batch->ids.push_back(_results.front());
+            _results.pop_front();
+        }
+        return PlanStage::NEED_TIME;
+    }
+
+    return child()->workBatch(maxWorks, batch);
+}
+
 void CachedPlanStage::doInvalidate(OperationContext* opCtx,
                                    const RecordId& dl,
                                    InvalidationType type) {
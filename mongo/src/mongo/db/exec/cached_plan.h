@@ -64,6 +64,7 @@ public:
     bool isEOF() final;
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, Batch* batch) final;
 
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
 
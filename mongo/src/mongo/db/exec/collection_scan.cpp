@@ -30,6 +30,8 @@
 
 #include "mongo/db/exec/collection_scan.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
@@ -38,6 +40,7 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
@@ -52,6 +55,14 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+namespace {
+
+// A columnar batch ends early once the records it has copied reach this size, so that a batch of
+// large documents holds a bounded amount of memory.
+const int kMaxColumnarBatchBytes = 4 * 1024 * 1024;
+
+}  // namespace
+
 /*
 2021-01-22T10:59:08.080+0800 D QUERY    [conn-1] Winning solution:
 FETCH  -------------PlanStageӦFetchStage   Ӧ־еdocsExamined:1
@@ -110,6 +121,13 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
         invariantOK(_endCondition->init(repl::OpTime::kTimestampFieldName,
                                         _endConditionBSON.firstElement()));
     }
+
+    if (internalQueryExecEnableColumnarFilter.load()) {
+        _columnarFilter = ColumnarFilter::compile(_filter);
+    }
+    if (internalQueryExecEnableCompiledFilter.load()) {
+        _compiledFilter = CompiledMatchExpression::compile(_filter);
+    }
 }
 
 /*
@@ -265,6 +283,120 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
     return returnIfMatches(member, id, out); //CollectionScan::returnIfMatches
 }
 
+PlanStage::StageState CollectionScan::doWorkBatch(size_t maxWorks, Batch* batch) {
+    // Tailable and oplog-tracking scans report their position to the caller after every result,
+    // so they must not read ahead of what has been returned.
+    if (_params.tailable || _params.shouldTrackLatestOplogTimestamp) {
+        return PlanStage::doWorkBatch(maxWorks, batch);
+    }
+
+    if (canUseColumnarFilter()) {
+        return doColumnarWorkBatch(maxWorks, batch);
+    }
+
+    for (size_t i = 0; i < maxWorks; ++i) {
+        ++batch->works;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = doWork(&id);
+
+        if (PlanStage::ADVANCED == state) {
+            // The next call to the cursor may invalidate the record data backing this result.
+            _workingSet->get(id)->makeObjOwnedIfNeeded();
+            batch->ids.push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            batch->stateId = id;
+            return state;
+        }
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
+bool CollectionScan::canUseColumnarFilter() const {
+    // The positioning, stopping and filter-dropping options are handled by doWork() only.
+    return _columnarFilter && _cursor && !_isDead && !_commonStats.isEOF &&
+        _params.start.isNull() && !_endCondition && 0 == _params.maxScan &&
+        !_params.stopApplyingFilterAfterFirstMatch;
+}
+
+PlanStage::StageState CollectionScan::doColumnarWorkBatch(size_t maxWorks, Batch* batch) {
+    _columnarFilter->clear();
+    _columnarRows.clear();
+
+    // Read the batch. Record data is only valid until the cursor moves, so the columns are
+    // extracted right away and an owned copy of the record is kept for building the results.
+    StageState endState = PlanStage::NEED_TIME;
+    WorkingSetID endStateId = WorkingSet::INVALID_ID;
+    int batchBytes = 0;
+    for (size_t i = 0; i < maxWorks && batchBytes < kMaxColumnarBatchBytes; ++i) {
+        ++batch->works;
+
+        boost::optional<Record> record;
+        try {
+            if (auto fetcher = _cursor->fetcherForNext()) {
+                WorkingSetMember* member = _workingSet->get(_wsidForFetch);
+                member->setFetcher(fetcher.release());
+                endState = PlanStage::NEED_YIELD;
+                endStateId = _wsidForFetch;
+                break;
+            }
+            record = _cursor->next();
+        } catch (const WriteConflictException&) {
+            endState = PlanStage::NEED_YIELD;
+            break;
+        }
+
+        if (!record) {
+            _commonStats.isEOF = true;
+            endState = PlanStage::IS_EOF;
+            break;
+        }
+
+        _lastSeenId = record->id;
+        ++_specificStats.docsTested;
+        BSONObj doc = record->data.releaseToBson().getOwned();
+        _columnarFilter->appendRow(doc);
+        batchBytes += doc.objsize();
+        _columnarRows.emplace_back(record->id, std::move(doc));
+    }
+
+    // Filter the batch and produce the results which pass.
+    _specificStats.columnarFilter = true;
+    const auto& results = _columnarFilter->evaluate();
+    const auto& residual = _columnarFilter->residual();
+    const SnapshotId snapshotId = getOpCtx()->recoveryUnit()->getSnapshotId();
+    for (size_t i = 0; i < _columnarRows.size(); ++i) {
+        if (ColumnarFilter::kNoMatch == results[i]) {
+            continue;
+        }
+
+        const BSONObj& doc = _columnarRows[i].second;
+        if (ColumnarFilter::kUnknown == results[i]) {
+            const bool matches =
+                _compiledFilter ? _compiledFilter->matchesBSON(doc) : _filter->matchesBSON(doc);
+            if (!matches) {
+                continue;
+            }
+        } else if (!std::all_of(residual.begin(), residual.end(), [&doc](auto expr) {
+                       return expr->matchesBSON(doc);
+                   })) {
+            continue;
+        }
+
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->recordId = _columnarRows[i].first;
+        member->obj = {snapshotId, doc};
+        _workingSet->transitionToRecordIdAndObj(id);
+        batch->ids.push_back(id);
+    }
+
+    if (PlanStage::NEED_TIME != endState) {
+        batch->stateId = endStateId;
+    }
+    return endState;
+}
+
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     auto tsElem = record.data.toBson()[repl::OpTime::kTimestampFieldName];
     if (tsElem.type() != BSONType::bsonTimestamp) {
@@ -285,9 +417,10 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         if (_params.stopApplyingFilterAfterFirstMatch) {
             _filter = nullptr;
+            _compiledFilter.reset();
         }
         *out = memberID;
         return PlanStage::ADVANCED;
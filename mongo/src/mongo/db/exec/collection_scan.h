@@ -30,8 +30,11 @@
 
 #include <memory>
 
+#include "mongo/bson/util/builder.h"
 #include "mongo/db/exec/collection_scan_common.h"
+#include "mongo/db/exec/columnar_filter.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/record_id.h"
 
@@ -56,6 +59,7 @@ public:
                    const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, Batch* batch) final;
     bool isEOF() final;
 
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
@@ -85,6 +89,17 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Returns true if the next batch can be filtered by '_columnarFilter'.
+     */
+    bool canUseColumnarFilter() const;
+
+    /**
+     * Implementation of doWorkBatch() which reads a batch of records and filters them a column
+     * at a time with '_columnarFilter'.
+     */
+    StageState doColumnarWorkBatch(size_t maxWorks, Batch* batch);
+
     /**
      * Extracts the timestamp from the 'ts' field of 'record', and sets '_latestOplogEntryTimestamp'
      * to that time if it isn't already greater.  Returns an error if the 'ts' field cannot be
@@ -102,6 +117,15 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // The compiled form of '_filter' used for batches, if it could be compiled.
+    std::unique_ptr<ColumnarFilter> _columnarFilter;
+
+    // The compiled form of '_filter' used to match single documents, if it could be compiled.
+    std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
+    // The ids and owned copies of the records of the current columnar batch.
+    std::vector<std::pair<RecordId, BSONObj>> _columnarRows;
+
     // If a document does not pass '_filter' but passes '_endCondition', stop scanning and return
     // IS_EOF.
     BSONObj _endConditionBSON;
@@ -0,0 +1,267 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/columnar_filter.h"
+
+#include <cmath>
+#include <functional>
+
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+
+namespace {
+
+// Doubles represent every integer of at most this magnitude exactly.
+const long long kMaxExactDoubleInteger = 1LL << 53;
+
+// A document can be matched against at most this many distinct fields, see appendRow().
+const size_t kMaxColumns = 64;
+
+/**
+ * Returns true and sets 'out' if 'elem' is a number which a double holds exactly.
+ */
+bool exactDouble(const BSONElement& elem, double* out) {
+    switch (elem.type()) {
+        case NumberInt:
+            *out = elem._numberInt();
+            return true;
+        case NumberDouble:
+            *out = elem._numberDouble();
+            return true;
+        case NumberLong: {
+            const long long value = elem._numberLong();
+            if (value < -kMaxExactDoubleInteger || value > kMaxExactDoubleInteger) {
+                return false;
+            }
+            *out = static_cast<double>(value);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * The kernel of evaluate(): ANDs the result of comparing each cell of a column against 'rhs' into
+ * 'mask', and records the cells which can't be compared in 'unknown'. 'tags' holds the cells'
+ * ColumnarFilter::Tag, 1 for kNumber and 2 for kUnrepresentable. Kept free of branches so that it
+ * compiles to vector instructions.
+ */
+template <typename Compare>
+void applyPredicate(const double* values,
+                    const uint8_t* tags,
+                    size_t numRows,
+                    double rhs,
+                    Compare compare,
+                    uint8_t* mask,
+                    uint8_t* unknown) {
+    for (size_t i = 0; i < numRows; ++i) {
+        const uint8_t isNumber = tags[i] == 1;
+        const uint8_t isUnknown = tags[i] == 2;
+        mask[i] &= (isNumber & static_cast<uint8_t>(compare(values[i], rhs))) | isUnknown;
+        unknown[i] |= isUnknown;
+    }
+}
+
+}  // namespace
+
+std::unique_ptr<ColumnarFilter> ColumnarFilter::compile(const MatchExpression* filter) {
+    if (!filter) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ColumnarFilter> columnarFilter(new ColumnarFilter());
+    if (MatchExpression::AND == filter->matchType()) {
+        for (size_t i = 0; i < filter->numChildren(); ++i) {
+            if (!columnarFilter->compilePredicate(filter->getChild(i))) {
+                columnarFilter->_residual.push_back(filter->getChild(i));
+            }
+        }
+    } else if (!columnarFilter->compilePredicate(filter)) {
+        return nullptr;
+    }
+
+    if (columnarFilter->_predicates.empty()) {
+        return nullptr;
+    }
+    return columnarFilter;
+}
+
+bool ColumnarFilter::compilePredicate(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            break;
+        default:
+            return false;
+    }
+
+    const auto* comparison = static_cast<const ComparisonMatchExpression*>(expr);
+    const StringData path = comparison->path();
+    if (path.empty() || path.find('.') != std::string::npos) {
+        return false;
+    }
+
+    // NaN has its own comparison semantics, so leave it to the match expression.
+    double rhs;
+    if (!exactDouble(comparison->getData(), &rhs) || std::isnan(rhs)) {
+        return false;
+    }
+
+    size_t column = 0;
+    while (column < _columns.size() && _columns[column].fieldName != path) {
+        ++column;
+    }
+    if (column == _columns.size()) {
+        if (_columns.size() == kMaxColumns) {
+            return false;
+        }
+        _columns.emplace_back();
+        _columns.back().fieldName = path.toString();
+    }
+
+    _predicates.push_back({column, expr->matchType(), rhs});
+    return true;
+}
+
+void ColumnarFilter::clear() {
+    for (auto&& column : _columns) {
+        column.values.clear();
+        column.tags.clear();
+    }
+    _numRows = 0;
+}
+
+void ColumnarFilter::appendRow(const BSONObj& doc) {
+    for (auto&& column : _columns) {
+        column.values.push_back(0);
+        column.tags.push_back(kNoNumber);
+    }
+
+    // Like the match expression, only look at the first occurrence of each field.
+    uint64_t found = 0;
+    const uint64_t all = (_columns.size() == kMaxColumns) ? ~0ULL : (1ULL << _columns.size()) - 1;
+    BSONObjIterator it(doc);
+    while (it.more() && found != all) {
+        const BSONElement elem = it.next();
+        const StringData fieldName = elem.fieldNameStringData();
+        for (size_t i = 0; i < _columns.size(); ++i) {
+            if ((found & (1ULL << i)) || _columns[i].fieldName != fieldName) {
+                continue;
+            }
+            found |= 1ULL << i;
+
+            double value;
+            if (exactDouble(elem, &value)) {
+                _columns[i].values.back() = value;
+                _columns[i].tags.back() = kNumber;
+            } else if (elem.type() == Array || elem.type() == NumberLong ||
+                       elem.type() == NumberDecimal) {
+                _columns[i].tags.back() = kUnrepresentable;
+            }
+            break;
+        }
+    }
+
+    ++_numRows;
+}
+
+const std::vector<ColumnarFilter::RowResult>& ColumnarFilter::evaluate() {
+    _mask.assign(_numRows, 1);
+    _unknown.assign(_numRows, 0);
+
+    for (auto&& predicate : _predicates) {
+        const Column& column = _columns[predicate.column];
+        const double* values = column.values.data();
+        const uint8_t* tags = column.tags.data();
+        switch (predicate.matchType) {
+            case MatchExpression::EQ:
+                applyPredicate(values,
+                               tags,
+                               _numRows,
+                               predicate.rhs,
+                               std::equal_to<double>(),
+                               _mask.data(),
+                               _unknown.data());
+                break;
+            case MatchExpression::LT:
+                applyPredicate(values,
+                               tags,
+                               _numRows,
+                               predicate.rhs,
+                               std::less<double>(),
+                               _mask.data(),
+                               _unknown.data());
+                break;
+            case MatchExpression::LTE:
+                applyPredicate(values,
+                               tags,
+                               _numRows,
+                               predicate.rhs,
+                               std::less_equal<double>(),
+                               _mask.data(),
+                               _unknown.data());
+                break;
+            case MatchExpression::GT:
+                applyPredicate(values,
+                               tags,
+                               _numRows,
+                               predicate.rhs,
+                               std::greater<double>(),
+                               _mask.data(),
+                               _unknown.data());
+                break;
+            case MatchExpression::GTE:
+                applyPredicate(values,
+                               tags,
+                               _numRows,
+                               predicate.rhs,
+                               std::greater_equal<double>(),
+                               _mask.data(),
+                               _unknown.data());
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+
+    _results.resize(_numRows);
+    for (size_t i = 0; i < _numRows; ++i) {
+        _results[i] = !_mask[i] ? kNoMatch : (_unknown[i] ? kUnknown : kMatch);
+    }
+    return _results;
+}
+
+}  // namespace mongo
@@ -0,0 +1,140 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+/**
+ * Evaluates the simple part of a collection scan filter over a batch of documents at a time.
+ *
+ * Comparisons ($eq, $lt, $lte, $gt, $gte) of a top-level field against a number are compiled,
+ * whether they form the whole filter or are children of its top-level $and. appendRow() extracts
+ * the fields they reference into typed columns, and evaluate() then runs each comparison over a
+ * whole column in a branch-free loop which the compiler vectorizes. Any other part of the filter
+ * is returned by residual() and must be evaluated by the caller for the rows that match.
+ *
+ * Values which a column can't represent exactly (arrays, decimals, longs beyond 2^53) make the
+ * row evaluate to kUnknown, in which case the caller must evaluate the full filter on it.
+ */
+class ColumnarFilter {
+    MONGO_DISALLOW_COPYING(ColumnarFilter);
+
+public:
+    enum RowResult : char { kNoMatch, kMatch, kUnknown };
+
+    /**
+     * Compiles 'filter'. Returns nullptr if none of it can be compiled.
+     */
+    static std::unique_ptr<ColumnarFilter> compile(const MatchExpression* filter);
+
+    /**
+     * Discards the rows of the current batch.
+     */
+    void clear();
+
+    /**
+     * Extracts the columns of 'doc' as a new row of the current batch. 'doc' need not outlive
+     * this call.
+     */
+    void appendRow(const BSONObj& doc);
+
+    size_t numRows() const {
+        return _numRows;
+    }
+
+    /**
+     * Evaluates the compiled comparisons over every row of the current batch. The returned
+     * vector holds one result per row and is valid until the next call to a non-const method.
+     */
+    const std::vector<RowResult>& evaluate();
+
+    /**
+     * The parts of the filter which were not compiled. They must also match for a row evaluating
+     * to kMatch to pass the filter.
+     */
+    const std::vector<const MatchExpression*>& residual() const {
+        return _residual;
+    }
+
+    size_t numCompiledPredicates() const {
+        return _predicates.size();
+    }
+
+private:
+    // The kind of value held by a cell of a column.
+    enum Tag : uint8_t {
+        // Missing, or of a type no numeric comparison matches.
+        kNoNumber = 0,
+        // A number which is held exactly by the cell's double.
+        kNumber = 1,
+        // A value the cell can't represent, so the row must be evaluated by the full filter.
+        kUnrepresentable = 2,
+    };
+
+    struct Column {
+        std::string fieldName;
+        std::vector<double> values;
+        std::vector<uint8_t> tags;
+    };
+
+    struct Predicate {
+        size_t column;
+        MatchExpression::MatchType matchType;
+        double rhs;
+    };
+
+    ColumnarFilter() = default;
+
+    /**
+     * Adds 'expr' to the compiled predicates if possible. Returns false otherwise.
+     */
+    bool compilePredicate(const MatchExpression* expr);
+
+    std::vector<Column> _columns;
+    std::vector<Predicate> _predicates;
+    std::vector<const MatchExpression*> _residual;
+
+    size_t _numRows = 0;
+
+    // Scratch space for evaluate().
+    std::vector<uint8_t> _mask;
+    std::vector<uint8_t> _unknown;
+    std::vector<RowResult> _results;
+};
+
+}  // namespace mongo
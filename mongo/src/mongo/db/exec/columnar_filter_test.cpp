@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/exec/columnar_filter.cpp
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/columnar_filter.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parseMatchExpression(const BSONObj& obj) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    StatusWithMatchExpression status = MatchExpressionParser::parse(obj, std::move(expCtx));
+    ASSERT_OK(status.getStatus());
+    return std::move(status.getValue());
+}
+
+/**
+ * Filters 'docs' as a collection scan does with a ColumnarFilter and checks that the outcome is
+ * the same as matching each document against the whole filter.
+ */
+void assertSameAsMatcher(const char* filterJson, const std::vector<BSONObj>& docs) {
+    auto filter = parseMatchExpression(fromjson(filterJson));
+    auto columnarFilter = ColumnarFilter::compile(filter.get());
+    ASSERT(columnarFilter);
+
+    for (auto&& doc : docs) {
+        columnarFilter->appendRow(doc);
+    }
+    ASSERT_EQ(docs.size(), columnarFilter->numRows());
+
+    const auto& results = columnarFilter->evaluate();
+    for (size_t i = 0; i < docs.size(); ++i) {
+        bool matches = false;
+        if (ColumnarFilter::kUnknown == results[i]) {
+            matches = filter->matchesBSON(docs[i]);
+        } else if (ColumnarFilter::kMatch == results[i]) {
+            matches = true;
+            for (auto&& expr : columnarFilter->residual()) {
+                matches = matches && expr->matchesBSON(docs[i]);
+            }
+        }
+        ASSERT_EQ(filter->matchesBSON(docs[i]), matches) << "filter: " << filterJson
+                                                         << ", doc: " << docs[i];
+    }
+}
+
+std::vector<BSONObj> testDocs() {
+    return {fromjson("{a: 1, b: 2}"),
+            fromjson("{a: 5, b: 'str'}"),
+            fromjson("{a: 5.5, b: -1}"),
+            fromjson("{a: NumberLong(10), b: 10}"),
+            fromjson("{b: 3}"),
+            fromjson("{a: null}"),
+            fromjson("{a: 'str'}"),
+            fromjson("{a: [1, 7], b: 2}"),
+            fromjson("{a: NumberDecimal('5'), b: 2}"),
+            fromjson("{a: NumberLong('9223372036854775807')}"),
+            fromjson("{a: NaN, b: 1}"),
+            fromjson("{a: -0.0}"),
+            fromjson("{b: 4, a: 4}"),
+            fromjson("{a: 2, a: 100}"),
+            fromjson("{a: {b: 5}}")};
+}
+
+TEST(ColumnarFilterTest, DoesNotCompileUnsupportedFilters) {
+    ASSERT_FALSE(ColumnarFilter::compile(nullptr));
+    ASSERT_FALSE(ColumnarFilter::compile(parseMatchExpression(fromjson("{'a.b': 1}")).get()));
+    ASSERT_FALSE(ColumnarFilter::compile(parseMatchExpression(fromjson("{a: 'str'}")).get()));
+    ASSERT_FALSE(ColumnarFilter::compile(parseMatchExpression(fromjson("{a: {$lt: NaN}}")).get()));
+    ASSERT_FALSE(ColumnarFilter::compile(
+                     parseMatchExpression(fromjson("{a: NumberDecimal('1')}")).get()));
+    ASSERT_FALSE(ColumnarFilter::compile(
+                     parseMatchExpression(fromjson("{$or: [{a: 1}, {b: 1}]}")).get()));
+    ASSERT_FALSE(
+        ColumnarFilter::compile(parseMatchExpression(fromjson("{a: {$ne: 1}}")).get()));
+}
+
+TEST(ColumnarFilterTest, CompilesConjunctionsPartially) {
+    auto filter = parseMatchExpression(fromjson("{a: {$gt: 1, $lt: 5}, b: /x/, c: 2}"));
+    auto columnarFilter = ColumnarFilter::compile(filter.get());
+    ASSERT(columnarFilter);
+    ASSERT_EQ(3U, columnarFilter->numCompiledPredicates());
+    ASSERT_EQ(1U, columnarFilter->residual().size());
+}
+
+TEST(ColumnarFilterTest, UnrepresentableValuesAreUnknown) {
+    auto filter = parseMatchExpression(fromjson("{a: {$gte: 1}}"));
+    auto columnarFilter = ColumnarFilter::compile(filter.get());
+    ASSERT(columnarFilter);
+
+    columnarFilter->appendRow(fromjson("{a: [0, 2]}"));
+    columnarFilter->appendRow(fromjson("{a: NumberDecimal('2')}"));
+    columnarFilter->appendRow(fromjson("{a: NumberLong('9223372036854775807')}"));
+    columnarFilter->appendRow(fromjson("{a: 2}"));
+    columnarFilter->appendRow(fromjson("{a: 0}"));
+
+    const auto& results = columnarFilter->evaluate();
+    ASSERT_EQ(ColumnarFilter::kUnknown, results[0]);
+    ASSERT_EQ(ColumnarFilter::kUnknown, results[1]);
+    ASSERT_EQ(ColumnarFilter::kUnknown, results[2]);
+    ASSERT_EQ(ColumnarFilter::kMatch, results[3]);
+    ASSERT_EQ(ColumnarFilter::kNoMatch, results[4]);
+}
+
+TEST(ColumnarFilterTest, ClearStartsANewBatch) {
+    auto filter = parseMatchExpression(fromjson("{a: 1}"));
+    auto columnarFilter = ColumnarFilter::compile(filter.get());
+    ASSERT(columnarFilter);
+
+    columnarFilter->appendRow(fromjson("{a: 1}"));
+    columnarFilter->clear();
+    ASSERT_EQ(0U, columnarFilter->numRows());
+
+    columnarFilter->appendRow(fromjson("{a: 2}"));
+    const auto& results = columnarFilter->evaluate();
+    ASSERT_EQ(1U, results.size());
+    ASSERT_EQ(ColumnarFilter::kNoMatch, results[0]);
+}
+
+TEST(ColumnarFilterTest, MatchesLikeMatchExpression) {
+    const auto docs = testDocs();
+    assertSameAsMatcher("{a: 5}", docs);
+    assertSameAsMatcher("{a: {$lt: 5}}", docs);
+    assertSameAsMatcher("{a: {$lte: 5}}", docs);
+    assertSameAsMatcher("{a: {$gt: 5}}", docs);
+    assertSameAsMatcher("{a: {$gte: 5}}", docs);
+    assertSameAsMatcher("{a: 0}", docs);
+    assertSameAsMatcher("{a: {$gt: NumberLong(1)}, b: {$lte: 2.5}}", docs);
+    assertSameAsMatcher("{a: {$gte: 1, $lt: 10}, b: {$type: 'string'}}", docs);
+    assertSameAsMatcher("{$and: [{a: {$gt: -1}}, {b: {$exists: true}}]}", docs);
+}
+
+}  // namespace
+}  // namespace mongo
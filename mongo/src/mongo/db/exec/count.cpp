@@ -30,9 +30,14 @@
 
 #include "mongo/db/exec/count.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/matcher/expression.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -63,6 +68,10 @@ bool CountStage::isEOF() {
         return true;
     }
 
+    if (_params.sampleCursor) {
+        return _sampleDone;
+    }
+
     if (_params.limit > 0 && _specificStats.nCounted >= _params.limit) {
         return true;
     }
@@ -72,8 +81,59 @@ bool CountStage::isEOF() {
 
 void CountStage::recordStoreCount() {
     invariant(_collection);
-    long long nCounted = _collection->numRecords(getOpCtx());
+    setCountWithSkipAndLimit(_collection->numRecords(getOpCtx()));
+    _specificStats.recordStoreCount = true;
+}
+
+PlanStage::StageState CountStage::sampleWork(WorkingSetID* out) {
+    invariant(_collection);
+
+    if (_specificStats.nSampled < _params.sampleSize) {
+        boost::optional<Record> record;
+        try {
+            record = _params.sampleCursor->next();
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
 
+        // A random cursor only runs out on an empty collection.
+        if (record) {
+            ++_specificStats.nSampled;
+            if (!_params.sampleFilter ||
+                _params.sampleFilter->matchesBSON(record->data.releaseToBson())) {
+                ++_specificStats.nSampleMatched;
+            }
+            return PlanStage::NEED_TIME;
+        }
+    }
+
+    // Scale the fraction of matching samples up to the whole collection. The error bound is the
+    // larger distance from that fraction to either end of its 95% Wilson score interval, scaled the
+    // same way. Unlike the normal approximation, the Wilson interval doesn't collapse to nothing
+    // when none or all of the samples match.
+    const double numRecords = _collection->numRecords(getOpCtx());
+    double fraction = 0;
+    double errorBound = 0;
+    if (_specificStats.nSampled > 0) {
+        const double n = _specificStats.nSampled;
+        const double z = 1.96;
+        fraction = _specificStats.nSampleMatched / n;
+        const double center = (fraction + z * z / (2 * n)) / (1 + z * z / n);
+        const double halfWidth = z / (1 + z * z / n) *
+            std::sqrt(fraction * (1 - fraction) / n + z * z / (4 * n * n));
+        errorBound = std::max(fraction - (center - halfWidth), (center + halfWidth) - fraction);
+    }
+
+    setCountWithSkipAndLimit(std::llround(numRecords * fraction));
+    _specificStats.approximate = true;
+    _specificStats.errorBound = static_cast<long long>(std::ceil(numRecords * errorBound));
+    _sampleDone = true;
+    _commonStats.isEOF = true;
+    return PlanStage::IS_EOF;
+}
+
+void CountStage::setCountWithSkipAndLimit(long long nCounted) {
     if (0 != _params.skip) {
         nCounted -= _params.skip;
         if (nCounted < 0) {
@@ -92,7 +152,6 @@ void CountStage::recordStoreCount() {
 
     _specificStats.nCounted = nCounted;
     _specificStats.nSkipped = _params.skip;
-    _specificStats.recordStoreCount = true;
 }
 
 PlanStage::StageState CountStage::doWork(WorkingSetID* out) {
@@ -110,6 +169,10 @@ PlanStage::StageState CountStage::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (_params.sampleCursor) {
+        return sampleWork(out);
+    }
+
     // For cases where we can't ask the record store directly, we should always have a child stage
     // from which we can retrieve results.
     invariant(child());
@@ -154,6 +217,40 @@ PlanStage::StageState CountStage::doWork(WorkingSetID* out) {
     return PlanStage::NEED_TIME;
 }
 
+void CountStage::doSaveState() {
+    if (_params.sampleCursor) {
+        _params.sampleCursor->save();
+    }
+}
+
+void CountStage::doRestoreState() {
+    // A random cursor has no position to lose, so it can always carry on sampling.
+    if (_params.sampleCursor) {
+        _params.sampleCursor->restore();
+    }
+}
+
+void CountStage::doDetachFromOperationContext() {
+    if (_params.sampleCursor) {
+        _params.sampleCursor->detachFromOperationContext();
+    }
+}
+
+void CountStage::doReattachToOperationContext() {
+    if (_params.sampleCursor) {
+        _params.sampleCursor->reattachToOperationContext(getOpCtx());
+    }
+}
+
+void CountStage::doInvalidate(OperationContext* opCtx,
+                              const RecordId& dl,
+                              InvalidationType type) {
+    // Deletions can harm the underlying RecordCursor so we must pass them down.
+    if (_params.sampleCursor && INVALIDATION_DELETION == type) {
+        _params.sampleCursor->invalidate(opCtx, dl);
+    }
+}
+
 unique_ptr<PlanStageStats> CountStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_COUNT);
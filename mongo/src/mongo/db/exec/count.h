@@ -31,9 +31,12 @@
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/query/count_request.h"
+#include "mongo/db/storage/record_store.h"
 
 namespace mongo {
 
+class MatchExpression;
+
 struct CountStageParams {
     CountStageParams(const CountRequest& request, bool useRecordStoreCount)
         : nss(request.getNs()),
@@ -56,6 +59,15 @@ struct CountStageParams {
     // Note: This strategy can lead to inaccurate counts on certain storage engines (including
     // WiredTiger).
     bool useRecordStoreCount;
+
+    // If set, this count stage estimates the count instead of computing one from a child. It reads
+    // 'sampleSize' documents from this random cursor, and scales the fraction of them which match
+    // 'sampleFilter' up to the number of records in the collection.
+    std::unique_ptr<RecordCursor> sampleCursor;
+    long long sampleSize = 0;
+
+    // Not owned. Null if every document matches.
+    const MatchExpression* sampleFilter = nullptr;
 };
 
 /**
@@ -84,6 +96,12 @@ public:
         return STAGE_COUNT;
     }
 
+    void doSaveState() final;
+    void doRestoreState() final;
+    void doDetachFromOperationContext() final;
+    void doReattachToOperationContext() final;
+    void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
+
     std::unique_ptr<PlanStageStats> getStats();
 
     const SpecificStats* getSpecificStats() const final;
@@ -99,6 +117,17 @@ private:
      */
     void recordStoreCount();
 
+    /**
+     * Reads and tests one sampled document. Once 'sampleSize' documents have been read, stores
+     * the estimated count and its error bound in '_specificStats'.
+     */
+    StageState sampleWork(WorkingSetID* out);
+
+    /**
+     * Applies the skip and limit to 'nCounted', and stores the result in '_specificStats'.
+     */
+    void setCountWithSkipAndLimit(long long nCounted);
+
     // The collection over which we are counting.
     Collection* _collection;
 
@@ -111,6 +140,9 @@ private:
     // by us.
     WorkingSet* _ws;
 
+    // True once we have read all of the sampled documents.
+    bool _sampleDone = false;
+
     CountStats _specificStats;
 };
 
@@ -91,6 +91,13 @@ public:
 
     const SpecificStats* getSpecificStats() const final;
 
+    /**
+     * The bounds of the scan. Unlike the 'indexBounds' of the stats, available without getStats().
+     */
+    const IndexBounds& getBounds() const {
+        return _params.bounds;
+    }
+
     static const char* kStageType;
 
 private:
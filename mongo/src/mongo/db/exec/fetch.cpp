@@ -30,11 +30,14 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -77,6 +80,10 @@ FetchStage::FetchStage(OperationContext* opCtx,
       _filter(filter),
       _idRetrying(WorkingSet::INVALID_ID) {
     _children.emplace_back(child);
+
+    if (internalQueryExecEnableCompiledFilter.load()) {
+        _compiledFilter = CompiledMatchExpression::compile(_filter);
+    }
 }
 
 FetchStage::~FetchStage() {}
@@ -88,6 +95,10 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_pendingIds.empty() || _hasPendingState) {
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -130,7 +141,15 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
+    if (_idRetrying == WorkingSet::INVALID_ID && !_pendingIds.empty()) {
+        status = ADVANCED;
+        id = _pendingIds.front();
+        _pendingIds.pop_front();
+    } else if (_idRetrying == WorkingSet::INVALID_ID && _hasPendingState) {
+        status = _pendingState;
+        id = _pendingStateId;
+        _hasPendingState = false;
+    } else if (_idRetrying == WorkingSet::INVALID_ID) {
         status = child()->work(&id); //ʵǵIndexScan::doWork
     } else {
         status = ADVANCED;
@@ -143,7 +162,9 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
 
         // If there's an obj there, there is no fetching to perform.
         if (member->hasObj()) {
-            ++_specificStats.alreadyHasObj;
+            if (0 == _prefetchedIds.erase(id)) {
+                ++_specificStats.alreadyHasObj;
+            }
         } else {
             // We need a valid RecordId to fetch from and this is the only state that has one.
             verify(WorkingSetMember::RID_AND_IDX == member->getState());
@@ -202,6 +223,94 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState FetchStage::doWorkBatch(size_t maxWorks, Batch* batch) {
+    size_t worksDone = 0;
+    while (worksDone < maxWorks) {
+        if (WorkingSet::INVALID_ID == _idRetrying && _pendingIds.empty() && !_hasPendingState) {
+            _childBatch.ids.clear();
+            _childBatch.stateId = WorkingSet::INVALID_ID;
+            _childBatch.works = 0;
+            StageState childState = child()->workBatch(maxWorks - worksDone, &_childBatch);
+
+            _pendingIds.assign(_childBatch.ids.begin(), _childBatch.ids.end());
+            if (internalQueryExecEnableFetchPrefetch.load()) {
+                prefetchPending();
+            }
+            if (PlanStage::NEED_TIME != childState) {
+                _hasPendingState = true;
+                _pendingState = childState;
+                _pendingStateId = _childBatch.stateId;
+            }
+
+            // Every result and the state ending the child's batch cost us a unit of work below,
+            // the NEED_TIMEs the child returned along the way are accounted for here.
+            const size_t childNeedTime =
+                _childBatch.works - _pendingIds.size() - (_hasPendingState ? 1 : 0);
+            batch->works += childNeedTime;
+            worksDone += childNeedTime;
+            continue;
+        }
+
+        ++batch->works;
+        ++worksDone;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = doWork(&id);
+
+        if (PlanStage::ADVANCED == state) {
+            // Fetching the next result may reposition '_cursor' and invalidate this one.
+            _ws->get(id)->makeObjOwnedIfNeeded();
+            batch->ids.push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            batch->stateId = id;
+            return state;
+        }
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
+void FetchStage::prefetchPending() {
+    std::vector<std::pair<RecordId, WorkingSetID>> toFetch;
+    for (auto&& id : _pendingIds) {
+        WorkingSetMember* member = _ws->get(id);
+        if (!member->hasObj() && WorkingSetMember::RID_AND_IDX == member->getState()) {
+            toFetch.emplace_back(member->recordId, id);
+        }
+    }
+
+    if (toFetch.size() < 2) {
+        return;
+    }
+
+    std::sort(toFetch.begin(), toFetch.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    try {
+        if (!_cursor)
+            _cursor = _collection->getCursor(getOpCtx());
+
+        for (auto&& entry : toFetch) {
+            // Leave documents which need paging in to doWork(), which can ask for a yield.
+            if (_cursor->fetcherForId(entry.first)) {
+                continue;
+            }
+
+            // A document which has gone away is left for doWork() to discard.
+            if (!WorkingSetCommon::fetch(getOpCtx(), _ws, entry.second, _cursor)) {
+                continue;
+            }
+
+            // Later seeks may reposition '_cursor' and invalidate this document.
+            _ws->get(entry.second)->makeObjOwnedIfNeeded();
+            _prefetchedIds.insert(entry.second);
+            ++_specificStats.prefetched;
+        }
+    } catch (const WriteConflictException&) {
+        // doWork() fetches whatever is left, yielding if the conflict persists.
+    }
+}
+
 void FetchStage::doSaveState() {
     if (_cursor)
         _cursor->saveUnpositioned();
@@ -232,6 +341,14 @@ void FetchStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, Inval
             WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
         }
     }
+
+    // The same goes for the results of the child's last batch which are still waiting for us.
+    for (auto&& id : _pendingIds) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasRecordId() && (member->recordId == dl)) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(opCtx, member, _collection);
+        }
+    }
 }
 
 //FetchStage::doWork
@@ -256,7 +373,7 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
 	//size_t docsExamined; FetchStage::returnIfMatches     keysExaminedIndexScan::doWork
     ++_specificStats.docsExamined; 
 
-    if (Filter::passes(member, _filter)) { 
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         *out = memberID;
         return PlanStage::ADVANCED; //Ҫ
     } else {
@@ -28,12 +28,15 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
+#include "mongo/stdx/unordered_set.h"
 
 namespace mongo {
 
@@ -77,6 +80,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, Batch* batch) final;
 
     void doSaveState() final;
     void doRestoreState() final;
@@ -101,6 +105,13 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Fetches the documents of the results in '_pendingIds' in RecordId order, so the storage
+     * engine reads them close to sequentially rather than in index order. Results keep their
+     * place in '_pendingIds'. Stops early, leaving the rest to doWork(), on a write conflict.
+     */
+    void prefetchPending();
+
     // Collection which is used by this stage. Used to resolve record ids retrieved by child
     // stages. The lifetime of the collection must supersede that of the stage.
     const Collection* _collection;
@@ -115,9 +126,28 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter; //filter : ѯSQLwhereʽ
 
+    // The compiled form of '_filter', if it could be compiled.
+    std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // Results of the child's last batch which have not been fetched yet, because fetching an
+    // earlier result of the batch requested a yield. Consumed before asking our child for more.
+    std::deque<WorkingSetID> _pendingIds;
+
+    // The state which ended the child's last batch, returned once '_pendingIds' is drained. Only
+    // meaningful when '_hasPendingState' is true.
+    bool _hasPendingState = false;
+    StageState _pendingState = PlanStage::NEED_TIME;
+    WorkingSetID _pendingStateId = WorkingSet::INVALID_ID;
+
+    // Scratch space for the child's batches.
+    Batch _childBatch;
+
+    // Members of '_pendingIds' whose documents prefetchPending() has already fetched.
+    stdx::unordered_set<WorkingSetID> _prefetchedIds;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "mongo/db/exec/working_set.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/matchable.h"
 
@@ -158,6 +159,19 @@ public:
         return filter->matches(&doc, NULL);
     }
 
+    /**
+     * Like passes() above, but evaluates the filter with 'compiledFilter', the compiled form of
+     * 'filter', if it isn't NULL and 'wsm' holds a document.
+     */
+    static bool passes(WorkingSetMember* wsm,
+                       const MatchExpression* filter,
+                       CompiledMatchExpression* compiledFilter) {
+        if (compiledFilter && wsm->hasObj()) {
+            return compiledFilter->matchesBSON(wsm->obj.value());
+        }
+        return passes(wsm, filter);
+    }
+
     static bool passes(const BSONObj& keyData,
                        const BSONObj& keyPattern,
                        const MatchExpression* filter) {
@@ -0,0 +1,326 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/gather.h"
+
+#include <algorithm>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_worker_pool.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+using std::unique_ptr;
+using stdx::make_unique;
+
+// static
+const char* GatherStage::kStageType = "GATHER";
+
+namespace {
+
+/**
+ * The threads which scan the partitions of every GatherStage. Never shut down.
+ */
+ThreadPool* getWorkerPool() {
+    static ThreadPool* pool = makeQueryWorkerPool("GatherStage", "gather-");
+    return pool;
+}
+
+/**
+ * Returns false if evaluating 'expr' changes state shared between threads, as for $where and
+ * $expr, which evaluate through a JavaScript scope and the query's variables.
+ */
+bool isSafeToMatchConcurrently(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::WHERE:
+        case MatchExpression::EXPRESSION:
+        case MatchExpression::TEXT:
+        case MatchExpression::GEO_NEAR:
+            return false;
+        default:
+            break;
+    }
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        if (!isSafeToMatchConcurrently(expr->getChild(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+GatherStage::GatherStage(OperationContext* opCtx,
+                         const Collection* collection,
+                         size_t degreeOfParallelism,
+                         WorkingSet* workingSet,
+                         const MatchExpression* filter)
+    : PlanStage(kStageType, opCtx),
+      _collection(collection),
+      _workingSet(workingSet),
+      _filter(filter),
+      _degreeOfParallelism(std::max(size_t(1), degreeOfParallelism)) {}
+
+// static
+bool GatherStage::canScanInParallel(OperationContext* opCtx,
+                                    const Collection* collection,
+                                    const MatchExpression* filter) {
+    if (filter && !isSafeToMatchConcurrently(filter)) {
+        return false;
+    }
+    if (collection->numRecords(opCtx) <
+        internalQueryExecParallelCollectionScanMinRecords.load()) {
+        return false;
+    }
+    auto cursor = collection->getRecordStore()->getCursor(opCtx, true);
+    return cursor->seekNear(RecordId());
+}
+
+PlanStage::StageState GatherStage::doWork(WorkingSetID* out) {
+    if (_commonStats.isEOF) {
+        return PlanStage::IS_EOF;
+    }
+
+    if (!_partitioned) {
+        try {
+            partition();
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+        _partitioned = true;
+        return PlanStage::NEED_TIME;
+    }
+
+    // Return the results of the last round.
+    while (_nextPartition < _partitions.size()) {
+        Partition& partition = _partitions[_nextPartition];
+        if (_nextResult < partition.results.size()) {
+            auto& result = partition.results[_nextResult++];
+            WorkingSetID id = _workingSet->allocate();
+            WorkingSetMember* member = _workingSet->get(id);
+            member->recordId = result.first;
+            // The document was read by a snapshot other than the one of this operation.
+            member->obj = {SnapshotId(), std::move(result.second)};
+            _workingSet->transitionToRecordIdAndObj(id);
+            *out = id;
+            return PlanStage::ADVANCED;
+        }
+        partition.results.clear();
+        ++_nextPartition;
+        _nextResult = 0;
+    }
+
+    if (std::all_of(_partitions.begin(), _partitions.end(), [](const Partition& partition) {
+            return partition.isEOF;
+        })) {
+        _commonStats.isEOF = true;
+        return PlanStage::IS_EOF;
+    }
+
+    runRound();
+    _nextPartition = 0;
+
+    for (auto&& partition : _partitions) {
+        if (!partition.status.isOK()) {
+            *out = WorkingSetCommon::allocateStatusMember(_workingSet, partition.status);
+            return PlanStage::FAILURE;
+        }
+    }
+    return PlanStage::NEED_TIME;
+}
+
+bool GatherStage::isEOF() {
+    return _commonStats.isEOF;
+}
+
+void GatherStage::partition() {
+    auto recordStore = _collection->getRecordStore();
+    auto first = recordStore->getCursor(getOpCtx(), true)->next();
+    auto last = recordStore->getCursor(getOpCtx(), false)->next();
+
+    _partitions.clear();
+    _partitions.emplace_back();
+    if (!first || !last || first->id >= last->id) {
+        _specificStats.partitions = _partitions.size();
+        return;
+    }
+
+    // RecordIds are assigned in increasing order, so ranges of equal width hold about as many
+    // records unless the collection has seen many deletes. The first and last ranges are left
+    // unbounded to cover records inserted at either end while the scan runs.
+    const unsigned long long width = last->id.repr() - first->id.repr();
+    const size_t numPartitions =
+        static_cast<size_t>(std::min<unsigned long long>(_degreeOfParallelism, width));
+    for (size_t i = 1; i < numPartitions; ++i) {
+        const RecordId boundary(first->id.repr() +
+                                static_cast<long long>(width / numPartitions * i));
+        _partitions.back().end = boundary;
+        _partitions.emplace_back();
+        _partitions.back().next = boundary;
+    }
+    _specificStats.partitions = _partitions.size();
+}
+
+void GatherStage::runRound() {
+    const size_t maxRecords =
+        std::max(1, internalQueryExecParallelCollectionScanRoundSize.load());
+
+    stdx::mutex mutex;
+    stdx::condition_variable allDone;
+    size_t numRunning = 0;
+
+    {
+        // The workers use the state above, so wait for them even if this thread throws.
+        ON_BLOCK_EXIT([&] {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            allDone.wait(lk, [&] { return numRunning == 0; });
+        });
+
+        Partition* ownPartition = nullptr;
+        for (auto&& partition : _partitions) {
+            if (partition.isEOF) {
+                continue;
+            }
+            if (!ownPartition) {
+                // Scanned by this thread once the others are started.
+                ownPartition = &partition;
+                continue;
+            }
+
+            Partition* const workerPartition = &partition;
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                ++numRunning;
+            }
+            auto status = getWorkerPool()->schedule([&, workerPartition] {
+                ON_BLOCK_EXIT([&] {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    if (--numRunning == 0) {
+                        allDone.notify_all();
+                    }
+                });
+                try {
+                    auto opCtx = cc().makeOperationContext();
+                    opCtx->setDeadlineByDate(getOpCtx()->getDeadline());
+                    scanPartition(opCtx.get(), workerPartition, maxRecords);
+                } catch (...) {
+                    workerPartition->status = exceptionToStatus();
+                }
+            });
+            if (!status.isOK()) {
+                // The pool is shutting down. Scan the partition on this thread instead.
+                {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    --numRunning;
+                }
+                scanPartition(getOpCtx(), workerPartition, maxRecords);
+            }
+        }
+
+        if (ownPartition) {
+            scanPartition(getOpCtx(), ownPartition, maxRecords);
+        }
+    }
+    ++_specificStats.rounds;
+
+    _specificStats.docsTested = 0;
+    for (auto&& partition : _partitions) {
+        _specificStats.docsTested += partition.docsTested;
+    }
+}
+
+void GatherStage::scanPartition(OperationContext* opCtx,
+                                Partition* partition,
+                                size_t maxRecords) const {
+    try {
+        auto cursor = _collection->getRecordStore()->getCursor(opCtx, true);
+        if (!partition->next.isNull()) {
+            invariant(cursor->seekNear(partition->next));
+        }
+        for (size_t i = 0; i < maxRecords; ++i) {
+            // killOp and maxTimeMS only reach the operation this stage belongs to, not the ones
+            // of the workers.
+            auto interruptStatus = getOpCtx()->checkForInterruptNoAssert();
+            if (!interruptStatus.isOK()) {
+                partition->status = interruptStatus;
+                return;
+            }
+
+            auto record = cursor->next();
+            if (!record || (!partition->end.isNull() && record->id >= partition->end)) {
+                partition->isEOF = true;
+                return;
+            }
+            partition->next = RecordId(record->id.repr() + 1);
+            ++partition->docsTested;
+
+            BSONObj doc = record->data.toBson();
+            if (!_filter || _filter->matchesBSON(doc)) {
+                partition->results.emplace_back(record->id, doc.getOwned());
+            }
+        }
+    } catch (const WriteConflictException&) {
+        // Keep what was read so far. The next round picks up from there with a new snapshot.
+    } catch (...) {
+        partition->status = exceptionToStatus();
+    }
+}
+
+unique_ptr<PlanStageStats> GatherStage::getStats() {
+    // Add a BSON representation of the filter to the stats tree, if there is one.
+    if (NULL != _filter) {
+        BSONObjBuilder bob;
+        _filter->serialize(&bob);
+        _commonStats.filter = bob.obj();
+    }
+
+    unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_GATHER);
+    ret->specific = make_unique<GatherStats>(_specificStats);
+    return ret;
+}
+
+const SpecificStats* GatherStage::getSpecificStats() const {
+    return &_specificStats;
+}
+
+}  // namespace mongo
@@ -0,0 +1,149 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+class Collection;
+class MatchExpression;
+class WorkingSet;
+
+/**
+ * Scans a collection forwards with several threads. The collection is split into ranges of
+ * RecordIds, and in each round every range which isn't exhausted has the next
+ * internalQueryExecParallelCollectionScanRoundSize records read and filtered by a thread of its
+ * own. The results of a round are returned before the next round starts, so they come out in no
+ * particular order.
+ *
+ * The worker threads take no locks: the stage waits for each round to finish, and a round only
+ * starts from within work(), while the query's own locks protect the collection. Each worker
+ * reads from a storage engine snapshot of its own, so this stage must only be used by reads which
+ * don't need a single point-in-time view of the collection, on storage engines supporting
+ * document-level locking.
+ *
+ * Preconditions: the filter must be safe to evaluate from several threads at once, see
+ * canScanInParallel().
+ */
+class GatherStage final : public PlanStage {
+public:
+    GatherStage(OperationContext* opCtx,
+                const Collection* collection,
+                size_t degreeOfParallelism,
+                WorkingSet* workingSet,
+                const MatchExpression* filter);
+
+    /**
+     * Returns true if a forward scan of 'collection' filtered by 'filter' may be done by a
+     * GatherStage: the collection is large enough, its record store can seek to any RecordId, and
+     * 'filter' can be evaluated by several threads at once.
+     */
+    static bool canScanInParallel(OperationContext* opCtx,
+                                  const Collection* collection,
+                                  const MatchExpression* filter);
+
+    StageState doWork(WorkingSetID* out) final;
+    bool isEOF() final;
+
+    StageType stageType() const final {
+        return STAGE_GATHER;
+    }
+
+    std::unique_ptr<PlanStageStats> getStats() final;
+
+    const SpecificStats* getSpecificStats() const final;
+
+    static const char* kStageType;
+
+private:
+    /**
+     * A range of RecordIds scanned by one thread, and the results of its current round.
+     */
+    struct Partition {
+        // The RecordId at which the next round resumes the scan. Null for the beginning of the
+        // collection.
+        RecordId next;
+
+        // The first RecordId past the range, or null if the range has no upper bound.
+        RecordId end;
+
+        bool isEOF = false;
+
+        // The documents which passed the filter in the current round, owned.
+        std::vector<std::pair<RecordId, BSONObj>> results;
+
+        size_t docsTested = 0;
+
+        // Set if the current round failed.
+        Status status = Status::OK();
+    };
+
+    /**
+     * Splits the collection into '_degreeOfParallelism' ranges of RecordIds of about the same
+     * width.
+     */
+    void partition();
+
+    /**
+     * Scans every partition which isn't exhausted by one round, one of them on this thread and
+     * the others on the shared worker pool, and waits for all of them to finish.
+     */
+    void runRound();
+
+    /**
+     * Reads the next records of 'partition' with a cursor of 'opCtx' and keeps those which pass
+     * '_filter'.
+     */
+    void scanPartition(OperationContext* opCtx, Partition* partition, size_t maxRecords) const;
+
+    // Not owned by us.
+    const Collection* _collection;
+    WorkingSet* _workingSet;
+    const MatchExpression* _filter;
+
+    const size_t _degreeOfParallelism;
+
+    bool _partitioned = false;
+    std::vector<Partition> _partitions;
+
+    // Position of the next result to return from the current round.
+    size_t _nextPartition = 0;
+    size_t _nextResult = 0;
+
+    GatherStats _specificStats;
+};
+
+}  // namespace mongo
@@ -30,14 +30,19 @@
 
 #include "mongo/db/exec/idhack.h"
 
+#include <algorithm>
+
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/projection.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/index/btree_access_method.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/indexability.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 
@@ -91,6 +96,25 @@ IDHackStage::IDHackStage(OperationContext* opCtx,
     _accessMethod = catalog->getIndex(descriptor);
 }
 
+IDHackStage::IDHackStage(OperationContext* opCtx,
+                         const Collection* collection,
+                         CanonicalQuery* query,
+                         const BSONObj& key,
+                         WorkingSet* ws,
+                         const IndexDescriptor* descriptor)
+    : PlanStage(kStageType, opCtx),
+      _collection(collection),
+      _workingSet(ws),
+      _key(key),
+      _filter(query->root()),
+      _done(false),
+      _addKeyMetadata(false),
+      _idBeingPagedIn(WorkingSet::INVALID_ID) {
+    const IndexCatalog* catalog = _collection->getIndexCatalog();
+    _specificStats.indexName = descriptor->indexName();
+    _accessMethod = catalog->getIndex(descriptor);
+}
+
 IDHackStage::~IDHackStage() {}
 
 bool IDHackStage::isEOF() {
@@ -179,6 +203,14 @@ PlanStage::StageState IDHackStage::advance(WorkingSetID id,
                                            WorkingSetID* out) {
     invariant(member->hasObj());
 
+    // Unlike _id, the fields of another index may have changed while the document was paged in.
+    if (_filter && !Filter::passes(member, _filter)) {
+        _workingSet->free(id);
+        _commonStats.isEOF = true;
+        _done = true;
+        return PlanStage::IS_EOF;
+    }
+
     if (_addKeyMetadata) {
         BSONObjBuilder bob;
         BSONObj ownedKeyObj = member->obj.value()["_id"].wrap().getOwned();
@@ -238,6 +270,82 @@ bool IDHackStage::supportsQuery(Collection* collection, const CanonicalQuery& qu
         CollatorInterface::collatorsMatch(query.getCollator(), collection->getDefaultCollator());
 }
 
+// static
+const IndexDescriptor* IDHackStage::findUniqueIndexForQuery(OperationContext* opCtx,
+                                                            const Collection* collection,
+                                                            const CanonicalQuery& query,
+                                                            BSONObj* keyOut) {
+    const QueryRequest& qr = query.getQueryRequest();
+    if (qr.showRecordId() || !qr.getHint().isEmpty() || qr.getSkip() || qr.isTailable() ||
+        (query.getProj() && query.getProj()->wantIndexKey())) {
+        return nullptr;
+    }
+
+    // Every predicate must be an equality to a value which the index holds as is. This leaves out
+    // null, which also matches missing fields, and arrays, which also match their elements.
+    const BSONObj& filter = qr.getFilter();
+    if (filter.isEmpty()) {
+        return nullptr;
+    }
+    for (auto&& elt : filter) {
+        if (elt.fieldName()[0] == '$' || !Indexability::isExactBoundsGenerating(elt)) {
+            return nullptr;
+        }
+    }
+
+    // Equalities on exactly the fields of a unique index match at most one document. The index
+    // mustn't be partial, as it would only be unique among the documents it holds.
+    const IndexCatalog* catalog = collection->getIndexCatalog();
+    IndexCatalog::IndexIterator ii = catalog->getIndexIterator(opCtx, false);
+    while (ii.more()) {
+        const IndexDescriptor* desc = ii.next();
+        if (!desc->unique() || desc->isPartial() ||
+            desc->getAccessMethodName() != IndexNames::BTREE ||
+            desc->keyPattern().nFields() != filter.nFields()) {
+            continue;
+        }
+
+        // With a collator, IndexAccessMethod::findSingle() generates the key from a document
+        // rather than seeking to the key it is given, so the index is left to the planner.
+        if (catalog->getEntry(desc)->getCollator() || query.getCollator()) {
+            continue;
+        }
+
+        BSONObjBuilder keyBuilder;
+        bool hasAllFields = true;
+        for (auto&& keyElt : desc->keyPattern()) {
+            BSONElement value = filter[keyElt.fieldNameStringData()];
+            if (!value) {
+                hasAllFields = false;
+                break;
+            }
+            keyBuilder.appendAs(value, "");
+        }
+
+        if (!hasAllFields) {
+            continue;
+        }
+
+        // The planner answers a projection of only indexed fields from the index keys, without
+        // fetching the document.
+        const ParsedProjection* proj = query.getProj();
+        if (proj && !proj->requiresDocument()) {
+            const BSONObj& keyPattern = desc->keyPattern();
+            const auto& fields = proj->getRequiredFields();
+            if (std::all_of(fields.begin(), fields.end(), [&keyPattern](StringData field) {
+                    return keyPattern.hasField(field);
+                })) {
+                return nullptr;
+            }
+        }
+
+        *keyOut = keyBuilder.obj();
+        return desc;
+    }
+
+    return nullptr;
+}
+
 unique_ptr<PlanStageStats> IDHackStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_IDHACK);
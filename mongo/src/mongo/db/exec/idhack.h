@@ -44,6 +44,9 @@ class RecordCursor;
  * A standalone stage implementing the fast path for key-value retrievals via the _id index. Since
  * the _id index always has the collection default collation, the IDHackStage can only be used when
  * the query's collation is equal to the collection default.
+ *
+ * The same fast path serves equalities on every field of another unique index, see
+ * findUniqueIndexForQuery(). The document found is then tested against the query.
  */
 //ֵѯIDHackֱӲѯ  //IDοprepareExecution
 class IDHackStage final : public PlanStage {
@@ -61,6 +64,17 @@ public:
                 WorkingSet* ws,
                 const IndexDescriptor* descriptor);
 
+    /**
+     * Looks up 'key', as returned by findUniqueIndexForQuery(), in the unique index 'descriptor'
+     * and returns the document found if it matches 'query'.
+     */
+    IDHackStage(OperationContext* opCtx,
+                const Collection* collection,
+                CanonicalQuery* query,
+                const BSONObj& key,
+                WorkingSet* ws,
+                const IndexDescriptor* descriptor);
+
     ~IDHackStage();
 
     bool isEOF() final;
@@ -77,6 +91,18 @@ public:
      */
     static bool supportsQuery(Collection* collection, const CanonicalQuery& query);
 
+    /**
+     * Returns a unique btree index whose every field the query tests for equality to a value with
+     * exact index bounds, and nothing else, so that at most one document can match. Sets 'keyOut'
+     * to the index key to look up. Returns null if there is no such index, or if the query needs
+     * more than the fast path provides. Indexes and queries with a collation are left to the
+     * planner, as are projections which the index could cover, since the fast path always fetches.
+     */
+    static const IndexDescriptor* findUniqueIndexForQuery(OperationContext* opCtx,
+                                                          const Collection* collection,
+                                                          const CanonicalQuery& query,
+                                                          BSONObj* keyOut);
+
     StageType stageType() const final {
         return STAGE_IDHACK;
     }
@@ -106,9 +132,12 @@ private:
     // Not owned here.
     const IndexAccessMethod* _accessMethod;
 
-    // The value to match against the _id field.
+    // The value to match against the _id field, or the key to look up in another unique index.
     BSONObj _key;
 
+    // The query the document found must match, when the index is not the _id index. Not owned.
+    const MatchExpression* _filter = nullptr;
+
     // Have we returned our one document?
     bool _done;
 
@@ -88,6 +88,7 @@ IndexScan::IndexScan(OperationContext* opCtx,
     _specificStats.isSparse = _params.descriptor->isSparse();
     _specificStats.isPartial = _params.descriptor->isPartial();
     _specificStats.indexVersion = static_cast<int>(_params.descriptor->version());
+    _specificStats.isSkipScan = _params.isSkipScan;
 }
 
 /*
@@ -312,6 +313,24 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) { //PlanStage::work
     return PlanStage::ADVANCED;
 }
 
+PlanStage::StageState IndexScan::doWorkBatch(size_t maxWorks, Batch* batch) {
+    // Results only hold owned keys and RecordIds, so they stay valid as the cursor moves on.
+    for (size_t i = 0; i < maxWorks; ++i) {
+        ++batch->works;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = doWork(&id);
+
+        if (PlanStage::ADVANCED == state) {
+            batch->ids.push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            batch->stateId = id;
+            return state;
+        }
+    }
+
+    return PlanStage::NEED_TIME;
+}
+
 bool IndexScan::isEOF() {
     return _commonStats.isEOF;
 }
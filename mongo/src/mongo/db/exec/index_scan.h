@@ -47,7 +47,12 @@ class WorkingSet;
 
 struct IndexScanParams {
     IndexScanParams()
-        : descriptor(NULL), direction(1), doNotDedup(false), maxScan(0), addKeyMetadata(false) {}
+        : descriptor(NULL),
+          direction(1),
+          doNotDedup(false),
+          maxScan(0),
+          addKeyMetadata(false),
+          isSkipScan(false) {}
 
     const IndexDescriptor* descriptor;
 
@@ -62,6 +67,10 @@ struct IndexScanParams {
 
     // Do we want to add the key as metadata?
     bool addKeyMetadata;
+
+    // Do the bounds skip between the distinct values of leading fields of the index? Only
+    // reported in the stats, the bounds checker does the skipping either way.
+    bool isSkipScan;
 };
 
 /**
@@ -96,6 +105,7 @@ public:
               const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, Batch* batch) final;
     bool isEOF() final;
     void doSaveState() final;
     void doRestoreState() final;
@@ -111,6 +121,13 @@ public:
 
     const SpecificStats* getSpecificStats() const final;
 
+    /**
+     * The bounds of the scan. Unlike the 'indexBounds' of the stats, available without getStats().
+     */
+    const IndexBounds& getBounds() const {
+        return _params.bounds;
+    }
+
     static const char* kStageType;
 
 private:
@@ -86,6 +86,30 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState LimitStage::doWorkBatch(size_t maxWorks, Batch* batch) {
+    if (0 == _numToReturn) {
+        ++batch->works;
+        return PlanStage::IS_EOF;
+    }
+
+    // Every unit of work produces at most one result, so bounding the child's budget by the
+    // number of results left means we never read ahead of the limit.
+    const size_t numBefore = batch->ids.size();
+    StageState status =
+        child()->workBatch(std::min(maxWorks, static_cast<size_t>(_numToReturn)), batch);
+    _numToReturn -= batch->ids.size() - numBefore;
+
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) &&
+        WorkingSet::INVALID_ID == batch->stateId) {
+        mongoutils::str::stream ss;
+        ss << "limit stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        batch->stateId = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> LimitStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_LIMIT);
@@ -45,13 +45,33 @@
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+namespace {
+
+/**
+ * Returns the lower and upper bounds of the Wilson score interval, 'z' standard deviations wide,
+ * around the fraction of the works of a plan which advanced.
+ */
+std::pair<double, double> productivityBounds(const CommonStats& stats, double z) {
+    const double n = static_cast<double>(stats.works);
+    const double p = static_cast<double>(stats.advanced) / n;
+    const double zSquaredOverN = z * z / n;
+    const double center = (p + zSquaredOverN / 2) / (1 + zSquaredOverN);
+    const double halfWidth =
+        z * std::sqrt(p * (1 - p) / n + zSquaredOverN / (4 * n)) / (1 + zSquaredOverN);
+    return {center - halfWidth, center + halfWidth};
+}
+
+}  // namespace
+
 using std::endl;
 using std::list;
 using std::unique_ptr;
@@ -155,6 +175,27 @@ PlanStage::StageState MultiPlanStage::doWork(WorkingSetID* out) {
     return state;
 }
 
+PlanStage::StageState MultiPlanStage::doWorkBatch(size_t maxWorks, Batch* batch) {
+    // Switching to the backup plan happens one result at a time in doWork().
+    if (_failure || hasBackupPlan()) {
+        return PlanStage::doWorkBatch(maxWorks, batch);
+    }
+
+    CandidatePlan& bestPlan = _candidates[_bestPlanIdx];
+
+    // The results buffered during the trial period are owned, so hand them out as a batch.
+    if (!bestPlan.results.empty()) {
+        for (size_t i = 0; i < maxWorks && !bestPlan.results.empty(); ++i) {
+            ++batch->works;
+            batch->ids.push_back(bestPlan.results.front());
+            bestPlan.results.pop_front();
+        }
+        return PlanStage::NEED_TIME;
+    }
+
+    return bestPlan.root->workBatch(maxWorks, batch);
+}
+
 //ǷkillûóCPUԴ
 Status MultiPlanStage::tryYield(PlanYieldPolicy* yieldPolicy) {
     // These are the conditions which can cause us to yield:
@@ -184,7 +225,9 @@ Status MultiPlanStage::tryYield(PlanYieldPolicy* yieldPolicy) {
 //MultiPlanStage::pickBestPlanִ
 //ȡcollectionܼ¼*0.2910000Сɨ10000Σ10000ôɨcollection*0.29Ρ  
 // static     
-size_t MultiPlanStage::getTrialPeriodWorks(OperationContext* opCtx, const Collection* collection) {
+size_t MultiPlanStage::getTrialPeriodWorks(OperationContext* opCtx,
+                                           const Collection* collection,
+                                           size_t numCandidates) {
     // Run each plan some number of times. This number is at least as great as
     // 'internalQueryPlanEvaluationWorks', but may be larger for big collections.
     size_t numWorks = internalQueryPlanEvaluationWorks.load();
@@ -199,9 +242,17 @@ size_t MultiPlanStage::getTrialPeriodWorks(OperationContext* opCtx, const Collec
         // fraction of the collection size.
         double fraction = internalQueryPlanEvaluationCollFraction;
 
+        double fractionWorks = fraction * collection->numRecords(opCtx);
+
+        // The fraction was chosen for a race between two plans. With more candidates, share
+        // the works it adds among them so that the trial period doesn't grow with their number.
+        if (internalQueryPlanEvaluationScaleByCandidates.load() && numCandidates > 2) {
+            fractionWorks = fractionWorks * 2 / numCandidates;
+        }
+
         numWorks = std::max(static_cast<size_t>(internalQueryPlanEvaluationWorks.load()),
 							// WiredTigerRecordStore::numRecords   collectionܼ¼
-                            static_cast<size_t>(fraction * collection->numRecords(opCtx)));
+                            static_cast<size_t>(fractionWorks));
     }
 
     return numWorks;
@@ -250,10 +301,12 @@ Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis); 
 
 	//ȡcollectionܼ¼*0.2910000Сɨ10000Σ10000ôɨcollection*0.29Ρ  
-    size_t numWorks = getTrialPeriodWorks(getOpCtx(), _collection);
+    size_t numWorks = getTrialPeriodWorks(getOpCtx(), _collection, _candidates.size());
 	//ȡNToReturn  limit internalQueryPlanEvaluationMaxResultsСֵ
     size_t numResults = getTrialPeriodNumToReturn(*_query);
 
+    Timer trialTimer;
+
     // Work the plans, stopping when a plan hits EOF or returns some
     // fixed number of results.
     for (size_t ix = 0; ix < numWorks; ++ix) {
@@ -263,6 +316,20 @@ Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
         if (!moreToDo) {
             break;
         }
+
+        // Once a single candidate is left running, the race is decided.
+        if (internalQueryPlanEvaluationEarlyTermination.load() && !terminateDominatedPlans()) {
+            break;
+        }
+    }
+
+    if (PlanCache::shouldCacheQuery(*_query)) {
+        long long trialWorks = 0;
+        for (auto&& candidate : _candidates) {
+            trialWorks += candidate.root->getCommonStats()->works;
+        }
+        _collection->infoCache()->getPlanCache()->notifyOfMultiPlanning(
+            *_query, trialTimer.micros(), trialWorks);
     }
 
     if (_failure) {
@@ -404,7 +471,7 @@ bool MultiPlanStage::workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolic
 	//ѡĲѯƻ_candidatesе
     for (size_t ix = 0; ix < _candidates.size(); ++ix) {
         CandidatePlan& candidate = _candidates[ix];
-        if (candidate.failed) {
+        if (candidate.failed || candidate.terminatedEarly) {
             continue;
         }
 
@@ -479,6 +546,47 @@ bool MultiPlanStage::workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolic
     return !doneWorking;
 }
 
+bool MultiPlanStage::terminateDominatedPlans() {
+    const size_t minWorks =
+        std::max(1, internalQueryPlanEvaluationMinWorksBeforeTermination.load());
+    const double z = internalQueryPlanEvaluationTerminationStdDevs.load();
+
+    // Find the candidate whose productivity is known to be the highest with most confidence.
+    double bestLowerBound = 0;
+    for (auto&& candidate : _candidates) {
+        const CommonStats* stats = candidate.root->getCommonStats();
+        if (candidate.failed || stats->works < minWorks) {
+            continue;
+        }
+        bestLowerBound = std::max(bestLowerBound, productivityBounds(*stats, z).first);
+    }
+
+    if (bestLowerBound <= 0) {
+        return true;
+    }
+
+    size_t numRunning = 0;
+    for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+        CandidatePlan& candidate = _candidates[ix];
+        if (candidate.failed || candidate.terminatedEarly) {
+            continue;
+        }
+
+        const CommonStats* stats = candidate.root->getCommonStats();
+        if (!candidate.solution->hasBlockingStage && stats->works >= minWorks &&
+            productivityBounds(*stats, z).second < bestLowerBound) {
+            LOG(2) << "Terminating candidate " << ix << " early after " << stats->works
+                   << " works and " << stats->advanced << " results";
+            candidate.terminatedEarly = true;
+            continue;
+        }
+
+        ++numRunning;
+    }
+
+    return numRunning > 1;
+}
+
 namespace {
 
 void invalidateHelper(OperationContext* opCtx,
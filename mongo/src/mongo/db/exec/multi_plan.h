@@ -86,6 +86,7 @@ public:
     bool isEOF() final;
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, Batch* batch) final;
 
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
 
@@ -119,9 +120,12 @@ public:
     /**
      * Returns the number of times that we are willing to work a plan during a trial period.
      *
-     * Calculated based on a fixed query knob and the size of the collection.
+     * Calculated based on a fixed query knob, the size of the collection and the number of
+     * candidate plans racing against each other.
      */
-    static size_t getTrialPeriodWorks(OperationContext* opCtx, const Collection* collection);
+    static size_t getTrialPeriodWorks(OperationContext* opCtx,
+                                      const Collection* collection,
+                                      size_t numCandidates);
 
     /**
      * Returns the max number of documents which we should allow any plan to return during the
@@ -171,6 +175,16 @@ private:
      */
     bool workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolicy);
 
+    /**
+     * Stops working the candidates whose productivity, the fraction of their works which
+     * advanced, is statistically below that of the most productive candidate. Candidates with a
+     * blocking stage are never stopped, as they produce nothing until they unblock.
+     *
+     * Returns false if at most one candidate is left running, in which case the trial period is
+     * over.
+     */
+    bool terminateDominatedPlans();
+
     /**
      * Checks whether we need to perform either a timing-based yield or a yield for a document
      * fetch. If so, then uses 'yieldPolicy' to actually perform the yield.
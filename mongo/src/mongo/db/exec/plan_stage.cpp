@@ -122,6 +122,48 @@ PlanStage::StageState PlanStage::work(WorkingSetID* out) {   //
     return workResult;
 }
 
+PlanStage::StageState PlanStage::workBatch(size_t maxWorks, Batch* batch) {
+    invariant(_opCtx);
+    invariant(maxWorks > 0);
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+
+    const size_t idsBefore = batch->ids.size();
+    const size_t worksBefore = batch->works;
+    StageState workResult = doWorkBatch(maxWorks, batch);
+
+    const size_t works = batch->works - worksBefore;
+    const size_t advanced = batch->ids.size() - idsBefore;
+    const size_t ended = (StageState::NEED_TIME == workResult) ? 0 : 1;
+    invariant(works >= advanced + ended);
+
+    _commonStats.works += works;
+    _commonStats.advanced += advanced;
+    _commonStats.needTime += works - advanced - ended;
+    if (StageState::NEED_YIELD == workResult) {
+        ++_commonStats.needYield;
+    }
+
+    return workResult;
+}
+
+PlanStage::StageState PlanStage::doWorkBatch(size_t maxWorks, Batch* batch) {
+    // Producing a single result keeps any storage engine memory backing it valid until the caller
+    // asks for more, so stages without a batched implementation need not own their results.
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    ++batch->works;
+    StageState state = doWork(&id);
+
+    if (StageState::ADVANCED == state) {
+        batch->ids.push_back(id);
+        return StageState::NEED_TIME;
+    }
+
+    if (StageState::NEED_TIME != state) {
+        batch->stateId = id;
+    }
+    return state;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
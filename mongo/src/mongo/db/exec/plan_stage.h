@@ -182,6 +182,20 @@ public:
     }
 
 
+    /**
+     * The output of a call to workBatch().
+     */
+    struct Batch {
+        // The results produced by the batch, in output order.
+        std::vector<WorkingSetID> ids;
+
+        // Set as work() would set its out parameter for the state which ended the batch.
+        WorkingSetID stateId = WorkingSet::INVALID_ID;
+
+        // Number of units of work performed, including the one which ended the batch.
+        size_t works = 0;
+    };
+
     /**
      * Perform a unit of work on the query.  Ask the stage to produce the next unit of output.
      * Stage returns StageState::ADVANCED if *out is set to the next unit of output.  Otherwise,
@@ -189,6 +203,20 @@ public:
      */
     StageState work(WorkingSetID* out);
 
+    /**
+     * Batched variant of work(). Performs at most 'maxWorks' units of work, appending the id of
+     * every ADVANCED result to 'batch->ids'. Returns NEED_TIME if the batch ended because the work
+     * budget ran out, or otherwise the first IS_EOF, NEED_YIELD, DEAD or FAILURE encountered, in
+     * which case 'batch->stateId' is set as the out parameter of work() would have been.
+     *
+     * Results appended to the batch are valid whatever the returned state is, and the caller must
+     * consume them before acting on the state. Whenever a stage produces more than one result per
+     * batch it guarantees that their objects are owned, so that they remain valid while the stage
+     * continues to do work. Stages which don't implement batching produce at most one result per
+     * call.
+     */
+    StageState workBatch(size_t maxWorks, Batch* batch);
+
     /**
      * Returns true if no more work can be done on the query / out of results.
      */
@@ -348,6 +376,14 @@ protected:
      */ //Ӧ//IndexScan::doWork()  CollectionScan::doWork(ȫɨ)  
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs up to 'maxWorks' units of work.  See comment at workBatch() above.  Implementations
+     * must increment 'batch->works' once per unit of work performed.
+     *
+     * The default implementation performs a single unit of work through doWork().
+     */
+    virtual StageState doWorkBatch(size_t maxWorks, Batch* batch);
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
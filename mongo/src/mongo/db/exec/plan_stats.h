@@ -231,7 +231,13 @@ private:
 };
 
 struct AndHashStats : public SpecificStats {
-    AndHashStats() : flaggedButPassed(0), flaggedInProgress(0), memUsage(0), memLimit(0) {}
+    AndHashStats()
+        : flaggedButPassed(0),
+          flaggedInProgress(0),
+          memUsage(0),
+          memLimit(0),
+          filterRejects(0),
+          recordIdsOnly(false) {}
 
     SpecificStats* clone() const final {
         AndHashStats* specific = new AndHashStats(*this);
@@ -258,6 +264,12 @@ struct AndHashStats : public SpecificStats {
 
     // What's our memory limit?
     size_t memLimit;
+
+    // How many children's results did the Bloom filter rule out of the intersection?
+    size_t filterRejects;
+
+    // Did we discard buffered index keys and documents to stay under the memory limit?
+    bool recordIdsOnly;
 };
 
 
@@ -307,10 +319,20 @@ struct CollectionScanStats : public SpecificStats {
     // sees a document that does not pass the filter and has a "ts" Timestamp field greater than
     // 'maxTs'.
     boost::optional<Timestamp> maxTs;
+
+    // True once the filter has been applied to a batch of documents by a ColumnarFilter.
+    bool columnarFilter = false;
 };
 
 struct CountStats : public SpecificStats {
-    CountStats() : nCounted(0), nSkipped(0), recordStoreCount(false) {}
+    CountStats()
+        : nCounted(0),
+          nSkipped(0),
+          recordStoreCount(false),
+          approximate(false),
+          nSampled(0),
+          nSampleMatched(0),
+          errorBound(0) {}
 
     SpecificStats* clone() const final {
         CountStats* specific = new CountStats(*this);
@@ -325,6 +347,17 @@ struct CountStats : public SpecificStats {
 
     // True if we computed the count via Collection::numRecords().
     bool recordStoreCount;
+
+    // True if we estimated the count from a random sample of the collection.
+    bool approximate;
+
+    // How many documents did we sample, and how many of them matched the query?
+    long long nSampled;
+    long long nSampleMatched;
+
+    // The estimated count is within this many documents of the true count, with 95% confidence.
+    // Never zero for an estimate, even when none or all of the samples matched.
+    long long errorBound;
 };
 
 struct CountScanStats : public SpecificStats {
@@ -448,7 +481,7 @@ struct EnsureSortedStats : public SpecificStats {
 };
 
 struct FetchStats : public SpecificStats {
-    FetchStats() : alreadyHasObj(0), forcedFetches(0), docsExamined(0) {}
+    FetchStats() : alreadyHasObj(0), forcedFetches(0), docsExamined(0), prefetched(0) {}
 
     SpecificStats* clone() const final {
         FetchStats* specific = new FetchStats(*this);
@@ -464,6 +497,25 @@ struct FetchStats : public SpecificStats {
     // The total number of full documents touched by the fetch stage.
     //size_t docsExamined; FetchStage::returnIfMatches     keysExaminedIndexScan::doWork
     size_t docsExamined; //FetchStage::returnIfMatches
+
+    // How many documents were fetched ahead of time, in RecordId order, for a batch of results?
+    size_t prefetched;
+};
+
+struct GatherStats : public SpecificStats {
+    SpecificStats* clone() const final {
+        GatherStats* specific = new GatherStats(*this);
+        return specific;
+    }
+
+    // Into how many ranges of RecordIds was the collection split?
+    size_t partitions = 0;
+
+    // How many times were the partitions scanned in parallel?
+    size_t rounds = 0;
+
+    // How many documents did we check against our filter?
+    size_t docsTested = 0;
 };
 
 struct GroupStats : public SpecificStats {
@@ -504,6 +556,7 @@ struct IndexScanStats : public SpecificStats {
           isPartial(false),
           isSparse(false),
           isUnique(false),
+          isSkipScan(false),
           dupsTested(0),
           dupsDropped(0),
           seenInvalidated(0),
@@ -550,6 +603,9 @@ struct IndexScanStats : public SpecificStats {
     bool isSparse;
     bool isUnique;
 
+    // Whether the scan seeks from one distinct value of the leading index fields to the next.
+    bool isSkipScan;
+
     size_t dupsTested;
     size_t dupsDropped;
 
@@ -620,7 +676,15 @@ struct ProjectionStats : public SpecificStats {
 };
 
 struct SortStats : public SpecificStats {
-    SortStats() : forcedFetches(0), memUsage(0), memLimit(0) {}
+    SortStats()
+        : forcedFetches(0),
+          memUsage(0),
+          memLimit(0),
+          usedDisk(false),
+          spilledBytes(0),
+          spilledRuns(0),
+          lateFetches(0),
+          lateFetchDrops(0) {}
 
     SpecificStats* clone() const final {
         SortStats* specific = new SortStats(*this);
@@ -641,6 +705,21 @@ struct SortStats : public SpecificStats {
 
     // The pattern according to which we are sorting.
     BSONObj sortPattern;
+
+    // Did the sort write its data to disk because it went over 'memLimit'?
+    bool usedDisk;
+
+    // How many bytes of sort keys and documents were written to disk, after compression?
+    size_t spilledBytes;
+
+    // How many sorted runs were written to disk?
+    size_t spilledRuns;
+
+    // How many documents were buffered as just their sort key and RecordId and fetched again?
+    size_t lateFetches;
+
+    // How many of those were dropped because the document changed or went away in the meantime?
+    size_t lateFetchDrops;
 };
 
 struct MergeSortStats : public SpecificStats {
@@ -683,6 +762,30 @@ struct SkipStats : public SpecificStats {
     size_t skip;
 };
 
+struct SubplanBranchStats {
+    // Was the branch planned from a plan cache entry?
+    bool fromCache = false;
+    // The position of an earlier branch with the same shape whose index assignment this branch
+    // reused without being planned itself, or -1.
+    int sameShapeAs = -1;
+    // How many candidate plans did the planner produce for the branch?
+    size_t numCandidates = 0;
+    // Total works of the candidate plans during the branch's multi-planning trial period.
+    size_t trialWorks = 0;
+    // Time spent planning the branch, including the multi-planning trial period.
+    long long planningMicros = 0;
+};
+
+struct SubplanStats : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new SubplanStats(*this);
+    }
+
+    // How many $or branches were dropped because they were identical to an earlier branch?
+    size_t duplicateBranches = 0;
+    std::vector<SubplanBranchStats> branches;
+};
+
 struct IntervalStats {
     // Number of results found in the covering of this interval.
     long long numResultsBuffered = 0;
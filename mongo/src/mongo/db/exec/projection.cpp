@@ -227,6 +227,34 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::doWorkBatch(size_t maxWorks, Batch* batch) {
+    const size_t numBefore = batch->ids.size();
+    StageState status = child()->workBatch(maxWorks, batch);
+
+    for (size_t i = numBefore; i < batch->ids.size(); ++i) {
+        Status projStatus = transform(_ws->get(batch->ids[i]));
+        if (!projStatus.isOK()) {
+            warning() << "Couldn't execute projection, status = " << redact(projStatus);
+            for (size_t j = i; j < batch->ids.size(); ++j) {
+                _ws->free(batch->ids[j]);
+            }
+            batch->ids.resize(i);
+            batch->stateId = WorkingSetCommon::allocateStatusMember(_ws, projStatus);
+            return PlanStage::FAILURE;
+        }
+    }
+
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) &&
+        WorkingSet::INVALID_ID == batch->stateId) {
+        mongoutils::str::stream ss;
+        ss << "projection stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        batch->stateId = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_PROJECTION);
@@ -84,6 +84,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, Batch* batch) final;
 
     StageType stageType() const final {
         return STAGE_PROJECTION;
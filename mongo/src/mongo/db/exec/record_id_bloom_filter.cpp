@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bloom_filter.h"
+
+namespace mongo {
+
+namespace {
+
+// Odd multipliers which spread the low 32 bits of a hash into a different bit of each word.
+const uint32_t kSalts[] = {0x47b6137bU,
+                           0x44974d91U,
+                           0x8824ad5bU,
+                           0xa2b7289dU,
+                           0x705495c7U,
+                           0x2df1424bU,
+                           0x9efc4947U,
+                           0x5c6bfb31U};
+
+const size_t kBitsPerBlock = 256;
+
+}  // namespace
+
+const size_t RecordIdBloomFilter::kDefaultBitsPerKey = 12;
+
+RecordIdBloomFilter::RecordIdBloomFilter(size_t expectedKeys, size_t bitsPerKey) {
+    static_assert(sizeof(kSalts) / sizeof(kSalts[0]) == kWordsPerBlock,
+                  "need one salt for each word of a block");
+
+    const size_t wantedBlocks = (expectedKeys * bitsPerKey + kBitsPerBlock - 1) / kBitsPerBlock;
+    size_t numBlocks = 1;
+    while (numBlocks < wantedBlocks) {
+        numBlocks <<= 1;
+    }
+
+    _blocks.resize(numBlocks, Block{});
+    _blockMask = numBlocks - 1;
+}
+
+uint64_t RecordIdBloomFilter::hash(const RecordId& recordId) {
+    // The finalizer from MurmurHash3. RecordIds are frequently sequential, so their bits have to
+    // be mixed thoroughly before they are used to pick a block.
+    uint64_t h = static_cast<uint64_t>(recordId.repr());
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+void RecordIdBloomFilter::insert(const RecordId& recordId) {
+    const uint64_t h = hash(recordId);
+    Block& block = _blocks[blockIndex(h)];
+    for (size_t i = 0; i < kWordsPerBlock; ++i) {
+        block.words[i] |= 1U << ((static_cast<uint32_t>(h) * kSalts[i]) >> 27);
+    }
+}
+
+bool RecordIdBloomFilter::mayContain(const RecordId& recordId) const {
+    const uint64_t h = hash(recordId);
+    const Block& block = _blocks[blockIndex(h)];
+    for (size_t i = 0; i < kWordsPerBlock; ++i) {
+        if (!(block.words[i] & (1U << ((static_cast<uint32_t>(h) * kSalts[i]) >> 27)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace mongo
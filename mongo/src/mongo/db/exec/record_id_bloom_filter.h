@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+/**
+ * A blocked Bloom filter over RecordIds. Each RecordId maps to a single 32-byte block and sets one
+ * bit in each of the block's eight 32-bit words, so a membership test touches one cache line.
+ *
+ * mayContain() never returns false for an inserted RecordId. It returns true for a RecordId that
+ * was not inserted with a probability of roughly 1% at the default density.
+ */
+class RecordIdBloomFilter {
+public:
+    static const size_t kDefaultBitsPerKey;
+
+    /**
+     * Sizes the filter for 'expectedKeys' insertions at 'bitsPerKey' bits of filter per key.
+     */
+    explicit RecordIdBloomFilter(size_t expectedKeys, size_t bitsPerKey = kDefaultBitsPerKey);
+
+    void insert(const RecordId& recordId);
+
+    bool mayContain(const RecordId& recordId) const;
+
+    /**
+     * Returns the number of bytes of filter storage.
+     */
+    size_t sizeBytes() const {
+        return _blocks.size() * sizeof(Block);
+    }
+
+private:
+    static const size_t kWordsPerBlock = 8;
+
+    struct Block {
+        uint32_t words[kWordsPerBlock];
+    };
+
+    static uint64_t hash(const RecordId& recordId);
+
+    size_t blockIndex(uint64_t hash) const {
+        return (hash >> 32) & _blockMask;
+    }
+
+    std::vector<Block> _blocks;
+
+    // The number of blocks is a power of two, so this selects a block from the hash's high bits.
+    uint64_t _blockMask;
+};
+
+}  // namespace mongo
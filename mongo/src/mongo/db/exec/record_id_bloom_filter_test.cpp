@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/exec/record_id_bloom_filter.cpp
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bloom_filter.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(RecordIdBloomFilterTest, EmptyFilterContainsNothing) {
+    RecordIdBloomFilter filter(0);
+    for (int64_t i = 1; i <= 1000; ++i) {
+        ASSERT_FALSE(filter.mayContain(RecordId(i)));
+    }
+}
+
+TEST(RecordIdBloomFilterTest, HasNoFalseNegatives) {
+    const int64_t numKeys = 10000;
+    RecordIdBloomFilter filter(numKeys);
+    for (int64_t i = 0; i < numKeys; ++i) {
+        filter.insert(RecordId(i * 7 + 1));
+    }
+
+    for (int64_t i = 0; i < numKeys; ++i) {
+        ASSERT_TRUE(filter.mayContain(RecordId(i * 7 + 1)));
+    }
+}
+
+TEST(RecordIdBloomFilterTest, FalsePositiveRateIsLow) {
+    const int64_t numKeys = 10000;
+    RecordIdBloomFilter filter(numKeys);
+    for (int64_t i = 1; i <= numKeys; ++i) {
+        filter.insert(RecordId(i));
+    }
+
+    // Probe with RecordIds adjacent to the inserted ones, as an intersection would.
+    int falsePositives = 0;
+    for (int64_t i = numKeys + 1; i <= 11 * numKeys; ++i) {
+        if (filter.mayContain(RecordId(i))) {
+            ++falsePositives;
+        }
+    }
+    ASSERT_LT(falsePositives, numKeys * 10 * 3 / 100);
+}
+
+TEST(RecordIdBloomFilterTest, SizeIsRoundedUpToPowerOfTwoBlocks) {
+    ASSERT_EQ(RecordIdBloomFilter(0).sizeBytes(), 32U);
+    ASSERT_EQ(RecordIdBloomFilter(1).sizeBytes(), 32U);
+    ASSERT_EQ(RecordIdBloomFilter(100, 8).sizeBytes(), 128U);
+    ASSERT_EQ(RecordIdBloomFilter(1000, 8).sizeBytes(), 1024U);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -87,6 +87,33 @@ PlanStage::StageState SkipStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState SkipStage::doWorkBatch(size_t maxWorks, Batch* batch) {
+    const size_t numBefore = batch->ids.size();
+    StageState status = child()->workBatch(maxWorks, batch);
+
+    // Drop the results we're still skipping from the front of the child's batch.
+    const size_t numToDrop =
+        std::min(static_cast<size_t>(_toSkip), batch->ids.size() - numBefore);
+    if (numToDrop > 0) {
+        auto begin = batch->ids.begin() + numBefore;
+        for (auto it = begin; it != begin + numToDrop; ++it) {
+            _ws->free(*it);
+        }
+        batch->ids.erase(begin, begin + numToDrop);
+        _toSkip -= numToDrop;
+    }
+
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) &&
+        WorkingSet::INVALID_ID == batch->stateId) {
+        mongoutils::str::stream ss;
+        ss << "skip stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        batch->stateId = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> SkipStage::getStats() {
     _commonStats.isEOF = isEOF();
     _specificStats.skip = _toSkip;
@@ -33,6 +33,7 @@
 #include <algorithm>
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
@@ -41,8 +42,10 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
@@ -67,6 +70,14 @@ bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
     return lhs.recordId < rhs.recordId;
 }
 
+SortStage::SpillComparator::SpillComparator(BSONObj p) : pattern(p) {}
+
+int SortStage::SpillComparator::operator()(const SpillSorter::Data& lhs,
+                                           const SpillSorter::Data& rhs) const {
+    // The trailing RecordId isn't covered by the pattern, so it compares in ascending order.
+    return lhs.first.woCompare(rhs.first, pattern, false);
+}
+
 SortStage::SortStage(OperationContext* opCtx,
                      const SortStageParams& params,
                      WorkingSet* ws,
@@ -78,18 +89,14 @@ SortStage::SortStage(OperationContext* opCtx,
       _limit(params.limit),
       _sorted(false),
       _resultIterator(_data.end()),
-      _memUsage(0) {
+      _memUsage(0),
+      _allowDiskUse(params.allowDiskUse && !storageGlobalParams.readOnly),
+      _fetchLate(params.fetchLate && params.limit > 0 && params.collection),
+      _bufferLimit(_fetchLate ? 2 * _limit : _limit) {
     _children.emplace_back(child);
 
     BSONObj sortComparator = FindCommon::transformSortSpec(_pattern);
     _sortKeyComparator = stdx::make_unique<WorkingSetComparator>(sortComparator);
-
-    // If limit > 1, we need to initialize _dataSet here to maintain ordered set of data items while
-    // fetching from the child stage.
-    if (_limit > 1) {
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        _dataSet.reset(new SortableDataItemSet(cmp));
-    }
 }
 
 SortStage::~SortStage() {}
@@ -97,13 +104,24 @@ SortStage::~SortStage() {}
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
+    if (_spillIterator) {
+        return child()->isEOF() && _sorted && !_spillIterator->more();
+    }
     return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
 }
 
 PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
 	//һѯĵڴ
-	if (_memUsage > maxBytes) {
+    if (_memUsage > maxBytes && _allowDiskUse) {
+        try {
+            spill();
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+    }
+    if (_memUsage > maxBytes) {
         mongoutils::str::stream ss;
         ss << "Sort operation used more than the maximum " << maxBytes
            << " bytes of RAM. Add an index, or specify a smaller limit.";
@@ -131,8 +149,18 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
             // Planner must put a fetch before we get here.
             verify(member->hasObj());
 
+            if (_spillSorter && !canSpill(*member)) {
+                mongoutils::str::stream ss;
+                ss << "Sort operation used more than the maximum " << maxBytes
+                   << " bytes of RAM and cannot write results with text score or geo metadata "
+                      "to disk. Add an index, or specify a smaller limit.";
+                Status status(ErrorCodes::OperationFailed, ss);
+                *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+                return PlanStage::FAILURE;
+            }
+
             // We might be sorting something that was invalidated at some point.
-            if (member->hasRecordId()) {
+            if (!_spillSorter && member->hasRecordId()) {
                 _wsidByRecordId[member->recordId] = id;
             }
 
@@ -151,14 +179,29 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
                 item.recordId = member->recordId;
             }
 
-            addToBuffer(item);
+            if (_spillSorter) {
+                addToSpillSorter(item);
+            } else {
+                if (_fetchLate && member->getState() == WorkingSetMember::RID_AND_OBJ) {
+                    dropDocument(member, &item);
+                }
+                addToBuffer(item);
+            }
 
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
-            _resultIterator = _data.begin();
+            if (_spillSorter) {
+                _spillIterator.reset(_spillSorter->done());
+                _specificStats.spilledRuns = _spillSorter->numFiles();
+                _specificStats.spilledBytes = _spillSorter->bytesSpilled();
+                _specificStats.usedDisk = _specificStats.spilledRuns > 0;
+                _spillSorter.reset();
+            } else {
+                sortBuffer();
+                _resultIterator = _data.begin();
+            }
             _sorted = true;
             return PlanStage::NEED_TIME;
         } else if (PlanStage::FAILURE == code || PlanStage::DEAD == code) {
@@ -181,18 +224,52 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     }
 
     // Returning results.
+    if (_spillIterator) {
+        verify(_sorted);
+        *out = nextFromSpillIterator();
+        return PlanStage::ADVANCED;
+    }
+
     verify(_resultIterator != _data.end());
     verify(_sorted);
-    *out = _resultIterator->wsid;
+
+    bool fetched = true;
+    if (_resultIterator->fetchLate) {
+        try {
+            fetched = fetchLate(*_resultIterator);
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+    }
+
+    WorkingSetID id = _resultIterator->wsid;
     _resultIterator++;
 
     // If we're returning something, take it out of our DL -> WSID map so that future
     // calls to invalidate don't cause us to take action for a DL we're done with.
-    WorkingSetMember* member = _ws->get(*out);
+    WorkingSetMember* member = _ws->get(id);
     if (member->hasRecordId()) {
         _wsidByRecordId.erase(member->recordId);
     }
 
+    if (!fetched) {
+        _ws->free(id);
+        return PlanStage::NEED_TIME;
+    }
+
+    // Once the limit is reached, the spares left over are not needed.
+    if (++_numResults == _limit) {
+        for (; _resultIterator != _data.end(); ++_resultIterator) {
+            WorkingSetMember* spare = _ws->get(_resultIterator->wsid);
+            if (spare->hasRecordId()) {
+                _wsidByRecordId.erase(spare->recordId);
+            }
+            _ws->free(_resultIterator->wsid);
+        }
+    }
+
+    *out = id;
     return PlanStage::ADVANCED;
 }
 
@@ -240,9 +317,9 @@ const SpecificStats* SortStage::getSpecificStats() const {
 
 /**
  * addToBuffer() and sortBuffer() work differently based on the
- * configured limit. addToBuffer() is also responsible for
- * performing some accounting on the overall memory usage to
- * make sure we're not using too much memory.
+ * configured limit, which here is '_bufferLimit'. addToBuffer() is
+ * also responsible for performing some accounting on the overall
+ * memory usage to make sure we're not using too much memory.
  *
  * limit == 0:
  *     addToBuffer() - Adds item to vector.
@@ -253,26 +330,26 @@ const SpecificStats* SortStage::getSpecificStats() const {
  *                     Updates memory usage if item was replaced.
  *     sortBuffer() - Does nothing.
  * limit > 1:
- *     addToBuffer() - Does not update vector. Adds item to set.
- *                     If size of set exceeds limit, remove item from set
- *                     with lowest key. Updates memory usage accordingly.
- *     sortBuffer() - Copies items from set to vectors.
+ *     addToBuffer() - Pushes item onto the heap kept in the vector.
+ *                     If size of heap exceeds limit, pops the item
+ *                     with the highest key. Updates memory usage accordingly.
+ *     sortBuffer() - Sorts the heap in place.
  */
 void SortStage::addToBuffer(const SortableDataItem& item) {
     // Holds ID of working set member to be freed at end of this function.
     WorkingSetID wsidToFree = WorkingSet::INVALID_ID;
 
     WorkingSetMember* member = _ws->get(item.wsid);
-    if (_limit == 0) {
+    if (_bufferLimit == 0) {
         // Ensure that the BSONObj underlying the WorkingSetMember is owned in case we yield.
         member->makeObjOwnedIfNeeded();
         _data.push_back(item);
-        _memUsage += member->getMemUsage();
-    } else if (_limit == 1) {
+        _memUsage += getMemUsage(item);
+    } else if (_bufferLimit == 1) {
         if (_data.empty()) {
             member->makeObjOwnedIfNeeded();
             _data.push_back(item);
-            _memUsage = member->getMemUsage();
+            _memUsage = getMemUsage(item);
             return;
         }
         wsidToFree = item.wsid;
@@ -282,36 +359,30 @@ void SortStage::addToBuffer(const SortableDataItem& item) {
             wsidToFree = _data[0].wsid;
             member->makeObjOwnedIfNeeded();
             _data[0] = item;
-            _memUsage = member->getMemUsage();
+            _memUsage = getMemUsage(item);
         }
     } else {
-        // Update data item set instead of vector
-        // Limit not reached - insert and return
-        vector<SortableDataItem>::size_type limit(_limit);
-        if (_dataSet->size() < limit) {
+        // Limit not reached - push onto the heap and return
+        const WorkingSetComparator& cmp = *_sortKeyComparator;
+        vector<SortableDataItem>::size_type limit(_bufferLimit);
+        if (_data.size() < limit) {
             member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
-            _memUsage += member->getMemUsage();
+            _data.push_back(item);
+            std::push_heap(_data.begin(), _data.end(), cmp);
+            _memUsage += getMemUsage(item);
             return;
         }
-        // Limit will be exceeded - compare with item with lowest key
-        // If new item does not have a lower key value than last item,
-        // do nothing.
+        // Limit will be exceeded - compare with the item with the highest key at the front of
+        // the heap. If new item does not have a lower key value than that item, do nothing.
         wsidToFree = item.wsid;
-        SortableDataItemSet::const_iterator lastItemIt = --(_dataSet->end());
-        const SortableDataItem& lastItem = *lastItemIt;
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        if (cmp(item, lastItem)) {
-            _memUsage -= _ws->get(lastItem.wsid)->getMemUsage();
-            _memUsage += member->getMemUsage();
-            wsidToFree = lastItem.wsid;
-            // According to std::set iterator validity rules,
-            // it does not matter which of erase()/insert() happens first.
-            // Here, we choose to erase first to release potential resources
-            // used by the last item and to keep the scope of the iterator to a minimum.
-            _dataSet->erase(lastItemIt);
+        if (cmp(item, _data.front())) {
+            _memUsage -= getMemUsage(_data.front());
+            _memUsage += getMemUsage(item);
+            wsidToFree = _data.front().wsid;
+            std::pop_heap(_data.begin(), _data.end(), cmp);
             member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
+            _data.back() = item;
+            std::push_heap(_data.begin(), _data.end(), cmp);
         }
     }
 
@@ -328,20 +399,168 @@ void SortStage::addToBuffer(const SortableDataItem& item) {
 
 //SortStage::sortBuffer()_data
 void SortStage::sortBuffer() {
-    if (_limit == 0) {
+    if (_bufferLimit == 0) {
         const WorkingSetComparator& cmp = *_sortKeyComparator;
         std::sort(_data.begin(), _data.end(), cmp);
-    } else if (_limit == 1) {
+    } else if (_bufferLimit == 1) {
         // Buffer contains either 0 or 1 item so it is already in a sorted state.
         return;
     } else {
-        // Set already contains items in sorted order, so we simply copy the items
-        // from the set to the vector.
-        // Release the memory for the set after the copy.
-        vector<SortableDataItem> newData(_dataSet->begin(), _dataSet->end());
-        _data.swap(newData);
-        _dataSet.reset();
+        // The buffer is a heap of at most '_bufferLimit' items, so this is O(limit log limit).
+        const WorkingSetComparator& cmp = *_sortKeyComparator;
+        std::sort_heap(_data.begin(), _data.end(), cmp);
     }
 }
 
+size_t SortStage::getMemUsage(const SortableDataItem& item) const {
+    // The sort key of the item shares its buffer with the member's computed data, so it is
+    // counted once here instead of on top of whatever the member accounts for.
+    if (item.fetchLate) {
+        return sizeof(RecordId) + item.sortKey.objsize();
+    }
+    return _ws->get(item.wsid)->getMemUsage();
+}
+
+void SortStage::dropDocument(WorkingSetMember* member, SortableDataItem* item) {
+    const BSONObj& doc = member->obj.value();
+    uint64_t hash[2];
+    MurmurHash3_x64_128(doc.objdata(), doc.objsize(), 0, hash);
+
+    item->fetchLate = true;
+    item->snapshotId = member->obj.snapshotId();
+    item->docHash = hash[0];
+
+    member->obj.reset();
+    _ws->transitionToRecordIdAndIdx(item->wsid);
+}
+
+bool SortStage::fetchLate(const SortableDataItem& item) {
+    WorkingSetMember* member = _ws->get(item.wsid);
+
+    // The document was fetched already, possibly by an invalidation.
+    if (member->hasObj()) {
+        return true;
+    }
+
+    Snapshotted<BSONObj> doc;
+    if (!_collection->findDoc(getOpCtx(), member->recordId, &doc)) {
+        ++_specificStats.lateFetchDrops;
+        return false;
+    }
+
+    // Unless we are still reading from the snapshot the document was buffered from, it may have
+    // changed so that it no longer matches the query or sorts differently.
+    if (doc.snapshotId() != item.snapshotId) {
+        uint64_t hash[2];
+        MurmurHash3_x64_128(doc.value().objdata(), doc.value().objsize(), 0, hash);
+        if (hash[0] != item.docHash) {
+            ++_specificStats.lateFetchDrops;
+            return false;
+        }
+    }
+
+    member->obj = std::move(doc);
+    member->isSuspicious = false;
+    _ws->transitionToRecordIdAndObj(item.wsid);
+    ++_specificStats.lateFetches;
+    return true;
+}
+
+bool SortStage::canSpill(const WorkingSetMember& member) {
+    return !member.hasComputed(WSM_COMPUTED_TEXT_SCORE) &&
+        !member.hasComputed(WSM_COMPUTED_GEO_DISTANCE) && !member.hasComputed(WSM_INDEX_KEY) &&
+        !member.hasComputed(WSM_GEO_NEAR_POINT);
+}
+
+void SortStage::spill() {
+    invariant(!_spillSorter);
+
+    for (auto&& item : _data) {
+        if (!canSpill(*_ws->get(item.wsid))) {
+            return;
+        }
+    }
+
+    // The sorter needs the documents of items buffered without them. Fetching may throw, in
+    // which case we are called again after yielding; items already fetched are skipped then.
+    for (auto it = _data.begin(); it != _data.end();) {
+        if (it->fetchLate && !fetchLate(*it)) {
+            WorkingSetMember* member = _ws->get(it->wsid);
+            if (member->hasRecordId()) {
+                _wsidByRecordId.erase(member->recordId);
+            }
+            _ws->free(it->wsid);
+            it = _data.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    SortOptions opts;
+    opts.limit = _limit;
+    opts.maxMemoryUsageBytes =
+        static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
+    opts.extSortAllowed = true;
+    opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+    _spillSorter.reset(
+        SpillSorter::make(opts, SpillComparator(FindCommon::transformSortSpec(_pattern))));
+
+    for (auto&& item : _data) {
+        addToSpillSorter(item);
+    }
+
+    _data.clear();
+    _resultIterator = _data.end();
+    _memUsage = 0;
+}
+
+void SortStage::addToSpillSorter(const SortableDataItem& item) {
+    WorkingSetMember* member = _ws->get(item.wsid);
+
+    BSONObjBuilder keyBuilder;
+    keyBuilder.appendElements(item.sortKey);
+    keyBuilder.append("", static_cast<long long>(item.recordId.repr()));
+    BSONObj key = keyBuilder.obj();
+    BSONObj value = member->obj.value().getOwned();
+
+    _spillSorter->add(key, value);
+
+    if (member->hasRecordId()) {
+        _wsidByRecordId.erase(member->recordId);
+    }
+    _ws->free(item.wsid);
+}
+
+WorkingSetID SortStage::nextFromSpillIterator() {
+    SpillSorter::Data data = _spillIterator->next();
+
+    // Split the RecordId off the end of the key.
+    BSONObjBuilder sortKeyBuilder;
+    RecordId recordId;
+    BSONObjIterator it(data.first);
+    while (it.more()) {
+        BSONElement elt = it.next();
+        if (it.more()) {
+            sortKeyBuilder.append(elt);
+        } else {
+            recordId = RecordId(elt.numberLong());
+        }
+    }
+
+    WorkingSetID id = _ws->allocate();
+    WorkingSetMember* member = _ws->get(id);
+    member->obj = {SnapshotId(), data.second};
+    if (recordId.isNull()) {
+        _ws->transitionToOwnedObj(id);
+    } else {
+        member->recordId = recordId;
+        _ws->transitionToRecordIdAndObj(id);
+    }
+    member->addComputed(new SortKeyComputedData(sortKeyBuilder.obj()));
+    return id;
+}
+
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
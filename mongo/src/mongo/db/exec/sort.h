@@ -28,7 +28,6 @@
 
 #pragma once
 
-#include <set>
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
@@ -37,6 +36,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
@@ -46,7 +46,7 @@ class BtreeKeyGenerator;
 // Parameters that must be provided to a SortStage
 class SortStageParams {
 public:
-    SortStageParams() : collection(NULL), limit(0) {}
+    SortStageParams() : collection(NULL), limit(0), allowDiskUse(false), fetchLate(false) {}
 
     // Used for resolving RecordIds to BSON
     const Collection* collection;
@@ -56,6 +56,13 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit;
+
+    // May the data be sorted on disk once it uses more than internalQueryExecMaxBlockingSortBytes?
+    bool allowDiskUse;
+
+    // With a limit, may documents read straight from 'collection' be buffered as just their sort
+    // key and RecordId, and fetched again once they make it into the results?
+    bool fetchLate;
 };
 
 /**
@@ -65,6 +72,18 @@ public:
  *   -- For each field in 'pattern', all inputs in the child must handle a getFieldDotted for that
  *   field.
  *   -- All WSMs produced by the child stage must have the sort key available as WSM computed data.
+ *
+ * With a limit, the stage keeps the best 'limit' items in a bounded heap. If late fetching is
+ * enabled it also drops the documents of items it buffers, keeping only their sort keys and
+ * RecordIds, and fetches the documents of the winning items as it returns them. An item whose
+ * document was deleted or changed in the meantime is dropped from the results, as a FetchStage
+ * drops results whose index keys no longer match the document. To make up for such items, the
+ * heap then holds up to 'limit' spare items beyond the best 'limit', which take the place of
+ * dropped winners.
+ *
+ * If the buffered data grows past internalQueryExecMaxBlockingSortBytes, the stage fails unless
+ * disk use is allowed, in which case all of the data is handed to an external Sorter which merges
+ * sorted runs written to temporary files.
  */
 class SortStage final : public PlanStage {
 public:
@@ -122,9 +141,15 @@ private:
         // RecordId to break sortKey ties.
         // See sorta.js.
         RecordId recordId;
+        // Set if the working set member holds no document, which has to be fetched by fetchLate().
+        // The snapshot and hash of the document as it was buffered are kept to tell whether it
+        // has changed since.
+        bool fetchLate = false;
+        SnapshotId snapshotId;
+        uint64_t docHash = 0;
     };
 
-    // Comparison object for data buffers (vector and set). Items are compared on (sortKey, loc).
+    // Comparison object for data buffers (vector and heap). Items are compared on (sortKey, loc).
     // This is also how the items are ordered in the indices. Keys are compared using
     // BSONObj::woCompare() with RecordId as a tie-breaker.
     //
@@ -139,7 +164,7 @@ private:
     };
 
     /**
-     * Inserts one item into data buffer (vector or set).
+     * Inserts one item into data buffer (vector or heap).
      * If limit is exceeded, remove item with lowest key.
      */
     void addToBuffer(const SortableDataItem& item);
@@ -147,11 +172,65 @@ private:
     /**
      * Sorts data buffer.
      * Assumes no more items will be added to buffer.
-     * If data is stored in set, copy set
-     * contents to vector and clear set.
+     * If data is stored as a heap, sorts the heap in place.
      */
     void sortBuffer();
 
+    /**
+     * Returns the memory accounted to a buffered item. Items buffered without their document
+     * account for their RecordId and sort key alone, which is all they hold.
+     */
+    size_t getMemUsage(const SortableDataItem& item) const;
+
+    /**
+     * Drops the document of the member, leaving only its RecordId and computed data, and records
+     * in 'item' what is needed to fetch it again.
+     */
+    void dropDocument(WorkingSetMember* member, SortableDataItem* item);
+
+    /**
+     * Fetches the document of an item buffered without it. Returns false if the document was
+     * deleted or changed since the item was buffered, in which case the item must be dropped.
+     * May throw WriteConflictException.
+     */
+    bool fetchLate(const SortableDataItem& item);
+
+    // The data of '_spillSorter'. The key is the sort key followed by the RecordId as a
+    // NumberLong, so that comparing keys also breaks ties by RecordId. The value is the document.
+    typedef Sorter<BSONObj, BSONObj> SpillSorter;
+
+    // Orders the data of '_spillSorter' like WorkingSetComparator orders items.
+    struct SpillComparator {
+        explicit SpillComparator(BSONObj p);
+
+        int operator()(const SpillSorter::Data& lhs, const SpillSorter::Data& rhs) const;
+
+        BSONObj pattern;
+    };
+
+    /**
+     * Returns true if 'member' carries nothing but its document, RecordId and sort key, which is
+     * all that is kept for data sorted on disk.
+     */
+    static bool canSpill(const WorkingSetMember& member);
+
+    /**
+     * Hands the buffered data to a new '_spillSorter' and frees its working set members. Leaves
+     * the buffer as it is if some of the buffered data can't be spilled. Documents of items
+     * buffered without them are fetched first, so this may throw WriteConflictException.
+     */
+    void spill();
+
+    /**
+     * Adds the item to '_spillSorter' and frees its working set member.
+     */
+    void addToSpillSorter(const SortableDataItem& item);
+
+    /**
+     * Makes a working set member out of the next data item of '_spillIterator'.
+     */
+    WorkingSetID nextFromSpillIterator();
+
     // Comparator for data buffer
     // Initialization follows sort key generator
     std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
@@ -160,12 +239,10 @@ private:
     // _data will contain sorted data when all data is gathered
     // and sorted.
     // When _limit is greater than 1 and not all data has been gathered from child stage,
-    // _dataSet is used instead to maintain an ordered set of the incomplete data set.
-    // When the data set is complete, we copy the items from _dataSet to _data which will
-    // be used to provide the results of this stage through _resultIterator.
+    // _data is kept as a max-heap of at most _limit items, whose front is the item to evict
+    // next. When the data set is complete, the heap is sorted in place and used to provide
+    // the results of this stage through _resultIterator.
     std::vector<SortableDataItem> _data;
-    typedef std::set<SortableDataItem, WorkingSetComparator> SortableDataItemSet;
-    std::unique_ptr<SortableDataItemSet> _dataSet;
 
     // Iterates through _data post-sort returning it.
     std::vector<SortableDataItem>::iterator _resultIterator;
@@ -178,6 +255,22 @@ private:
 
     // The usage in bytes of all buffered data that we're sorting.
     size_t _memUsage;
+
+    bool _allowDiskUse;
+
+    bool _fetchLate;
+
+    // The number of items the buffer holds with a limit: '_limit', plus as many spares when
+    // fetching late.
+    size_t _bufferLimit;
+
+    // The number of results returned from '_data'.
+    size_t _numResults = 0;
+
+    // Set once the buffered data has outgrown the memory limit. From then on all data is added
+    // here, and the sorted data is read back through '_spillIterator'.
+    std::unique_ptr<SpillSorter> _spillSorter;
+    std::unique_ptr<SpillSorter::Iterator> _spillIterator;
 };
 
 }  // namespace mongo
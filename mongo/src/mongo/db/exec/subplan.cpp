@@ -43,12 +43,14 @@
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 #include "mongo/util/transitional_tools_do_not_use/vector_spooling.h"
 
 namespace mongo {
@@ -191,6 +193,31 @@ Status SubplanStage::planSubqueries() {
         invariant(CanonicalQuery::isValid(_orExpression.get(), _query->getQueryRequest()).isOK());
     }
 
+    const bool mergeSameShape = internalQuerySubplanMergeSameShapeBranches.load();
+
+    // A branch identical to an earlier one selects the same documents, so only the first is kept.
+    // At least two branches must remain for the expression to stay a rooted $or.
+    if (mergeSameShape) {
+        std::vector<MatchExpression*>& orChildren = *_orExpression->getChildVector();
+        size_t i = 1;
+        while (i < orChildren.size() && orChildren.size() > 2U) {
+            bool isDuplicate = false;
+            for (size_t j = 0; j < i && !isDuplicate; ++j) {
+                isDuplicate = orChildren[j]->equivalent(orChildren[i]);
+            }
+
+            if (isDuplicate) {
+                LOG(5) << "Subplanner: dropping duplicate child "
+                       << redact(orChildren[i]->toString());
+                delete orChildren[i];
+                orChildren.erase(orChildren.begin() + i);
+                ++_specificStats.duplicateBranches;
+            } else {
+                ++i;
+            }
+        }
+    }
+
     for (size_t i = 0; i < _plannerParams.indices.size(); ++i) {
         const IndexEntry& ie = _plannerParams.indices[i];
         _indexMap[ie.name] = i;
@@ -198,7 +225,16 @@ Status SubplanStage::planSubqueries() {
         LOG(5) << "Subplanner: index " << i << " is " << ie;
     }
 
+    PlanCache* planCache = _collection->infoCache()->getPlanCache();
+
+    // The position in '_branchResults' of the first branch of each plan cache key.
+    std::map<PlanCacheKey, size_t> branchByKey;
+
+    _specificStats.branches.resize(_orExpression->numChildren());
     for (size_t i = 0; i < _orExpression->numChildren(); ++i) {
+        Timer timer;
+        SubplanBranchStats& branchStats = _specificStats.branches[i];
+
         // We need a place to shove the results from planning this branch.
         _branchResults.push_back(stdx::make_unique<BranchPlanningResult>());
         BranchPlanningResult* branchResult = _branchResults.back().get();
@@ -219,6 +255,21 @@ Status SubplanStage::planSubqueries() {
 
         branchResult->canonicalQuery = std::move(statusWithCQ.getValue());
 
+        // A branch with the same shape as an earlier one reuses the plan chosen for that branch,
+        // just as the plan cache would serve both from a single entry.
+        if (mergeSameShape) {
+            auto inserted =
+                branchByKey.emplace(planCache->computeKey(*branchResult->canonicalQuery), i);
+            if (!inserted.second) {
+                LOG(5) << "Subplanner: child " << i << " has the same shape as child "
+                       << inserted.first->second;
+                branchResult->sameShapeAs = inserted.first->second;
+                branchStats.sameShapeAs = static_cast<int>(inserted.first->second);
+                branchStats.planningMicros = timer.micros();
+                continue;
+            }
+        }
+
         // Plan the i-th child. We might be able to find a plan for the i-th child in the plan
         // cache. If there's no cached plan, then we generate and rank plans using the MPS.
         CachedSolution* rawCS;
@@ -234,6 +285,7 @@ Status SubplanStage::planSubqueries() {
                    << _orExpression->numChildren();
 
             branchResult->cachedSolution.reset(rawCS);
+            branchStats.fromCache = true;
         } else {
             // No CachedSolution found. We'll have to plan from scratch.
             //ORµĵڼ֧
@@ -258,6 +310,7 @@ Status SubplanStage::planSubqueries() {
             }
 			//ORķ֧Ӧindexed solutions.
             LOG(5) << "Subplanner: got " << branchResult->solutions.size() << " solutions";
+            branchStats.numCandidates = branchResult->solutions.size();
 
             if (0 == branchResult->solutions.size()) {
                 // If one child doesn't have an indexed solution, bail out.
@@ -267,6 +320,8 @@ Status SubplanStage::planSubqueries() {
 				return Status(ErrorCodes::BadValue, ss);
             }
         }
+
+        branchStats.planningMicros = timer.micros();
     }
 
     return Status::OK();
@@ -336,8 +391,18 @@ Status SubplanStage::choosePlanForSubqueries(PlanYieldPolicy* yieldPolicy) {
     for (size_t i = 0; i < _orExpression->numChildren(); ++i) {
         MatchExpression* orChild = _orExpression->getChild(i);
         BranchPlanningResult* branchResult = _branchResults[i].get();
+        SubplanBranchStats& branchStats = _specificStats.branches[i];
 
-        if (branchResult->cachedSolution.get()) {
+        if (branchResult->sameShapeAs) {
+            // Apply the index tags chosen for the earlier branch of the same shape.
+            const BranchPlanningResult* sameShapeResult =
+                _branchResults[*branchResult->sameShapeAs].get();
+            Status tagStatus = tagOrChildAccordingToCache(
+                cacheData.get(), sameShapeResult->chosenCacheData.get(), orChild, _indexMap);
+            if (!tagStatus.isOK()) {
+                return tagStatus;
+            }
+        } else if (branchResult->cachedSolution.get()) {
             // We can get the index tags we need out of the cache.
             Status tagStatus = tagOrChildAccordingToCache(
                 cacheData.get(), branchResult->cachedSolution->plannerData[0], orChild, _indexMap);
@@ -347,6 +412,8 @@ Status SubplanStage::choosePlanForSubqueries(PlanYieldPolicy* yieldPolicy) {
                 ss << "SubplanStage::choosePlanForSubqueries 2";
                 return tagStatus;
             }
+            branchResult->chosenCacheData.reset(
+                branchResult->cachedSolution->plannerData[0]->clone());
         } else if (1 == branchResult->solutions.size()) {
             QuerySolution* soln = branchResult->solutions.front().get();
             Status tagStatus = tagOrChildAccordingToCache(
@@ -357,12 +424,14 @@ Status SubplanStage::choosePlanForSubqueries(PlanYieldPolicy* yieldPolicy) {
 				LOG(5) << "No indexed cache data for subchild " << orChild->toString();
                 return tagStatus;
             }
+            branchResult->chosenCacheData.reset(soln->cacheData->clone());
         } else {
             // N solutions, rank them.
 
             // We already checked for zero solutions in planSubqueries(...).
             invariant(!branchResult->solutions.empty());
 
+            Timer timer;
             _ws->clear();
 
             // We pass the SometimesCache option to the MPS because the SubplanStage currently does
@@ -397,6 +466,10 @@ Status SubplanStage::choosePlanForSubqueries(PlanYieldPolicy* yieldPolicy) {
             }
 
             Status planSelectStat = multiPlanStage->pickBestPlan(yieldPolicy);
+            for (auto&& candidate : multiPlanStage->getChildren()) {
+                branchStats.trialWorks += candidate->getCommonStats()->works;
+            }
+            branchStats.planningMicros += timer.micros();
             if (!planSelectStat.isOK()) {
 				LOG(2) << "SubplanStage::choosePlanForSubqueries 5";
 				mongoutils::str::stream ss;
@@ -443,6 +516,7 @@ Status SubplanStage::choosePlanForSubqueries(PlanYieldPolicy* yieldPolicy) {
             }
 
             cacheData->children.push_back(bestSoln->cacheData->tree->clone());
+            branchResult->chosenCacheData.reset(bestSoln->cacheData->clone());
         }
     }
 
@@ -636,6 +710,7 @@ PlanStage::StageState SubplanStage::doWork(WorkingSetID* out) {
 unique_ptr<PlanStageStats> SubplanStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_SUBPLAN);
+    ret->specific = make_unique<SubplanStats>(_specificStats);
     ret->children.emplace_back(child()->getStats());
     return ret;
 }
@@ -645,8 +720,12 @@ bool SubplanStage::branchPlannedFromCache(size_t i) const {
     return NULL != _branchResults[i]->cachedSolution.get();
 }
 
+bool SubplanStage::branchPlannedFromSameShape(size_t i) const {
+    return static_cast<bool>(_branchResults[i]->sameShapeAs);
+}
+
 const SpecificStats* SubplanStage::getSpecificStats() const {
-    return NULL;
+    return &_specificStats;
 }
 
 }  // namespace mongo
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,6 +37,7 @@
 #include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_yield_policy.h"
@@ -66,6 +68,10 @@ class OperationContext;
  *   another rooted $or query, or shape C as its own query.
  *
  *   --Plans for entire rooted $or queries are neither written to nor read from the plan cache.
+ *
+ *   --Clauses identical to an earlier clause are dropped, and a clause with the same shape as an
+ *   earlier one is neither looked up in the plan cache nor planned: it takes the index tags
+ *   chosen for the earlier clause, just as it would from a plan cache entry for that shape.
  */ 
 /*
 db.test.find( {$or : [{ $and : [ { name : "0.99" }, { "age" : 99 } ] },{ $or : [ {  name : "cc" }, { "xx" : 3} ] } ]} ).sort({"name":1}).limit(7)
@@ -149,6 +155,12 @@ public:
      */
     bool branchPlannedFromCache(size_t i) const;
 
+    /**
+     * Returns true if the i-th branch took the index assignment chosen for an earlier branch of
+     * the same shape instead of being planned.
+     */
+    bool branchPlannedFromSameShape(size_t i) const;
+
     /**
      * Provide access to the query solution for our composite solution. Does not relinquish
      * ownership.
@@ -182,6 +194,15 @@ private:
 
         // Query solutions resulting from planning the $or branch.
         std::vector<std::unique_ptr<QuerySolution>> solutions;
+
+        // The position in '_branchResults' of an earlier branch with the same plan cache key.
+        // Such a branch is neither looked up in the plan cache nor planned; it is tagged with
+        // the index assignment chosen for the earlier branch.
+        boost::optional<size_t> sameShapeAs;
+
+        // The cache data of the plan chosen for this branch, kept for the later branches of the
+        // same shape.
+        std::unique_ptr<SolutionCacheData> chosenCacheData;
     };
 
     /**
@@ -234,6 +255,8 @@ private:
     // We need this to extract cache-friendly index data from the index assignments.
     //ñӦеϢ浽map
     std::map<StringData, size_t> _indexMap;
+
+    SubplanStats _specificStats;
 };
 
 }  // namespace mongo
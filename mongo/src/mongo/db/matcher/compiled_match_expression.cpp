@@ -0,0 +1,246 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Returns whether 'cmp', the result of comparing an element against the right-hand side of a
+ * comparison, satisfies a comparison of type 'matchType'.
+ */
+bool comparisonResult(MatchExpression::MatchType matchType, int cmp) {
+    switch (matchType) {
+        case MatchExpression::EQ:
+            return cmp == 0;
+        case MatchExpression::LT:
+            return cmp < 0;
+        case MatchExpression::LTE:
+            return cmp <= 0;
+        case MatchExpression::GT:
+            return cmp > 0;
+        case MatchExpression::GTE:
+            return cmp >= 0;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+/**
+ * Returns true and sets 'out' if 'elem' is an int or a double which isn't NaN. Such numbers
+ * compare with each other exactly as doubles.
+ */
+bool comparableDouble(const BSONElement& elem, double* out) {
+    switch (elem.type()) {
+        case NumberInt:
+            *out = elem._numberInt();
+            return true;
+        case NumberDouble:
+            *out = elem._numberDouble();
+            return !std::isnan(*out);
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+std::unique_ptr<CompiledMatchExpression> CompiledMatchExpression::compile(
+    const MatchExpression* expr) {
+    if (!expr) {
+        return nullptr;
+    }
+
+    std::unique_ptr<CompiledMatchExpression> compiled(new CompiledMatchExpression());
+    compiled->compilePredicates(expr);
+
+    // A single predicate left to its MatchExpression is no better than the tree.
+    if (compiled->_predicates.size() == 1 && Kind::kGeneric == compiled->_predicates[0].kind) {
+        return nullptr;
+    }
+    return compiled;
+}
+
+void CompiledMatchExpression::compilePredicates(const MatchExpression* expr) {
+    if (MatchExpression::AND == expr->matchType()) {
+        for (size_t i = 0; i < expr->numChildren(); ++i) {
+            compilePredicates(expr->getChild(i));
+        }
+        return;
+    }
+
+    _predicates.emplace_back();
+    Predicate& predicate = _predicates.back();
+    predicate.kind = Kind::kGeneric;
+    predicate.matchType = expr->matchType();
+    predicate.expr = expr;
+
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::BITS_ALL_SET:
+        case MatchExpression::BITS_ALL_CLEAR:
+        case MatchExpression::BITS_ANY_SET:
+        case MatchExpression::BITS_ANY_CLEAR:
+        case MatchExpression::TYPE_OPERATOR:
+            break;
+        default:
+            return;
+    }
+
+    const StringData path = expr->path();
+    if (path.empty()) {
+        return;
+    }
+
+    size_t start = 0;
+    for (size_t dot = path.find('.'); dot != std::string::npos; dot = path.find('.', start)) {
+        predicate.pathParts.push_back(path.substr(start, dot - start).toString());
+        start = dot + 1;
+    }
+    predicate.pathParts.push_back(path.substr(start).toString());
+    predicate.kind = Kind::kPath;
+
+    if (!ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        return;
+    }
+
+    const auto* comparison = static_cast<const ComparisonMatchExpression*>(expr);
+    const BSONElement rhs = comparison->getData();
+    if (comparableDouble(rhs, &predicate.numberRhs)) {
+        predicate.kind = Kind::kNumberComparison;
+    } else if (String == rhs.type() && !comparison->getCollator()) {
+        predicate.kind = Kind::kStringComparison;
+        predicate.stringRhs = rhs.valueStringData();
+    }
+}
+
+size_t CompiledMatchExpression::numSpecializedPredicates() const {
+    return std::count_if(_predicates.begin(), _predicates.end(), [](const Predicate& predicate) {
+        return Kind::kGeneric != predicate.kind;
+    });
+}
+
+bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) {
+    if (++_sinceReorder == kReorderInterval) {
+        reorder();
+    }
+
+    for (auto&& predicate : _predicates) {
+        ++predicate.evaluated;
+        if (!evaluate(predicate, doc)) {
+            return false;
+        }
+        ++predicate.passed;
+    }
+    return true;
+}
+
+bool CompiledMatchExpression::evaluate(const Predicate& predicate, const BSONObj& doc) {
+    if (Kind::kGeneric == predicate.kind) {
+        return predicate.expr->matchesBSON(doc);
+    }
+
+    // Resolve the path like getFieldDottedOrArray(): a path which runs into a value other than an
+    // object resolves to EOO. Arrays may expand into several elements, which is left to the
+    // MatchExpression.
+    BSONElement elem = doc.getField(predicate.pathParts[0]);
+    for (size_t i = 1; i < predicate.pathParts.size(); ++i) {
+        if (Array == elem.type()) {
+            return predicate.expr->matchesBSON(doc);
+        }
+        if (Object != elem.type()) {
+            elem = BSONElement();
+            break;
+        }
+        elem = elem.embeddedObject().getField(predicate.pathParts[i]);
+    }
+    if (Array == elem.type()) {
+        return predicate.expr->matchesBSON(doc);
+    }
+
+    switch (predicate.kind) {
+        case Kind::kNumberComparison: {
+            double value;
+            if (comparableDouble(elem, &value)) {
+                const int cmp = value < predicate.numberRhs ? -1 : value > predicate.numberRhs;
+                return comparisonResult(predicate.matchType, cmp);
+            }
+            break;
+        }
+        case Kind::kStringComparison:
+            if (String == elem.type()) {
+                return comparisonResult(predicate.matchType,
+                                        elem.valueStringData().compare(predicate.stringRhs));
+            }
+            break;
+        default:
+            break;
+    }
+    return predicate.expr->matchesSingleElement(elem);
+}
+
+void CompiledMatchExpression::reorder() {
+    _sinceReorder = 0;
+
+    // Predicates which haven't been evaluated recently are ordered as if everything passed them.
+    auto passRate = [](const Predicate& predicate) {
+        return predicate.evaluated ? static_cast<double>(predicate.passed) / predicate.evaluated
+                                   : 1.0;
+    };
+    std::stable_sort(_predicates.begin(),
+                     _predicates.end(),
+                     [&](const Predicate& lhs, const Predicate& rhs) {
+                         return passRate(lhs) < passRate(rhs);
+                     });
+
+    // Decay the counts so that the order follows changes in the data.
+    for (auto&& predicate : _predicates) {
+        predicate.evaluated /= 2;
+        predicate.passed /= 2;
+    }
+}
+
+}  // namespace mongo
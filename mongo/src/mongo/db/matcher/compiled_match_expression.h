@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+/**
+ * A MatchExpression flattened into a conjunction of predicates which can be evaluated against a
+ * document without walking the expression tree or allocating an ElementIterator per leaf.
+ *
+ * compile() splits the expression's top-level $and, recursively, into its conjuncts. Conjuncts
+ * which are path leaves ($eq, $lt, $lte, $gt, $gte, $in, $exists, $regex, $mod, $type and the bit
+ * tests) keep their path split into its parts, and find their element by descending the document
+ * part by part. Comparisons of a number against a number, and of a string against a string when
+ * there is no collation, are evaluated inline. If the path reaches an array, the leaf falls back
+ * to the array-aware MatchExpression so that results are always the same as the tree's. All other
+ * conjuncts ($or, $not, $elemMatch, $expr, ...) are evaluated by the MatchExpression itself.
+ *
+ * The conjuncts are evaluated in order of their observed pass rate, so that the ones which reject
+ * the most documents run first. The order is revised every kReorderInterval documents.
+ *
+ * The compiled expression points into the MatchExpression it was compiled from, which must outlive
+ * it. Because it keeps statistics, a compiled expression must not be shared between threads.
+ * MatchDetails are not supported; callers needing them must use the MatchExpression.
+ */
+class CompiledMatchExpression {
+    MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+
+public:
+    static const size_t kReorderInterval = 1024;
+
+    /**
+     * Compiles 'expr'. Returns nullptr if 'expr' is null, or if compiling it wouldn't change how it
+     * is evaluated.
+     */
+    static std::unique_ptr<CompiledMatchExpression> compile(const MatchExpression* expr);
+
+    /**
+     * Returns the same result as MatchExpression::matchesBSON() on the compiled expression.
+     */
+    bool matchesBSON(const BSONObj& doc);
+
+    size_t numPredicates() const {
+        return _predicates.size();
+    }
+
+    /**
+     * Returns the number of conjuncts which aren't evaluated by their MatchExpression alone.
+     */
+    size_t numSpecializedPredicates() const;
+
+    /**
+     * Returns the conjunct evaluated in position 'i'.
+     */
+    const MatchExpression* getPredicate(size_t i) const {
+        return _predicates[i].expr;
+    }
+
+private:
+    enum class Kind : uint8_t {
+        // Evaluated by MatchExpression::matchesBSON().
+        kGeneric,
+        // Resolves its path, then evaluated by MatchExpression::matchesSingleElement().
+        kPath,
+        // A comparison against a number which isn't NaN.
+        kNumberComparison,
+        // A comparison against a string, without a collation.
+        kStringComparison,
+    };
+
+    struct Predicate {
+        Kind kind;
+        MatchExpression::MatchType matchType;
+        const MatchExpression* expr;
+        std::vector<std::string> pathParts;
+
+        // The right-hand side of a kNumberComparison or kStringComparison.
+        double numberRhs = 0;
+        StringData stringRhs;
+
+        // Decayed counts of the documents this predicate was evaluated on, and which passed it.
+        uint64_t evaluated = 0;
+        uint64_t passed = 0;
+    };
+
+    CompiledMatchExpression() = default;
+
+    /**
+     * Appends the predicates of 'expr' to '_predicates'.
+     */
+    void compilePredicates(const MatchExpression* expr);
+
+    static bool evaluate(const Predicate& predicate, const BSONObj& doc);
+
+    /**
+     * Sorts '_predicates' by ascending pass rate and decays their counts.
+     */
+    void reorder();
+
+    std::vector<Predicate> _predicates;
+
+    // Number of documents matched since the last call to reorder().
+    size_t _sinceReorder = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const BSONObj& query,
+                                       const CollatorInterface* collator = nullptr) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    expCtx->setCollator(collator);
+    auto statusWithMatcher = MatchExpressionParser::parse(query, expCtx);
+    ASSERT_OK(statusWithMatcher.getStatus());
+    return std::move(statusWithMatcher.getValue());
+}
+
+/**
+ * Asserts that the compiled form of 'query' matches every document of 'docs' exactly like the
+ * MatchExpression does.
+ */
+void assertSameResults(const BSONObj& query, const std::vector<BSONObj>& docs) {
+    auto expr = parse(query);
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    for (auto&& doc : docs) {
+        ASSERT_EQ(expr->matchesBSON(doc), compiled->matchesBSON(doc))
+            << "query: " << query << ", document: " << doc;
+    }
+}
+
+const std::vector<BSONObj> kDocs = {
+    fromjson("{}"),
+    fromjson("{a: 1}"),
+    fromjson("{a: 5.5, b: 'foo'}"),
+    fromjson("{a: NaN, b: 'bar'}"),
+    fromjson("{a: null, b: null}"),
+    fromjson("{a: NumberLong(3), b: 'foo\\u0000bar'}"),
+    fromjson("{a: NumberDecimal('3'), b: 'fo'}"),
+    fromjson("{a: '1', b: 2}"),
+    fromjson("{a: [1, 5], b: ['foo', 'zzz']}"),
+    fromjson("{a: [[3]], b: []}"),
+    fromjson("{a: {b: 3}, b: {c: 'foo'}}"),
+    fromjson("{a: {b: [3, 9]}, b: {c: 1}}"),
+    fromjson("{a: [{b: 3}, {b: 7}], b: 3}"),
+    fromjson("{a: {b: {c: 4}}, c: true}"),
+    fromjson("{a: 3, a: 9}"),
+    fromjson("{a: MinKey, b: MaxKey}"),
+};
+
+TEST(CompiledMatchExpressionTest, NullExpressionIsNotCompiled) {
+    ASSERT(!CompiledMatchExpression::compile(nullptr));
+}
+
+TEST(CompiledMatchExpressionTest, SingleGenericPredicateIsNotCompiled) {
+    auto expr = parse(fromjson("{$or: [{a: 1}, {b: 1}]}"));
+    ASSERT(!CompiledMatchExpression::compile(expr.get()));
+}
+
+TEST(CompiledMatchExpressionTest, FlattensNestedConjunctions) {
+    auto expr = parse(fromjson("{$and: [{a: 1}, {$and: [{b: {$gt: 2}}, {c: {$exists: true}}]}], "
+                               "$or: [{d: 1}, {e: 1}]}"));
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQ(4U, compiled->numPredicates());
+    ASSERT_EQ(3U, compiled->numSpecializedPredicates());
+}
+
+TEST(CompiledMatchExpressionTest, NumberComparisonsMatchLikeTheTree) {
+    for (auto&& op : {"$eq", "$lt", "$lte", "$gt", "$gte"}) {
+        for (auto&& rhs : {BSON("" << 3), BSON("" << 5.5), BSON("" << -1)}) {
+            const BSONObj predicate = BSON(op << rhs.firstElement());
+            assertSameResults(BSON("a" << predicate << "c" << BSON("$ne" << 1)), kDocs);
+            assertSameResults(BSON("a.b" << predicate << "b" << BSON("$ne" << 1)), kDocs);
+        }
+    }
+}
+
+TEST(CompiledMatchExpressionTest, StringComparisonsMatchLikeTheTree) {
+    for (auto&& op : {"$eq", "$lt", "$lte", "$gt", "$gte"}) {
+        for (auto&& rhs : {"foo"_sd, "fo"_sd, ""_sd, "foo\0bar"_sd}) {
+            assertSameResults(BSON("b" << BSON(op << rhs) << "c" << BSON("$ne" << 1)), kDocs);
+            assertSameResults(BSON("b.c" << BSON(op << rhs) << "a" << BSON("$ne" << 1)), kDocs);
+        }
+    }
+}
+
+TEST(CompiledMatchExpressionTest, OtherPredicatesMatchLikeTheTree) {
+    const std::vector<BSONObj> queries = {
+        fromjson("{a: null, b: {$exists: true}}"),
+        fromjson("{a: {$exists: false}, b: {$exists: true}}"),
+        fromjson("{a: NaN, b: {$exists: true}}"),
+        fromjson("{a: {$in: [1, 3, '1']}, b: {$ne: 2}}"),
+        fromjson("{'a.b': {$in: [3, null]}, c: {$ne: 2}}"),
+        fromjson("{b: /^fo/, a: {$exists: true}}"),
+        fromjson("{a: {$mod: [2, 1]}, b: {$exists: true}}"),
+        fromjson("{a: {$type: 'number'}, b: {$type: 'string'}}"),
+        fromjson("{a: {$bitsAllSet: 1}, b: {$exists: true}}"),
+        fromjson("{'a.b.c': 4, c: true}"),
+        fromjson("{'a.b': {$gt: 5}, $or: [{b: 3}, {'b.c': 1}]}"),
+        fromjson("{a: {$elemMatch: {b: 3}}, b: 3}"),
+        fromjson("{a: {$not: {$gt: 2}}, b: {$exists: true}}"),
+        fromjson("{a: {$gte: MinKey}, b: {$lte: MaxKey}}"),
+    };
+    for (auto&& query : queries) {
+        assertSameResults(query, kDocs);
+    }
+}
+
+TEST(CompiledMatchExpressionTest, StringComparisonRespectsCollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kAlwaysEqual);
+    auto expr = parse(fromjson("{a: 'foo', b: 1}"), &collator);
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_TRUE(compiled->matchesBSON(fromjson("{a: 'bar', b: 1}")));
+}
+
+TEST(CompiledMatchExpressionTest, MostSelectivePredicateMovesFirst) {
+    auto expr = parse(fromjson("{a: {$gte: 0}, b: 1}"));
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQ(MatchExpression::GTE, compiled->getPredicate(0)->matchType());
+
+    // Every document passes 'a', but only one in ten passes 'b'.
+    for (size_t i = 0; i < CompiledMatchExpression::kReorderInterval; ++i) {
+        const BSONObj doc = BSON("a" << 1 << "b" << static_cast<int>(i % 10));
+        ASSERT_EQ(expr->matchesBSON(doc), compiled->matchesBSON(doc));
+    }
+    ASSERT_EQ(MatchExpression::EQ, compiled->getPredicate(0)->matchType());
+}
+
+}  // namespace
+}  // namespace mongo
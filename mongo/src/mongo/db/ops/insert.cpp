@@ -275,6 +275,8 @@ Status userAllowedCreateNS(StringData db, StringData coll) { //
                 return Status::OK();
             if (coll == "system.healthlog")
                 return Status::OK();
+            if (coll == "system.plan_cache")
+                return Status::OK();
         }
         return Status(ErrorCodes::InvalidNamespace,
                       str::stream() << "cannot write to '" << db << "." << coll << "'");
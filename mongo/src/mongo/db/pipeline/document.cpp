@@ -30,6 +30,7 @@
 
 #include "mongo/db/pipeline/document.h"
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 
 #include "mongo/bson/bson_depth.h"
@@ -45,10 +46,96 @@ using std::vector;
 
 const DocumentStorage DocumentStorage::kEmptyDoc;
 
+namespace {
+/**
+ * Returns true if serializing 'obj' at 'recursionLevel' passes the depth checks of
+ * Document::toBson() and Value::addToBsonObj(). Those check the level of a document even if it is
+ * empty, but the level of an array only for each of its elements.
+ */
+bool fitsInMaxDepth(const BSONObj& obj, size_t recursionLevel, bool isArray) {
+    if ((!isArray || !obj.isEmpty()) && recursionLevel > BSONDepth::getMaxAllowableDepth()) {
+        return false;
+    }
+    for (auto&& elem : obj) {
+        if (elem.type() == Object || elem.type() == Array) {
+            if (!fitsInMaxDepth(elem.Obj(), recursionLevel + 1, elem.type() == Array)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}  // namespace
+
 const std::vector<StringData> Document::allMetadataFieldNames = {
     Document::metaFieldTextScore, Document::metaFieldRandVal, Document::metaFieldSortKey};
 
+DocumentStorage::DocumentStorage(const BSONObj& bson, size_t bufferBytes) : DocumentStorage() {
+    invariant(bson.isOwned());
+    _bson = bson;
+    _hasBackingBson = true;
+    _bsonBufferBytes = bufferBytes;
+
+    // Skip the size of the object. The next element is the terminating EOO if it is empty.
+    const char* first = _bson.objdata() + sizeof(int);
+    if (*first != EOO) {
+        _bsonNext = first;
+    }
+}
+
 Position DocumentStorage::findField(StringData requested) const {
+    const Position pos = findFieldInCache(requested);
+    if (pos.found() || !_bsonNext) {
+        return pos;
+    }
+    return const_cast<DocumentStorage*>(this)->loadFromBsonUntil(requested);
+}
+
+Position DocumentStorage::loadNextFromBson() {
+    const BSONElement elem(_bsonNext);
+    _bsonNext += elem.size();
+    if (*_bsonNext == EOO) {
+        _bsonNext = nullptr;
+    }
+
+    // A sub-document is wrapped as is, so that only the fields looked up in it are converted. It
+    // shares the buffer of this document unless that would pin a buffer much larger than itself,
+    // since its size accounts for the whole buffer.
+    Value value;
+    if (elem.type() == Object) {
+        BSONObj subObj = elem.embeddedObject();
+        if (subObj.isEmpty() || size_t(subObj.objsize()) * 2 < _bsonBufferBytes) {
+            value = Value(Document(subObj.getOwned()));
+        } else {
+            value = Value(Document(
+                new DocumentStorage(subObj.shareOwnershipWith(_bson), _bsonBufferBytes)));
+        }
+    } else {
+        value = Value(elem);
+    }
+
+    const Position pos = getNextPosition();
+    appendField(elem.fieldNameStringData()) = std::move(value);
+    return pos;
+}
+
+Position DocumentStorage::loadFromBsonUntil(StringData requested) {
+    while (_bsonNext) {
+        const Position pos = loadNextFromBson();
+        if (getField(pos).nameSD() == requested) {
+            return pos;
+        }
+    }
+    return Position();
+}
+
+void DocumentStorage::loadAllFromBson() {
+    while (_bsonNext) {
+        loadNextFromBson();
+    }
+}
+
+Position DocumentStorage::findFieldInCache(StringData requested) const {
     int reqSize = requested.size();  // get size calculation out of the way if needed
 
     if (_numFields >= HASH_TAB_MIN) {  // hash lookup
@@ -186,6 +273,8 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 }
 
 intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
+    // The clone is about to be modified, so it doesn't keep the backing BSON.
+    fillCache();
     intrusive_ptr<DocumentStorage> out(new DocumentStorage());
 
     // Make a copy of the buffer.
@@ -223,6 +312,13 @@ DocumentStorage::~DocumentStorage() {
 }
 
 Document::Document(const BSONObj& bson) {
+    if (bson.isOwned() && !bson.isEmpty()) {
+        // The fields are only converted as they are accessed, so that a pipeline which uses a few
+        // fields of a large document doesn't pay for converting all of them.
+        _storage = new DocumentStorage(bson, bson.objsize());
+        return;
+    }
+
     MutableDocument md(bson.nFields());
 
     BSONObjIterator it(bson);
@@ -258,6 +354,15 @@ void Document::toBson(BSONObjBuilder* builder, size_t recursionLevel) const {
                           << " levels of nesting",
             recursionLevel <= BSONDepth::getMaxAllowableDepth());
 
+    // An unmodified document read from BSON is copied as is, unless converting it field by field
+    // would fail for exceeding the maximum depth.
+    if (const BSONObj* bson = storage().getBackingBson()) {
+        if (fitsInMaxDepth(*bson, recursionLevel, false)) {
+            builder->appendElements(*bson);
+            return;
+        }
+    }
+
     for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
         it->val.addToBsonObj(builder, it->nameSD(), recursionLevel);
     }
@@ -286,6 +391,22 @@ BSONObj Document::toBsonWithMetaData(bool includeSortKey) const {
 }
 
 Document Document::fromBsonWithMetaData(const BSONObj& bson) {
+    if (bson.isOwned()) {
+        bool hasMetadata = false;
+        for (auto&& elem : bson) {
+            const auto fieldName = elem.fieldNameStringData();
+            if (fieldName[0] == '$' &&
+                std::find(allMetadataFieldNames.begin(), allMetadataFieldNames.end(), fieldName) !=
+                    allMetadataFieldNames.end()) {
+                hasMetadata = true;
+                break;
+            }
+        }
+        if (!hasMetadata) {
+            return Document(bson);
+        }
+    }
+
     MutableDocument md;
 
     BSONObjIterator it(bson);
@@ -380,6 +501,18 @@ size_t Document::getApproximateSize() const {
     if (!_storage)
         return 0;  // we've allocated no memory
 
+    // A document read from BSON is sized by the buffer it keeps alive, or by the slots its fields
+    // take once converted if those are larger. Either is at most what converting the document up
+    // front costs, and neither changes as fields are read, so that its size stays the same while
+    // a cache which subtracts it on eviction holds it.
+    if (const BSONObj* bson = storage().getBackingBson()) {
+        size_t slotBytes = 0;
+        for (auto&& elem : *bson) {
+            slotBytes += sizeof(ValueElement) + elem.fieldNameSize() - 1;
+        }
+        return sizeof(DocumentStorage) + std::max(storage().getBackingBufferBytes(), slotBytes);
+    }
+
     size_t size = sizeof(DocumentStorage);
     size += storage().allocatedBytes();
 
@@ -400,6 +533,13 @@ void Document::hash_combine(size_t& seed,
     }
 }
 
+void Document::fillCache() const {
+    storage().fillCache();
+    for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
+        it->val.fillCache();
+    }
+}
+
 int Document::compare(const Document& rL,
                       const Document& rR,
                       const StringData::ComparatorInterface* stringComparator) {
@@ -99,7 +99,11 @@ public:
     /// Empty Document (does no allocation)
     Document() {}
 
-    /// Create a new Document deep-converted from the given BSONObj.
+    /**
+     * Create a new Document from the given BSONObj. If 'bson' is owned, its fields are only
+     * converted as they are first accessed, and the Document shares ownership of its buffer.
+     * Otherwise it is deep-converted.
+     */
     explicit Document(const BSONObj& bson);
 
     /**
@@ -144,7 +148,7 @@ public:
 
     /// True if this document has no fields.
     bool empty() const {
-        return !_storage || storage().iterator().atEnd();
+        return !_storage || storage().empty();
     }
 
     /// Create a new FieldIterator that can be used to examine the Document's fields in order.
@@ -159,6 +163,13 @@ public:
      */
     size_t getApproximateSize() const;
 
+    /**
+     * Converts any fields of this document and its sub-documents not yet read from the BSON they
+     * were created from. Reading those fields modifies the shared storage, so a document must be
+     * filled before other threads may access it.
+     */
+    void fillCache() const;
+
     /**
      * Compare two documents. Most callers should prefer using DocumentComparator instead. See
      * document_comparator.h for details.
@@ -283,6 +294,7 @@ public:
     }
 
 private:
+    friend class DocumentStorage;  // for wrapping sub-documents read from BSON
     friend class FieldIterator;
     friend class ValueStorage;
     friend class MutableDocument;
@@ -568,7 +580,9 @@ private:
             return clonedStorage();
 
         // This function exists to ensure this is safe
-        return const_cast<DocumentStorage&>(*storagePtr());
+        DocumentStorage& storage = const_cast<DocumentStorage&>(*storagePtr());
+        storage.prepareForModification();
+        return storage;
     }
     DocumentStorage& newStorage() {
         reset(new DocumentStorage);
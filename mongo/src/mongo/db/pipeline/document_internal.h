@@ -191,6 +191,16 @@ public:
           _textScore(0),
           _randVal(0) {}
 
+    /**
+     * Creates a storage whose fields are read from 'bson', which must be owned, only as they are
+     * first looked up or iterated over. 'bufferBytes' is the size of the buffer 'bson' keeps alive,
+     * which is larger than 'bson' for a sub-document sharing the buffer of its parent.
+     *
+     * Sub-documents are read lazily as well. They share the buffer of 'bson' rather than being
+     * converted up front, unless they are small enough next to that buffer to be worth copying.
+     */
+    DocumentStorage(const BSONObj& bson, size_t bufferBytes);
+
     ~DocumentStorage();
 
     enum MetaType : char {
@@ -206,7 +216,8 @@ public:
     }
 
     size_t size() const {
-        // can't use _numFields because it includes removed Fields
+        // can't use _numFields because it includes removed Fields. iterator() reads any fields
+        // left in the backing BSON.
         size_t count = 0;
         for (DocumentStorageIterator it = iterator(); !it.atEnd(); it.advance())
             count++;
@@ -221,6 +232,11 @@ public:
     /// Returns the position of the named field (may be missing) or Position()
     Position findField(StringData name) const;
 
+    /// True if this document has no fields. Doesn't read the backing BSON.
+    bool empty() const {
+        return iteratorCacheOnly().atEnd() && !_bsonNext;
+    }
+
     // Document uses these
     const ValueElement& getField(Position pos) const {
         verify(pos.found());
@@ -255,14 +271,55 @@ public:
 
     /// This skips missing values
     DocumentStorageIterator iterator() const {
+        fillCache();
         return DocumentStorageIterator(_firstElement, end(), false);
     }
 
-    /// This includes missing values
+    /// This includes missing values. Unlike iterator(), this doesn't read the backing BSON.
     DocumentStorageIterator iteratorAll() const {
         return DocumentStorageIterator(_firstElement, end(), true);
     }
 
+    /// Like iterator(), but only over the fields already read from the backing BSON.
+    DocumentStorageIterator iteratorCacheOnly() const {
+        return DocumentStorageIterator(_firstElement, end(), false);
+    }
+
+    /**
+     * Reads the fields left in the backing BSON, if any. Reading a lazily created document isn't
+     * thread safe, so it must be filled before being shared with other threads.
+     */
+    void fillCache() const {
+        if (MONGO_unlikely(_bsonNext)) {
+            const_cast<DocumentStorage*>(this)->loadAllFromBson();
+        }
+    }
+
+    /**
+     * Returns the BSON object this document was read from, or nullptr if it wasn't or if its fields
+     * may have been modified since.
+     */
+    const BSONObj* getBackingBson() const {
+        return _hasBackingBson ? &_bson : nullptr;
+    }
+
+    /// The size of the buffer kept alive by the backing BSON, which may be larger than it.
+    size_t getBackingBufferBytes() const {
+        return _bsonBufferBytes;
+    }
+
+    /**
+     * Must be called before modifying the fields. Reads the fields left in the backing BSON, and
+     * forgets it since it won't match the fields anymore.
+     */
+    void prepareForModification() {
+        if (MONGO_unlikely(_hasBackingBson)) {
+            fillCache();
+            _bson = BSONObj();
+            _hasBackingBson = false;
+        }
+    }
+
     /// Shallow copy of this. Caller owns memory.
     boost::intrusive_ptr<DocumentStorage> clone() const;
 
@@ -325,6 +382,17 @@ private:
         return _firstElement ? _firstElement->plusBytes(_usedBytes) : nullptr;
     }
 
+    /// Like findField(), but doesn't read the backing BSON.
+    Position findFieldInCache(StringData name) const;
+
+    /// Appends the next field of the backing BSON and returns its position.
+    Position loadNextFromBson();
+
+    /// Appends the fields of the backing BSON up to the named one, and returns its position.
+    Position loadFromBsonUntil(StringData name);
+
+    void loadAllFromBson();
+
     /// Allocates space in _buffer. Copies existing data if there is any.
     void alloc(unsigned newSize);
 
@@ -401,6 +469,14 @@ private:
     double _textScore;
     double _randVal;
     BSONObj _sortKey;
+
+    // The owned BSON object the fields are read from, if this document was created from one, and
+    // the start of its next element not read yet, or null once all of them are. '_bson' is kept
+    // after that, so that an unmodified document can be serialized by copying it.
+    BSONObj _bson;
+    const char* _bsonNext = nullptr;
+    bool _hasBackingBson = false;
+    size_t _bsonBufferBytes = 0;
     // When adding a field, make sure to update clone() method
 
     // Defined in document.cpp
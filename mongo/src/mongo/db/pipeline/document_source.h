@@ -756,6 +756,20 @@ public:
         virtual CollectionIndexUsageMap getIndexStats(OperationContext* opCtx,
                                                       const NamespaceString& ns) = 0;
 
+        /**
+         * Returns the usage counters of the plan cache of collection "ns": a single document of
+         * totals if "totals" is true, and one document per query shape otherwise.
+         */
+        virtual std::vector<BSONObj> getPlanCacheStats(OperationContext* opCtx,
+                                                       const NamespaceString& ns,
+                                                       bool totals) = 0;
+
+        /**
+         * Returns the stats of each query shape executed by this server, and forgets them if
+         * "clear" is true.
+         */
+        virtual std::vector<BSONObj> getQueryStats(OperationContext* opCtx, bool clear) = 0;
+
         /**
          * Appends operation latency statistics for collection "nss" to "builder"
          */
@@ -89,7 +89,9 @@ void DocumentSourceCursor::loadBatch() {
                 } else if (_dependencies) {
                     _currentBatch.push_back(_dependencies->extractFields(resultObj));
                 } else {
-                    _currentBatch.push_back(Document::fromBsonWithMetaData(resultObj));
+                    // An owned object is wrapped rather than converted, so that only the fields
+                    // the pipeline reads are converted.
+                    _currentBatch.push_back(Document::fromBsonWithMetaData(resultObj.getOwned()));
                 }
 
                 if (_limit) {
@@ -270,7 +272,7 @@ DocumentSourceCursor::DocumentSourceCursor(
     recordPlanSummaryStats();
 
     if (collection) {
-        collection->infoCache()->notifyOfQuery(pExpCtx->opCtx, _planSummaryStats.indexesUsed);
+        collection->infoCache()->notifyOfQuery(pExpCtx->opCtx, _planSummaryStats);
     }
 }
 
@@ -30,6 +30,7 @@
 
 #include "mongo/db/pipeline/document_source_facet.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -38,15 +39,24 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/bsontypes.h"
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_tee_consumer.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/tee_buffer.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_worker_pool.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/encryption_hooks.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -106,6 +116,15 @@ vector<pair<string, vector<BSONObj>>> extractRawPipelines(const BSONElement& ele
     }
     return rawFacetPipelines;
 }
+
+/**
+ * Returns the pool of threads shared by all $facet stages that run their sub-pipelines in
+ * parallel. It is never shut down.
+ */
+ThreadPool* getWorkerPool() {
+    static ThreadPool* pool = makeQueryWorkerPool("DocumentSourceFacet", "facet-");
+    return pool;
+}
 }  // namespace
 
 std::unique_ptr<DocumentSourceFacet::LiteParsed> DocumentSourceFacet::LiteParsed::parse(
@@ -169,16 +188,20 @@ DocumentSource::GetNextResult DocumentSourceFacet::getNext() {
     }
 
     vector<vector<Value>> results(_facets.size());
-    bool allPipelinesEOF = false;
-    while (!allPipelinesEOF) {
-        allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
-        for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
-            const auto& pipeline = _facets[facetId].pipeline;
-            auto next = pipeline->getSources().back()->getNext();
-            for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
-                results[facetId].emplace_back(next.releaseDocument());
+    if (canRunFacetsInParallel()) {
+        runFacetsInParallel(&results);
+    } else {
+        bool allPipelinesEOF = false;
+        while (!allPipelinesEOF) {
+            allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
+            for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+                const auto& pipeline = _facets[facetId].pipeline;
+                auto next = pipeline->getSources().back()->getNext();
+                for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
+                    results[facetId].emplace_back(next.releaseDocument());
+                }
+                allPipelinesEOF = allPipelinesEOF && next.isEOF();
             }
-            allPipelinesEOF = allPipelinesEOF && next.isEOF();
         }
     }
 
@@ -191,6 +214,142 @@ DocumentSource::GetNextResult DocumentSourceFacet::getNext() {
     return resultDoc.freeze();
 }
 
+bool DocumentSourceFacet::canRunFacetsInParallel() const {
+    if (!internalQueryFacetParallelExecution.load() || _facets.size() < 2 ||
+        !pExpCtx->allowDiskUse || pExpCtx->inMongos || pExpCtx->tempDir.empty()) {
+        return false;
+    }
+
+    // The spilled input would be written to disk unencrypted.
+    if (EncryptionHooks::get(getGlobalServiceContext())->enabled()) {
+        return false;
+    }
+
+    // Each sub-pipeline is re-parsed on its own, outside the scope of any variables defined by an
+    // enclosing stage.
+    if (pExpCtx->variablesParseState.hasDefinedVariables()) {
+        return false;
+    }
+
+    // Stages which query other collections or draw from the Client's random number generator must
+    // stay on the thread running the operation.
+    return std::none_of(_facets.begin(), _facets.end(), [](const auto& facet) {
+        const auto& sources = facet.pipeline->getSources();
+        return std::any_of(sources.begin(), sources.end(), [](const auto& source) {
+            return dynamic_cast<DocumentSourceNeedsMongoProcessInterface*>(source.get()) ||
+                dynamic_cast<DocumentSourceSample*>(source.get());
+        });
+    });
+}
+
+void DocumentSourceFacet::runFacetsInParallel(std::vector<std::vector<Value>>* results) {
+    // Evaluating expressions and checking for interrupts both modify the ExpressionContext, so give
+    // every sub-pipeline a copy of its own by parsing it again.
+    for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+        auto& facet = _facets[facetId];
+        std::vector<BSONObj> rawPipeline;
+        for (auto&& stage : facet.pipeline->serialize()) {
+            rawPipeline.push_back(stage.getDocument().toBson());
+        }
+
+        auto facetExpCtx =
+            pExpCtx->copyWith(pExpCtx->ns,
+                              pExpCtx->uuid,
+                              pExpCtx->getCollator() ? pExpCtx->getCollator()->clone() : nullptr);
+        auto pipeline = uassertStatusOK(Pipeline::parseFacetPipeline(rawPipeline, facetExpCtx));
+        pipeline->optimizePipeline();
+        pipeline->addInitialSource(
+            DocumentSourceTeeConsumer::create(facetExpCtx, facetId, _teeBuffer));
+
+        // The replaced pipeline never ran, and disposing of it would dispose of its consumer.
+        facet.pipeline.get_deleter().dismissDisposal();
+        facet.pipeline = std::move(pipeline);
+    }
+    _teeBuffer->startConcurrentConsumers(pExpCtx->tempDir);
+
+    stdx::mutex mutex;
+    stdx::condition_variable allDone;
+    size_t numRunning = 0;
+    Status status = Status::OK();
+    bool inputLoaded = false;
+
+    {
+        // The workers use the state above, so wait for them even if this thread throws. Until all
+        // of the input is loaded they may be waiting for more, so stop them first in that case.
+        ON_BLOCK_EXIT([&] {
+            if (!inputLoaded) {
+                _teeBuffer->abort(Status(ErrorCodes::InternalError,
+                                         "$facet stopped before reading all its input"));
+            }
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            allDone.wait(lk, [&] { return numRunning == 0; });
+        });
+
+        auto runFacet = [&](size_t facetId) {
+            try {
+                const auto& pipeline = _facets[facetId].pipeline;
+                auto next = pipeline->getSources().back()->getNext();
+                for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
+                    (*results)[facetId].emplace_back(next.releaseDocument());
+                }
+                invariant(next.isEOF());
+            } catch (...) {
+                // Stop the input and the other sub-pipelines, since the whole $facet will fail.
+                // Nothing may escape a worker, which would terminate the process.
+                const Status error = exceptionToStatus();
+                _teeBuffer->abort(error);
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (status.isOK()) {
+                    status = error;
+                }
+            }
+        };
+
+        std::vector<size_t> inlineFacets;
+        for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                ++numRunning;
+            }
+            auto scheduled = getWorkerPool()->schedule([&, facetId] {
+                ON_BLOCK_EXIT([&] {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    if (--numRunning == 0) {
+                        allDone.notify_all();
+                    }
+                });
+                runFacet(facetId);
+            });
+            if (!scheduled.isOK()) {
+                // The pool is shutting down. Run the facet on this thread once all input is
+                // buffered.
+                {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    --numRunning;
+                }
+                inlineFacets.push_back(facetId);
+            }
+        }
+
+        try {
+            _teeBuffer->loadAllInput();
+        } catch (...) {
+            const Status error = exceptionToStatus();
+            _teeBuffer->abort(error);
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (status.isOK()) {
+                status = error;
+            }
+        }
+        inputLoaded = true;
+
+        for (auto facetId : inlineFacets) {
+            runFacet(facetId);
+        }
+    }
+    uassertStatusOK(status);
+}
+
 Value DocumentSourceFacet::serialize(boost::optional<ExplainOptions::Verbosity> explain) const {
     MutableDocument serialized;
     for (auto&& facet : _facets) {
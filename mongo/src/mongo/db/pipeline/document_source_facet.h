@@ -150,6 +150,19 @@ private:
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
 
+    /**
+     * Returns true if the sub-pipelines may run on separate threads. This requires that buffered
+     * input can be spilled to disk, and that no sub-pipeline contains a stage which relies on the
+     * OperationContext or the Client beyond checking for interrupts.
+     */
+    bool canRunFacetsInParallel() const;
+
+    /**
+     * Runs each sub-pipeline on a thread of its own while this thread reads the input into
+     * '_teeBuffer', and appends the results of the facet at index 'i' to '(*results)[i]'.
+     */
+    void runFacetsInParallel(std::vector<std::vector<Value>>* results);
+
     boost::intrusive_ptr<TeeBuffer> _teeBuffer;
     std::vector<FacetPipeline> _facets;
 
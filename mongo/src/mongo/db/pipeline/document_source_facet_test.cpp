@@ -43,7 +43,9 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_source_skip.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/unittest/death_test.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -370,6 +372,66 @@ DEATH_TEST_F(DocumentSourceFacetTest,
     facetStage->getNext();  // This should cause a crash.
 }
 
+/**
+ * Makes the $facet stages which run while it is in scope run their sub-pipelines in parallel,
+ * keeping at most 'bufferSizeBytes' of their input in memory.
+ */
+class ParallelFacetGuard {
+public:
+    explicit ParallelFacetGuard(int bufferSizeBytes)
+        : _oldParallelExecution(internalQueryFacetParallelExecution.load()),
+          _oldBufferSizeBytes(internalQueryFacetBufferSizeBytes.load()) {
+        internalQueryFacetParallelExecution.store(true);
+        internalQueryFacetBufferSizeBytes.store(bufferSizeBytes);
+    }
+
+    ~ParallelFacetGuard() {
+        internalQueryFacetParallelExecution.store(_oldParallelExecution);
+        internalQueryFacetBufferSizeBytes.store(_oldBufferSizeBytes);
+    }
+
+private:
+    const bool _oldParallelExecution;
+    const int _oldBufferSizeBytes;
+};
+
+TEST_F(DocumentSourceFacetTest, ParallelFacetsShouldProduceTheSameResultsAsSerialFacets) {
+    auto ctx = getExpCtx();
+    unittest::TempDir tempDir("document_source_facet_test");
+    ctx->allowDiskUse = true;
+    ctx->tempDir = tempDir.path();
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 500; ++i) {
+        inputs.emplace_back(Document{{"_id", i}, {"a", i % 7}});
+    }
+
+    const auto spec = fromjson(
+        "{$facet: {"
+        "  matched: [{$match: {a: {$gt: 4}}}, {$project: {b: {$multiply: ['$a', '$_id']}}}],"
+        "  grouped: [{$group: {_id: '$a', count: {$sum: 1}}}, {$sort: {_id: 1}}],"
+        "  topTwo: [{$sort: {_id: -1}}, {$limit: 2}]"
+        "}}");
+    auto runFacet = [&] {
+        auto facetStage = DocumentSourceFacet::createFromBson(spec.firstElement(), ctx);
+        facetStage->optimize();
+        auto mock = DocumentSourceMock::create(inputs);
+        facetStage->setSource(mock.get());
+
+        auto output = facetStage->getNext();
+        ASSERT(output.isAdvanced());
+        ASSERT(facetStage->getNext().isEOF());
+        return output.releaseDocument();
+    };
+
+    const auto serialOutput = runFacet();
+    ASSERT_EQ(serialOutput["matched"].getArrayLength(), 142UL);
+
+    // Only the newest input document stays in memory, the rest is read back from disk.
+    ParallelFacetGuard guard(1);
+    ASSERT_DOCUMENT_EQ(runFacet(), serialOutput);
+}
+
 //
 // Miscellaneous.
 //
@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -38,7 +40,13 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_worker_pool.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -114,13 +122,19 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
+    // A parallel $group outputs the groups of its partitions one after the other.
+    while (groupsIterator == _groups->end() && _nextPartition < _partitions.size()) {
+        _groups = std::move(_partitions[_nextPartition++].groups);
+        groupsIterator = _groups->begin();
+    }
+
     // Not spilled, and not streaming.
-    if (_groups->empty())
+    if (groupsIterator == _groups->end())
         return GetNextResult::makeEOF();
 
     Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
 
-    if (++groupsIterator == _groups->end())
+    if (++groupsIterator == _groups->end() && _nextPartition == _partitions.size())
         dispose();
 
     return std::move(out);
@@ -128,51 +142,161 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
     // Streaming optimization is active.
-    if (!_firstDocOfNextGroup) {
+    while (_streamingOutput.empty()) {
+        if (_streamingEOF) {
+            dispose();
+            return GetNextResult::makeEOF();
+        }
+
         auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
+        if (nextInput.isPaused()) {
+            // The current run is left in '_groups' until the input resumes.
             return nextInput;
         }
-        _firstDocOfNextGroup = nextInput.releaseDocument();
+        if (nextInput.isEOF()) {
+            flushRun();
+            _streamingEOF = true;
+            continue;
+        }
+
+        auto rootDocument = nextInput.releaseDocument();
+        std::vector<Value> runKey;
+        if (!computeRunKey(rootDocument, &runKey)) {
+            // The groups output so far sort strictly before this document, so no later document
+            // can belong to them. Accumulate the rest of the input, including the current run,
+            // like an unsorted $group.
+            accumulate(rootDocument);
+            _streamingAbandoned = true;
+            for (auto&& sortField : getStreamingOutputSort()) {
+                _streamingOutputSortFields.emplace_back(FieldPath(sortField.fieldName()),
+                                                        sortField.numberInt());
+            }
+            _initialized = false;
+            return getNext();
+        }
+
+        // The groups of the current run are complete once the sort key changes.
+        bool sameRun = !_groups->empty();
+        for (size_t i = 0; sameRun && i < runKey.size(); i++) {
+            sameRun = pExpCtx->getValueComparator().evaluate(runKey[i] == _runKey[i]);
+        }
+        if (!sameRun) {
+            flushRun();
+        }
+        _runKey = std::move(runKey);
+        accumulate(rootDocument);
+    }
+
+    Document out = std::move(_streamingOutput.front());
+    _streamingOutput.pop_front();
+    return std::move(out);
+}
+
+void DocumentSourceGroup::flushRun() {
+    for (auto&& group : *_groups) {
+        _streamingOutput.push_back(makeDocument(group.first, group.second, pExpCtx->needsMerge));
     }
+    _groups->clear();
+    _memoryUsageBytes = 0;
+}
 
-    Value id;
-    do {
-        // Add to the current accumulator(s).
-        for (size_t i = 0; i < _currentAccumulators.size(); i++) {
-            _currentAccumulators[i]->process(
-                _accumulatedFields[i].expression->evaluate(*_firstDocOfNextGroup), _doingMerge);
+bool DocumentSourceGroup::computeRunKey(const Document& root, std::vector<Value>* runKey) const {
+    runKey->clear();
+    runKey->reserve(_runKeyExpressions.size());
+    for (auto&& expression : _runKeyExpressions) {
+        Value value = expression->evaluate(root);
+        if (value.isArray()) {
+            return false;
         }
+        // A sort doesn't tell null, missing and undefined values apart, so neither may a run.
+        runKey->push_back(value.nullish() ? Value(BSONNULL) : std::move(value));
+    }
+    return true;
+}
 
-        // Retrieve the next document.
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
+void DocumentSourceGroup::finishAbandonedStreaming() {
+    // Keep the order promised by getOutputSorts(), which a later stage may already rely on.
+    std::vector<const GroupsMap::value_type*> groups;
+    groups.reserve(_groups->size());
+    for (auto&& group : *_groups) {
+        groups.push_back(&group);
+    }
+    std::sort(groups.begin(),
+              groups.end(),
+              [this](const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) {
+                  return compareIdsInStreamingOrder(lhs->first, rhs->first) < 0;
+              });
+
+    for (auto&& group : groups) {
+        _streamingOutput.push_back(makeDocument(group->first, group->second, pExpCtx->needsMerge));
+    }
+    _groups->clear();
+    _streamingEOF = true;
+}
+
+int DocumentSourceGroup::compareIdsInStreamingOrder(const Value& lhs, const Value& rhs) const {
+    const auto& comparator = pExpCtx->getValueComparator();
+    const Document lhsDoc{{"_id", expandId(lhs)}};
+    const Document rhsDoc{{"_id", expandId(rhs)}};
+    for (auto&& sortField : _streamingOutputSortFields) {
+        const int cmp = comparator.compare(lhsDoc.getNestedField(sortField.first),
+                                           rhsDoc.getNestedField(sortField.first));
+        if (cmp != 0) {
+            return cmp * sortField.second;
         }
+    }
+    return comparator.compare(lhs, rhs);
+}
 
-        _firstDocOfNextGroup = nextInput.releaseDocument();
+bool DocumentSourceGroup::accumulate(const Document& root) {
+    const size_t numAccumulators = _accumulatedFields.size();
+    Value id = computeId(root);
 
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
 
-        // Compute the id. If it does not match _currentId, we will exit the loop, leaving
-        // _firstDocOfNextGroup set for the next time getNext() is called.
-        id = computeId(*_firstDocOfNextGroup);
-    } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
 
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
-    _currentId = std::move(id);
+        // Add the accumulators
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
 
-    return std::move(out);
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(_accumulatedFields[i].expression->evaluate(root), _doingMerge);
+
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
+
+    return inserted;
 }
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _partitions.clear();
 
     // Make us look done.
     groupsIterator = _groups->end();
 
-    _firstDocOfNextGroup = boost::none;
+    _streamingOutput.clear();
+    _streamingEOF = true;
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
@@ -359,6 +483,14 @@ namespace {
 
 using GroupsMap = DocumentSourceGroup::GroupsMap;
 
+/**
+ * The threads which accumulate the partitions of every parallel $group. Never shut down.
+ */
+ThreadPool* getWorkerPool() {
+    static ThreadPool* pool = makeQueryWorkerPool("DocumentSourceGroup", "group-");
+    return pool;
+}
+
 class SorterComparator {
 public:
     typedef pair<Value, Value> Data;
@@ -451,81 +583,55 @@ void getFieldPathListForSpilled(ExpressionObject* expressionObj,
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
 
-    boost::optional<BSONObj> inputSort = findRelevantInputSort();
+    boost::optional<BSONObj> inputSort =
+        _streamingAbandoned ? boost::none : findRelevantInputSort();
     if (inputSort) {
-        // We can convert to streaming.
+        // We can convert to streaming. The input is read in runs by getNextStreaming().
         _streaming = true;
         _inputSort = *inputSort;
-
-        // Set up accumulators.
-        _currentAccumulators.reserve(numAccumulators);
-        for (auto&& accumulatedField : _accumulatedFields) {
-            _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        _runKeyExpressions.clear();
+        for (auto&& sortField : _inputSort) {
+            _runKeyExpressions.push_back(
+                ExpressionFieldPath::create(pExpCtx, sortField.fieldName()));
         }
-
-        // We only need to load the first document.
-        auto firstInput = pSource->getNext();
-        if (!firstInput.isAdvanced()) {
-            // Leave '_firstDocOfNextGroup' uninitialized and return.
-            return firstInput;
-        }
-        _firstDocOfNextGroup = firstInput.releaseDocument();
-
-        // Compute the _id value.
-        _currentId = computeId(*_firstDocOfNextGroup);
         _initialized = true;
         return DocumentSource::GetNextResult::makeEOF();
     }
 
+    // The groups of an abandoned streaming $group are already in '_groups', so it can't be
+    // partitioned.
+    if (_partitions.empty() && !_streamingAbandoned) {
+        const size_t degree = getParallelDegree();
+        if (degree > 1) {
+            _partitions.reserve(degree);
+            for (size_t i = 0; i < degree; ++i) {
+                _partitions.emplace_back(
+                    pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>());
+            }
+        }
+    }
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups', or the groups of
+    // '_partitions' for a parallel $group.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
+        if (!_partitions.empty()) {
+            bufferForPartition(input.releaseDocument());
+            continue;
+        }
+
         if (_memoryUsageBytes > _maxMemoryUsageBytes) {
             uassert(16945,
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _allowDiskUse);
-            _sortedFiles.push_back(spill());
+            _sortedFiles.push_back(spill(_groups.get_ptr()));
             _memoryUsageBytes = 0;
         }
 
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
-        auto rootDocument = input.releaseDocument();
-        Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
-                              _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
-        }
+        const bool inserted = accumulate(input.releaseDocument());
 
         if (kDebugBuild && !storageGlobalParams.readOnly) {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
@@ -534,7 +640,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                 !_allowDiskUse &&            // don't change behavior when testing external sort
                 _sortedFiles.size() < 20) {  // don't open too many FDs
 
-                _sortedFiles.push_back(spill());
+                _sortedFiles.push_back(spill(_groups.get_ptr()));
             }
         }
     }
@@ -548,17 +654,33 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
+            if (!_partitions.empty()) {
+                finishPartitions();
+            }
+
             if (!_sortedFiles.empty()) {
                 _spilled = true;
                 if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
+                    _sortedFiles.push_back(spill(_groups.get_ptr()));
                 }
 
                 // We won't be using groups again so free its memory.
                 _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
 
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+                if (_streamingAbandoned) {
+                    _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+                        _sortedFiles,
+                        SortOptions(),
+                        [this](const SorterComparator::Data& lhs,
+                               const SorterComparator::Data& rhs) {
+                            return compareIdsInStreamingOrder(lhs.first, rhs.first);
+                        }));
+                } else {
+                    _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+                        _sortedFiles,
+                        SortOptions(),
+                        SorterComparator(pExpCtx->getValueComparator())));
+                }
 
                 // prepare current to accumulate data
                 _currentAccumulators.reserve(numAccumulators);
@@ -568,6 +690,8 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
 
                 verify(_sorterIterator->more());  // we put data in, we should get something out.
                 _firstPartOfNextGroup = _sorterIterator->next();
+            } else if (_streamingAbandoned) {
+                finishAbandonedStreaming();
             } else {
                 // start the group iterator
                 groupsIterator = _groups->begin();
@@ -582,14 +706,22 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill(GroupsMap* groups) const {
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
+    ptrs.reserve(groups->size());
+    for (GroupsMap::const_iterator it = groups->begin(), end = groups->end(); it != end; ++it) {
         ptrs.push_back(&*it);
     }
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+    if (_streamingAbandoned) {
+        stable_sort(ptrs.begin(),
+                    ptrs.end(),
+                    [this](const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) {
+                        return compareIdsInStreamingOrder(lhs->first, rhs->first) < 0;
+                    });
+    } else {
+        stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+    }
 
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
     switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
@@ -617,15 +749,172 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
             break;
     }
 
-    _groups->clear();
+    groups->clear();
 
     return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
 }
 
+size_t DocumentSourceGroup::getParallelDegree() const {
+    // Collators aren't shared between threads, and the groups are compared through the collator.
+    const int degree = internalDocumentSourceGroupParallelDegree.load();
+    if (degree <= 1 || pExpCtx->getCollator()) {
+        return 1;
+    }
+    return degree;
+}
+
+void DocumentSourceGroup::bufferForPartition(const Document& root) {
+    // Expressions are evaluated on this thread, since they share the query's variables.
+    // Documents read lazily from BSON are filled here too, as the workers may share them.
+    Value id = computeId(root);
+    id.fillCache();
+    vector<Value> arguments;
+    arguments.reserve(_accumulatedFields.size());
+    for (auto&& accumulatedField : _accumulatedFields) {
+        arguments.push_back(accumulatedField.expression->evaluate(root));
+        arguments.back().fillCache();
+    }
+
+    // Take the partition from the high bits of the mixed hash, so that the groups of a partition
+    // still spread over all the buckets of its map.
+    const uint64_t hash = pExpCtx->getValueComparator().hash(id) * 0x9E3779B97F4A7C15ULL;
+    Partition& partition = _partitions[(hash >> 32) % _partitions.size()];
+    partition.inputs.emplace_back(std::move(id), std::move(arguments));
+
+    const size_t roundSize = std::max(1, internalDocumentSourceGroupParallelRoundSize.load());
+    if (++_numBufferedInputs >= roundSize) {
+        runParallelRound();
+    }
+}
+
+void DocumentSourceGroup::runParallelRound() {
+    stdx::mutex mutex;
+    stdx::condition_variable allDone;
+    size_t numRunning = 0;
+
+    {
+        // The workers use the state above and the partitions, so wait for them even if this
+        // thread throws.
+        ON_BLOCK_EXIT([&] {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            allDone.wait(lk, [&] { return numRunning == 0; });
+        });
+
+        Partition* ownPartition = nullptr;
+        for (auto&& partition : _partitions) {
+            if (partition.inputs.empty()) {
+                continue;
+            }
+            if (!ownPartition) {
+                // Accumulated by this thread once the others are started.
+                ownPartition = &partition;
+                continue;
+            }
+
+            Partition* const workerPartition = &partition;
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                ++numRunning;
+            }
+            auto status = getWorkerPool()->schedule([&, workerPartition] {
+                ON_BLOCK_EXIT([&] {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    if (--numRunning == 0) {
+                        allDone.notify_all();
+                    }
+                });
+                accumulatePartition(workerPartition);
+            });
+            if (!status.isOK()) {
+                // The pool is shutting down. Accumulate the partition on this thread instead.
+                {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    --numRunning;
+                }
+                accumulatePartition(workerPartition);
+            }
+        }
+
+        if (ownPartition) {
+            accumulatePartition(ownPartition);
+        }
+    }
+    _numBufferedInputs = 0;
+
+    size_t memoryUsageBytes = 0;
+    for (auto&& partition : _partitions) {
+        uassertStatusOK(partition.status);
+        memoryUsageBytes += partition.memoryUsageBytes;
+    }
+    uassert(16945,
+            "Exceeded memory limit for $group, but didn't allow external sort."
+            " Pass allowDiskUse:true to opt in.",
+            _allowDiskUse || memoryUsageBytes <= _maxMemoryUsageBytes);
+}
+
+void DocumentSourceGroup::accumulatePartition(Partition* partition) const {
+    const size_t numAccumulators = _accumulatedFields.size();
+    const size_t maxMemoryUsageBytes = _maxMemoryUsageBytes / _partitions.size();
+
+    try {
+        for (auto&& input : partition->inputs) {
+            if (_allowDiskUse && partition->memoryUsageBytes > maxMemoryUsageBytes) {
+                partition->sortedFiles.push_back(spill(&partition->groups));
+                partition->memoryUsageBytes = 0;
+            }
+
+            // As in initialize(), find or add the group while hashing its key only once.
+            const size_t idSize = input.first.getApproximateSize();
+            const size_t oldSize = partition->groups.size();
+            Accumulators& group = partition->groups[std::move(input.first)];
+            if (partition->groups.size() != oldSize) {
+                partition->memoryUsageBytes += idSize;
+                group.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+                }
+            } else {
+                for (auto&& accumulator : group) {
+                    partition->memoryUsageBytes -= accumulator->memUsageForSorter();
+                }
+            }
+
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group[i]->process(input.second[i], _doingMerge);
+                partition->memoryUsageBytes += group[i]->memUsageForSorter();
+            }
+        }
+    } catch (...) {
+        // Exceptions must not escape the workers, which would terminate the process.
+        partition->status = exceptionToStatus();
+    }
+    partition->inputs.clear();
+}
+
+void DocumentSourceGroup::finishPartitions() {
+    if (_numBufferedInputs > 0) {
+        runParallelRound();
+    }
+
+    const bool spilled =
+        std::any_of(_partitions.begin(), _partitions.end(), [](const Partition& partition) {
+            return !partition.sortedFiles.empty();
+        });
+    if (spilled) {
+        for (auto&& partition : _partitions) {
+            if (!partition.groups.empty()) {
+                partition.sortedFiles.push_back(spill(&partition.groups));
+            }
+            _sortedFiles.insert(
+                _sortedFiles.end(), partition.sortedFiles.begin(), partition.sortedFiles.end());
+        }
+        _partitions.clear();
+    }
+    _nextPartition = 0;
+}
+
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
-    if (true) {
-        // Until streaming $group correctly handles nullish values, the streaming behavior is
-        // disabled. See SERVER-23318.
+    if (!internalDocumentSourceGroupEnableStreaming.load()) {
         return boost::none;
     }
 
@@ -695,78 +984,83 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
-        return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    // An abandoned streaming $group keeps its streaming order, even once it spills.
+    if (_streaming) {
+        return allPrefixes(getStreamingOutputSort());
     }
 
-    BSONObjBuilder sortOrder;
-
-    if (_idFieldNames.empty()) {
-        if (_spilled) {
+    if (_spilled) {
+        // We have spilled to disk, so the groups are output in the order of their internal _id.
+        BSONObjBuilder sortOrder;
+        if (_idFieldNames.empty()) {
             sortOrder.append("_id", 1);
         } else {
-            // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
-            // get the sort order out of it.
-            if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
-                FieldPath _idSort = obj->getFieldPath();
-
-                sortOrder.append(
-                    "_id",
-                    _inputSort.getIntField(_idSort.getFieldName(_idSort.getPathLength() - 1)));
+            std::vector<std::string> outputSort;
+            for (size_t i = 0; i < _idFieldNames.size(); i++) {
+                intrusive_ptr<Expression> exp = _idExpressions[i];
+                if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
+                    // _id is an object containing a nested document, such as: {_id: {x: {y:
+                    // "$b"}}}.
+                    getFieldPathListForSpilled(obj, "_id." + _idFieldNames[i], &outputSort);
+                } else {
+                    outputSort.push_back("_id." + _idFieldNames[i]);
+                }
             }
-        }
-    } else if (_streaming) {
-        // At this point, we know that _streaming is true, so _id must have only contained
-        // ExpressionObjects, ExpressionConstants or ExpressionFieldPaths. We now process each
-        // '_idExpression'.
-
-        // We populate 'fieldMap' such that each key is a field the input is sorted by, and the
-        // value is where that input field is located within the _id document. For example, if our
-        // _id object is {_id: {x: {y: "$a.b"}}}, 'fieldMap' would be: {'a.b': '_id.x.y'}.
-        StringMap<std::string> fieldMap;
-        for (size_t i = 0; i < _idFieldNames.size(); i++) {
-            intrusive_ptr<Expression> exp = _idExpressions[i];
-            if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
-                // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
-                getFieldPathMap(obj, "_id." + _idFieldNames[i], &fieldMap);
-            } else if (auto fieldPath = dynamic_cast<ExpressionFieldPath*>(exp.get())) {
-                FieldPath _idSort = fieldPath->getFieldPath();
-                fieldMap[_idSort.getFieldName(_idSort.getPathLength() - 1)] =
-                    "_id." + _idFieldNames[i];
+            for (auto&& field : outputSort) {
+                sortOrder.append(field, 1);
             }
         }
+        return allPrefixes(sortOrder.obj());
+    }
 
-        // Because the order of '_inputSort' is important, we go through each field we are sorted on
-        // and append it to the BSONObjBuilder in order.
-        for (BSONElement sortField : _inputSort) {
-            std::string sortString = sortField.fieldNameStringData().toString();
-
-            auto itr = fieldMap.find(sortString);
+    return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+}
 
-            // If our sort order is (a, b, c), we could not have converted to a streaming $group if
-            // our _id was predicated on (a, c) but not 'b'. Verify that this is true.
-            invariant(itr != fieldMap.end());
+BSONObj DocumentSourceGroup::getStreamingOutputSort() const {
+    BSONObjBuilder sortOrder;
 
-            sortOrder.append(itr->second, _inputSort.getIntField(sortString));
-        }
-    } else {
-        // We are blocking and have spilled to disk.
-        std::vector<std::string> outputSort;
-        for (size_t i = 0; i < _idFieldNames.size(); i++) {
-            intrusive_ptr<Expression> exp = _idExpressions[i];
-            if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
-                // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
-                getFieldPathListForSpilled(obj, "_id." + _idFieldNames[i], &outputSort);
-            } else {
-                outputSort.push_back("_id." + _idFieldNames[i]);
-            }
+    if (_idFieldNames.empty()) {
+        // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
+        // get the sort order out of it.
+        if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
+            sortOrder.append("_id", _inputSort.getIntField(obj->getFieldPath().tail().fullPath()));
         }
-        for (auto&& field : outputSort) {
-            sortOrder.append(field, 1);
+        return sortOrder.obj();
+    }
+
+    // At this point, we know that _streaming is true, so _id must have only contained
+    // ExpressionObjects, ExpressionConstants or ExpressionFieldPaths. We now process each
+    // '_idExpression'.
+
+    // We populate 'fieldMap' such that each key is a field the input is sorted by, and the
+    // value is where that input field is located within the _id document. For example, if our
+    // _id object is {_id: {x: {y: "$a.b"}}}, 'fieldMap' would be: {'a.b': '_id.x.y'}.
+    StringMap<std::string> fieldMap;
+    for (size_t i = 0; i < _idFieldNames.size(); i++) {
+        intrusive_ptr<Expression> exp = _idExpressions[i];
+        if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
+            // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
+            getFieldPathMap(obj, "_id." + _idFieldNames[i], &fieldMap);
+        } else if (auto fieldPath = dynamic_cast<ExpressionFieldPath*>(exp.get())) {
+            fieldMap[fieldPath->getFieldPath().tail().fullPath()] = "_id." + _idFieldNames[i];
         }
     }
 
-    return allPrefixes(sortOrder.obj());
+    // Because the order of '_inputSort' is important, we go through each field we are sorted on
+    // and append it to the BSONObjBuilder in order.
+    for (BSONElement sortField : _inputSort) {
+        std::string sortString = sortField.fieldNameStringData().toString();
+
+        auto itr = fieldMap.find(sortString);
+
+        // If our sort order is (a, b, c), we could not have converted to a streaming $group if
+        // our _id was predicated on (a, c) but not 'b'. Verify that this is true.
+        invariant(itr != fieldMap.end());
+
+        sortOrder.append(itr->second, _inputSort.getIntField(sortString));
+    }
+
+    return sortOrder.obj();
 }
 
 
@@ -786,7 +1080,7 @@ Value DocumentSourceGroup::computeId(const Document& root) {
     return Value(std::move(vals));
 }
 
-Value DocumentSourceGroup::expandId(const Value& val) {
+Value DocumentSourceGroup::expandId(const Value& val) const {
     // _id doesn't get wrapped in a document
     if (_idFieldNames.empty())
         return val;
@@ -28,8 +28,10 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -111,8 +113,13 @@ private:
 
     /**
      * getNext() dispatches to one of these three depending on what type of $group it is. All three
-     * of these methods expect '_currentAccumulators' to have been reset before being called, and
-     * also expect initialize() to have been called already.
+     * of these methods expect initialize() to have been called already. getNextSpilled() also
+     * expects '_currentAccumulators' to have been reset before being called. getNextStreaming()
+     * doesn't use them: it keeps the groups of the current run in '_groups'.
+     *
+     * A streaming $group reads its sorted input in runs of documents with equal sort keys, and
+     * outputs the groups of a run as soon as the next run starts. A run usually holds a single
+     * group, but may hold several whose _ids differ only by null, missing and undefined values.
      */
     GetNextResult getNextStreaming();
     GetNextResult getNextSpilled();
@@ -124,11 +131,48 @@ private:
      */
     boost::optional<BSONObj> findRelevantInputSort() const;
 
+    /**
+     * Returns the sort order of the output of a streaming $group, in terms of the fields of _id.
+     */
+    BSONObj getStreamingOutputSort() const;
+
+    /**
+     * Computes the sort key of 'root' under '_inputSort' into 'runKey', with null, missing and
+     * undefined values all mapped to null. Returns false if any of the sorted fields is an array,
+     * as arrays sort by one of their elements and so don't keep equal _ids consecutive.
+     */
+    bool computeRunKey(const Document& root, std::vector<Value>* runKey) const;
+
+    /**
+     * Moves the groups of the current run from '_groups' to '_streamingOutput'.
+     */
+    void flushRun();
+
+    /**
+     * Called once the input of a streaming $group which met an array in its sorted fields is
+     * exhausted. Outputs the groups accumulated since then in the order of
+     * getStreamingOutputSort(), unless they spilled.
+     */
+    void finishAbandonedStreaming();
+
+    /**
+     * Compares the internal _ids of two groups in the order of getStreamingOutputSort(), and then
+     * as a whole so that equal _ids stay adjacent. The groups of an abandoned streaming $group are
+     * output, and spilled, in this order.
+     */
+    int compareIdsInStreamingOrder(const Value& lhs, const Value& rhs) const;
+
+    /**
+     * Adds 'root' to its group in '_groups', creating the group if there was none, and accounts
+     * for the change in '_memoryUsageBytes'. Returns true if the group was created.
+     */
+    bool accumulate(const Document& root);
+
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
-     * initialize() requests the first document from the previous source, and uses it to prepare the
-     * accumulators. In an unsorted $group, initialize() exhausts the previous source before
-     * returning. The '_initialized' boolean indicates that initialize() has finished.
+     * initialize() only prepares to read the input in runs. In an unsorted $group, initialize()
+     * exhausts the previous source before returning. The '_initialized' boolean indicates that
+     * initialize() has finished.
      *
      * This method may not be able to finish initialization in a single call if 'pSource' returns a
      * DocumentSource::GetNextResult::kPauseExecution, so it returns the last GetNextResult
@@ -137,11 +181,63 @@ private:
     GetNextResult initialize();
 
     /**
-     * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
+     * Spill 'groups' to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
-     * store of documents at any one time, only an unsorted group can spill to disk.
+     * store of documents at any one time, only an unsorted group can spill to disk. An abandoned
+     * streaming $group is unsorted from then on, but spills in its streaming order.
+     */
+    std::shared_ptr<Sorter<Value, Value>::Iterator> spill(GroupsMap* groups) const;
+
+    /**
+     * A hash partition of the groups of a parallel $group. Only one thread accumulates into a
+     * partition at a time.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    struct Partition {
+        explicit Partition(GroupsMap groups) : groups(std::move(groups)) {}
+
+        GroupsMap groups;
+        size_t memoryUsageBytes = 0;
+        std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> sortedFiles;
+
+        // The group keys and accumulator arguments of the buffered inputs belonging to this
+        // partition, in input order.
+        std::vector<std::pair<Value, std::vector<Value>>> inputs;
+
+        // The error raised while accumulating the last round, if any.
+        Status status = Status::OK();
+    };
+
+    /**
+     * Returns the number of threads to accumulate the groups with, or 1 if this $group must not
+     * be run in parallel.
+     */
+    size_t getParallelDegree() const;
+
+    /**
+     * Evaluates the group key and accumulator arguments of 'root' and buffers them for the
+     * partition owning its group. Runs a round once enough inputs are buffered.
+     */
+    void bufferForPartition(const Document& root);
+
+    /**
+     * Accumulates the buffered inputs of every partition, each partition on its own thread, and
+     * enforces the memory limit over all partitions.
+     */
+    void runParallelRound();
+
+    /**
+     * Accumulates the buffered inputs of 'partition' into its groups. The groups are spilled
+     * whenever they outgrow the partition's share of the memory limit, if disk use is allowed.
+     * Errors are stored in 'partition' rather than thrown, as this runs on a worker thread.
+     */
+    void accumulatePartition(Partition* partition) const;
+
+    /**
+     * Called once the input of a parallel $group is exhausted. Accumulates the inputs still
+     * buffered, then, if any partition spilled, spills every partition into '_sortedFiles' so that
+     * they are all merged in order.
+     */
+    void finishPartitions();
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
@@ -154,7 +250,7 @@ private:
      * Converts the internal representation of the group key to the _id shape specified by the
      * user.
      */
-    Value expandId(const Value& val);
+    Value expandId(const Value& val) const;
 
     std::vector<AccumulationStatement> _accumulatedFields;
 
@@ -168,6 +264,20 @@ private:
     bool _streaming;
     bool _initialized;
 
+    // Only used when '_streaming' is true. '_runKey' is the sort key of the current run, computed
+    // by evaluating '_runKeyExpressions', one per field of '_inputSort'. '_streamingOutput' holds
+    // the groups of the finished runs which are yet to be returned.
+    std::vector<boost::intrusive_ptr<Expression>> _runKeyExpressions;
+    std::vector<Value> _runKey;
+    std::deque<Document> _streamingOutput;
+    bool _streamingEOF = false;
+
+    // Set once a streaming $group meets an array in its sorted fields. It then accumulates the rest
+    // of its input like an unsorted $group. '_streamingOutputSortFields' then holds the fields of
+    // getStreamingOutputSort() and their directions.
+    bool _streamingAbandoned = false;
+    std::vector<std::pair<FieldPath, int>> _streamingOutputSortFields;
+
     Value _currentId;
     Accumulators _currentAccumulators;
 
@@ -176,6 +286,13 @@ private:
     // definition of equality.
     boost::optional<GroupsMap> _groups;
 
+    // The partitions of a parallel $group, empty otherwise. Unless they spilled, their groups are
+    // output one partition after the other, starting with '_partitions[_nextPartition]' once
+    // '_groups' is exhausted.
+    std::vector<Partition> _partitions;
+    size_t _numBufferedInputs = 0;
+    size_t _nextPartition = 0;
+
     std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
     bool _spilled;
 
@@ -187,8 +304,6 @@ private:
     const bool _allowDiskUse;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
-    // Only used when '_sorted' is true.
-    boost::optional<Document> _firstDocOfNextGroup;
 };
 
 }  // namespace mongo
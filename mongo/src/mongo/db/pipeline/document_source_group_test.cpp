@@ -47,6 +47,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
@@ -139,6 +140,50 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+TEST_F(DocumentSourceGroupTest, AbandonedStreamingGroupShouldSpillInItsStreamingOrder) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$a", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+    // The array stops the streaming, and every group after it spills.
+    string largeStr(maxMemoryUsageBytes, 'x');
+    auto mock = DocumentSourceMock::create({Document{{"a", 5}, {"largeStr", largeStr}},
+                                            Document{{"a", 4}, {"largeStr", largeStr}},
+                                            Document{{"a", Value(BSON_ARRAY(1 << 4))}},
+                                            Document{{"a", 3}, {"largeStr", largeStr}},
+                                            Document{{"a", 3}, {"largeStr", largeStr}},
+                                            Document{{"a", 2}, {"largeStr", largeStr}},
+                                            Document{{"a", 1}, {"largeStr", largeStr}}});
+    mock->sorts = {BSON("a" << -1)};
+    group->setSource(mock.get());
+
+    // The groups come out in the descending order of the input, as streaming promised.
+    std::vector<Value> expectedIds = {
+        Value(5), Value(BSON_ARRAY(1 << 4)), Value(4), Value(3), Value(2), Value(1)};
+    for (auto&& expectedId : expectedIds) {
+        auto result = group->getNext();
+        ASSERT_TRUE(result.isAdvanced());
+        ASSERT_VALUE_EQ(result.getDocument()["_id"], expectedId);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    BSONObjSet outputSort = group->getOutputSorts();
+    ASSERT_EQUALS(outputSort.size(), 1U);
+    ASSERT_EQUALS(outputSort.count(BSON("_id" << -1)), 1U);
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
@@ -189,6 +234,132 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
 }
 
+/**
+ * Makes the $group stages which run while it is in scope accumulate with 'degree' threads, handing
+ * them 'roundSize' inputs at a time.
+ */
+class ParallelGroupGuard {
+public:
+    ParallelGroupGuard(int degree, int roundSize)
+        : _oldDegree(internalDocumentSourceGroupParallelDegree.load()),
+          _oldRoundSize(internalDocumentSourceGroupParallelRoundSize.load()) {
+        internalDocumentSourceGroupParallelDegree.store(degree);
+        internalDocumentSourceGroupParallelRoundSize.store(roundSize);
+    }
+
+    ~ParallelGroupGuard() {
+        internalDocumentSourceGroupParallelDegree.store(_oldDegree);
+        internalDocumentSourceGroupParallelRoundSize.store(_oldRoundSize);
+    }
+
+private:
+    const int _oldDegree;
+    const int _oldRoundSize;
+};
+
+/**
+ * Returns the results of grouping 'inputs' by "$k" with 'group', keyed by their _id.
+ */
+std::map<int, Document> runGroup(const intrusive_ptr<DocumentSourceGroup>& group,
+                                 const deque<DocumentSource::GetNextResult>& inputs) {
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    std::map<int, Document> results;
+    for (auto result = group->getNext(); !result.isEOF(); result = group->getNext()) {
+        if (result.isPaused()) {
+            continue;
+        }
+        auto doc = result.releaseDocument();
+        ASSERT_TRUE(results.emplace(doc["_id"].coerceToInt(), doc).second);
+    }
+    return results;
+}
+
+intrusive_ptr<DocumentSourceGroup> makeOrderSensitiveGroup(
+    const intrusive_ptr<ExpressionContextForTest>& expCtx, size_t maxMemoryUsageBytes) {
+    VariablesParseState vps = expCtx->variablesParseState;
+    auto vExpression = ExpressionFieldPath::parse(expCtx, "$v", vps);
+    return DocumentSourceGroup::create(
+        expCtx,
+        ExpressionFieldPath::parse(expCtx, "$k", vps),
+        {AccumulationStatement{"total", vExpression, AccumulationStatement::getFactory("$sum")},
+         AccumulationStatement{"first", vExpression, AccumulationStatement::getFactory("$first")},
+         AccumulationStatement{"all", vExpression, AccumulationStatement::getFactory("$push")}},
+        maxMemoryUsageBytes);
+}
+
+TEST_F(DocumentSourceGroupTest, ParallelGroupShouldMatchSerialGroup) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 1000; ++i) {
+        inputs.push_back(Document{{"k", i % 37}, {"v", i}});
+        if (i % 300 == 0) {
+            inputs.push_back(DocumentSource::GetNextResult::makePauseExecution());
+        }
+    }
+
+    const auto serialResults = runGroup(
+        makeOrderSensitiveGroup(expCtx, DocumentSourceGroup::kDefaultMaxMemoryUsageBytes), inputs);
+
+    ParallelGroupGuard guard(4, 64);
+    const auto parallelResults = runGroup(
+        makeOrderSensitiveGroup(expCtx, DocumentSourceGroup::kDefaultMaxMemoryUsageBytes), inputs);
+
+    ASSERT_EQ(37UL, parallelResults.size());
+    ASSERT_EQ(serialResults.size(), parallelResults.size());
+    for (auto&& result : serialResults) {
+        ASSERT_DOCUMENT_EQ(result.second, parallelResults.at(result.first));
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, ParallelGroupShouldSpillEachPartitionAndMergeInOrder) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 400; ++i) {
+        inputs.push_back(Document{{"k", i % 50}, {"v", string(100, 'a' + i % 26)}});
+    }
+
+    ParallelGroupGuard guard(4, 32);
+    auto group = makeOrderSensitiveGroup(expCtx, 2000);
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    // Spilled groups are merged back together sorted by _id.
+    int expectedId = 0;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_VALUE_EQ(doc["_id"], Value(expectedId));
+        ASSERT_EQ(8UL, doc["all"].getArrayLength());
+        ASSERT_VALUE_EQ(doc["first"], Value(string(100, 'a' + expectedId % 26)));
+        ++expectedId;
+    }
+    ASSERT_EQ(50, expectedId);
+}
+
+TEST_F(DocumentSourceGroupTest, ParallelGroupShouldErrorIfNotAllowedToSpillToDisk) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow external sort.
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 100; ++i) {
+        inputs.push_back(Document{{"k", i}, {"v", string(100, 'x')}});
+    }
+
+    ParallelGroupGuard guard(4, 32);
+    auto group = makeOrderSensitiveGroup(expCtx, 1000);
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -1005,6 +1176,106 @@ public:
     }
 };
 
+class StreamingWithNullishIds : public Base {
+public:
+    void run() {
+        // Null and missing values sort equal, so their groups may be interleaved in the input.
+        auto source = DocumentSourceMock::create(
+            {"{a: 1, b: null}", "{a: 1}", "{a: 1, b: null}", "{a: 1, b: 2}"});
+        source->sorts = {BSON("a" << 1 << "b" << 1)};
+
+        createGroup(fromjson("{_id: {x: '$a', y: '$b'}, count: {$sum: 1}}"));
+        group()->setSource(source.get());
+
+        auto first = group()->getNext();
+        ASSERT_TRUE(first.isAdvanced());
+        ASSERT_TRUE(group()->isStreaming());
+        auto second = group()->getNext();
+        ASSERT_TRUE(second.isAdvanced());
+
+        // The groups of a run are output in no particular order.
+        Document nullGroup = first.releaseDocument();
+        Document missingGroup = second.releaseDocument();
+        if (missingGroup["_id"]["y"].getType() == jstNULL) {
+            std::swap(nullGroup, missingGroup);
+        }
+        ASSERT_BSONOBJ_EQ(nullGroup.toBson(), fromjson("{_id: {x: 1, y: null}, count: 2}"));
+        ASSERT_BSONOBJ_EQ(missingGroup.toBson(), fromjson("{_id: {x: 1}, count: 1}"));
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_BSONOBJ_EQ(res.getDocument().toBson(), fromjson("{_id: {x: 1, y: 2}, count: 1}"));
+
+        assertEOF(group());
+    }
+};
+
+class StreamingWithArrayIds : public Base {
+public:
+    void run() {
+        // A descending sort orders an array by its greatest element, so [1, 3] may be anywhere
+        // among the 3s.
+        auto source =
+            DocumentSourceMock::create({"{a: 4}", "{a: 3}", "{a: [1, 3]}", "{a: 3}", "{a: 2}"});
+        source->sorts = {BSON("a" << -1)};
+
+        createGroup(fromjson("{_id: '$a', count: {$sum: 1}}"));
+        group()->setSource(source.get());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_BSONOBJ_EQ(res.getDocument().toBson(), fromjson("{_id: 4, count: 1}"));
+
+        // The groups from the array on are only output once the input is exhausted, still in the
+        // order of the input sort.
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_BSONOBJ_EQ(res.getDocument().toBson(), fromjson("{_id: [1, 3], count: 1}"));
+        ASSERT_TRUE(source->getNext().isEOF());
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_BSONOBJ_EQ(res.getDocument().toBson(), fromjson("{_id: 3, count: 2}"));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_BSONOBJ_EQ(res.getDocument().toBson(), fromjson("{_id: 2, count: 1}"));
+
+        assertEOF(group());
+
+        BSONObjSet outputSort = group()->getOutputSorts();
+        ASSERT_EQUALS(outputSort.size(), 1U);
+        ASSERT_EQUALS(outputSort.count(BSON("_id" << -1)), 1U);
+    }
+};
+
+class StreamingShouldBeAbleToPause : public Base {
+public:
+    void run() {
+        auto source =
+            DocumentSourceMock::create({Document{{"a", 1}},
+                                        DocumentSource::GetNextResult::makePauseExecution(),
+                                        Document{{"a", 1}},
+                                        Document{{"a", 2}}});
+        source->sorts = {BSON("a" << 1)};
+
+        createGroup(fromjson("{_id: '$a', count: {$sum: 1}}"));
+        group()->setSource(source.get());
+
+        ASSERT_TRUE(group()->getNext().isPaused());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_BSONOBJ_EQ(res.getDocument().toBson(), fromjson("{_id: 1, count: 2}"));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_BSONOBJ_EQ(res.getDocument().toBson(), fromjson("{_id: 2, count: 1}"));
+
+        assertEOF(group());
+    }
+};
+
 class NoOptimizationIfMissingDoubleSort : public Base {
 public:
     void run() {
@@ -1157,8 +1428,6 @@ public:
         add<Dependencies>();
         add<StringConstantIdAndAccumulatorExpressions>();
         add<ArrayConstantAccumulatorExpression>();
-#if 0
-        // Disabled tests until SERVER-23318 is implemented.
         add<StreamingOptimization>();
         add<StreamingWithMultipleIdFields>();
         add<NoOptimizationIfMissingDoubleSort>();
@@ -1170,7 +1439,9 @@ public:
         add<StreamingWithRootSubfield>();
         add<StreamingWithConstantAndFieldPath>();
         add<StreamingWithFieldRepeated>();
-#endif
+        add<StreamingWithNullishIds>();
+        add<StreamingWithArrayIds>();
+        add<StreamingShouldBeAbleToPause>();
     }
 };
 
@@ -30,6 +30,8 @@
 
 #include "mongo/db/pipeline/document_source_index_stats.h"
 
+#include <algorithm>
+
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/server_options.h"
 #include "mongo/util/net/sock.h"
@@ -72,6 +74,36 @@ DocumentSource::GetNextResult DocumentSourceIndexStats::getNext() {
         doc["host"] = Value(_processName);
         doc["accesses"]["ops"] = Value(stats.accesses.loadRelaxed());
         doc["accesses"]["since"] = Value(stats.trackerStartTime);
+        doc["accesses"]["keysExamined"] = Value(stats.keysExamined.loadRelaxed());
+        doc["accesses"]["docsExamined"] = Value(stats.docsExamined.loadRelaxed());
+        doc["accesses"]["seeks"] = Value(stats.seeks.loadRelaxed());
+
+        std::vector<Value> latency;
+        for (size_t i = 0; i < CollectionIndexUsageTracker::kLatencyBuckets; ++i) {
+            latency.push_back(Value(DOC(
+                "micros" << CollectionIndexUsageTracker::kLatencyBucketLowerBoundsMicros[i]
+                         << "count"
+                         << stats.latencyHistogram[i].loadRelaxed())));
+        }
+        doc["accesses"]["latency"] = Value(std::move(latency));
+
+        // The hottest key ranges first, with their sampled access counts scaled back up.
+        auto keyRanges = stats.keyRanges;
+        std::sort(keyRanges.begin(),
+                  keyRanges.end(),
+                  [](const CollectionIndexUsageTracker::KeyRangeStats& lhs,
+                     const CollectionIndexUsageTracker::KeyRangeStats& rhs) {
+                      return lhs.sampledAccesses > rhs.sampledAccesses;
+                  });
+        std::vector<Value> hotRanges;
+        const long long samplePeriod = CollectionIndexUsageTracker::kKeyRangeSamplePeriod;
+        for (auto&& range : keyRanges) {
+            hotRanges.push_back(Value(DOC("bounds" << range.bounds << "estimatedAccesses"
+                                                   << range.sampledAccesses * samplePeriod
+                                                   << "maxOverestimate"
+                                                   << range.maxOvercount * samplePeriod)));
+        }
+        doc["keyRanges"] = Value(std::move(hotRanges));
         ++_indexStatsIter;
         return doc.freeze();
     }
@@ -30,9 +30,12 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
+
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
@@ -63,6 +66,10 @@ std::string pipelineToString(const vector<BSONObj>& pipeline) {
     sb << "]";
     return sb.str();
 }
+
+// Roughly how many foreign documents a hash join can read in the time it takes to build and run
+// the pipeline which joins a single input document through an index on the foreign field.
+const long long kIndexedJoinCostInScannedDocs = 50;
 }  // namespace
 
 constexpr size_t DocumentSourceLookUp::kMaxSubPipelineDepth;
@@ -221,27 +228,36 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
-    if (!wasConstructedWithPipelineSyntax()) {
-        auto matchStage =
-            makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
-        // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-        _resolvedPipeline.back() = matchStage;
-    }
-
-    auto pipeline = buildPipeline(inputDoc);
-
     std::vector<Value> results;
     int objsize = 0;
 
-    while (auto result = pipeline->getNext()) {
-        objsize += result->getApproximateSize();
+    auto addResult = [&](Document result) {
+        objsize += result.getApproximateSize();
         uassert(4568,
                 str::stream() << "Total size of documents in " << _fromNs.coll()
                               << " matching pipeline "
                               << getUserPipelineDefinition()
                               << " exceeds maximum document size",
                 objsize <= BSONObjMaxInternalSize);
-        results.emplace_back(std::move(*result));
+        results.emplace_back(std::move(result));
+    };
+
+    if (!wasConstructedWithPipelineSyntax() && useHashJoin()) {
+        for (auto&& result : probeHashTable(inputDoc)) {
+            addResult(std::move(result));
+        }
+    } else {
+        if (!wasConstructedWithPipelineSyntax()) {
+            auto matchStage = makeMatchStageFromInput(
+                inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
+            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
+            _resolvedPipeline.back() = matchStage;
+        }
+
+        auto pipeline = buildPipeline(inputDoc);
+        while (auto result = pipeline->getNext()) {
+            addResult(std::move(*result));
+        }
     }
 
     MutableDocument output(std::move(inputDoc));
@@ -298,6 +314,134 @@ std::unique_ptr<Pipeline, Pipeline::Deleter> DocumentSourceLookUp::buildPipeline
     return pipeline;
 }
 
+bool DocumentSourceLookUp::useHashJoin() {
+    invariant(!wasConstructedWithPipelineSyntax());
+
+    if (_hashTable) {
+        return _hashTable->isServing();
+    }
+
+    const int minInputDocs = internalDocumentSourceLookupHashJoinMinInputDocs.load();
+    if (minInputDocs < 0 || _numQueriedInputs++ < minInputDocs) {
+        return false;
+    }
+
+    _hashTable.emplace(*_foreignField,
+                       _fromExpCtx->getValueComparator(),
+                       internalDocumentSourceLookupHashJoinMaxSizeBytes.load());
+    if (!LookUpHashTable::canJoinOn(*_foreignField) || !foreignCollectionSuitsHashJoin()) {
+        _hashTable->abandon();
+        return false;
+    }
+
+    // Read the foreign collection through the view pipeline, if any, followed by the predicates we
+    // have absorbed, in place of the trailing $match on the join field.
+    std::vector<BSONObj> scanPipeline(_resolvedPipeline.begin(), _resolvedPipeline.end() - 1);
+    if (_additionalFilter) {
+        scanPipeline.push_back(BSON("$match" << *_additionalFilter));
+    }
+
+    // Equality to null also matches documents which are missing the join field, which the table
+    // doesn't index. Evaluate it once per foreign document here rather than once per probe.
+    auto nullQuery = uassertStatusOK(
+        MatchExpressionParser::parse(BSON(_foreignField->fullPath() << BSONNULL), _fromExpCtx));
+
+    auto pipeline =
+        uassertStatusOK(_mongoProcessInterface->makePipeline(scanPipeline, _fromExpCtx));
+    while (_hashTable->isBuilding()) {
+        auto result = pipeline->getNext();
+        if (!result) {
+            _hashTable->freeze();
+            break;
+        }
+        const bool matchesNull = nullQuery->matchesBSON(result->toBson());
+        _hashTable->add(std::move(*result), matchesNull);
+    }
+
+    return _hashTable->isServing();
+}
+
+bool DocumentSourceLookUp::foreignCollectionSuitsHashJoin() {
+    // The table only counts the documents that pass '_additionalFilter', but building it reads the
+    // whole collection, so don't start if the collection alone is larger than the table may grow.
+    boost::optional<long long> foreignCount;
+    BSONObjBuilder foreignStats;
+    if (_mongoProcessInterface->appendStorageStats(_resolvedNs, BSONObj(), &foreignStats).isOK()) {
+        const BSONObj stats = foreignStats.asTempObj();
+        const long long dataSize = stats["size"].safeNumberLong();
+        if (dataSize > internalDocumentSourceLookupHashJoinMaxSizeBytes.load()) {
+            return false;
+        }
+        foreignCount = stats["count"].safeNumberLong();
+    }
+
+    // Without an index on the foreign field, each per-document query scans the whole collection.
+    // A view may rename or compute the foreign field, so its indexes are only considered when
+    // there is no view pipeline.
+    bool foreignFieldIsIndexed = false;
+    if (_resolvedPipeline.size() == 1) {
+        const auto indexes = _mongoProcessInterface->getIndexStats(pExpCtx->opCtx, _resolvedNs);
+        for (auto&& index : indexes) {
+            auto firstKey = index.second.indexKey.firstElement();
+            if (firstKey.fieldNameStringData() == _foreignField->fullPath() &&
+                (firstKey.isNumber() || firstKey.valueStringData() == "hashed"_sd)) {
+                foreignFieldIsIndexed = true;
+                break;
+            }
+        }
+    }
+    if (!foreignFieldIsIndexed) {
+        return true;
+    }
+
+    // With an index, reading the whole foreign collection once only pays off for enough input
+    // documents. Earlier stages may filter the local collection, so its size only bounds how many
+    // there will be, and the inputs joined so far are a lower bound.
+    if (!foreignCount) {
+        return false;
+    }
+    long long expectedInputs = _numQueriedInputs;
+    BSONObjBuilder localStats;
+    if (_mongoProcessInterface->appendStorageStats(pExpCtx->ns, BSONObj(), &localStats).isOK()) {
+        expectedInputs =
+            std::max(expectedInputs, localStats.asTempObj()["count"].safeNumberLong());
+    }
+    return expectedInputs * kIndexedJoinCostInScannedDocs >= *foreignCount;
+}
+
+std::vector<Document> DocumentSourceLookUp::probeHashTable(const Document& inputDoc) {
+    std::vector<Value> values;
+    bool hasNullish = false;
+    document_path_support::visitAllValuesAtPath(inputDoc, *_localField, [&](const Value& value) {
+        if (value.getType() == BSONType::Undefined) {
+            // Fail the same way as the query we would have run instead.
+            auto matchStage = makeMatchStageFromInput(
+                inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
+            uassertStatusOK(MatchExpressionParser::parse(
+                matchStage.firstElement().embeddedObject(), _fromExpCtx));
+        }
+        if (value.nullish()) {
+            hasNullish = true;
+        } else {
+            values.push_back(value);
+        }
+    });
+
+    // Missing values are treated as null, as in makeMatchStageFromInput().
+    return _hashTable->lookUp(values, hasNullish || values.empty());
+}
+
+boost::optional<Document> DocumentSourceLookUp::getNextForeignResult() {
+    if (_pipeline) {
+        return _pipeline->getNext();
+    }
+
+    if (_hashJoinResultIndex < _hashJoinResults.size()) {
+        return _hashJoinResults[_hashJoinResultIndex++];
+    }
+    return boost::none;
+}
+
 DocumentSource::GetModPathsReturn DocumentSourceLookUp::getModifiedPaths() const {
     std::set<std::string> modifiedPaths{_as.fullPath()};
     if (_unwindSrc) {
@@ -528,7 +672,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
+    while (!_input || !_nextValue) {
         auto nextInput = pSource->getNext();
         if (!nextInput.isAdvanced()) {
             return nextInput;
@@ -536,27 +680,34 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
         _input = nextInput.releaseDocument();
 
-        if (!wasConstructedWithPipelineSyntax()) {
-            BSONObj filter = _additionalFilter.value_or(BSONObj());
-            auto matchStage =
-                makeMatchStageFromInput(*_input, *_localField, _foreignField->fullPath(), filter);
-            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-            _resolvedPipeline.back() = matchStage;
-        }
-
         if (_pipeline) {
             _pipeline->dispose(pExpCtx->opCtx);
+            _pipeline.reset();
         }
 
-        _pipeline = buildPipeline(*_input);
+        if (!wasConstructedWithPipelineSyntax() && useHashJoin()) {
+            _hashJoinResults = probeHashTable(*_input);
+            _hashJoinResultIndex = 0;
+        } else {
+            if (!wasConstructedWithPipelineSyntax()) {
+                BSONObj filter = _additionalFilter.value_or(BSONObj());
+                auto matchStage = makeMatchStageFromInput(
+                    *_input, *_localField, _foreignField->fullPath(), filter);
+                // We've already allocated space for the trailing $match stage in
+                // '_resolvedPipeline'.
+                _resolvedPipeline.back() = matchStage;
+            }
+
+            _pipeline = buildPipeline(*_input);
 
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+            // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+            // potentially be used by multiple OperationContexts, and the $lookup stage is part of
+            // an outer Pipeline that will propagate dispose() calls before being destroyed.
+            _pipeline.get_deleter().dismissDisposal();
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = getNextForeignResult();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -574,7 +725,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = getNextForeignResult();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -36,6 +36,7 @@
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
+#include "mongo/db/pipeline/lookup_hash_table.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
 
@@ -269,6 +270,34 @@ private:
      */
     std::unique_ptr<Pipeline, Pipeline::Deleter> buildPipeline(const Document& inputDoc);
 
+    /**
+     * Returns true if input documents are joined through '_hashTable' rather than by querying the
+     * foreign collection. Once internalDocumentSourceLookupHashJoinMinInputDocs input documents
+     * have been joined by queries, reads the foreign collection into '_hashTable', which stays
+     * abandoned if the collection doesn't fit, the join field isn't supported, or
+     * foreignCollectionSuitsHashJoin() returns false.
+     */
+    bool useHashJoin();
+
+    /**
+     * Returns false if the foreign collection is too large for '_hashTable', or if the foreign
+     * field is indexed and the expected number of input documents is too small to pay for reading
+     * the whole foreign collection, in which case the per-document queries are the better plan.
+     */
+    bool foreignCollectionSuitsHashJoin();
+
+    /**
+     * Returns the foreign documents which join with 'inputDoc', in the order of the foreign
+     * collection scan that built '_hashTable'.
+     */
+    std::vector<Document> probeHashTable(const Document& inputDoc);
+
+    /**
+     * Returns the next foreign document joining with '_input' when unwinding, from either
+     * '_pipeline' or '_hashJoinResults'.
+     */
+    boost::optional<Document> getNextForeignResult();
+
     /**
      * The pipeline supplied via the $lookup 'pipeline' argument. This may differ from pipeline that
      * is executed in that it will not include optimizations or resolved views.
@@ -307,6 +336,12 @@ private:
     // from a cursor source.
     boost::optional<SequentialDocumentCache> _cache;
 
+    // For use when $lookup is specified with localField/foreignField syntax. Holds the foreign
+    // documents of a hash join, see useHashJoin(). '_numQueriedInputs' counts the input documents
+    // joined by querying the foreign collection before the table was built.
+    boost::optional<LookUpHashTable> _hashTable;
+    long long _numQueriedInputs = 0;
+
     // The ExpressionContext used when performing aggregation pipelines against the '_resolvedNs'
     // namespace.
     boost::intrusive_ptr<ExpressionContext> _fromExpCtx;
@@ -330,6 +365,8 @@ private:
     // not null.
     long long _cursorIndex = 0;
     std::unique_ptr<Pipeline, Pipeline::Deleter> _pipeline;
+    std::vector<Document> _hashJoinResults;
+    size_t _hashJoinResultIndex = 0;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
 };
@@ -47,6 +47,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -519,10 +520,28 @@ public:
         return false;
     }
 
+    CollectionIndexUsageMap getIndexStats(OperationContext* opCtx,
+                                          const NamespaceString& ns) final {
+        return _indexStats;
+    }
+
+    Status appendStorageStats(const NamespaceString& nss,
+                              const BSONObj& param,
+                              BSONObjBuilder* builder) const final {
+        auto stats = _storageStats.find(nss.ns());
+        if (stats == _storageStats.end()) {
+            return {ErrorCodes::NamespaceNotFound, "no storage stats for " + nss.ns()};
+        }
+        builder->appendNumber("size", stats->second.first);
+        builder->appendNumber("count", stats->second.second);
+        return Status::OK();
+    }
+
     StatusWith<std::unique_ptr<Pipeline, Pipeline::Deleter>> makePipeline(
         const std::vector<BSONObj>& rawPipeline,
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         const MakePipelineOptions opts) final {
+        ++_numPipelinesMade;
         auto pipeline = Pipeline::parse(rawPipeline, expCtx);
         if (!pipeline.isOK()) {
             return pipeline.getStatus();
@@ -554,9 +573,31 @@ public:
         return Status::OK();
     }
 
+    /**
+     * Reports an index with the given key pattern on the foreign collection.
+     */
+    void addIndex(const BSONObj& keyPattern) {
+        _indexStats[keyPattern.toString()] =
+            CollectionIndexUsageTracker::IndexUsageStats(Date_t::now(), keyPattern);
+    }
+
+    /**
+     * Reports a data size of 'dataSizeBytes' and 'count' documents for the collection 'nss'.
+     */
+    void setStorageStats(const NamespaceString& nss, long long dataSizeBytes, long long count) {
+        _storageStats[nss.ns()] = {dataSizeBytes, count};
+    }
+
+    int numPipelinesMade() const {
+        return _numPipelinesMade;
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    CollectionIndexUsageMap _indexStats;
+    std::map<std::string, std::pair<long long, long long>> _storageStats;
+    int _numPipelinesMade = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -663,6 +704,171 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+/**
+ * Runs a $lookup of the local field 'l' against the foreign field 'f' over a fixed set of inputs,
+ * with the hash join enabled after 'minInputDocs' inputs and capped at 'maxSizeBytes'. The foreign
+ * collection reports an index on 'foreignIndex', if not empty, a data size of 'foreignSizeBytes'
+ * and 'foreignCount' documents, and the local collection 'localCount' documents. If
+ * 'numForeignPipelines' is given, it receives the number of pipelines run against the foreign
+ * collection.
+ */
+std::vector<Document> runEqualityLookup(
+    const boost::intrusive_ptr<ExpressionContextForTest>& expCtx,
+    int minInputDocs,
+    int maxSizeBytes,
+    const BSONObj& foreignIndex = BSONObj(),
+    long long foreignSizeBytes = 0,
+    int* numForeignPipelines = nullptr,
+    long long foreignCount = 4,
+    long long localCount = 7) {
+    const int originalMinInputDocs = internalDocumentSourceLookupHashJoinMinInputDocs.load();
+    const int originalMaxSizeBytes = internalDocumentSourceLookupHashJoinMaxSizeBytes.load();
+    internalDocumentSourceLookupHashJoinMinInputDocs.store(minInputDocs);
+    internalDocumentSourceLookupHashJoinMaxSizeBytes.store(maxSizeBytes);
+    ON_BLOCK_EXIT([&] {
+        internalDocumentSourceLookupHashJoinMinInputDocs.store(originalMinInputDocs);
+        internalDocumentSourceLookupHashJoinMaxSizeBytes.store(originalMaxSizeBytes);
+    });
+
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "l"_sd},
+                                         {"foreignField", "f"_sd},
+                                         {"as", "joined"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource =
+        DocumentSourceMock::create({Document{{"_id", 0}, {"l", 1}},
+                                    Document{{"_id", 1}, {"l", 1}},
+                                    Document{{"_id", 2}, {"l", DOC_ARRAY(3 << 1)}},
+                                    Document{{"_id", 3}},
+                                    Document{{"_id", 4}, {"l", 2}},
+                                    Document{{"_id", 5}, {"l", 4}},
+                                    Document{{"_id", 6}, {"l", DOC_ARRAY(BSONNULL << 2)}}});
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"f", 1}},
+        Document{{"_id", 1}, {"f", DOC_ARRAY(2 << 3)}},
+        Document{{"_id", 2}},
+        Document{{"_id", 3}, {"f", 1.0}}};
+    auto mongoProcessInterface =
+        std::make_shared<MockMongoProcessInterface>(std::move(mockForeignContents));
+    if (!foreignIndex.isEmpty()) {
+        mongoProcessInterface->addIndex(foreignIndex);
+    }
+    mongoProcessInterface->setStorageStats(fromNs, foreignSizeBytes, foreignCount);
+    mongoProcessInterface->setStorageStats(expCtx->ns, 0, localCount);
+    lookup->injectMongoProcessInterface(mongoProcessInterface);
+
+    std::vector<Document> results;
+    for (auto next = lookup->getNext(); next.isAdvanced(); next = lookup->getNext()) {
+        results.push_back(next.releaseDocument());
+    }
+    lookup->dispose();
+    if (numForeignPipelines) {
+        *numForeignPipelines = mongoProcessInterface->numPipelinesMade();
+    }
+    return results;
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinProducesSameResultsAsPerDocumentQueries) {
+    const auto expected = runEqualityLookup(getExpCtx(), -1, 100 * 1024 * 1024);
+    ASSERT_EQ(expected.size(), 7U);
+
+    // Outputs of $lookup on an array local field preserve the foreign collection's order.
+    ASSERT_VALUE_EQ(expected[2]["joined"],
+                    Value(DOC_ARRAY(DOC("_id" << 0 << "f" << 1)
+                                    << DOC("_id" << 1 << "f" << DOC_ARRAY(2 << 3))
+                                    << DOC("_id" << 3 << "f" << 1.0))));
+    // A missing local field joins with documents which are missing the foreign field.
+    ASSERT_VALUE_EQ(expected[3]["joined"], Value(DOC_ARRAY(DOC("_id" << 2))));
+    ASSERT_VALUE_EQ(expected[5]["joined"], Value(std::vector<Value>{}));
+    ASSERT_VALUE_EQ(expected[6]["joined"],
+                    Value(DOC_ARRAY(DOC("_id" << 1 << "f" << DOC_ARRAY(2 << 3))
+                                    << DOC("_id" << 2))));
+
+    for (int minInputDocs : {0, 1, 3}) {
+        const auto results = runEqualityLookup(getExpCtx(), minInputDocs, 100 * 1024 * 1024);
+        ASSERT_EQ(results.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_DOCUMENT_EQ(results[i], expected[i]);
+        }
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinFallsBackToPerDocumentQueriesWhenTableIsTooLarge) {
+    const auto expected = runEqualityLookup(getExpCtx(), -1, 100 * 1024 * 1024);
+    const auto results = runEqualityLookup(getExpCtx(), 0, 1);
+    ASSERT_EQ(results.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(results[i], expected[i]);
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinReadsForeignCollectionOnce) {
+    int numForeignPipelines = 0;
+    runEqualityLookup(getExpCtx(), 0, 100 * 1024 * 1024, BSONObj(), 0, &numForeignPipelines);
+    ASSERT_EQ(numForeignPipelines, 1);
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinIsNotUsedWhenIndexedForeignCollectionOutweighsInput) {
+    const auto expected = runEqualityLookup(getExpCtx(), -1, 100 * 1024 * 1024);
+    for (auto&& index : {BSON("f" << 1), BSON("f" << -1 << "g" << 1), BSON("f"
+                                                                           << "hashed")}) {
+        int numForeignPipelines = 0;
+        const auto results = runEqualityLookup(
+            getExpCtx(), 0, 100 * 1024 * 1024, index, 0, &numForeignPipelines, 1000 * 1000);
+        ASSERT_EQ(numForeignPipelines, static_cast<int>(expected.size()));
+        ASSERT_EQ(results.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_DOCUMENT_EQ(results[i], expected[i]);
+        }
+    }
+
+    // An index which can't serve equality on the foreign field doesn't count.
+    int numForeignPipelines = 0;
+    runEqualityLookup(getExpCtx(),
+                      0,
+                      100 * 1024 * 1024,
+                      BSON("g" << 1 << "f" << 1),
+                      0,
+                      &numForeignPipelines,
+                      1000 * 1000);
+    ASSERT_EQ(numForeignPipelines, 1);
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinIsUsedWhenForeignFieldIsIndexedButInputOutweighsIt) {
+    const auto expected = runEqualityLookup(getExpCtx(), -1, 100 * 1024 * 1024);
+    int numForeignPipelines = 0;
+    const auto results = runEqualityLookup(getExpCtx(),
+                                           0,
+                                           100 * 1024 * 1024,
+                                           BSON("f" << 1),
+                                           0,
+                                           &numForeignPipelines,
+                                           200 * 1000,
+                                           5 * 1000 * 1000);
+    ASSERT_EQ(numForeignPipelines, 1);
+    ASSERT_EQ(results.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(results[i], expected[i]);
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinIsNotUsedWhenForeignCollectionIsTooLarge) {
+    const int maxSizeBytes = 100 * 1024 * 1024;
+    int numForeignPipelines = 0;
+    const auto results = runEqualityLookup(
+        getExpCtx(), 0, maxSizeBytes, BSONObj(), maxSizeBytes + 1LL, &numForeignPipelines);
+    ASSERT_EQ(numForeignPipelines, static_cast<int>(results.size()));
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/stringutils.h"
 
@@ -73,6 +74,7 @@ intrusive_ptr<DocumentSource> DocumentSourceMatch::optimize() {
         return nullptr;
     }
 
+    resetCompiledExpression();
     _expression = MatchExpression::optimize(std::move(_expression));
 
     return this;
@@ -84,6 +86,13 @@ DocumentSource::GetNextResult DocumentSourceMatch::getNext() {
     // The user facing error should have been generated earlier.
     massert(17309, "Should never call getNext on a $match stage with $text clause", !_isTextQuery);
 
+    if (!_isExpressionCompiled) {
+        if (internalQueryExecEnableCompiledFilter.load()) {
+            _compiledExpression = CompiledMatchExpression::compile(_expression.get());
+        }
+        _isExpressionCompiled = true;
+    }
+
     auto nextInput = pSource->getNext();
     for (; nextInput.isAdvanced(); nextInput = pSource->getNext()) {
         // MatchExpression only takes BSON documents, so we have to make one. As an optimization,
@@ -93,7 +102,9 @@ DocumentSource::GetNextResult DocumentSourceMatch::getNext() {
             : document_path_support::documentToBsonWithPaths(nextInput.getDocument(),
                                                              _dependencies.fields);
 
-        if (_expression->matchesBSON(toMatch)) {
+        const bool matches = _compiledExpression ? _compiledExpression->matchesBSON(toMatch)
+                                                 : _expression->matchesBSON(toMatch);
+        if (matches) {
             return nextInput;
         }
 
@@ -375,6 +386,7 @@ void DocumentSourceMatch::joinMatchWith(intrusive_ptr<DocumentSourceMatch> other
 
     StatusWithMatchExpression status = uassertStatusOK(MatchExpressionParser::parse(
         _predicate, pExpCtx, ExtensionsCallbackNoop(), Pipeline::kAllowedMatcherFeatures));
+    resetCompiledExpression();
     _expression = std::move(status.getValue());
     _dependencies = DepsTracker(_dependencies.getMetadataAvailable());
     getDependencies(&_dependencies);
@@ -383,6 +395,7 @@ void DocumentSourceMatch::joinMatchWith(intrusive_ptr<DocumentSourceMatch> other
 pair<intrusive_ptr<DocumentSourceMatch>, intrusive_ptr<DocumentSourceMatch>>
 DocumentSourceMatch::splitSourceBy(const std::set<std::string>& fields,
                                    const StringMap<std::string>& renames) {
+    resetCompiledExpression();
     pair<unique_ptr<MatchExpression>, unique_ptr<MatchExpression>> newExpr(
         expression::splitMatchExpressionBy(std::move(_expression), fields, renames));
 
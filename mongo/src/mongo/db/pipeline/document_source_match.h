@@ -32,6 +32,7 @@
 #include <utility>
 
 #include "mongo/client/connpool.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/matcher.h"
 #include "mongo/db/pipeline/document_source.h"
 
@@ -159,8 +160,22 @@ protected:
                         const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
 private:
+    /**
+     * Discards the compiled form of '_expression', which must be called whenever '_expression'
+     * changes.
+     */
+    void resetCompiledExpression() {
+        _compiledExpression.reset();
+        _isExpressionCompiled = false;
+    }
+
     std::unique_ptr<MatchExpression> _expression;
 
+    // The compiled form of '_expression', compiled by the first call to getNext() once the pipeline
+    // has been optimized. Null if '_expression' couldn't be compiled.
+    std::unique_ptr<CompiledMatchExpression> _compiledExpression;
+    bool _isExpressionCompiled = false;
+
     BSONObj _predicate;
     const bool _isTextQuery;
 
@@ -41,6 +41,7 @@
 #include "mongo/db/pipeline/document_source_project.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -160,6 +161,135 @@ TEST_F(ProjectStageTest, ShouldPropagatePauses) {
     ASSERT(project->getNext().isEOF());
 }
 
+/**
+ * Makes the $project and $addFields stages which run while it is in scope evaluate their computed
+ * fields over batches of 'batchSize' documents, or fewer once they reach 'batchSizeBytes'.
+ */
+class ProjectionBatchSizeGuard {
+public:
+    explicit ProjectionBatchSizeGuard(int batchSize, int batchSizeBytes = 4 * 1024 * 1024)
+        : _oldBatchSize(internalDocumentSourceProjectionBatchSize.load()),
+          _oldBatchSizeBytes(internalDocumentSourceProjectionBatchSizeBytes.load()) {
+        internalDocumentSourceProjectionBatchSize.store(batchSize);
+        internalDocumentSourceProjectionBatchSizeBytes.store(batchSizeBytes);
+    }
+
+    ~ProjectionBatchSizeGuard() {
+        internalDocumentSourceProjectionBatchSize.store(_oldBatchSize);
+        internalDocumentSourceProjectionBatchSizeBytes.store(_oldBatchSizeBytes);
+    }
+
+private:
+    const int _oldBatchSize;
+    const int _oldBatchSizeBytes;
+};
+
+TEST_F(ProjectStageTest, ComputedFieldsShouldBeEvaluatedInBatchesWhichEndAtPauses) {
+    ProjectionBatchSizeGuard batchSizeGuard(2);
+    auto project =
+        DocumentSourceProject::create(fromjson("{_id: 0, b: {$add: ['$a', 1]}}"), getExpCtx());
+    auto source = DocumentSourceMock::create({Document{{"a", 1}},
+                                              Document{{"a", 2}},
+                                              Document{{"a", 3}},
+                                              DocumentSource::GetNextResult::makePauseExecution(),
+                                              Document{{"a", 4}}});
+    project->setSource(source.get());
+
+    for (int a = 1; a <= 3; ++a) {
+        auto next = project->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", a + 1}}));
+    }
+    ASSERT_TRUE(project->getNext().isPaused());
+
+    auto next = project->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", 5}}));
+
+    ASSERT(project->getNext().isEOF());
+    ASSERT(project->getNext().isEOF());
+}
+
+TEST_F(ProjectStageTest, BatchesShouldStartWithOneDocumentAndDoubleUpToTheBatchSize) {
+    ProjectionBatchSizeGuard batchSizeGuard(4);
+    auto project =
+        DocumentSourceProject::create(fromjson("{_id: 0, b: {$add: ['$a', 1]}}"), getExpCtx());
+    auto source = DocumentSourceMock::create(
+        {"{a: 0}", "{a: 1}", "{a: 2}", "{a: 3}", "{a: 4}", "{a: 5}", "{a: 6}", "{a: 7}", "{a: 8}"});
+    project->setSource(source.get());
+
+    // A later stage which only asks for one document only makes the source produce one.
+    const std::vector<size_t> queueSizeAfterNext = {8, 6, 6, 2, 2, 2, 2, 0, 0};
+    for (int a = 0; a < 9; ++a) {
+        auto next = project->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", a + 1}}));
+        ASSERT_EQUALS(queueSizeAfterNext[a], source->queue.size());
+    }
+    ASSERT(project->getNext().isEOF());
+}
+
+TEST_F(ProjectStageTest, BatchesShouldEndOnceTheirDocumentsReachTheByteLimit) {
+    const Document large{{"a", 1}, {"s", std::string(1024, 'x')}};
+    ProjectionBatchSizeGuard batchSizeGuard(4, large.getApproximateSize() + 1);
+
+    auto project =
+        DocumentSourceProject::create(fromjson("{_id: 0, b: {$add: ['$a', 1]}}"), getExpCtx());
+    auto source = DocumentSourceMock::create({Document{{"a", 0}},
+                                              Document{{"a", 0}},
+                                              Document{{"a", 0}},
+                                              Document(large),
+                                              Document(large),
+                                              Document{{"a", 2}}});
+    project->setSource(source.get());
+
+    // The first two batches hold one and two documents.
+    for (int i = 0; i < 3; ++i) {
+        auto next = project->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", 1}}));
+    }
+
+    // The third batch stops after its second document, which takes it over the limit.
+    auto next = project->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", 2}}));
+    ASSERT_EQUALS(1U, source->queue.size());
+
+    next = project->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", 2}}));
+    next = project->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"b", 3}}));
+    ASSERT(project->getNext().isEOF());
+}
+
+TEST_F(ProjectStageTest, ShouldOnlyFailAtTheDocumentWhichCannotBeProjected) {
+    ProjectionBatchSizeGuard batchSizeGuard(4);
+    auto project = DocumentSourceProject::create(fromjson("{_id: 0, q: {$divide: ['$a', '$b']}}"),
+                                                 getExpCtx());
+    auto source = DocumentSourceMock::create(
+        {"{a: 6, b: 3}", "{a: 6, b: 2}", "{a: 6, b: 0}", "{a: 1, b: 4}"});
+    project->setSource(source.get());
+
+    auto next = project->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"q", 2.0}}));
+
+    // The second batch can't be evaluated as a whole, but the documents before the failing one are
+    // still returned, in case a later stage stops before asking for it.
+    next = project->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"q", 3.0}}));
+    ASSERT_THROWS_CODE(project->getNext(), AssertionException, 16608);
+
+    next = project->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"q", 0.25}}));
+    ASSERT(project->getNext().isEOF());
+}
+
 TEST_F(ProjectStageTest, InclusionShouldAddDependenciesOfIncludedAndComputedFields) {
     auto project = DocumentSourceProject::create(
         fromjson("{a: true, x: '$b', y: {$and: ['$c','$d']}, z: {$meta: 'textScore'}}"),
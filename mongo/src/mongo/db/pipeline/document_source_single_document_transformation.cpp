@@ -30,6 +30,7 @@
 
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 
+#include <algorithm>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
 
 #include "mongo/db/pipeline/document.h"
@@ -37,6 +38,7 @@
 #include "mongo/db/pipeline/document_source_skip.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -57,6 +59,21 @@ const char* DocumentSourceSingleDocumentTransformation::getSourceName() const {
 DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::getNext() {
     pExpCtx->checkForInterrupt();
 
+    if (_batchPosition < _batchInputs.size() || _resultAfterBatch || !_errorAfterBatch.isOK()) {
+        return getNextFromBatch();
+    }
+
+    // Reading ahead would make a tailable, awaitData cursor wait for documents it doesn't need yet.
+    // The batches start with a single document and double from there, so that a later stage which
+    // only wants a few documents doesn't make the source produce many more.
+    const int maxBatchSize = internalDocumentSourceProjectionBatchSize.load();
+    if (maxBatchSize > 1 && _parsedTransform->prefersBatches() && !pExpCtx->isTailableAwaitData()) {
+        const size_t batchSize = std::min(_nextBatchSize, static_cast<size_t>(maxBatchSize));
+        _nextBatchSize = batchSize * 2;
+        loadBatch(batchSize);
+        return getNextFromBatch();
+    }
+
     // Get the next input document.
     auto input = pSource->getNext();
     if (!input.isAdvanced()) {
@@ -67,12 +84,82 @@ DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::getNex
     return _parsedTransform->applyTransformation(input.releaseDocument());
 }
 
+void DocumentSourceSingleDocumentTransformation::loadBatch(size_t batchSize) {
+    _batchInputs.clear();
+    _batchOutputs.clear();
+    _batchPosition = 0;
+    _transformBatchOneAtATime = false;
+
+    const size_t maxBatchBytes = std::max(0, internalDocumentSourceProjectionBatchSizeBytes.load());
+    size_t batchBytes = 0;
+    while (_batchInputs.size() < batchSize) {
+        try {
+            auto input = pSource->getNext();
+            if (!input.isAdvanced()) {
+                _resultAfterBatch = std::move(input);
+                break;
+            }
+            _batchInputs.push_back(input.releaseDocument());
+            batchBytes += _batchInputs.back().getApproximateSize();
+            if (batchBytes >= maxBatchBytes) {
+                break;
+            }
+        } catch (const DBException& ex) {
+            if (_batchInputs.empty()) {
+                throw;
+            }
+            _errorAfterBatch = ex.toStatus();
+            break;
+        }
+    }
+
+    if (_batchInputs.empty()) {
+        return;
+    }
+
+    try {
+        _batchOutputs = _parsedTransform->applyTransformationBatch(_batchInputs);
+    } catch (const DBException&) {
+        // Some document can't be transformed, but it may not be the first one which fails when
+        // transformed on its own, and a later stage might not even ask for it.
+        _transformBatchOneAtATime = true;
+    }
+}
+
+DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::getNextFromBatch() {
+    if (_batchPosition < _batchInputs.size()) {
+        const size_t position = _batchPosition++;
+        if (_transformBatchOneAtATime) {
+            return _parsedTransform->applyTransformation(_batchInputs[position]);
+        }
+        return std::move(_batchOutputs[position]);
+    }
+
+    if (!_errorAfterBatch.isOK()) {
+        auto error = std::move(_errorAfterBatch);
+        _errorAfterBatch = Status::OK();
+        uassertStatusOK(error);
+    }
+
+    invariant(_resultAfterBatch);
+    auto result = std::move(*_resultAfterBatch);
+    _resultAfterBatch = boost::none;
+    return result;
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceSingleDocumentTransformation::optimize() {
     _parsedTransform->optimize();
     return this;
 }
 
 void DocumentSourceSingleDocumentTransformation::doDispose() {
+    _batchInputs.clear();
+    _batchOutputs.clear();
+    _batchPosition = 0;
+    _nextBatchSize = 1;
+    _transformBatchOneAtATime = false;
+    _resultAfterBatch = boost::none;
+    _errorAfterBatch = Status::OK();
     _parsedTransform.reset();
 }
 
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <vector>
+
 #include "mongo/db/pipeline/document_source.h"
 
 namespace mongo {
@@ -62,6 +65,30 @@ public:
         };
         virtual ~TransformerInterface() = default;
         virtual Document applyTransformation(const Document& input) = 0;
+
+        /**
+         * Applies the transformation to each document in 'inputs', returning the results in the
+         * same order. Transformers which can do better than the default of transforming one
+         * document at a time should override this and prefersBatches().
+         */
+        virtual std::vector<Document> applyTransformationBatch(
+            const std::vector<Document>& inputs) {
+            std::vector<Document> outputs;
+            outputs.reserve(inputs.size());
+            for (auto&& input : inputs) {
+                outputs.push_back(applyTransformation(input));
+            }
+            return outputs;
+        }
+
+        /**
+         * Returns true if applyTransformationBatch() is cheaper than transforming each document
+         * in turn, in which case the stage reads its input ahead in batches.
+         */
+        virtual bool prefersBatches() const {
+            return false;
+        }
+
         virtual TransformerType getType() const = 0;
         virtual void optimize() = 0;
         virtual DocumentSource::GetDepsReturn addDependencies(DepsTracker* deps) const = 0;
@@ -150,9 +177,42 @@ protected:
                                                      Pipeline::SourceContainer* container) final;
 
 private:
+    /**
+     * Reads up to 'batchSize' documents ahead from the source and transforms them together.
+     * Reading stops early once the documents read reach
+     * internalDocumentSourceProjectionBatchSizeBytes, at the first result which is not a document,
+     * or at an error once some documents have been read, which is then held back until the batch
+     * has been returned.
+     */
+    void loadBatch(size_t batchSize);
+
+    /**
+     * Returns the next result of the current batch, or the result or error which ended it.
+     */
+    GetNextResult getNextFromBatch();
+
     // Stores transformation logic.
     std::unique_ptr<TransformerInterface> _parsedTransform;
 
+    // The documents of the current batch, their transformed versions, and the position of the
+    // next one to return.
+    std::vector<Document> _batchInputs;
+    std::vector<Document> _batchOutputs;
+    size_t _batchPosition = 0;
+
+    // The number of documents the next batch reads, unless the batch size knob is lower. It
+    // doubles with each batch.
+    size_t _nextBatchSize = 1;
+
+    // Set if transforming the batch as a whole threw, in which case each document of the batch is
+    // transformed as it is returned instead, so that the stage fails at the same document as it
+    // would have without batching.
+    bool _transformBatchOneAtATime = false;
+
+    // The result or error which ended the current batch, returned after its documents.
+    boost::optional<GetNextResult> _resultAfterBatch;
+    Status _errorAfterBatch = Status::OK();
+
     // Specific name of the transformation.
     std::string _name;
 };
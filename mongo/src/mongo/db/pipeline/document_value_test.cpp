@@ -96,6 +96,89 @@ TEST(DocumentConstruction, FromNonEmptyBson) {
     ASSERT_EQUALS("q", getNthField(document, 1).second.getString());
 }
 
+TEST(DocumentConstruction, FromOwnedBsonReadsFieldsOnDemand) {
+    BSONObj obj = fromjson("{a: 1, b: {c: 2, d: [3, {e: 4}]}, f: 'q', a: 5}");
+    Document document = fromBson(obj);
+
+    // Looking up a later field first doesn't change the order of the fields.
+    ASSERT_EQUALS("q", document["f"].getString());
+    ASSERT_EQUALS(2, document.getNestedField(FieldPath("b.c")).getInt());
+    ASSERT_EQUALS(1, document["a"].getInt());
+    ASSERT_EQUALS(4U, document.size());
+    ASSERT_EQUALS("a", getNthField(document, 0).first.toString());
+    ASSERT_EQUALS("b", getNthField(document, 1).first.toString());
+    ASSERT_EQUALS("f", getNthField(document, 2).first.toString());
+    ASSERT_EQUALS(5, getNthField(document, 3).second.getInt());
+    ASSERT_BSONOBJ_EQ(obj, toBson(document));
+    // An unowned object is converted up front.
+    ASSERT_DOCUMENT_EQ(document, Document(BSONObj(obj.objdata())));
+    assertRoundTrips(document);
+}
+
+TEST(DocumentConstruction, FromOwnedBsonKeepsSizeAfterReadingFields) {
+    Document document = fromBson(fromjson("{a: 1, b: {c: 2}, d: 'a string too long to inline'}"));
+    const size_t size = document.getApproximateSize();
+    ASSERT_EQUALS(2, document["b"]["c"].getInt());
+    document.fillCache();
+    ASSERT_EQUALS(size, document.getApproximateSize());
+}
+
+TEST(DocumentConstruction, FromOwnedBsonCountsFieldsNotReadYet) {
+    BSONObj obj = fromjson("{a: 1, b: 2, c: 3}");
+    Document document = fromBson(obj);
+    ASSERT_GT(document.getApproximateSize(), sizeof(DocumentStorage) + obj.objsize());
+}
+
+TEST(DocumentConstruction, FromOwnedBsonCountsNoMoreThanConvertingUpFront) {
+    const std::string longString(100, 'x');
+    BSONObj obj = BSON("a" << 1 << "b" << 2.5 << "c" << longString << "d" << BSON("e" << 1)
+                           << "f"
+                           << BSON_ARRAY(1 << 2 << 3)
+                           << "g"
+                           << true);
+    Document lazy = fromBson(obj);
+
+    // A document read from unowned BSON converts all of its fields up front.
+    Document converted = fromBson(BSONObj(obj.objdata()));
+    ASSERT_LTE(lazy.getApproximateSize(), converted.getApproximateSize());
+
+    // Reading fields doesn't change the size.
+    const size_t sizeBeforeReading = lazy.getApproximateSize();
+    ASSERT_EQUALS(longString, lazy["c"].getString());
+    ASSERT_EQUALS(1, lazy["d"]["e"].getInt());
+    ASSERT_EQUALS(sizeBeforeReading, lazy.getApproximateSize());
+}
+
+TEST(DocumentConstruction, SmallSubDocumentOfOwnedBsonDoesNotPinItsParent) {
+    const std::string longString(10 * 1024, 'x');
+    BSONObj obj = BSON("small" << BSON("c" << 1) << "large" << BSON("s" << longString));
+    Document document = fromBson(obj);
+
+    // The small sub-document is copied rather than keeping the whole parent alive, while the
+    // large one shares the parent buffer and is sized by it.
+    ASSERT_LT(document["small"].getApproximateSize(), size_t(obj.objsize()));
+    ASSERT_GT(document["large"].getApproximateSize(), size_t(obj.objsize()));
+    ASSERT_EQUALS(1, document["small"]["c"].getInt());
+    ASSERT_EQUALS(longString, document["large"]["s"].getString());
+}
+
+TEST(DocumentConstruction, ModifyingDocumentFromOwnedBsonLeavesBsonUnchanged) {
+    BSONObj obj = fromjson("{a: 1, b: {c: 2}}");
+    Document document = fromBson(obj);
+
+    MutableDocument shared(document);
+    shared["a"] = Value(3);
+    ASSERT_BSONOBJ_EQ(fromjson("{a: 3, b: {c: 2}}"), toBson(shared.freeze()));
+    ASSERT_BSONOBJ_EQ(obj, toBson(document));
+
+    // The storage of 'document' isn't shared anymore, so it is modified in place.
+    MutableDocument unshared(std::move(document));
+    unshared.setNestedField(FieldPath("b.c"), Value(4));
+    unshared.addField("d", Value(5));
+    ASSERT_BSONOBJ_EQ(fromjson("{a: 1, b: {c: 4}, d: 5}"), toBson(unshared.freeze()));
+    ASSERT_BSONOBJ_EQ(fromjson("{a: 1, b: {c: 2}}"), obj);
+}
+
 TEST(DocumentConstruction, FromInitializerList) {
     auto document = Document{{"a", 1}, {"b", "q"_sd}};
     ASSERT_EQUALS(2U, document.size());
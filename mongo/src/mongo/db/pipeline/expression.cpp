@@ -103,6 +103,13 @@ intrusive_ptr<Expression> Expression::parseObject(
     return ExpressionObject::parse(expCtx, obj, vps);
 }
 
+void Expression::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    results->resize(roots.size());
+    for (size_t i = 0; i < roots.size(); ++i) {
+        (*results)[i] = evaluate(roots[i]);
+    }
+}
+
 namespace {
 StringMap<Parser> parserMap;
 }
@@ -239,7 +246,13 @@ const char* ExpressionAbs::getOpName() const {
 
 /* ------------------------- ExpressionAdd ----------------------------- */
 
-Value ExpressionAdd::evaluate(const Document& root) const {
+namespace {
+/**
+ * Adds the 'n' values returned by 'getOperand', which is called with each index in order until a
+ * nullish value ends the sum.
+ */
+template <typename GetOperand>
+Value addValues(size_t n, GetOperand getOperand) {
     // We'll try to return the narrowest possible result value while avoiding overflow, loss
     // of precision due to intermediate rounding or implicit use of decimal types. To do that,
     // compute a compensated sum for non-decimal values and a separate decimal sum for decimal
@@ -249,9 +262,8 @@ Value ExpressionAdd::evaluate(const Document& root) const {
     BSONType totalType = NumberInt;
     bool haveDate = false;
 
-    const size_t n = vpOperand.size();
     for (size_t i = 0; i < n; ++i) {
-        Value val = vpOperand[i]->evaluate(root);
+        Value val = getOperand(i);
 
         switch (val.getType()) {
             case NumberDecimal:
@@ -313,6 +325,19 @@ Value ExpressionAdd::evaluate(const Document& root) const {
             massert(16417, "$add resulted in a non-numeric type", false);
     }
 }
+}  // namespace
+
+Value ExpressionAdd::evaluate(const Document& root) const {
+    return addValues(vpOperand.size(), [&](size_t i) { return vpOperand[i]->evaluate(root); });
+}
+
+void ExpressionAdd::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = addValues(operands.size(), [&](size_t i) { return operands[i][row]; });
+    }
+}
 
 REGISTER_EXPRESSION(add, ExpressionAdd::parse);
 const char* ExpressionAdd::getOpName() const {
@@ -788,13 +813,12 @@ static const CmpLookup cmpLookup[7] = {
     // CMP is special. Only name is used.
     /* CMP */ {{false, false, false}, ExpressionCompare::CMP, "$cmp"},
 };
-}
-
-Value ExpressionCompare::evaluate(const Document& root) const {
-    Value pLeft(vpOperand[0]->evaluate(root));
-    Value pRight(vpOperand[1]->evaluate(root));
 
-    int cmp = getExpressionContext()->getValueComparator().compare(pLeft, pRight);
+Value compareValues(const ValueComparator& comparator,
+                    ExpressionCompare::CmpOp cmpOp,
+                    const Value& pLeft,
+                    const Value& pRight) {
+    int cmp = comparator.compare(pLeft, pRight);
 
     // Make cmp one of 1, 0, or -1.
     if (cmp == 0) {
@@ -805,12 +829,29 @@ Value ExpressionCompare::evaluate(const Document& root) const {
         cmp = 1;
     }
 
-    if (cmpOp == CMP)
+    if (cmpOp == ExpressionCompare::CMP)
         return Value(cmp);
 
     bool returnValue = cmpLookup[cmpOp].truthValue[cmp + 1];
     return Value(returnValue);
 }
+}  // namespace
+
+Value ExpressionCompare::evaluate(const Document& root) const {
+    Value pLeft(vpOperand[0]->evaluate(root));
+    Value pRight(vpOperand[1]->evaluate(root));
+    return compareValues(getExpressionContext()->getValueComparator(), cmpOp, pLeft, pRight);
+}
+
+void ExpressionCompare::evaluateBatch(const vector<Document>& roots,
+                                      vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    const auto& comparator = getExpressionContext()->getValueComparator();
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = compareValues(comparator, cmpOp, operands[0][row], operands[1][row]);
+    }
+}
 
 const char* ExpressionCompare::getOpName() const {
     return cmpLookup[cmpOp].name;
@@ -818,12 +859,16 @@ const char* ExpressionCompare::getOpName() const {
 
 /* ------------------------- ExpressionConcat ----------------------------- */
 
-Value ExpressionConcat::evaluate(const Document& root) const {
-    const size_t n = vpOperand.size();
-
+namespace {
+/**
+ * Concatenates the 'n' strings returned by 'getOperand', which is called with each index in order
+ * until a nullish value ends the concatenation.
+ */
+template <typename GetOperand>
+Value concatValues(size_t n, GetOperand getOperand) {
     StringBuilder result;
     for (size_t i = 0; i < n; ++i) {
-        Value val = vpOperand[i]->evaluate(root);
+        Value val = getOperand(i);
         if (val.nullish())
             return Value(BSONNULL);
 
@@ -836,6 +881,20 @@ Value ExpressionConcat::evaluate(const Document& root) const {
 
     return Value(result.str());
 }
+}  // namespace
+
+Value ExpressionConcat::evaluate(const Document& root) const {
+    return concatValues(vpOperand.size(), [&](size_t i) { return vpOperand[i]->evaluate(root); });
+}
+
+void ExpressionConcat::evaluateBatch(const vector<Document>& roots,
+                                     vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = concatValues(operands.size(), [&](size_t i) { return operands[i][row]; });
+    }
+}
 
 REGISTER_EXPRESSION(concat, ExpressionConcat::parse);
 const char* ExpressionConcat::getOpName() const {
@@ -878,6 +937,34 @@ Value ExpressionCond::evaluate(const Document& root) const {
     return vpOperand[idx]->evaluate(root);
 }
 
+void ExpressionCond::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    vector<Value> conds;
+    vpOperand[0]->evaluateBatch(roots, &conds);
+
+    // Evaluate each branch only against the documents which select it, as evaluate() does. A
+    // branch is often only valid when its condition holds, as in
+    // {$cond: [{$eq: ["$b", 0]}, null, {$divide: ["$a", "$b"]}]}.
+    vector<Document> branchRoots[2];
+    vector<size_t> branchRows[2];
+    for (size_t row = 0; row < roots.size(); ++row) {
+        const int branch = conds[row].coerceToBool() ? 0 : 1;
+        branchRoots[branch].push_back(roots[row]);
+        branchRows[branch].push_back(row);
+    }
+
+    results->resize(roots.size());
+    vector<Value> branchResults;
+    for (int branch = 0; branch < 2; ++branch) {
+        if (branchRoots[branch].empty()) {
+            continue;
+        }
+        vpOperand[branch + 1]->evaluateBatch(branchRoots[branch], &branchResults);
+        for (size_t i = 0; i < branchRows[branch].size(); ++i) {
+            (*results)[branchRows[branch][i]] = std::move(branchResults[i]);
+        }
+    }
+}
+
 intrusive_ptr<Expression> ExpressionCond::parse(
     const boost::intrusive_ptr<ExpressionContext>& expCtx,
     BSONElement expr,
@@ -950,6 +1037,11 @@ Value ExpressionConstant::evaluate(const Document& root) const {
     return _value;
 }
 
+void ExpressionConstant::evaluateBatch(const vector<Document>& roots,
+                                       vector<Value>* results) const {
+    results->assign(roots.size(), _value);
+}
+
 Value ExpressionConstant::serialize(bool explain) const {
     return serializeConstant(_value);
 }
@@ -1644,10 +1736,8 @@ void ExpressionDateToString::_doAddDependencies(DepsTracker* deps) const {
 
 /* ----------------------- ExpressionDivide ---------------------------- */
 
-Value ExpressionDivide::evaluate(const Document& root) const {
-    Value lhs = vpOperand[0]->evaluate(root);
-    Value rhs = vpOperand[1]->evaluate(root);
-
+namespace {
+Value divideValues(const Value& lhs, const Value& rhs) {
     auto assertNonZero = [](bool nonZero) { uassert(16608, "can't $divide by zero", nonZero); };
 
     if (lhs.numeric() && rhs.numeric()) {
@@ -1674,6 +1764,22 @@ Value ExpressionDivide::evaluate(const Document& root) const {
                                 << typeName(rhs.getType()));
     }
 }
+}  // namespace
+
+Value ExpressionDivide::evaluate(const Document& root) const {
+    Value lhs = vpOperand[0]->evaluate(root);
+    Value rhs = vpOperand[1]->evaluate(root);
+    return divideValues(lhs, rhs);
+}
+
+void ExpressionDivide::evaluateBatch(const vector<Document>& roots,
+                                     vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = divideValues(operands[0][row], operands[1][row]);
+    }
+}
 
 REGISTER_EXPRESSION(divide, ExpressionDivide::parse);
 const char* ExpressionDivide::getOpName() const {
@@ -1902,6 +2008,19 @@ Value ExpressionFieldPath::evaluate(const Document& root) const {
     }
 }
 
+void ExpressionFieldPath::evaluateBatch(const vector<Document>& roots,
+                                        vector<Value>* results) const {
+    if (_variable != Variables::kRootId || _fieldPath.getPathLength() == 1) {
+        Expression::evaluateBatch(roots, results);
+        return;
+    }
+
+    results->resize(roots.size());
+    for (size_t i = 0; i < roots.size(); ++i) {
+        (*results)[i] = evaluatePath(1, roots[i]);
+    }
+}
+
 Value ExpressionFieldPath::serialize(bool explain) const {
     if (_fieldPath.getFieldName(0) == "CURRENT" && _fieldPath.getPathLength() > 1) {
         // use short form for "$$CURRENT.foo" but not just "$$CURRENT"
@@ -2350,10 +2469,8 @@ void ExpressionMeta::_doAddDependencies(DepsTracker* deps) const {
 
 /* ----------------------- ExpressionMod ---------------------------- */
 
-Value ExpressionMod::evaluate(const Document& root) const {
-    Value lhs = vpOperand[0]->evaluate(root);
-    Value rhs = vpOperand[1]->evaluate(root);
-
+namespace {
+Value modValues(const Value& lhs, const Value& rhs) {
     BSONType leftType = lhs.getType();
     BSONType rightType = rhs.getType();
 
@@ -2399,6 +2516,21 @@ Value ExpressionMod::evaluate(const Document& root) const {
                                 << typeName(rhs.getType()));
     }
 }
+}  // namespace
+
+Value ExpressionMod::evaluate(const Document& root) const {
+    Value lhs = vpOperand[0]->evaluate(root);
+    Value rhs = vpOperand[1]->evaluate(root);
+    return modValues(lhs, rhs);
+}
+
+void ExpressionMod::evaluateBatch(const vector<Document>& roots, vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = modValues(operands[0][row], operands[1][row]);
+    }
+}
 
 REGISTER_EXPRESSION(mod, ExpressionMod::parse);
 const char* ExpressionMod::getOpName() const {
@@ -2407,7 +2539,13 @@ const char* ExpressionMod::getOpName() const {
 
 /* ------------------------- ExpressionMultiply ----------------------------- */
 
-Value ExpressionMultiply::evaluate(const Document& root) const {
+namespace {
+/**
+ * Multiplies the 'n' values returned by 'getOperand', which is called with each index in order
+ * until a nullish value ends the product.
+ */
+template <typename GetOperand>
+Value multiplyValues(size_t n, GetOperand getOperand) {
     /*
       We'll try to return the narrowest possible result value.  To do that
       without creating intermediate Values, do the arithmetic for double
@@ -2420,9 +2558,8 @@ Value ExpressionMultiply::evaluate(const Document& root) const {
 
     BSONType productType = NumberInt;
 
-    const size_t n = vpOperand.size();
     for (size_t i = 0; i < n; ++i) {
-        Value val = vpOperand[i]->evaluate(root);
+        Value val = getOperand(i);
 
         if (val.numeric()) {
             BSONType oldProductType = productType;
@@ -2462,6 +2599,22 @@ Value ExpressionMultiply::evaluate(const Document& root) const {
     else
         massert(16418, "$multiply resulted in a non-numeric type", false);
 }
+}  // namespace
+
+Value ExpressionMultiply::evaluate(const Document& root) const {
+    return multiplyValues(vpOperand.size(),
+                          [&](size_t i) { return vpOperand[i]->evaluate(root); });
+}
+
+void ExpressionMultiply::evaluateBatch(const vector<Document>& roots,
+                                       vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] =
+            multiplyValues(operands.size(), [&](size_t i) { return operands[i][row]; });
+    }
+}
 
 REGISTER_EXPRESSION(multiply, ExpressionMultiply::parse);
 const char* ExpressionMultiply::getOpName() const {
@@ -2915,6 +3068,14 @@ void ExpressionNary::_doAddDependencies(DepsTracker* deps) const {
     }
 }
 
+vector<vector<Value>> ExpressionNary::evaluateOperandsBatch(const vector<Document>& roots) const {
+    vector<vector<Value>> columns(vpOperand.size());
+    for (size_t i = 0; i < vpOperand.size(); ++i) {
+        vpOperand[i]->evaluateBatch(roots, &columns[i]);
+    }
+    return columns;
+}
+
 void ExpressionNary::addOperand(const intrusive_ptr<Expression>& pExpression) {
     vpOperand.push_back(pExpression);
 }
@@ -3844,21 +4005,21 @@ const char* ExpressionStrcasecmp::getOpName() const {
 
 /* ----------------------- ExpressionSubstrBytes ---------------------------- */
 
-Value ExpressionSubstrBytes::evaluate(const Document& root) const {
-    Value pString(vpOperand[0]->evaluate(root));
-    Value pLower(vpOperand[1]->evaluate(root));
-    Value pLength(vpOperand[2]->evaluate(root));
-
+namespace {
+Value substrBytesValues(StringData opName,
+                        const Value& pString,
+                        const Value& pLower,
+                        const Value& pLength) {
     string str = pString.coerceToString();
     uassert(16034,
-            str::stream() << getOpName()
+            str::stream() << opName
                           << ":  starting index must be a numeric type (is BSON type "
                           << typeName(pLower.getType())
                           << ")",
             (pLower.getType() == NumberInt || pLower.getType() == NumberLong ||
              pLower.getType() == NumberDouble));
     uassert(16035,
-            str::stream() << getOpName() << ":  length must be a numeric type (is BSON type "
+            str::stream() << opName << ":  length must be a numeric type (is BSON type "
                           << typeName(pLength.getType())
                           << ")",
             (pLength.getType() == NumberInt || pLength.getType() == NumberLong ||
@@ -3868,7 +4029,7 @@ Value ExpressionSubstrBytes::evaluate(const Document& root) const {
     string::size_type length = static_cast<string::size_type>(pLength.coerceToLong());
 
     uassert(28656,
-            str::stream() << getOpName()
+            str::stream() << opName
                           << ":  Invalid range, starting index is a UTF-8 continuation byte.",
             (lower >= str.length() || !str::isUTF8ContinuationByte(str[lower])));
 
@@ -3876,7 +4037,7 @@ Value ExpressionSubstrBytes::evaluate(const Document& root) const {
     // means we're in the middle of a UTF-8 character.
     uassert(
         28657,
-        str::stream() << getOpName()
+        str::stream() << opName
                       << ":  Invalid range, ending index is in the middle of a UTF-8 character.",
         (lower + length >= str.length() || !str::isUTF8ContinuationByte(str[lower + length])));
 
@@ -3887,6 +4048,24 @@ Value ExpressionSubstrBytes::evaluate(const Document& root) const {
     }
     return Value(str.substr(lower, length));
 }
+}  // namespace
+
+Value ExpressionSubstrBytes::evaluate(const Document& root) const {
+    Value pString(vpOperand[0]->evaluate(root));
+    Value pLower(vpOperand[1]->evaluate(root));
+    Value pLength(vpOperand[2]->evaluate(root));
+    return substrBytesValues(getOpName(), pString, pLower, pLength);
+}
+
+void ExpressionSubstrBytes::evaluateBatch(const vector<Document>& roots,
+                                          vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] =
+            substrBytesValues(getOpName(), operands[0][row], operands[1][row], operands[2][row]);
+    }
+}
 
 // $substr is deprecated in favor of $substrBytes, but for now will just parse into a $substrBytes.
 REGISTER_EXPRESSION(substrBytes, ExpressionSubstrBytes::parse);
@@ -3972,9 +4151,8 @@ const char* ExpressionSubstrCP::getOpName() const {
 
 /* ----------------------- ExpressionStrLenBytes ------------------------- */
 
-Value ExpressionStrLenBytes::evaluate(const Document& root) const {
-    Value str(vpOperand[0]->evaluate(root));
-
+namespace {
+Value strLenBytesValue(const Value& str) {
     uassert(34473,
             str::stream() << "$strLenBytes requires a string argument, found: "
                           << typeName(str.getType()),
@@ -3987,6 +4165,19 @@ Value ExpressionStrLenBytes::evaluate(const Document& root) const {
             strLen <= std::numeric_limits<int>::max());
     return Value(static_cast<int>(strLen));
 }
+}  // namespace
+
+Value ExpressionStrLenBytes::evaluate(const Document& root) const {
+    return strLenBytesValue(vpOperand[0]->evaluate(root));
+}
+
+void ExpressionStrLenBytes::evaluateBatch(const vector<Document>& roots,
+                                          vector<Value>* results) const {
+    vpOperand[0]->evaluateBatch(roots, results);
+    for (auto&& result : *results) {
+        result = strLenBytesValue(result);
+    }
+}
 
 REGISTER_EXPRESSION(strLenBytes, ExpressionStrLenBytes::parse);
 const char* ExpressionStrLenBytes::getOpName() const {
@@ -4020,10 +4211,8 @@ const char* ExpressionStrLenCP::getOpName() const {
 
 /* ----------------------- ExpressionSubtract ---------------------------- */
 
-Value ExpressionSubtract::evaluate(const Document& root) const {
-    Value lhs = vpOperand[0]->evaluate(root);
-    Value rhs = vpOperand[1]->evaluate(root);
-
+namespace {
+Value subtractValues(const Value& lhs, const Value& rhs) {
     BSONType diffType = Value::getWidestNumeric(rhs.getType(), lhs.getType());
 
     if (diffType == NumberDecimal) {
@@ -4060,6 +4249,22 @@ Value ExpressionSubtract::evaluate(const Document& root) const {
                                 << typeName(lhs.getType()));
     }
 }
+}  // namespace
+
+Value ExpressionSubtract::evaluate(const Document& root) const {
+    Value lhs = vpOperand[0]->evaluate(root);
+    Value rhs = vpOperand[1]->evaluate(root);
+    return subtractValues(lhs, rhs);
+}
+
+void ExpressionSubtract::evaluateBatch(const vector<Document>& roots,
+                                       vector<Value>* results) const {
+    const auto operands = evaluateOperandsBatch(roots);
+    results->resize(roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        (*results)[row] = subtractValues(operands[0][row], operands[1][row]);
+    }
+}
 
 REGISTER_EXPRESSION(subtract, ExpressionSubtract::parse);
 const char* ExpressionSubtract::getOpName() const {
@@ -4197,12 +4402,25 @@ Value ExpressionSwitch::serialize(bool explain) const {
 
 /* ------------------------- ExpressionToLower ----------------------------- */
 
-Value ExpressionToLower::evaluate(const Document& root) const {
-    Value pString(vpOperand[0]->evaluate(root));
+namespace {
+Value toLowerValue(const Value& pString) {
     string str = pString.coerceToString();
     boost::to_lower(str);
     return Value(str);
 }
+}  // namespace
+
+Value ExpressionToLower::evaluate(const Document& root) const {
+    return toLowerValue(vpOperand[0]->evaluate(root));
+}
+
+void ExpressionToLower::evaluateBatch(const vector<Document>& roots,
+                                      vector<Value>* results) const {
+    vpOperand[0]->evaluateBatch(roots, results);
+    for (auto&& result : *results) {
+        result = toLowerValue(result);
+    }
+}
 
 REGISTER_EXPRESSION(toLower, ExpressionToLower::parse);
 const char* ExpressionToLower::getOpName() const {
@@ -4211,12 +4429,25 @@ const char* ExpressionToLower::getOpName() const {
 
 /* ------------------------- ExpressionToUpper -------------------------- */
 
-Value ExpressionToUpper::evaluate(const Document& root) const {
-    Value pString(vpOperand[0]->evaluate(root));
+namespace {
+Value toUpperValue(const Value& pString) {
     string str(pString.coerceToString());
     boost::to_upper(str);
     return Value(str);
 }
+}  // namespace
+
+Value ExpressionToUpper::evaluate(const Document& root) const {
+    return toUpperValue(vpOperand[0]->evaluate(root));
+}
+
+void ExpressionToUpper::evaluateBatch(const vector<Document>& roots,
+                                      vector<Value>* results) const {
+    vpOperand[0]->evaluateBatch(roots, results);
+    for (auto&& result : *results) {
+        result = toUpperValue(result);
+    }
+}
 
 REGISTER_EXPRESSION(toUpper, ExpressionToUpper::parse);
 const char* ExpressionToUpper::getOpName() const {
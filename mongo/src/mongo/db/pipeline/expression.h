@@ -128,6 +128,21 @@ public:
      */
     virtual Value evaluate(const Document& root) const = 0;
 
+    /**
+     * Evaluate expression with respect to each Document in 'roots', replacing the contents of
+     * 'results' with one Value per Document, in the same order.
+     *
+     * The default evaluates the Documents one at a time. Expressions which override this evaluate
+     * each of their operands over the whole batch before combining them, so that the tree is
+     * walked once per batch rather than once per Document. As a consequence, an operand which
+     * evaluate() would have skipped for some Document, such as the argument after a null in an
+     * $add, may be evaluated anyway. The values produced are the same as evaluate() would produce,
+     * but if this throws, callers that need the error evaluate() would have raised, or the values
+     * of the Documents which did not fail, must evaluate the Documents one at a time instead.
+     */
+    virtual void evaluateBatch(const std::vector<Document>& roots,
+                               std::vector<Value>* results) const;
+
     /**
      * Returns information about the paths computed by this expression. This only needs to be
      * overridden by expressions that have renaming semantics, where optimization code could take
@@ -278,6 +293,12 @@ protected:
 
     void _doAddDependencies(DepsTracker* deps) const override;
 
+    /**
+     * Evaluates every operand over all of 'roots' with evaluateBatch(), returning one column of
+     * results per operand.
+     */
+    std::vector<std::vector<Value>> evaluateOperandsBatch(const std::vector<Document>& roots) const;
+
     ExpressionVector vpOperand;
 };
 
@@ -415,7 +436,21 @@ public:
     virtual ~ExpressionSingleNumericArg() {}
 
     Value evaluate(const Document& root) const final {
-        Value arg = this->vpOperand[0]->evaluate(root);
+        return evaluateArg(this->vpOperand[0]->evaluate(root));
+    }
+
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final {
+        this->vpOperand[0]->evaluateBatch(roots, results);
+        for (auto&& result : *results) {
+            result = evaluateArg(result);
+        }
+    }
+
+    virtual Value evaluateNumericArg(const Value& numericArg) const = 0;
+
+private:
+    Value evaluateArg(const Value& arg) const {
         if (arg.nullish())
             return Value(BSONNULL);
 
@@ -426,8 +461,6 @@ public:
 
         return evaluateNumericArg(arg);
     }
-
-    virtual Value evaluateNumericArg(const Value& numericArg) const = 0;
 };
 
 /**
@@ -437,6 +470,8 @@ class ExpressionConstant final : public Expression {
 public:
     boost::intrusive_ptr<Expression> optimize() final;
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     Value serialize(bool explain) const final;
 
     const char* getOpName() const;
@@ -510,20 +545,43 @@ public:
         if (timeZoneId.nullish()) {
             return Value(BSONNULL);
         }
+        return evaluateDate(date, getTimeZone(timeZoneId));
+    }
 
-        uassert(40533,
-                str::stream() << _opName
-                              << " requires a string for the timezone argument, but was given a "
-                              << typeName(timeZoneId.getType())
-                              << " ("
-                              << timeZoneId.toString()
-                              << ")",
-                timeZoneId.getType() == BSONType::String);
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final {
+        _date->evaluateBatch(roots, results);
+        std::vector<Value> timeZoneIds;
+        if (_timeZone) {
+            _timeZone->evaluateBatch(roots, &timeZoneIds);
+        }
 
-        invariant(getExpressionContext()->timeZoneDatabase);
-        auto timeZone =
-            getExpressionContext()->timeZoneDatabase->getTimeZone(timeZoneId.getString());
-        return evaluateDate(date, timeZone);
+        // Consecutive documents usually share a time zone, so only look it up when it changes.
+        boost::optional<TimeZone> timeZone;
+        Value timeZoneIdOfLastLookup;
+        for (size_t i = 0; i < results->size(); ++i) {
+            auto& result = (*results)[i];
+            if (result.nullish()) {
+                result = Value(BSONNULL);
+                continue;
+            }
+            auto date = result.coerceToDate();
+
+            if (!_timeZone) {
+                result = evaluateDate(date, TimeZoneDatabase::utcZone());
+                continue;
+            }
+            if (timeZoneIds[i].nullish()) {
+                result = Value(BSONNULL);
+                continue;
+            }
+            if (!timeZone || timeZoneIds[i].getType() != BSONType::String ||
+                Value::compare(timeZoneIds[i], timeZoneIdOfLastLookup, nullptr) != 0) {
+                timeZone = getTimeZone(timeZoneIds[i]);
+                timeZoneIdOfLastLookup = timeZoneIds[i];
+            }
+            result = evaluateDate(date, *timeZone);
+        }
     }
 
     /**
@@ -624,6 +682,24 @@ protected:
     virtual Value evaluateDate(Date_t date, const TimeZone& timezone) const = 0;
 
 private:
+    /**
+     * Looks up the time zone named by 'timeZoneId', the non-nullish value of the timezone
+     * argument.
+     */
+    TimeZone getTimeZone(const Value& timeZoneId) const {
+        uassert(40533,
+                str::stream() << _opName
+                              << " requires a string for the timezone argument, but was given a "
+                              << typeName(timeZoneId.getType())
+                              << " ("
+                              << timeZoneId.toString()
+                              << ")",
+                timeZoneId.getType() == BSONType::String);
+
+        invariant(getExpressionContext()->timeZoneDatabase);
+        return getExpressionContext()->timeZoneDatabase->getTimeZone(timeZoneId.getString());
+    }
+
     // The name of this expression, e.g. $week or $month.
     StringData _opName;
 
@@ -649,6 +725,8 @@ public:
         : ExpressionVariadic<ExpressionAdd>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     bool isAssociative() const final {
@@ -789,6 +867,8 @@ public:
         : ExpressionFixedArity<ExpressionCompare, 2>(expCtx), cmpOp(cmpOp) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     CmpOp getOp() const {
@@ -818,6 +898,8 @@ public:
         : ExpressionVariadic<ExpressionConcat>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     bool isAssociative() const final {
@@ -845,6 +927,8 @@ public:
     explicit ExpressionCond(const boost::intrusive_ptr<ExpressionContext>& expCtx) : Base(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     static boost::intrusive_ptr<Expression> parse(
@@ -1026,6 +1110,8 @@ public:
         : ExpressionFixedArity<ExpressionDivide, 2>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 };
 
@@ -1048,6 +1134,8 @@ public:
 
     boost::intrusive_ptr<Expression> optimize() final;
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     Value serialize(bool explain) const final;
 
     /*
@@ -1360,6 +1448,8 @@ public:
         : ExpressionFixedArity<ExpressionMod, 2>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 };
 
@@ -1370,6 +1460,8 @@ public:
         : ExpressionVariadic<ExpressionMultiply>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     bool isAssociative() const final {
@@ -1681,6 +1773,8 @@ public:
         : ExpressionFixedArity<ExpressionSubstrBytes, 3>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const;
 };
 
@@ -1701,6 +1795,8 @@ public:
         : ExpressionFixedArity<ExpressionStrLenBytes, 1>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 };
 
@@ -1721,6 +1817,8 @@ public:
         : ExpressionFixedArity<ExpressionSubtract, 2>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 };
 
@@ -1756,6 +1854,8 @@ public:
         : ExpressionFixedArity<ExpressionToLower, 1>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 };
 
@@ -1766,6 +1866,8 @@ public:
         : ExpressionFixedArity<ExpressionToUpper, 1>(expCtx) {}
 
     Value evaluate(const Document& root) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 };
 
@@ -5335,6 +5335,133 @@ TEST_F(ExpressionDateFromStringTest, ReadWithUTCOffset) {
 
 }  // namespace ExpressionDateFromStringTest
 
+namespace EvaluateBatch {
+
+using EvaluateBatchTest = AggregationContextFixture;
+
+/**
+ * Asserts that evaluating the expression given by the only field of 'spec' over all of 'roots' at
+ * once produces the same values as evaluating it against each of them in turn.
+ */
+void assertBatchMatchesOneAtATime(const intrusive_ptr<ExpressionContext>& expCtx,
+                                  const BSONObj& spec,
+                                  const vector<Document>& roots) {
+    auto expression =
+        Expression::parseOperand(expCtx, spec.firstElement(), expCtx->variablesParseState);
+    vector<Value> results;
+    expression->evaluateBatch(roots, &results);
+    ASSERT_EQ(results.size(), roots.size());
+    for (size_t i = 0; i < roots.size(); ++i) {
+        ASSERT_VALUE_EQ(results[i], expression->evaluate(roots[i]));
+    }
+}
+
+vector<Document> numericRoots() {
+    return {Document(fromjson("{a: 1, b: 2}")),
+            Document(fromjson("{a: 5.5, b: -3}")),
+            Document(fromjson("{a: NumberLong(7), b: 4}")),
+            Document(fromjson("{a: NumberDecimal('2.5'), b: 10}")),
+            Document(fromjson("{a: null, b: 1}")),
+            Document(fromjson("{b: 6}")),
+            Document(fromjson("{a: 2147483647, b: 2147483647}"))};
+}
+
+TEST_F(EvaluateBatchTest, ArithmeticExpressionsMatchOneAtATime) {
+    for (auto&& spec : {fromjson("{e: {$add: ['$a', '$b', 1]}}"),
+                        fromjson("{e: {$subtract: ['$a', '$b']}}"),
+                        fromjson("{e: {$multiply: ['$a', '$b', 3]}}"),
+                        fromjson("{e: {$divide: ['$a', '$b']}}"),
+                        fromjson("{e: {$mod: ['$a', '$b']}}"),
+                        fromjson("{e: {$abs: '$b'}}"),
+                        fromjson("{e: {$trunc: '$a'}}")}) {
+        assertBatchMatchesOneAtATime(getExpCtx(), spec, numericRoots());
+    }
+}
+
+TEST_F(EvaluateBatchTest, ComparisonExpressionsMatchOneAtATime) {
+    vector<Document> roots = numericRoots();
+    roots.push_back(Document(fromjson("{a: 'x', b: 'y'}")));
+    for (auto&& spec : {fromjson("{e: {$eq: ['$a', '$b']}}"),
+                        fromjson("{e: {$ne: ['$a', 1]}}"),
+                        fromjson("{e: {$gt: ['$a', '$b']}}"),
+                        fromjson("{e: {$lte: ['$a', '$b']}}"),
+                        fromjson("{e: {$cmp: ['$a', '$b']}}")}) {
+        assertBatchMatchesOneAtATime(getExpCtx(), spec, roots);
+    }
+}
+
+TEST_F(EvaluateBatchTest, StringExpressionsMatchOneAtATime) {
+    vector<Document> roots = {Document(fromjson("{s: 'Hello', t: 'World'}")),
+                              Document(fromjson("{s: '', t: 'x'}")),
+                              Document(fromjson("{s: null, t: 'y'}")),
+                              Document(fromjson("{t: 'z'}"))};
+    for (auto&& spec : {fromjson("{e: {$concat: ['$s', ' ', '$t']}}"),
+                        fromjson("{e: {$toLower: '$s'}}"),
+                        fromjson("{e: {$toUpper: '$t'}}"),
+                        fromjson("{e: {$substrBytes: ['$s', 1, 3]}}"),
+                        fromjson("{e: {$strLenBytes: '$t'}}")}) {
+        assertBatchMatchesOneAtATime(getExpCtx(), spec, roots);
+    }
+}
+
+TEST_F(EvaluateBatchTest, DateExpressionsMatchOneAtATimeAsTimeZoneChanges) {
+    const Date_t date = Date_t::fromMillisSinceEpoch(1500000000000LL);
+    vector<Document> roots = {Document{{"d", date}, {"tz", "UTC"_sd}},
+                              Document{{"d", date}, {"tz", "America/New_York"_sd}},
+                              Document{{"d", date}, {"tz", "America/New_York"_sd}},
+                              Document{{"d", BSONNULL}, {"tz", "UTC"_sd}},
+                              Document{{"d", date}, {"tz", BSONNULL}},
+                              Document{{"d", date}, {"tz", "+05:30"_sd}}};
+    for (auto&& spec : {fromjson("{e: {$hour: {date: '$d', timezone: '$tz'}}}"),
+                        fromjson("{e: {$dayOfMonth: {date: '$d', timezone: '$tz'}}}"),
+                        fromjson("{e: {$year: '$d'}}")}) {
+        assertBatchMatchesOneAtATime(getExpCtx(), spec, roots);
+    }
+}
+
+TEST_F(EvaluateBatchTest, CondOnlyEvaluatesTheBranchEachDocumentSelects) {
+    vector<Document> roots = {Document(fromjson("{a: 6, b: 3}")),
+                              Document(fromjson("{a: 6, b: 0}")),
+                              Document(fromjson("{a: 1, b: 4}"))};
+    auto spec = fromjson("{e: {$cond: [{$eq: ['$b', 0]}, null, {$divide: ['$a', '$b']}]}}");
+    auto expression = Expression::parseOperand(
+        getExpCtx(), spec.firstElement(), getExpCtx()->variablesParseState);
+
+    vector<Value> results;
+    expression->evaluateBatch(roots, &results);
+    ASSERT_EQ(results.size(), 3U);
+    ASSERT_VALUE_EQ(results[0], Value(2.0));
+    ASSERT_VALUE_EQ(results[1], Value(BSONNULL));
+    ASSERT_VALUE_EQ(results[2], Value(0.25));
+}
+
+TEST_F(EvaluateBatchTest, NestedExpressionsMatchOneAtATime) {
+    vector<Document> roots = numericRoots();
+    for (auto&& root : roots) {
+        MutableDocument withString(root);
+        withString["s"] = Value("Name"_sd);
+        root = withString.freeze();
+    }
+    for (auto&& spec :
+         {fromjson("{e: {$cond: {if: {$gt: [{$add: ['$a', '$b']}, 5]}, then: {$concat: ['$s', "
+                   "'!']}, else: {$toUpper: '$s'}}}}"),
+          fromjson("{e: {$map: {input: ['$a', '$b'], as: 'x', in: {$multiply: ['$$x', 2]}}}}"),
+          fromjson("{e: {$let: {vars: {c: {$add: ['$b', 1]}}, in: {$eq: ['$$c', '$a']}}}}")}) {
+        assertBatchMatchesOneAtATime(getExpCtx(), spec, roots);
+    }
+}
+
+TEST_F(EvaluateBatchTest, EmptyBatchProducesNoValues) {
+    auto spec = fromjson("{e: {$add: ['$a', {$cond: ['$b', 1, 2]}]}}");
+    auto expression = Expression::parseOperand(
+        getExpCtx(), spec.firstElement(), getExpCtx()->variablesParseState);
+    vector<Value> results{Value(1)};
+    expression->evaluateBatch({}, &results);
+    ASSERT_TRUE(results.empty());
+}
+
+}  // namespace EvaluateBatch
+
 class All : public Suite {
 public:
     All() : Suite("expression") {}
@@ -5534,6 +5661,7 @@ public:
         add<AllAnyElements::TrueViaInt>();
         add<AllAnyElements::FalseViaInt>();
         add<AllAnyElements::Null>();
+
     }
 };
 
@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/lookup_hash_table.h"
+
+#include <algorithm>
+
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+
+LookUpHashTable::LookUpHashTable(FieldPath joinField,
+                                 const ValueComparator& comparator,
+                                 size_t maxSizeBytes)
+    : _joinField(std::move(joinField)),
+      _maxSizeBytes(maxSizeBytes),
+      _index(comparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+bool LookUpHashTable::canJoinOn(const FieldPath& joinField) {
+    for (size_t i = 0; i < joinField.getPathLength(); ++i) {
+        if (parseUnsignedBase10Integer(joinField.getFieldName(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LookUpHashTable::add(Document doc, bool matchesNull) {
+    invariant(_status == TableStatus::kBuilding);
+
+    const size_t docIndex = _docs.size();
+    _sizeBytes += doc.getApproximateSize();
+    _docs.push_back(std::move(doc));
+    indexValuesAtPath(Value(_docs.back()), 0, docIndex);
+    if (matchesNull) {
+        _sizeBytes += sizeof(size_t);
+        _nullMatches.push_back(docIndex);
+    }
+
+    if (_sizeBytes > _maxSizeBytes) {
+        abandon();
+    }
+}
+
+void LookUpHashTable::freeze() {
+    invariant(_status == TableStatus::kBuilding);
+
+    _status = TableStatus::kServing;
+    _docs.shrink_to_fit();
+}
+
+void LookUpHashTable::abandon() {
+    _status = TableStatus::kAbandoned;
+
+    _docs.clear();
+    _docs.shrink_to_fit();
+    _index.clear();
+    _nullMatches.clear();
+    _nullMatches.shrink_to_fit();
+    _sizeBytes = 0;
+}
+
+std::vector<Document> LookUpHashTable::lookUp(const std::vector<Value>& values,
+                                              bool includeNullMatches) const {
+    invariant(_status == TableStatus::kServing);
+
+    std::vector<size_t> docIndexes;
+    if (includeNullMatches) {
+        docIndexes = _nullMatches;
+    }
+    for (auto&& value : values) {
+        invariant(!value.nullish());
+        auto it = _index.find(value);
+        if (it != _index.end()) {
+            docIndexes.insert(docIndexes.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    // Each list is sorted and free of duplicates already, so only several lists need merging.
+    if (values.size() + (includeNullMatches ? 1 : 0) > 1) {
+        std::sort(docIndexes.begin(), docIndexes.end());
+        docIndexes.erase(std::unique(docIndexes.begin(), docIndexes.end()), docIndexes.end());
+    }
+
+    std::vector<Document> docs;
+    docs.reserve(docIndexes.size());
+    for (auto docIndex : docIndexes) {
+        docs.push_back(_docs[docIndex]);
+    }
+    return docs;
+}
+
+void LookUpHashTable::addToIndex(const Value& value, size_t docIndex) {
+    auto it = _index.find(value);
+    if (it == _index.end()) {
+        _sizeBytes += value.getApproximateSize();
+        it = _index.emplace(value, std::vector<size_t>()).first;
+    } else if (it->second.back() == docIndex) {
+        return;
+    }
+
+    _sizeBytes += sizeof(size_t);
+    it->second.push_back(docIndex);
+}
+
+void LookUpHashTable::indexValuesAtPath(const Value& value, size_t pathIndex, size_t docIndex) {
+    if (pathIndex == _joinField.getPathLength()) {
+        // An equality query matches either an element of an array or the array itself.
+        if (value.isArray()) {
+            for (auto&& element : value.getArray()) {
+                if (!element.missing()) {
+                    addToIndex(element, docIndex);
+                }
+            }
+        }
+        if (!value.missing()) {
+            addToIndex(value, docIndex);
+        }
+        return;
+    }
+
+    // Arrays along the path are traversed, but arrays directly within arrays are not.
+    if (value.isArray()) {
+        for (auto&& element : value.getArray()) {
+            if (element.getType() == BSONType::Object) {
+                indexValuesAtPath(element, pathIndex, docIndex);
+            }
+        }
+    } else if (value.getType() == BSONType::Object) {
+        indexValuesAtPath(value.getDocument().getField(_joinField.getFieldName(pathIndex)),
+                          pathIndex + 1,
+                          docIndex);
+    }
+}
+
+}  // namespace mongo
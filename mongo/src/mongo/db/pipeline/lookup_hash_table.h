@@ -0,0 +1,164 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+
+namespace mongo {
+
+/**
+ * Holds the foreign side of an equality $lookup in memory, indexed by the values found at the join
+ * field, up to a maximum size. Like a SequentialDocumentCache, the table is either building,
+ * serving, or abandoned.
+ *
+ * The index holds every value found along the join field, treating each element of an array as
+ * well as the array itself as a value, which is what an equality query on the field matches
+ * against. Paths with numeric components, which a query may treat either as a field name or as an
+ * array position, are not supported.
+ *
+ * Equality to null also matches documents that are missing the join field, which the index cannot
+ * express, so the caller tells the table which documents match null as they are added and the
+ * table keeps them in a separate list.
+ */
+class LookUpHashTable {
+    MONGO_DISALLOW_COPYING(LookUpHashTable);
+
+public:
+    enum class TableStatus {
+        // Documents are being added. A newly instantiated table is in this state.
+        kBuilding,
+
+        // The caller has invoked freeze() and the table is read-only.
+        kServing,
+
+        // The maximum size has been exceeded, or the caller explicitly abandoned the table.
+        kAbandoned,
+    };
+
+    /**
+     * The 'comparator' must outlive the table.
+     */
+    LookUpHashTable(FieldPath joinField, const ValueComparator& comparator, size_t maxSizeBytes);
+
+    /**
+     * Returns true if a table can be built for the given join field.
+     */
+    static bool canJoinOn(const FieldPath& joinField);
+
+    /**
+     * Adds a document to the table, abandoning the table if it grows over its maximum size.
+     * 'matchesNull' says whether an equality to null on the join field matches the document. May
+     * only be called while building.
+     */
+    void add(Document doc, bool matchesNull);
+
+    /**
+     * Makes the table read-only. May only be called while building.
+     */
+    void freeze();
+
+    /**
+     * Marks the table abandoned and releases its memory.
+     */
+    void abandon();
+
+    /**
+     * Returns the documents holding any of 'values' at the join field, along with the documents
+     * matching null if 'includeNullMatches' is true, in the order they were added and each at most
+     * once. None of 'values' may be nullish; the caller asks for the null matches instead. May
+     * only be called while serving.
+     */
+    std::vector<Document> lookUp(const std::vector<Value>& values, bool includeNullMatches) const;
+
+    /**
+     * Returns all documents in the order they were added. May only be called while serving.
+     */
+    const std::vector<Document>& getAll() const {
+        invariant(_status == TableStatus::kServing);
+        return _docs;
+    }
+
+    TableStatus status() const {
+        return _status;
+    }
+
+    size_t sizeBytes() const {
+        return _sizeBytes;
+    }
+
+    size_t count() const {
+        return _docs.size();
+    }
+
+    bool isBuilding() const {
+        return _status == TableStatus::kBuilding;
+    }
+
+    bool isServing() const {
+        return _status == TableStatus::kServing;
+    }
+
+    bool isAbandoned() const {
+        return _status == TableStatus::kAbandoned;
+    }
+
+private:
+    /**
+     * Records 'docIndex' under 'value', unless it was already recorded there.
+     */
+    void addToIndex(const Value& value, size_t docIndex);
+
+    /**
+     * Indexes the document at 'docIndex' under every value found along '_joinField' below 'value',
+     * starting at the path component 'pathIndex'.
+     */
+    void indexValuesAtPath(const Value& value, size_t pathIndex, size_t docIndex);
+
+    TableStatus _status = TableStatus::kBuilding;
+    const FieldPath _joinField;
+    const size_t _maxSizeBytes;
+    size_t _sizeBytes = 0;
+
+    std::vector<Document> _docs;
+
+    // Maps each value found at the join field to the indexes in '_docs' of the documents holding
+    // it, in increasing order.
+    ValueUnorderedMap<std::vector<size_t>> _index;
+
+    // The indexes in '_docs' of the documents matching an equality to null, in increasing order.
+    std::vector<size_t> _nullMatches;
+};
+
+}  // namespace mongo
@@ -0,0 +1,172 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/lookup_hash_table.h"
+
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/death_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const size_t kTableSizeBytes = 1024 * 1024;
+
+/**
+ * Returns the "_id" of each of 'docs'.
+ */
+std::vector<Value> ids(const std::vector<Document>& docs) {
+    std::vector<Value> out;
+    for (auto&& doc : docs) {
+        out.push_back(doc["_id"]);
+    }
+    return out;
+}
+
+TEST(LookUpHashTableTest, TableIsInBuildingModeUponInstantiation) {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    ASSERT(table.isBuilding());
+}
+
+DEATH_TEST(LookUpHashTableTest, CannotLookUpWhileBuilding, "invariant") {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    table.lookUp({Value(1)}, false);
+}
+
+DEATH_TEST(LookUpHashTableTest, CannotLookUpNullishValues, "invariant") {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    table.freeze();
+    table.lookUp({Value(BSONNULL)}, false);
+}
+
+TEST(LookUpHashTableTest, FindsScalarsAndArrayElements) {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << 1), false);
+    table.add(DOC("_id" << 1 << "a" << DOC_ARRAY(1 << 2)), false);
+    table.add(DOC("_id" << 2 << "a" << DOC_ARRAY(DOC_ARRAY(1))), false);
+    table.add(DOC("_id" << 3 << "a" << 2), false);
+    table.add(DOC("_id" << 4), true);
+    table.freeze();
+
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(1)}, false))), Value(DOC_ARRAY(0 << 1)));
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(2)}, false))), Value(DOC_ARRAY(1 << 3)));
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(DOC_ARRAY(1 << 2))}, false))),
+                    Value(DOC_ARRAY(1)));
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(DOC_ARRAY(1))}, false))), Value(DOC_ARRAY(2)));
+    ASSERT(table.lookUp({Value(3)}, false).empty());
+}
+
+TEST(LookUpHashTableTest, ReturnsEachDocumentOnceInInsertionOrder) {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << DOC_ARRAY(2 << 1 << 2)), false);
+    table.add(DOC("_id" << 1 << "a" << 1), false);
+    table.add(DOC("_id" << 2 << "a" << 2), false);
+    table.freeze();
+
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(2), Value(1)}, false))),
+                    Value(DOC_ARRAY(0 << 1 << 2)));
+}
+
+TEST(LookUpHashTableTest, TraversesArraysOfDocumentsButNotNestedArrays) {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a.b"), comparator, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << DOC_ARRAY(DOC("b" << 1) << DOC("b" << DOC_ARRAY(2)))),
+              false);
+    table.add(DOC("_id" << 1 << "a" << DOC_ARRAY(DOC_ARRAY(DOC("b" << 1)))), false);
+    table.add(DOC("_id" << 2 << "a" << DOC("b" << 2)), false);
+    table.freeze();
+
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(1)}, false))), Value(DOC_ARRAY(0)));
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(2)}, false))), Value(DOC_ARRAY(0 << 2)));
+}
+
+TEST(LookUpHashTableTest, MergesNullMatchesWithValueMatches) {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << 1), false);
+    table.add(DOC("_id" << 1), true);
+    table.add(DOC("_id" << 2 << "a" << 2), false);
+    table.add(DOC("_id" << 3 << "a" << BSONNULL), true);
+    table.add(DOC("_id" << 4 << "a" << 1), false);
+    table.freeze();
+
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({}, true))), Value(DOC_ARRAY(1 << 3)));
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(1)}, true))),
+                    Value(DOC_ARRAY(0 << 1 << 3 << 4)));
+}
+
+TEST(LookUpHashTableTest, NumbersOfDifferentTypesAreEqual) {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << 1.0), false);
+    table.add(DOC("_id" << 1 << "a" << 1LL), false);
+    table.freeze();
+
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value(1)}, false))), Value(DOC_ARRAY(0 << 1)));
+}
+
+TEST(LookUpHashTableTest, RespectsCollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kToLowerString);
+    ValueComparator comparator(&collator);
+    LookUpHashTable table(FieldPath("a"), comparator, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a"
+                        << "ABC"_sd),
+              false);
+    table.freeze();
+
+    ASSERT_VALUE_EQ(Value(ids(table.lookUp({Value("abc"_sd)}, false))), Value(DOC_ARRAY(0)));
+}
+
+TEST(LookUpHashTableTest, AbandonsTableOverMaxSize) {
+    ValueComparator comparator;
+    LookUpHashTable table(FieldPath("a"), comparator, 10);
+    table.add(DOC("_id" << 0 << "a"
+                        << "a string that is too long"_sd),
+              false);
+
+    ASSERT(table.isAbandoned());
+    ASSERT_EQ(table.count(), 0ul);
+    ASSERT_EQ(table.sizeBytes(), 0ul);
+}
+
+TEST(LookUpHashTableTest, CannotJoinOnNumericPathComponents) {
+    ASSERT(LookUpHashTable::canJoinOn(FieldPath("a.b")));
+    ASSERT_FALSE(LookUpHashTable::canJoinOn(FieldPath("a.0")));
+    ASSERT_FALSE(LookUpHashTable::canJoinOn(FieldPath("a.1.b")));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -90,6 +90,23 @@ Document ParsedAddFields::applyProjection(const Document& inputDoc) const {
     return output.freeze();
 }
 
+std::vector<Document> ParsedAddFields::applyProjectionBatch(
+    const std::vector<Document>& inputDocs) const {
+    const auto columns = _root->evaluateComputedFields(inputDocs);
+
+    std::vector<Document> outputDocs;
+    outputDocs.reserve(inputDocs.size());
+    for (size_t i = 0; i < inputDocs.size(); ++i) {
+        MutableDocument output(inputDocs[i]);
+        _root->addComputedFields(&output, inputDocs[i], columns, i);
+
+        // Pass through the metadata.
+        output.copyMetaDataFrom(inputDocs[i]);
+        outputDocs.push_back(output.freeze());
+    }
+    return outputDocs;
+}
+
 bool ParsedAddFields::parseObjectAsExpression(StringData pathToObject,
                                               const BSONObj& objSpec,
                                               const VariablesParseState& variablesParseState) {
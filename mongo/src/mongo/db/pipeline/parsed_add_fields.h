@@ -112,6 +112,16 @@ public:
      */
     Document applyProjection(const Document& inputDoc) const final;
 
+    /**
+     * Add the specified fields to each of 'inputDocs', evaluating the top-level fields over all of
+     * them at once.
+     */
+    std::vector<Document> applyProjectionBatch(const std::vector<Document>& inputDocs) const final;
+
+    bool prefersBatches() const final {
+        return _root->hasOwnComputedFields();
+    }
+
 private:
     /**
      * Attempts to parse 'objSpec' as an expression like {$add: [...]}. Adds a computed field to
@@ -334,6 +334,24 @@ TEST(ParsedAddFieldsExecutionTest, AddsNewFieldsAfterExistingFieldsInOrderSpecif
     ASSERT_DOCUMENT_EQ(result, expectedResult);
 }
 
+// Verify that adding fields to a batch of documents gives the same results as adding them to each
+// document in turn.
+TEST(ParsedAddFieldsExecutionTest, AddsFieldsToBatchAsToEachDocument) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ParsedAddFields addition(expCtx);
+    addition.parse(fromjson("{a: {$add: ['$a', 1]}, c: {$toUpper: '$b'}, 'd.e': {$literal: 1}}"));
+    ASSERT_TRUE(addition.prefersBatches());
+
+    vector<Document> inputDocs = {Document{{"a", 1}, {"b", "x"_sd}},
+                                  Document{{"b", "y"_sd}, {"d", DOC_ARRAY(1 << 2)}},
+                                  Document{{"c", 0}, {"a", 2.5}}};
+    auto results = addition.applyProjectionBatch(inputDocs);
+    ASSERT_EQ(results.size(), inputDocs.size());
+    for (size_t i = 0; i < inputDocs.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(results[i], addition.applyProjection(inputDocs[i]));
+    }
+}
+
 // Verify that both adding and replacing fields at the same time follows the same rules as doing
 // each independently.
 TEST(ParsedAddFieldsExecutionTest, ReplacesAndAddsNewFieldsWithSameOrderingRulesAsSeparately) {
@@ -32,6 +32,7 @@
 
 #include <boost/intrusive_ptr.hpp>
 #include <memory>
+#include <vector>
 
 #include "mongo/bson/bsonelement.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
@@ -177,6 +178,13 @@ public:
         return applyProjection(input);
     }
 
+    /**
+     * Apply the projection transformation to each document in 'inputs'.
+     */
+    std::vector<Document> applyTransformationBatch(const std::vector<Document>& inputs) final {
+        return applyProjectionBatch(inputs);
+    }
+
 protected:
     ParsedAggregationProjection(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : _expCtx(expCtx){};
@@ -186,6 +194,19 @@ protected:
      */
     virtual Document applyProjection(const Document& input) const = 0;
 
+    /**
+     * Apply the projection to each document in 'inputs'. Projections which can do better than
+     * applying themselves to one document at a time should override this and prefersBatches().
+     */
+    virtual std::vector<Document> applyProjectionBatch(const std::vector<Document>& inputs) const {
+        std::vector<Document> outputs;
+        outputs.reserve(inputs.size());
+        for (auto&& input : inputs) {
+            outputs.push_back(applyProjection(input));
+        }
+        return outputs;
+    }
+
     boost::intrusive_ptr<ExpressionContext> _expCtx;
 };
 }  // namespace parsed_aggregation_projection
@@ -142,11 +142,38 @@ Value InclusionNode::applyInclusionsToValue(Value inputValue) const {
 }
 
 void InclusionNode::addComputedFields(MutableDocument* outputDoc, const Document& root) const {
+    addComputedFields(outputDoc, root, nullptr, 0);
+}
+
+InclusionNode::ComputedFieldColumns InclusionNode::evaluateComputedFields(
+    const std::vector<Document>& roots) const {
+    ComputedFieldColumns columns;
+    for (auto&& expressionPair : _expressions) {
+        expressionPair.second->evaluateBatch(roots, &columns[expressionPair.first]);
+    }
+    return columns;
+}
+
+void InclusionNode::addComputedFields(MutableDocument* outputDoc,
+                                      const Document& root,
+                                      const ComputedFieldColumns& columns,
+                                      size_t row) const {
+    addComputedFields(outputDoc, root, &columns, row);
+}
+
+void InclusionNode::addComputedFields(MutableDocument* outputDoc,
+                                      const Document& root,
+                                      const ComputedFieldColumns* columns,
+                                      size_t row) const {
     for (auto&& field : _orderToProcessAdditionsAndChildren) {
         auto childIt = _children.find(field);
         if (childIt != _children.end()) {
             outputDoc->setField(field,
                                 childIt->second->addComputedFields(outputDoc->peek()[field], root));
+        } else if (columns) {
+            auto columnIt = columns->find(field);
+            invariant(columnIt != columns->end());
+            outputDoc->setField(field, columnIt->second[row]);
         } else {
             auto expressionIt = _expressions.find(field);
             invariant(expressionIt != _expressions.end());
@@ -349,6 +376,24 @@ Document ParsedInclusionProjection::applyProjection(const Document& inputDoc) co
     return output.freeze();
 }
 
+std::vector<Document> ParsedInclusionProjection::applyProjectionBatch(
+    const std::vector<Document>& inputDocs) const {
+    const auto columns = _root->evaluateComputedFields(inputDocs);
+
+    std::vector<Document> outputDocs;
+    outputDocs.reserve(inputDocs.size());
+    for (size_t i = 0; i < inputDocs.size(); ++i) {
+        MutableDocument output;
+        _root->applyInclusions(inputDocs[i], &output);
+        _root->addComputedFields(&output, inputDocs[i], columns, i);
+
+        // Always pass through the metadata.
+        output.copyMetaDataFrom(inputDocs[i]);
+        outputDocs.push_back(output.freeze());
+    }
+    return outputDocs;
+}
+
 bool ParsedInclusionProjection::parseObjectAsExpression(
     StringData pathToObject,
     const BSONObj& objSpec,
@@ -52,6 +52,12 @@ namespace parsed_aggregation_projection {
  */
 class InclusionNode {
 public:
+    /**
+     * The values of a node's own computed fields over a batch of documents, one column per field
+     * holding one Value per document. See evaluateComputedFields().
+     */
+    using ComputedFieldColumns = StringMap<std::vector<Value>>;
+
     InclusionNode(std::string pathToNode = "");
 
     /**
@@ -90,6 +96,30 @@ public:
      */
     void addComputedFields(MutableDocument* outputDoc, const Document& root) const;
 
+    /**
+     * Returns true if this node, as opposed to its children, has any computed fields.
+     */
+    bool hasOwnComputedFields() const {
+        return !_expressions.empty();
+    }
+
+    /**
+     * Evaluates the expressions of this node's own computed fields against every document in
+     * 'roots' with Expression::evaluateBatch(). Computed fields of child nodes are still evaluated
+     * one document at a time, since a child is applied to each element of an array separately.
+     */
+    ComputedFieldColumns evaluateComputedFields(const std::vector<Document>& roots) const;
+
+    /**
+     * Like addComputedFields() above, but takes the values of this node's own computed fields for
+     * 'root' from row 'row' of 'columns', which must have been returned by
+     * evaluateComputedFields().
+     */
+    void addComputedFields(MutableDocument* outputDoc,
+                           const Document& root,
+                           const ComputedFieldColumns& columns,
+                           size_t row) const;
+
     /**
      * Creates the child if it doesn't already exist. 'field' is not allowed to be dotted.
      */
@@ -141,6 +171,15 @@ private:
     Value applyInclusionsToValue(Value inputVal) const;
     Value addComputedFields(Value inputVal, const Document& root) const;
 
+    /**
+     * Adds computed fields to 'outputDoc', taking the values of this node's own computed fields
+     * from row 'row' of 'columns' if it is non-null, or evaluating them against 'root' otherwise.
+     */
+    void addComputedFields(MutableDocument* outputDoc,
+                           const Document& root,
+                           const ComputedFieldColumns* columns,
+                           size_t row) const;
+
     /**
      * Returns nullptr if no such child exists.
      */
@@ -244,6 +283,16 @@ public:
      */
     Document applyProjection(const Document& inputDoc) const final;
 
+    /**
+     * Apply this inclusion projection to each of 'inputDocs', evaluating the top-level computed
+     * fields over all of them at once.
+     */
+    std::vector<Document> applyProjectionBatch(const std::vector<Document>& inputDocs) const final;
+
+    bool prefersBatches() const final {
+        return _root->hasOwnComputedFields();
+    }
+
     /*
      * Checks whether the inclusion projection represented by the InclusionNode
      * tree is a subset of the object passed in. Projections that have any
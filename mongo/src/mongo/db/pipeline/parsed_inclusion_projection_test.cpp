@@ -643,6 +643,28 @@ TEST(InclusionProjectionExecutionTest, ShouldAlwaysKeepMetadataFromOriginalDoc)
     ASSERT_DOCUMENT_EQ(result, expectedDoc.freeze());
 }
 
+TEST(InclusionProjectionExecutionTest, ShouldApplyProjectionToBatchAsToEachDocument) {
+    const boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    ParsedInclusionProjection inclusion(expCtx);
+    inclusion.parse(fromjson(
+        "{a: true, c: {$multiply: ['$a', 2]}, 'd.e': {$concat: ['$b', '!']}, f: {$literal: 1}}"));
+    ASSERT_TRUE(inclusion.prefersBatches());
+
+    MutableDocument withMetadata(Document{{"a", 3}, {"b", "x"_sd}});
+    withMetadata.setTextScore(2.0);
+    std::vector<Document> inputDocs = {Document{{"a", 1}, {"b", "y"_sd}, {"d", 5}},
+                                       withMetadata.freeze(),
+                                       Document{{"d", Document{{"g", 1}}}},
+                                       Document(fromjson("{d: [1, {g: 2}]}"))};
+
+    auto results = inclusion.applyProjectionBatch(inputDocs);
+    ASSERT_EQ(results.size(), inputDocs.size());
+    for (size_t i = 0; i < inputDocs.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(results[i], inclusion.applyProjection(inputDocs[i]));
+        ASSERT_EQ(results[i].hasTextScore(), inputDocs[i].hasTextScore());
+    }
+}
+
 //
 // Detection of subset projection.
 //
@@ -64,8 +64,10 @@
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_stats_store.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
@@ -143,6 +145,40 @@ public:
         return collection->infoCache()->getIndexUsageStats();
     }
 
+    std::vector<BSONObj> getPlanCacheStats(OperationContext* opCtx,
+                                           const NamespaceString& ns,
+                                           bool totals) final {
+        AutoGetCollectionForReadCommand autoColl(opCtx, ns);
+
+        Collection* collection = autoColl.getCollection();
+        if (!collection) {
+            LOG(2) << "Collection not found on plan cache stats retrieval: " << ns.ns();
+            return std::vector<BSONObj>();
+        }
+
+        const PlanCache* planCache = collection->infoCache()->getPlanCache();
+        if (totals) {
+            BSONObjBuilder builder;
+            planCache->getCounters().appendTo(&builder);
+            return {builder.obj()};
+        }
+
+        std::vector<BSONObj> shapeStats;
+        for (auto&& stats : planCache->getShapeStats()) {
+            shapeStats.push_back(stats.toBSON());
+        }
+        return shapeStats;
+    }
+
+    std::vector<BSONObj> getQueryStats(OperationContext* opCtx, bool clear) final {
+        QueryStatsStore& store = QueryStatsStore::get(opCtx->getServiceContext());
+        std::vector<BSONObj> stats = store.getStats();
+        if (clear) {
+            store.clear();
+        }
+        return stats;
+    }
+
     void appendLatencyStats(const NamespaceString& nss,
                             bool includeHistograms,
                             BSONObjBuilder* builder) const final {
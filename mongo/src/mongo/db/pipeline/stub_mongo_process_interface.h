@@ -64,6 +64,16 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    std::vector<BSONObj> getPlanCacheStats(OperationContext* opCtx,
+                                           const NamespaceString& ns,
+                                           bool totals) override {
+        MONGO_UNREACHABLE;
+    }
+
+    std::vector<BSONObj> getQueryStats(OperationContext* opCtx, bool clear) override {
+        MONGO_UNREACHABLE;
+    }
+
     void appendLatencyStats(const NamespaceString& nss,
                             bool includeHistograms,
                             BSONObjBuilder* builder) const override {
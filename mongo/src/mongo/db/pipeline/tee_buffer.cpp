@@ -31,14 +31,35 @@
 #include "mongo/db/pipeline/tee_buffer.h"
 
 #include <algorithm>
+#include <boost/filesystem/operations.hpp>
 
 #include "mongo/db/pipeline/document.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/destructor_guard.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
+namespace {
+unsigned nextSpillFileNumber() {
+    static AtomicUInt32 spillFileCounter;
+    return spillFileCounter.fetchAndAdd(1);
+}
+}  // namespace
+
 TeeBuffer::TeeBuffer(size_t nConsumers, size_t bufferSizeBytes)
     : _bufferSizeBytes(bufferSizeBytes), _consumers(nConsumers) {}
 
+TeeBuffer::~TeeBuffer() {
+    if (_spillFile.is_open()) {
+        _spillFile.close();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_spillFileName);)
+    }
+}
+
 boost::intrusive_ptr<TeeBuffer> TeeBuffer::create(size_t nConsumers, int bufferSizeBytes) {
     uassert(40309, "need at least one consumer for a TeeBuffer", nConsumers > 0);
     uassert(40310,
@@ -48,44 +69,116 @@ boost::intrusive_ptr<TeeBuffer> TeeBuffer::create(size_t nConsumers, int bufferS
     return new TeeBuffer(nConsumers, bufferSizeBytes);
 }
 
+void TeeBuffer::dispose(size_t consumerId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _consumers[consumerId].stillInUse = false;
+    releaseConsumedDocuments();
+
+    // With concurrent consumers, the source belongs to the thread running loadAllInput(), which
+    // disposes of it once it notices that nobody is left to consume its input.
+    if (_source && !_concurrentConsumers && !anyConsumerStillInUse()) {
+        _source->dispose();
+    }
+}
+
 DocumentSource::GetNextResult TeeBuffer::getNext(size_t consumerId) {
-    size_t nConsumersStillProcessingThisBatch =
-        std::count_if(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
-            return info.nLeftToReturn > 0;
-        });
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    auto& consumer = _consumers[consumerId];
 
-    if (_buffer.empty() || nConsumersStillProcessingThisBatch == 0) {
+    while (consumer.nextIndex == endIndex()) {
+        uassertStatusOK(_abortStatus);
+        if (_inputExhausted) {
+            return DocumentSource::GetNextResult::makeEOF();
+        }
+
+        if (_concurrentConsumers) {
+            _inputAvailable.wait(lk, [&] {
+                return consumer.nextIndex < endIndex() || _inputExhausted || !_abortStatus.isOK();
+            });
+            continue;
+        }
+
+        if (_bytesInBuffer >= _bufferSizeBytes) {
+            // This consumer has read everything buffered so far, but there are still other
+            // consumers that haven't, and the buffer is full.
+            return DocumentSource::GetNextResult::makePauseExecution();
+        }
         loadNextBatch();
     }
+    uassertStatusOK(_abortStatus);
 
-    if (_buffer.empty()) {
-        // If we've loaded the next batch and it's still empty, then we've exhausted our input.
-        return DocumentSource::GetNextResult::makeEOF();
-    }
+    auto next = getDocumentAt(consumer.nextIndex++);
+    releaseConsumedDocuments();
+    return std::move(next);
+}
 
-    if (_consumers[consumerId].nLeftToReturn == 0) {
-        // This consumer has reached the end of this batch, but there are still other consumers that
-        // haven't seen this whole batch.
-        return DocumentSource::GetNextResult::makePauseExecution();
-    }
+void TeeBuffer::startConcurrentConsumers(std::string tempDir) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(!tempDir.empty());
+    invariant(endIndex() == 0);
+    _tempDir = std::move(tempDir);
+    _concurrentConsumers = true;
+}
 
-    const size_t bufferIndex = _buffer.size() - _consumers[consumerId].nLeftToReturn;
-    --_consumers[consumerId].nLeftToReturn;
+void TeeBuffer::loadAllInput() {
+    invariant(_concurrentConsumers);
 
-    return _buffer[bufferIndex];
+    while (true) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_abortStatus.isOK()) {
+                return;
+            }
+            if (!anyConsumerStillInUse()) {
+                _source->dispose();
+                return;
+            }
+        }
+
+        // The source is only used by this thread, so the consumers can keep reading while it
+        // produces the next document.
+        auto input = _source->getNext();
+        invariant(!input.isPaused());
+        if (input.isAdvanced()) {
+            // Consumers on other threads will read this document concurrently.
+            input.getDocument().fillCache();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (input.isEOF()) {
+            _inputExhausted = true;
+            _inputAvailable.notify_all();
+            return;
+        }
+
+        const size_t size = input.getDocument().getApproximateSize();
+        _buffer.push_back({input.releaseDocument(), size});
+        _bytesInBuffer += size;
+        while (_bytesInBuffer > _bufferSizeBytes && _buffer.size() > 1) {
+            spillOldestDocument();
+        }
+        _inputAvailable.notify_all();
+    }
 }
 
-void TeeBuffer::loadNextBatch() {
-    _buffer.clear();
-    size_t bytesInBuffer = 0;
+void TeeBuffer::abort(Status status) {
+    invariant(!status.isOK());
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_abortStatus.isOK()) {
+        _abortStatus = std::move(status);
+    }
+    _inputAvailable.notify_all();
+}
 
+void TeeBuffer::loadNextBatch() {
     auto input = _source->getNext();
     for (; input.isAdvanced(); input = _source->getNext()) {
-        bytesInBuffer += input.getDocument().getApproximateSize();
-        _buffer.push_back(std::move(input));
+        const size_t size = input.getDocument().getApproximateSize();
+        _buffer.push_back({input.releaseDocument(), size});
+        _bytesInBuffer += size;
 
-        if (bytesInBuffer >= _bufferSizeBytes) {
-            break;  // Need to break here so we don't get the next input and accidentally ignore it.
+        if (_bytesInBuffer >= _bufferSizeBytes) {
+            return;  // Stop before getting the next input, or we would accidentally ignore it.
         }
     }
 
@@ -94,13 +187,73 @@ void TeeBuffer::loadNextBatch() {
     //   - The $facet stage is the only stage that uses TeeBuffer.
     //   - We currently disallow nested $facet stages.
     invariant(!input.isPaused());
+    _inputExhausted = true;
+}
+
+Document TeeBuffer::getDocumentAt(size_t index) {
+    if (index >= _firstInMemory) {
+        return _buffer[index - _firstInMemory].document;
+    }
+
+    const auto& spilled = _spilled[index - (_firstInMemory - _spilled.size())];
+    auto bson = SharedBuffer::allocate(spilled.size);
+    _spillFile.seekg(spilled.offset);
+    _spillFile.read(bson.get(), spilled.size);
+    uassert(50605,
+            str::stream() << "error reading $facet spill file \"" << _spillFileName << "\": "
+                          << errnoWithDescription(),
+            _spillFile.good());
+    return Document::fromBsonWithMetaData(BSONObj(std::move(bson)));
+}
 
-    // Populate the pending returns.
-    for (size_t consumerId = 0; consumerId < _consumers.size(); ++consumerId) {
-        if (_consumers[consumerId].stillInUse) {
-            _consumers[consumerId].nLeftToReturn = _buffer.size();
+void TeeBuffer::releaseConsumedDocuments() {
+    size_t firstNeeded = endIndex();
+    for (auto&& consumer : _consumers) {
+        if (consumer.stillInUse) {
+            firstNeeded = std::min(firstNeeded, consumer.nextIndex);
         }
     }
+
+    const size_t nSpilledToRelease =
+        std::min(_spilled.size(), firstNeeded - (_firstInMemory - _spilled.size()));
+    _spilled.erase(_spilled.begin(), _spilled.begin() + nSpilledToRelease);
+
+    for (; _firstInMemory < firstNeeded; ++_firstInMemory) {
+        _bytesInBuffer -= _buffer.front().approximateSize;
+        _buffer.pop_front();
+    }
+}
+
+void TeeBuffer::spillOldestDocument() {
+    if (!_spillFile.is_open()) {
+        boost::filesystem::create_directories(_tempDir);
+        _spillFileName = str::stream() << _tempDir << "/facet." << nextSpillFileNumber();
+        _spillFile.open(_spillFileName.c_str(),
+                        std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        uassert(50604,
+                str::stream() << "error opening $facet spill file \"" << _spillFileName << "\": "
+                              << errnoWithDescription(),
+                _spillFile.good());
+    }
+
+    const auto bson = _buffer.front().document.toBsonWithMetaData();
+    _spillFile.seekp(0, std::ios::end);
+    _spilled.push_back({_spillFile.tellp(), bson.objsize()});
+    _spillFile.write(bson.objdata(), bson.objsize());
+    uassert(50606,
+            str::stream() << "error writing $facet spill file \"" << _spillFileName << "\": "
+                          << errnoWithDescription(),
+            _spillFile.good());
+
+    _bytesInBuffer -= _buffer.front().approximateSize;
+    _buffer.pop_front();
+    ++_firstInMemory;
+}
+
+bool TeeBuffer::anyConsumerStillInUse() const {
+    return std::any_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+        return info.stillInUse;
+    });
 }
 
 }  // namespace mongo
@@ -28,22 +28,36 @@
 
 #pragma once
 
-#include <algorithm>
 #include <boost/intrusive_ptr.hpp>
+#include <deque>
+#include <fstream>
+#include <string>
 #include <vector>
 
+#include "mongo/base/status.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/intrusive_counter.h"
 
 namespace mongo {
 
 /**
- * This stage takes a stream of input documents and makes them available to multiple consumers. To
- * do so, it will batch incoming documents and allow each consumer to consume one batch at a time.
- * As a consequence, consumers must be able to pause their execution to allow other consumers to
- * process the batch before moving to the next batch.
+ * This stage takes a stream of input documents and makes them available to multiple consumers. Each
+ * consumer reads the stream at its own pace, and a document is held in the buffer until every
+ * consumer still in use has read it.
+ *
+ * By default the consumers run on the thread which owns the source. A consumer which has read
+ * everything buffered so far loads more input itself, unless the documents held for the other
+ * consumers already fill the buffer, in which case it must pause its execution to allow the other
+ * consumers to catch up.
+ *
+ * Once startConcurrentConsumers() has been called, the consumers may instead run on other threads
+ * while the owning thread feeds them through loadAllInput(). The buffer then never waits for the
+ * slowest consumer: the oldest documents it holds are written to a temporary file once they exceed
+ * the buffer size, and are read back from there by the consumers which still need them.
  */
 class TeeBuffer : public RefCountable {
 public:
@@ -54,6 +68,8 @@ public:
     static boost::intrusive_ptr<TeeBuffer> create(
         size_t nConsumers, int bufferSizeBytes = internalQueryFacetBufferSizeBytes.load());
 
+    ~TeeBuffer();
+
     void setSource(DocumentSource* source) {
         _source = source;
     }
@@ -62,45 +78,106 @@ public:
      * Removes 'consumerId' as a consumer of this buffer. This is required to be called if a
      * consumer will not consume all input.
      */
-    void dispose(size_t consumerId) {
-        _consumers[consumerId].stillInUse = false;
-        _consumers[consumerId].nLeftToReturn = 0;
-        if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
-                return info.stillInUse;
-            })) {
-            _buffer.clear();
-            if (_source) {
-                _source->dispose();
-            }
-        }
-    }
+    void dispose(size_t consumerId);
 
     /**
      * Retrieves the next document meant to be consumed by the pipeline given by 'consumerId'.
      * Returns GetNextState::ResultState::kPauseExecution if this pipeline has consumed the whole
      * buffer, but other consumers are still using it.
+     *
+     * With concurrent consumers, this instead waits until loadAllInput() provides the next document
+     * and never pauses. Throws if the buffer has been aborted.
      */
     DocumentSource::GetNextResult getNext(size_t consumerId);
 
+    /**
+     * Allows getNext() to be called from threads other than the one owning the source, which must
+     * then call loadAllInput(). Documents which don't fit in the buffer are spilled to a file in
+     * 'tempDir'. Must be called before any consumer has read from this buffer.
+     */
+    void startConcurrentConsumers(std::string tempDir);
+
+    /**
+     * Reads the remaining input from the source, handing each document to the concurrent consumers
+     * as soon as it is read. Returns early if every consumer has been disposed or the buffer has
+     * been aborted.
+     */
+    void loadAllInput();
+
+    /**
+     * Makes the consumers waiting in getNext(), and any later calls to getNext(), fail with
+     * 'status', and stops loadAllInput().
+     */
+    void abort(Status status);
+
 private:
     TeeBuffer(size_t nConsumers, size_t bufferSizeBytes);
 
     /**
-     * Clears '_buffer', then keeps requesting results from '_source' and pushing them all into
-     * '_buffer', until more than '_bufferSizeBytes' of documents have been returned, or until
-     * '_source' is exhausted.
+     * Keeps requesting results from '_source' and pushing them all into '_buffer', until more than
+     * '_bufferSizeBytes' of documents are buffered, or until '_source' is exhausted.
      */
     void loadNextBatch();
 
+    /**
+     * Returns the document at position 'index' of the input, which must still be held in memory or
+     * in the spill file.
+     */
+    Document getDocumentAt(size_t index);
+
+    /**
+     * Drops the documents which every consumer still in use has read.
+     */
+    void releaseConsumedDocuments();
+
+    /**
+     * Moves the oldest document held in memory to the spill file.
+     */
+    void spillOldestDocument();
+
+    bool anyConsumerStillInUse() const;
+
+    size_t endIndex() const {
+        return _firstInMemory + _buffer.size();
+    }
+
     DocumentSource* _source = nullptr;
 
     const size_t _bufferSizeBytes;
-    std::vector<DocumentSource::GetNextResult> _buffer;
+
+    struct BufferedDocument {
+        Document document;
+        size_t approximateSize;
+    };
+
+    // The documents at positions [_firstInMemory, endIndex()) of the input, and their total size.
+    std::deque<BufferedDocument> _buffer;
+    size_t _firstInMemory = 0;
+    size_t _bytesInBuffer = 0;
+    bool _inputExhausted = false;
+
+    struct SpilledDocument {
+        std::streamoff offset;
+        int size;
+    };
+
+    // Where in '_spillFile' the documents just before '_firstInMemory' were written, oldest first.
+    std::deque<SpilledDocument> _spilled;
+    std::string _tempDir;
+    std::string _spillFileName;
+    std::fstream _spillFile;
 
     struct ConsumerInfo {
         bool stillInUse = true;
-        int nLeftToReturn = 0;
+        size_t nextIndex = 0;  // Position in the input of the next document to return.
     };
     std::vector<ConsumerInfo> _consumers;
+
+    // Everything below is only used once concurrent consumers have been started. '_mutex' protects
+    // all of the state above except '_source', which is only used by the thread owning it.
+    bool _concurrentConsumers = false;
+    Status _abortStatus = Status::OK();
+    stdx::mutex _mutex;
+    stdx::condition_variable _inputAvailable;
 };
 }  // namespace mongo
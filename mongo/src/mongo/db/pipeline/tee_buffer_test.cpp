@@ -30,9 +30,13 @@
 
 #include "mongo/db/pipeline/tee_buffer.h"
 
+#include <vector>
+
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 
@@ -166,5 +170,98 @@ TEST(TeeBufferTest, ShouldAllowOtherConsumersToAdvanceOnceTrailingConsumerIsDisp
     ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
     ASSERT_TRUE(teeBuffer->getNext(0).isEOF());
 }
+
+TEST(TeeBufferTest, ShouldSpillDocumentsWhichConcurrentConsumersHaveNotRead) {
+    MutableDocument withTextScore(Document{{"a", 3}});
+    withTextScore.setTextScore(1.5);
+    std::deque<DocumentSource::GetNextResult> inputs{
+        Document{{"a", 1}}, Document{{"a", 2}}, withTextScore.freeze()};
+    auto mock = DocumentSourceMock::create(inputs);
+
+    const size_t nConsumers = 2;
+    const size_t bufferBytes = 1;  // Only the newest document stays in memory.
+    auto teeBuffer = TeeBuffer::create(nConsumers, bufferBytes);
+    teeBuffer->setSource(mock.get());
+
+    unittest::TempDir tempDir("tee_buffer_test");
+    teeBuffer->startConcurrentConsumers(tempDir.path());
+    teeBuffer->loadAllInput();
+
+    for (size_t consumerId = 0; consumerId < nConsumers; ++consumerId) {
+        for (auto&& input : inputs) {
+            auto next = teeBuffer->getNext(consumerId);
+            ASSERT_TRUE(next.isAdvanced());
+            ASSERT_DOCUMENT_EQ(next.getDocument(), input.getDocument());
+            ASSERT_EQ(next.getDocument().hasTextScore(), input.getDocument().hasTextScore());
+            if (input.getDocument().hasTextScore()) {
+                ASSERT_EQ(next.getDocument().getTextScore(), 1.5);
+            }
+        }
+        ASSERT_TRUE(teeBuffer->getNext(consumerId).isEOF());
+    }
+}
+
+TEST(TeeBufferTest, ConcurrentConsumersShouldEachSeeAllResults) {
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < 1000; ++i) {
+        inputs.emplace_back(Document{{"a", i}});
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+
+    const size_t nConsumers = 3;
+    const size_t bufferBytes = 1000;
+    auto teeBuffer = TeeBuffer::create(nConsumers, bufferBytes);
+    teeBuffer->setSource(mock.get());
+
+    unittest::TempDir tempDir("tee_buffer_test");
+    teeBuffer->startConcurrentConsumers(tempDir.path());
+
+    std::vector<std::vector<Document>> results(nConsumers);
+    std::vector<stdx::thread> consumers;
+    for (size_t consumerId = 0; consumerId < nConsumers; ++consumerId) {
+        consumers.emplace_back([&, consumerId] {
+            for (auto next = teeBuffer->getNext(consumerId); next.isAdvanced();
+                 next = teeBuffer->getNext(consumerId)) {
+                results[consumerId].push_back(next.releaseDocument());
+            }
+        });
+    }
+    teeBuffer->loadAllInput();
+    for (auto&& consumer : consumers) {
+        consumer.join();
+    }
+
+    for (auto&& result : results) {
+        ASSERT_EQ(result.size(), inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            ASSERT_DOCUMENT_EQ(result[i], inputs[i].getDocument());
+        }
+    }
+}
+
+TEST(TeeBufferTest, AbortShouldFailConcurrentConsumersWaitingForInput) {
+    auto mock = DocumentSourceMock::create();
+    auto teeBuffer = TeeBuffer::create(1);
+    teeBuffer->setSource(mock.get());
+
+    unittest::TempDir tempDir("tee_buffer_test");
+    teeBuffer->startConcurrentConsumers(tempDir.path());
+
+    Status consumerStatus = Status::OK();
+    stdx::thread consumer([&] {
+        try {
+            teeBuffer->getNext(0);
+        } catch (const DBException& ex) {
+            consumerStatus = ex.toStatus();
+        }
+    });
+    teeBuffer->abort(Status(ErrorCodes::Interrupted, "interrupted"));
+    consumer.join();
+    ASSERT_EQ(consumerStatus, ErrorCodes::Interrupted);
+
+    // The input is no longer read once the buffer has been aborted.
+    teeBuffer->loadAllInput();
+    ASSERT_THROWS_CODE(teeBuffer->getNext(0), AssertionException, ErrorCodes::Interrupted);
+}
 }  // namespace
 }  // namespace mongo
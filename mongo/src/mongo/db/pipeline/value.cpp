@@ -1031,6 +1031,16 @@ bool Value::integral() const {
     }
 }
 
+void Value::fillCache() const {
+    if (getType() == Object) {
+        getDocument().fillCache();
+    } else if (getType() == Array) {
+        for (auto&& value : getArray()) {
+            value.fillCache();
+        }
+    }
+}
+
 size_t Value::getApproximateSize() const {
     switch (getType()) {
         case Code:
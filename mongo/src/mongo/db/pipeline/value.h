@@ -308,6 +308,9 @@ public:
     /// Get the approximate memory size of the value, in bytes. Includes sizeof(Value)
     size_t getApproximateSize() const;
 
+    /// Converts any lazily read fields of the documents in this value. See Document::fillCache().
+    void fillCache() const;
+
     /**
      * Calculate a hash value.
      *
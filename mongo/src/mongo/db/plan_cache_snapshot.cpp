@@ -0,0 +1,298 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/plan_cache_snapshot.h"
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/commands/plan_cache_commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/cached_plan.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/transitional_tools_do_not_use/vector_spooling.h"
+
+namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(planCacheSnapshotEnabled, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(planCacheSnapshotIntervalSecs, int, 300);
+
+const NamespaceString PlanCacheSnapshot::kNss("local", "system.plan_cache");
+
+namespace {
+
+/**
+ * Appends the name and key pattern of each index used by 'tree' to 'indexes'.
+ */
+void appendIndexes(const PlanCacheIndexTree* tree, BSONArrayBuilder* indexes) {
+    if (tree->entry) {
+        indexes->append(BSON("name" << tree->entry->name << "key" << tree->entry->keyPattern));
+    }
+    for (auto&& child : tree->children) {
+        appendIndexes(child, indexes);
+    }
+}
+
+BSONArray indexesOf(const SolutionCacheData& cacheData) {
+    BSONArrayBuilder indexes;
+    if (cacheData.tree) {
+        appendIndexes(cacheData.tree.get(), &indexes);
+    }
+    return indexes.arr();
+}
+
+/**
+ * Adds the plan saved in 'doc' to the plan cache of its collection. Returns whether it was added.
+ */
+bool loadPlan(OperationContext* opCtx, const BSONObj& doc) {
+    const NamespaceString nss(doc["ns"].str());
+    AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+    Collection* collection = autoColl.getCollection();
+    if (!collection) {
+        return false;
+    }
+
+    auto statusWithCQ = PlanCacheCommand::canonicalize(opCtx, nss.ns(), doc);
+    if (!statusWithCQ.isOK()) {
+        return false;
+    }
+    std::unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    PlanCache* planCache = collection->infoCache()->getPlanCache();
+    if (!PlanCache::shouldCacheQuery(*cq) || planCache->contains(*cq)) {
+        return false;
+    }
+
+    QueryPlannerParams plannerParams;
+    fillOutPlannerParams(opCtx, collection, cq.get(), &plannerParams);
+    std::vector<QuerySolution*> rawSolutions;
+    if (!QueryPlanner::plan(*cq, plannerParams, &rawSolutions).isOK()) {
+        return false;
+    }
+    std::vector<std::unique_ptr<QuerySolution>> solutions =
+        transitional_tools_do_not_use::spool_vector(rawSolutions);
+
+    // The description of a solution names the indexes it uses, so only a solution using indexes
+    // of the same names and key patterns as when it was saved matches.
+    const std::string savedSolution = doc["solution"].str();
+    const BSONObj savedIndexes = doc["indexes"].Obj();
+    for (auto&& solution : solutions) {
+        if (!solution->cacheData || solution->cacheData->toString() != savedSolution ||
+            !SimpleBSONObjComparator::kInstance.evaluate(indexesOf(*solution->cacheData) ==
+                                                         savedIndexes)) {
+            continue;
+        }
+
+        // The decision only needs to carry the works the plan was picked with, against which the
+        // CachedPlanStage decides whether to replan.
+        auto decision = stdx::make_unique<PlanRankingDecision>();
+        CommonStats common(CachedPlanStage::kStageType);
+        common.works = doc["works"].numberLong();
+        decision->stats.push_back(stdx::make_unique<PlanStageStats>(common, STAGE_CACHED_PLAN));
+        decision->scores.push_back(doc["score"].numberDouble());
+        decision->candidateOrder.push_back(0);
+
+        return planCache
+            ->add(*cq,
+                  {solution.get()},
+                  decision.release(),
+                  opCtx->getServiceContext()->getPreciseClockSource()->now())
+            .isOK();
+    }
+
+    return false;
+}
+
+}  // namespace
+
+void PlanCacheSnapshot::save(OperationContext* opCtx) {
+    // Each snapshot is tagged, so that the previous one is only removed once the new one is
+    // written, and a failed save leaves it in place.
+    const OID snapshotId = OID::gen();
+    std::vector<BSONObj> docs;
+
+    std::vector<std::string> dbNames;
+    opCtx->getServiceContext()->getGlobalStorageEngine()->listDatabases(&dbNames);
+    for (auto&& dbName : dbNames) {
+        if (dbName == NamespaceString::kLocalDb) {
+            continue;
+        }
+
+        AutoGetDb autoDb(opCtx, dbName, MODE_IS);
+        Database* db = autoDb.getDb();
+        if (!db) {
+            continue;
+        }
+
+        for (auto&& collection : *db) {
+            PlanCache* planCache = collection->infoCache()->getPlanCache();
+            for (PlanCacheEntry* rawEntry : planCache->getAllEntries()) {
+                std::unique_ptr<PlanCacheEntry> entry(rawEntry);
+                const SolutionCacheData* winner = entry->plannerData[0];
+
+                BSONObjBuilder doc;
+                doc.append("ns", collection->ns().ns());
+                doc.append("query", entry->query);
+                doc.append("sort", entry->sort);
+                doc.append("projection", entry->projection);
+                if (!entry->collation.isEmpty()) {
+                    doc.append("collation", entry->collation);
+                }
+                doc.append("solution", winner->toString());
+                doc.append("indexes", indexesOf(*winner));
+                doc.append("works",
+                           static_cast<long long>(entry->decision->stats[0]->common.works));
+                doc.append("score", entry->decision->scores[0]);
+                doc.append("snapshotId", snapshotId);
+                docs.push_back(doc.obj());
+            }
+        }
+    }
+
+    DBDirectClient client(opCtx);
+    if (!docs.empty()) {
+        client.insert(kNss.ns(), docs);
+        const std::string error = client.getLastError();
+        uassert(50607,
+                str::stream() << "failed to save the plan cache to " << kNss.ns() << ": " << error,
+                error.empty());
+    }
+    client.remove(kNss.ns(), BSON("snapshotId" << BSON("$ne" << snapshotId)));
+    LOG(1) << "saved " << docs.size() << " plan cache entries to " << kNss;
+}
+
+size_t PlanCacheSnapshot::load(OperationContext* opCtx) {
+    // Read the saved plans up front, so that no cursor is held while planning.
+    std::vector<BSONObj> docs;
+    {
+        DBDirectClient client(opCtx);
+        auto cursor = client.query(kNss.ns(), Query());
+        while (cursor->more()) {
+            docs.push_back(cursor->nextSafe().getOwned());
+        }
+    }
+
+    size_t numLoaded = 0;
+    for (auto&& doc : docs) {
+        try {
+            if (loadPlan(opCtx, doc)) {
+                ++numLoaded;
+            }
+        } catch (const DBException& ex) {
+            LOG(1) << "skipping saved plan " << redact(doc) << ": " << redact(ex.toStatus());
+        }
+    }
+
+    log() << "loaded " << numLoaded << " of " << docs.size() << " plans saved in " << kNss;
+    return numLoaded;
+}
+
+namespace {
+
+class PlanCacheSnapshotter : public BackgroundJob {
+public:
+    std::string name() const final {
+        return "PlanCacheSnapshotter";
+    }
+
+    void run() final {
+        Client::initThread(name().c_str());
+        AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+        bool loaded = false;
+        Date_t lastSave = Date_t::now();
+
+        while (!globalInShutdownDeprecated()) {
+            {
+                MONGO_IDLE_THREAD_BLOCK;
+                sleepsecs(1);
+            }
+
+            if (!planCacheSnapshotEnabled.load()) {
+                continue;
+            }
+
+            // If part of replSet but not in a readable state (e.g. during initial sync), skip.
+            auto replCoord = repl::getGlobalReplicationCoordinator();
+            const bool isReplSet =
+                replCoord->getReplicationMode() == repl::ReplicationCoordinator::modeReplSet;
+            if (isReplSet && !replCoord->getMemberState().readable()) {
+                continue;
+            }
+
+            const ServiceContext::UniqueOperationContext opCtx = cc().makeOperationContext();
+            try {
+                // The snapshot is only loaded at startup. The local database isn't replicated, so
+                // a node which steps up would only find the plans it saved itself, which a
+                // secondary keeps overwriting with whatever its reads cached.
+                if (!loaded) {
+                    PlanCacheSnapshot::load(opCtx.get());
+                    loaded = true;
+                }
+
+                if (Date_t::now() - lastSave >= Seconds(planCacheSnapshotIntervalSecs.load()) &&
+                    !lockedForWriting()) {
+                    PlanCacheSnapshot::save(opCtx.get());
+                    lastSave = Date_t::now();
+                }
+            } catch (const DBException& ex) {
+                warning() << "plan cache snapshot failed: " << redact(ex.toStatus());
+            }
+        }
+    }
+};
+
+// The global PlanCacheSnapshotter object is intentionally leaked, like the TTLMonitor.
+PlanCacheSnapshotter* planCacheSnapshotter = nullptr;
+
+}  // namespace
+
+void startPlanCacheSnapshotBackgroundJob() {
+    planCacheSnapshotter = new PlanCacheSnapshotter();
+    planCacheSnapshotter->go();
+}
+
+}  // namespace mongo
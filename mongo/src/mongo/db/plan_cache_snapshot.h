@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/namespace_string.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * The winning plans of the plan caches of all collections can be saved to a collection of the local
+ * database, so that a restarted node doesn't have to multi plan every query shape again while it
+ * warms up. The local database isn't replicated, so each node only ever loads the plans it saved
+ * itself.
+ */
+class PlanCacheSnapshot {
+public:
+    // The collection the plans are saved to. Each document holds the shape of a query, the
+    // description of its winning solution, the indexes that solution uses and the id of the
+    // snapshot it belongs to.
+    static const NamespaceString kNss;
+
+    /**
+     * Replaces the saved plans by the winning plans currently in the plan caches of all
+     * collections outside of the local database. The new plans are written before the old ones
+     * are removed, so the old ones stay if writing fails.
+     */
+    static void save(OperationContext* opCtx);
+
+    /**
+     * Adds the saved plans to the plan caches of their collections. A saved plan is skipped if its
+     * query shape is already cached, or if planning the shape again no longer yields a solution
+     * which matches it on the current indexes.
+     *
+     * Returns the number of plans added.
+     */
+    static size_t load(OperationContext* opCtx);
+};
+
+/**
+ * Starts the background job which periodically saves the plan caches once planCacheSnapshotEnabled
+ * is set, and loads them once the node is first readable.
+ */
+void startPlanCacheSnapshotBackgroundJob();
+
+}  // namespace mongo
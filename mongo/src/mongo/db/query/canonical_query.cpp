@@ -319,6 +319,9 @@ void CanonicalQuery::setCollator(std::unique_ptr<CollatorInterface> collator) {
     // the object owned by '_collator'. We must associate the match expression tree with the new
     // value of '_collator'.
     _root->setCollator(_collator.get());
+
+    // Index compatibility, and so the plan cache key, depends on the collator.
+    _planCacheKeyEpoch = 0;
 }
 
 // static
@@ -191,6 +191,9 @@ public:
     }
 
 private:
+    // Memoizes its cache key in the query.
+    friend class PlanCache;
+
     // You must go through canonicalize to create a CanonicalQuery.
     CanonicalQuery() {}
 
@@ -227,6 +230,13 @@ private:
     //̵߳Ķ$isolate̶֤߳ȡδύݡ
     //$isolate֤⣬Ϊ̳߳ʱϳصӰmongoĲԡ
     bool _isIsolated;
+
+    // The plan cache key of this query and its hash, memoized by the PlanCache of the collection.
+    // Only valid while '_planCacheKeyEpoch' is the epoch of the index state the cache keys depend
+    // on. Zero means the key wasn't computed.
+    mutable std::string _planCacheKey;
+    mutable size_t _planCacheKeyHash = 0;
+    mutable unsigned long long _planCacheKeyEpoch = 0;
 };
 
 }  // namespace mongo
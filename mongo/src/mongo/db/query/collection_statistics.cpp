@@ -0,0 +1,205 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+
+namespace mongo {
+
+//
+// IndexStatistics
+//
+
+// static
+IndexStatistics IndexStatistics::make(const BSONObj& keyPattern,
+                                      std::vector<BSONObj> leadingValues,
+                                      long long numDocsSampled,
+                                      long long numRecords,
+                                      size_t maxBuckets) {
+    invariant(maxBuckets > 0);
+
+    IndexStatistics stats;
+    stats._keyPattern = keyPattern.getOwned();
+    stats._numRecords = numRecords;
+    stats._numDocsSampled = numDocsSampled;
+    stats._numKeysSampled = static_cast<long long>(leadingValues.size());
+
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+    std::sort(leadingValues.begin(), leadingValues.end(), comparator.makeLessThan());
+
+    // Fill each bucket up to an equal share of the sample, without splitting the keys of a value
+    // across buckets.
+    const long long depth =
+        std::max(1LL, (stats._numKeysSampled + static_cast<long long>(maxBuckets) - 1) /
+                     static_cast<long long>(maxBuckets));
+    long long numSingletons = 0;
+    for (size_t i = 0; i < leadingValues.size();) {
+        size_t end = i + 1;
+        while (end < leadingValues.size() &&
+               comparator.evaluate(leadingValues[end] == leadingValues[i])) {
+            ++end;
+        }
+
+        if (stats._buckets.empty() || stats._buckets.back().numKeys >= depth) {
+            stats._buckets.push_back({leadingValues[i].getOwned(), BSONObj(), 0, 0});
+        }
+        Bucket& bucket = stats._buckets.back();
+        bucket.upperBound = leadingValues[i].getOwned();
+        bucket.numKeys += end - i;
+        ++bucket.numDistinct;
+
+        ++stats._numDistinctSampled;
+        if (1 == end - i) {
+            ++numSingletons;
+        }
+        i = end;
+    }
+
+    // A sample of the whole collection saw every value. Otherwise, use the GEE estimator: the
+    // values seen more than once are likely the only such values, while each value seen once
+    // stands for sqrt(N / n) values of the collection.
+    const double numKeys = numRecords * stats.getKeysPerDocument();
+    if (numDocsSampled >= numRecords || 0 == stats._numKeysSampled) {
+        stats._numDistinct = stats._numDistinctSampled;
+    } else {
+        const double estimate = std::sqrt(numKeys / stats._numKeysSampled) * numSingletons +
+            (stats._numDistinctSampled - numSingletons);
+        stats._numDistinct =
+            std::max(static_cast<double>(stats._numDistinctSampled), std::min(numKeys, estimate));
+    }
+
+    return stats;
+}
+
+bool IndexStatistics::isStale(long long numRecords, double maxChange) const {
+    return std::abs(static_cast<double>(numRecords - _numRecords)) >
+        maxChange * std::max(_numRecords, 1LL);
+}
+
+double IndexStatistics::estimateSelectivity(const OrderedIntervalList& oil) const {
+    if (0 == _numKeysSampled) {
+        return 0.0;
+    }
+
+    // How many distinct values of the collection each distinct value of the sample stands for.
+    const double distinctScale =
+        _numDistinctSampled ? std::max(1.0, _numDistinct / _numDistinctSampled) : 1.0;
+
+    double numKeys = 0.0;
+    for (auto&& interval : oil.intervals) {
+        BSONElement low = interval.start;
+        BSONElement high = interval.end;
+        if (low.woCompare(high, false) > 0) {
+            std::swap(low, high);
+        }
+        const bool isPoint = 0 == low.woCompare(high, false);
+
+        for (auto&& bucket : _buckets) {
+            const BSONElement lower = bucket.lowerBound.firstElement();
+            const BSONElement upper = bucket.upperBound.firstElement();
+            if (upper.woCompare(low, false) < 0 || lower.woCompare(high, false) > 0) {
+                continue;
+            }
+
+            if (isPoint) {
+                // A bucket of a single value holds all of its keys.
+                if (1 == bucket.numDistinct) {
+                    numKeys += bucket.numKeys;
+                } else {
+                    numKeys += bucket.numKeys / (bucket.numDistinct * distinctScale);
+                }
+            } else if (lower.woCompare(low, false) >= 0 && upper.woCompare(high, false) <= 0) {
+                numKeys += bucket.numKeys;
+            } else {
+                // The values of a bucket can't be interpolated, assume half of it overlaps.
+                numKeys += bucket.numKeys / 2.0;
+            }
+        }
+    }
+
+    return std::min(1.0, numKeys / _numKeysSampled);
+}
+
+BSONObj IndexStatistics::toBSON() const {
+    BSONObjBuilder bob;
+    bob.append("keyPattern", _keyPattern);
+    bob.appendNumber("numRecords", _numRecords);
+    bob.appendNumber("numDocsSampled", _numDocsSampled);
+    bob.appendNumber("numKeysSampled", _numKeysSampled);
+    bob.append("keysPerDocument", getKeysPerDocument());
+    bob.append("numDistinct", _numDistinct);
+
+    BSONArrayBuilder histogramBuilder(bob.subarrayStart("histogram"));
+    for (auto&& bucket : _buckets) {
+        BSONObjBuilder bucketBuilder(histogramBuilder.subobjStart());
+        bucketBuilder.appendAs(bucket.lowerBound.firstElement(), "lowerBound");
+        bucketBuilder.appendAs(bucket.upperBound.firstElement(), "upperBound");
+        bucketBuilder.appendNumber("numKeys", bucket.numKeys);
+        bucketBuilder.appendNumber("numDistinct", bucket.numDistinct);
+    }
+    histogramBuilder.doneFast();
+
+    return bob.obj();
+}
+
+//
+// CollectionStatistics
+//
+
+std::shared_ptr<const IndexStatistics> CollectionStatistics::get(StringData indexName) const {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    auto it = _indexStats.find(indexName);
+    if (it == _indexStats.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void CollectionStatistics::set(StringData indexName, std::shared_ptr<const IndexStatistics> stats) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _indexStats[indexName] = std::move(stats);
+}
+
+void CollectionStatistics::remove(StringData indexName) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _indexStats.erase(indexName);
+}
+
+size_t CollectionStatistics::size() const {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    return _indexStats.size();
+}
+
+}  // namespace mongo
@@ -0,0 +1,173 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+/**
+ * Statistics about the keys of one index, estimated from a sample of the documents of its
+ * collection. Built by the analyze command and immutable afterwards.
+ *
+ * Besides the number of keys per document, they consist of an equi-depth histogram of the values
+ * of the leading field of the index, and an estimate of how many distinct values it has.
+ */
+class IndexStatistics {
+public:
+    /**
+     * A bucket of the histogram. Holds the sampled keys whose leading field lies within
+     * ['lowerBound', 'upperBound']. Like index keys, the bounds have a single field with an
+     * empty name. All the keys with a given value belong to the same bucket.
+     */
+    struct Bucket {
+        BSONObj lowerBound;
+        BSONObj upperBound;
+        long long numKeys;
+        long long numDistinct;
+    };
+
+    /**
+     * Builds the statistics of the index 'keyPattern' from 'leadingValues', the leading fields of
+     * the keys generated for 'numDocsSampled' documents out of the 'numRecords' in the
+     * collection, shaped like the bounds of a bucket. The histogram has at most 'maxBuckets'
+     * buckets.
+     */
+    static IndexStatistics make(const BSONObj& keyPattern,
+                                std::vector<BSONObj> leadingValues,
+                                long long numDocsSampled,
+                                long long numRecords,
+                                size_t maxBuckets);
+
+    /**
+     * Estimates the fraction of the keys of the index whose leading field lies within 'oil',
+     * which is in the order of either the index or its reverse.
+     */
+    double estimateSelectivity(const OrderedIntervalList& oil) const;
+
+    const BSONObj& getKeyPattern() const {
+        return _keyPattern;
+    }
+
+    long long getNumDocsSampled() const {
+        return _numDocsSampled;
+    }
+
+    long long getNumKeysSampled() const {
+        return _numKeysSampled;
+    }
+
+    /**
+     * The number of records in the collection when the statistics were built.
+     */
+    long long getNumRecords() const {
+        return _numRecords;
+    }
+
+    /**
+     * Returns true if the collection's record count has since moved from getNumRecords() by more
+     * than the fraction 'maxChange' of it, a sign that the histogram no longer describes the
+     * collection and that the analyze command should be run again.
+     */
+    bool isStale(long long numRecords, double maxChange) const;
+
+    /**
+     * The average number of keys a document has in the index, above one if it is multikey and
+     * below one if it is sparse.
+     */
+    double getKeysPerDocument() const {
+        return _numDocsSampled ? static_cast<double>(_numKeysSampled) / _numDocsSampled : 0.0;
+    }
+
+    /**
+     * The estimated number of distinct values of the leading field in the whole collection.
+     */
+    double getNumDistinct() const {
+        return _numDistinct;
+    }
+
+    const std::vector<Bucket>& getBuckets() const {
+        return _buckets;
+    }
+
+    BSONObj toBSON() const;
+
+private:
+    IndexStatistics() = default;
+
+    BSONObj _keyPattern;
+    long long _numRecords = 0;
+    long long _numDocsSampled = 0;
+    long long _numKeysSampled = 0;
+    long long _numDistinctSampled = 0;
+    double _numDistinct = 0.0;
+    std::vector<Bucket> _buckets;
+};
+
+/**
+ * The statistics collected for the indexes of a collection, by index name. Safe for concurrent
+ * use.
+ */
+class CollectionStatistics {
+    MONGO_DISALLOW_COPYING(CollectionStatistics);
+
+public:
+    CollectionStatistics() = default;
+
+    /**
+     * Returns the statistics of the index 'indexName', or null if none were collected.
+     */
+    std::shared_ptr<const IndexStatistics> get(StringData indexName) const;
+
+    /**
+     * Adds or replaces the statistics of the index 'indexName'.
+     */
+    void set(StringData indexName, std::shared_ptr<const IndexStatistics> stats);
+
+    /**
+     * Drops the statistics of the index 'indexName', if any.
+     */
+    void remove(StringData indexName);
+
+    size_t size() const;
+
+private:
+    mutable stdx::mutex _mutex;
+    StringMap<std::shared_ptr<const IndexStatistics>> _indexStats;
+};
+
+}  // namespace mongo
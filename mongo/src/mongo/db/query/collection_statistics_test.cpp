@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/collection_statistics.h
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::vector<BSONObj> leadingValues(const std::vector<int>& values) {
+    std::vector<BSONObj> out;
+    for (int value : values) {
+        out.push_back(BSON("" << value));
+    }
+    return out;
+}
+
+std::vector<int> range(int begin, int end) {
+    std::vector<int> out;
+    for (int i = begin; i < end; ++i) {
+        out.push_back(i);
+    }
+    return out;
+}
+
+OrderedIntervalList makeOil(const BSONObj& bounds, bool startInclusive, bool endInclusive) {
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(Interval(bounds, startInclusive, endInclusive));
+    return oil;
+}
+
+IndexStatistics makeStats(const std::vector<int>& values,
+                          long long numDocsSampled,
+                          long long numRecords) {
+    return IndexStatistics::make(
+        fromjson("{a: 1}"), leadingValues(values), numDocsSampled, numRecords, 10);
+}
+
+TEST(IndexStatisticsTest, BucketsOfUniformValuesHaveEqualDepth) {
+    auto stats = makeStats(range(0, 100), 100, 100);
+    ASSERT_EQ(10U, stats.getBuckets().size());
+    for (auto&& bucket : stats.getBuckets()) {
+        ASSERT_EQ(10, bucket.numKeys);
+        ASSERT_EQ(10, bucket.numDistinct);
+    }
+    ASSERT_EQ(1.0, stats.getKeysPerDocument());
+}
+
+TEST(IndexStatisticsTest, RangeSelectivityOfUniformValues) {
+    auto stats = makeStats(range(0, 100), 100, 100);
+    auto selectivity = [&](const BSONObj& bounds) {
+        return stats.estimateSelectivity(makeOil(bounds, true, true));
+    };
+    ASSERT_APPROX_EQUAL(0.5, selectivity(BSON("" << 0 << "" << 49)), 0.01);
+    ASSERT_APPROX_EQUAL(1.0, selectivity(BSON("" << MINKEY << "" << MAXKEY)), 0.01);
+    ASSERT_EQ(0.0, selectivity(BSON("" << 500 << "" << 600)));
+}
+
+TEST(IndexStatisticsTest, ReversedIntervalHasSameSelectivity) {
+    auto stats =
+        IndexStatistics::make(fromjson("{a: -1}"), leadingValues(range(0, 100)), 100, 100, 10);
+    ASSERT_EQ(stats.estimateSelectivity(makeOil(BSON("" << 0 << "" << 49), true, true)),
+              stats.estimateSelectivity(makeOil(BSON("" << 49 << "" << 0), true, true)));
+}
+
+TEST(IndexStatisticsTest, PointSelectivityOfFrequentValue) {
+    std::vector<int> values(90, 7);
+    auto others = range(100, 110);
+    values.insert(values.end(), others.begin(), others.end());
+
+    auto stats = makeStats(values, 100, 100);
+    ASSERT_APPROX_EQUAL(
+        0.9, stats.estimateSelectivity(makeOil(BSON("" << 7 << "" << 7), true, true)), 0.01);
+    ASSERT_APPROX_EQUAL(
+        0.01, stats.estimateSelectivity(makeOil(BSON("" << 105 << "" << 105), true, true)), 0.01);
+}
+
+TEST(IndexStatisticsTest, NumDistinctIsExactForFullSample) {
+    std::vector<int> values = range(0, 50);
+    auto again = range(0, 50);
+    values.insert(values.end(), again.begin(), again.end());
+
+    auto stats = makeStats(values, 100, 100);
+    ASSERT_EQ(50.0, stats.getNumDistinct());
+}
+
+TEST(IndexStatisticsTest, NumDistinctIsScaledUpForPartialSample) {
+    // Each value sampled once out of a hundred times as many keys stands for ten values.
+    auto stats = makeStats(range(0, 100), 100, 10000);
+    ASSERT_APPROX_EQUAL(1000.0, stats.getNumDistinct(), 0.01);
+}
+
+TEST(IndexStatisticsTest, MultikeyIndexHasSeveralKeysPerDocument) {
+    auto stats = makeStats(range(0, 30), 10, 10);
+    ASSERT_EQ(3.0, stats.getKeysPerDocument());
+}
+
+TEST(IndexStatisticsTest, EmptySample) {
+    auto stats = IndexStatistics::make(fromjson("{a: 1}"), {}, 0, 0, 10);
+    ASSERT_EQ(0U, stats.getBuckets().size());
+    ASSERT_EQ(0.0, stats.estimateSelectivity(makeOil(BSON("" << 0 << "" << 49), true, true)));
+}
+
+TEST(CollectionStatisticsTest, SetGetAndRemove) {
+    CollectionStatistics collStats;
+    ASSERT_FALSE(collStats.get("a_1"));
+
+    collStats.set("a_1", std::make_shared<IndexStatistics>(makeStats(range(0, 10), 10, 10)));
+    ASSERT_EQ(1U, collStats.size());
+    auto stats = collStats.get("a_1");
+    ASSERT(stats);
+    ASSERT_EQ(10, stats->getNumKeysSampled());
+    ASSERT_FALSE(collStats.get("b_1"));
+
+    collStats.remove("a_1");
+    ASSERT_FALSE(collStats.get("a_1"));
+    ASSERT_EQ(0U, collStats.size());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -46,6 +46,7 @@ const char kExplainField[] = "explain";
 const char kCommentField[] = "comment";
 const char kMaxTimeMSField[] = "maxTimeMS";
 const char kReadConcernField[] = "readConcern";
+const char kApproximateField[] = "approximate";
 }  // namespace
 
 CountRequest::CountRequest(NamespaceString nss, BSONObj query)
@@ -137,6 +138,13 @@ StatusWith<CountRequest> CountRequest::parseFromBSON(const NamespaceString& nss,
         return Status(ErrorCodes::BadValue, "comment value is not a string");
     }
 
+    // Approximate
+    if (BSONType::Bool == cmdObj[kApproximateField].type()) {
+        request.setApproximate(cmdObj[kApproximateField].boolean());
+    } else if (cmdObj[kApproximateField].ok()) {
+        return Status(ErrorCodes::BadValue, "approximate value is not a boolean");
+    }
+
 
     // Explain
     request.setExplain(isExplain);
@@ -94,6 +94,14 @@ public:
         _explain = explain;
     }
 
+    bool isApproximate() const {
+        return _approximate;
+    }
+
+    void setApproximate(bool approximate) {
+        _approximate = approximate;
+    }
+
     const std::string& getComment() const {
         return _comment;
     }
@@ -175,6 +183,9 @@ private:
 
     // If true, generate an explain plan instead of the actual count.
     bool _explain = false;
+
+    // If true, the count may be estimated from a sample of the collection.
+    bool _approximate = false;
 };
 
 }  // namespace mongo
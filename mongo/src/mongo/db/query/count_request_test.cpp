@@ -67,6 +67,7 @@ TEST(CountRequest, ParseDefaults) {
     ASSERT(countRequest.getReadConcern().isEmpty());
     ASSERT(countRequest.getUnwrappedReadPref().isEmpty());
     ASSERT(countRequest.getComment().empty());
+    ASSERT_FALSE(countRequest.isApproximate());
 }
 
 TEST(CountRequest, ParseComplete) {
@@ -200,6 +201,37 @@ TEST(CountRequest, FailParseBadCollationValue) {
     ASSERT_EQUALS(countRequestStatus.getStatus(), ErrorCodes::BadValue);
 }
 
+TEST(CountRequest, ParseApproximate) {
+    const bool isExplain = false;
+    const auto countRequestStatus =
+        CountRequest::parseFromBSON(testns,
+                                    BSON("count"
+                                         << "TestColl"
+                                         << "query"
+                                         << BSON("a" << BSON("$gte" << 11))
+                                         << "approximate"
+                                         << true),
+                                    isExplain);
+
+    ASSERT_OK(countRequestStatus.getStatus());
+    ASSERT_TRUE(countRequestStatus.getValue().isApproximate());
+}
+
+TEST(CountRequest, FailParseBadApproximateValue) {
+    const bool isExplain = false;
+    const auto countRequestStatus =
+        CountRequest::parseFromBSON(testns,
+                                    BSON("count"
+                                         << "TestColl"
+                                         << "query"
+                                         << BSON("a" << BSON("$gte" << 11))
+                                         << "approximate"
+                                         << 1),
+                                    isExplain);
+
+    ASSERT_EQUALS(countRequestStatus.getStatus(), ErrorCodes::BadValue);
+}
+
 TEST(CountRequest, ConvertToAggregationWithHint) {
     CountRequest countRequest(testns, BSONObj());
     countRequest.setHint(BSON("x" << 1));
@@ -157,9 +157,15 @@ size_t getDocsExamined(StageType type, const SpecificStats* specific) {
     } else if (STAGE_FETCH == type) {
         const FetchStats* spec = static_cast<const FetchStats*>(specific);
         return spec->docsExamined;
+    } else if (STAGE_GATHER == type) {
+        const GatherStats* spec = static_cast<const GatherStats*>(specific);
+        return spec->docsTested;
     } else if (STAGE_IDHACK == type) {
         const IDHackStats* spec = static_cast<const IDHackStats*>(specific);
         return spec->docsExamined;
+    } else if (STAGE_SORT == type) {
+        const SortStats* spec = static_cast<const SortStats*>(specific);
+        return spec->lateFetches + spec->lateFetchDrops;
     } else if (STAGE_TEXT_OR == type) {
         const TextOrStats* spec = static_cast<const TextOrStats*>(specific);
         return spec->fetches;
@@ -361,6 +367,8 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+            bob->appendBool("recordIdsOnly", spec->recordIdsOnly);
+            bob->appendNumber("filterRejects", spec->filterRejects);
 
             bob->appendNumber("flaggedButPassed", spec->flaggedButPassed);
             bob->appendNumber("flaggedInProgress", spec->flaggedInProgress);
@@ -386,6 +394,9 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         }
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->docsTested);
+            if (!stats.common.filter.isEmpty()) {
+                bob->append("filterPath", spec->columnarFilter ? "columnar" : "matcher");
+            }
         }
     } else if (STAGE_COUNT == stats.stageType) {
         CountStats* spec = static_cast<CountStats*>(stats.specific.get());
@@ -393,6 +404,11 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("nCounted", spec->nCounted);
             bob->appendNumber("nSkipped", spec->nSkipped);
+            if (spec->approximate) {
+                bob->appendNumber("nSampled", spec->nSampled);
+                bob->appendNumber("nSampleMatched", spec->nSampleMatched);
+                bob->appendNumber("errorBound", spec->errorBound);
+            }
         }
     } else if (STAGE_COUNT_SCAN == stats.stageType) {
         CountScanStats* spec = static_cast<CountScanStats*>(stats.specific.get());
@@ -466,6 +482,14 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->docsExamined);
             bob->appendNumber("alreadyHasObj", spec->alreadyHasObj);
+            bob->appendNumber("prefetched", spec->prefetched);
+        }
+    } else if (STAGE_GATHER == stats.stageType) {
+        GatherStats* spec = static_cast<GatherStats*>(stats.specific.get());
+        if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
+            bob->appendNumber("partitions", spec->partitions);
+            bob->appendNumber("rounds", spec->rounds);
+            bob->appendNumber("docsExamined", spec->docsTested);
         }
     } else if (STAGE_GEO_NEAR_2D == stats.stageType || STAGE_GEO_NEAR_2DSPHERE == stats.stageType) {
         NearStats* spec = static_cast<NearStats*>(stats.specific.get());
@@ -495,6 +519,7 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         }
     } else if (STAGE_IDHACK == stats.stageType) {
         IDHackStats* spec = static_cast<IDHackStats*>(stats.specific.get());
+        bob->append("indexName", spec->indexName);
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("keysExamined", spec->keysExamined);
             bob->appendNumber("docsExamined", spec->docsExamined);
@@ -523,6 +548,10 @@ void Explain::statsToBSON(const PlanStageStats& stats,
             bob->append("indexBounds", spec->indexBounds);
         }
 
+        if (spec->isSkipScan) {
+            bob->appendBool("isSkipScan", true);
+        }
+
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("keysExamined", spec->keysExamined);
             bob->appendNumber("seeks", spec->seeks);
@@ -560,6 +589,13 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+            bob->appendBool("usedDisk", spec->usedDisk);
+            if (spec->usedDisk) {
+                bob->appendNumber("spilledBytes", spec->spilledBytes);
+                bob->appendNumber("spilledRuns", spec->spilledRuns);
+            }
+            bob->appendNumber("lateFetches", spec->lateFetches);
+            bob->appendNumber("lateFetchDrops", spec->lateFetchDrops);
         }
 
         if (spec->limit > 0) {
@@ -573,6 +609,24 @@ void Explain::statsToBSON(const PlanStageStats& stats,
             bob->appendNumber("dupsTested", spec->dupsTested);
             bob->appendNumber("dupsDropped", spec->dupsDropped);
         }
+    } else if (STAGE_SUBPLAN == stats.stageType) {
+        SubplanStats* spec = static_cast<SubplanStats*>(stats.specific.get());
+
+        if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
+            bob->appendNumber("duplicateBranches", spec->duplicateBranches);
+            BSONArrayBuilder branchesBob(bob->subarrayStart("branches"));
+            for (auto&& branch : spec->branches) {
+                BSONObjBuilder branchBob(branchesBob.subobjStart());
+                branchBob.appendBool("fromCache", branch.fromCache);
+                if (branch.sameShapeAs >= 0) {
+                    branchBob.append("sameShapeAs", branch.sameShapeAs);
+                }
+                branchBob.appendNumber("candidates", branch.numCandidates);
+                branchBob.appendNumber("trialWorks", branch.trialWorks);
+                branchBob.appendNumber("planningMicros", branch.planningMicros);
+            }
+            branchesBob.doneFast();
+        }
     } else if (STAGE_TEXT == stats.stageType) {
         TextStats* spec = static_cast<TextStats*>(stats.specific.get());
 
@@ -915,6 +969,10 @@ void Explain::getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsO
     if (root->stageType() == STAGE_PIPELINE_PROXY) {
         auto pipelineProxy = static_cast<PipelineProxyStage*>(root);
         pipelineProxy->getPlanSummaryStats(statsOut);
+        // The cursor stage may have disposed of the plan its index bounds point into.
+        for (auto&& access : statsOut->indexAccesses) {
+            access.second.indexBounds = nullptr;
+        }
         return;
     }
 
@@ -931,6 +989,7 @@ void Explain::getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsO
 
     statsOut->totalKeysExamined = 0;
     statsOut->totalDocsExamined = 0;
+    statsOut->indexAccesses.clear();
 
     for (size_t i = 0; i < stages.size(); i++) {
         statsOut->totalKeysExamined +=
@@ -947,21 +1006,50 @@ void Explain::getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsO
             const IndexScanStats* ixscanStats =
                 static_cast<const IndexScanStats*>(ixscan->getSpecificStats());
             statsOut->indexesUsed.insert(ixscanStats->indexName);
+
+            auto& access = statsOut->indexAccesses[ixscanStats->indexName];
+            access.keysExamined += ixscanStats->keysExamined;
+            access.seeks += ixscanStats->seeks;
+            // The stats only hold the bounds once getStats() was called for explain.
+            if (!access.indexBounds) {
+                access.indexBounds = &ixscan->getBounds();
+            }
         } else if (STAGE_COUNT_SCAN == stages[i]->stageType()) {
             const CountScan* countScan = static_cast<const CountScan*>(stages[i]);
             const CountScanStats* countScanStats =
                 static_cast<const CountScanStats*>(countScan->getSpecificStats());
             statsOut->indexesUsed.insert(countScanStats->indexName);
+            statsOut->indexAccesses[countScanStats->indexName].keysExamined +=
+                countScanStats->keysExamined;
         } else if (STAGE_IDHACK == stages[i]->stageType()) {
             const IDHackStage* idHackStage = static_cast<const IDHackStage*>(stages[i]);
             const IDHackStats* idHackStats =
                 static_cast<const IDHackStats*>(idHackStage->getSpecificStats());
             statsOut->indexesUsed.insert(idHackStats->indexName);
+
+            auto& access = statsOut->indexAccesses[idHackStats->indexName];
+            access.keysExamined += idHackStats->keysExamined;
+            access.docsExamined += idHackStats->docsExamined;
         } else if (STAGE_DISTINCT_SCAN == stages[i]->stageType()) {
             const DistinctScan* distinctScan = static_cast<const DistinctScan*>(stages[i]);
             const DistinctScanStats* distinctScanStats =
                 static_cast<const DistinctScanStats*>(distinctScan->getSpecificStats());
             statsOut->indexesUsed.insert(distinctScanStats->indexName);
+
+            auto& access = statsOut->indexAccesses[distinctScanStats->indexName];
+            access.keysExamined += distinctScanStats->keysExamined;
+            if (!access.indexBounds) {
+                access.indexBounds = &distinctScan->getBounds();
+            }
+        } else if (STAGE_FETCH == stages[i]->stageType() &&
+                   STAGE_IXSCAN == stages[i]->getChildren()[0]->stageType()) {
+            // Charge the documents fetched for an index scan to its index.
+            const IndexScanStats* ixscanStats = static_cast<const IndexScanStats*>(
+                stages[i]->getChildren()[0]->getSpecificStats());
+            const FetchStats* fetchStats =
+                static_cast<const FetchStats*>(stages[i]->getSpecificStats());
+            statsOut->indexAccesses[ixscanStats->indexName].docsExamined +=
+                fetchStats->docsExamined;
         } else if (STAGE_TEXT == stages[i]->stageType()) {
             const TextStage* textStage = static_cast<const TextStage*>(stages[i]);
             const TextStats* textStats =
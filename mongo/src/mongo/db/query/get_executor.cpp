@@ -64,6 +64,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cost_estimator.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -71,8 +72,10 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_settings.h"
+#include "mongo/db/query/query_stats_store.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/db/repl/optime.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_sharding_state.h"
@@ -206,6 +209,10 @@ void fillOutPlannerParams(OperationContext* opCtx,
         plannerParams->options |= QueryPlannerParams::GENERATE_COVERED_IXSCANS;
     }
 
+    if (internalQueryPlannerMaxSkipScanPrefixFields.load() > 0) {
+        plannerParams->options |= QueryPlannerParams::GENERATE_SKIP_SCANS;
+    }
+
     plannerParams->options |= QueryPlannerParams::SPLIT_LIMITED_SORT;
 
     // Doc-level locking storage engines cannot answer predicates implicitly via exact index
@@ -229,6 +236,23 @@ void fillOutPlannerParams(OperationContext* opCtx,
 
 namespace {
 
+/**
+ * Returns true if a read of 'nss' may split its collection scan across several threads. Each
+ * thread reads from a storage engine snapshot of its own, which requires document-level locking
+ * and rules out read concerns that pin the read to a single snapshot.
+ */
+bool canScanInParallel(OperationContext* opCtx,
+                       const Collection* collection,
+                       const NamespaceString& nss) {
+    if (!collection || nss.isOplog() ||
+        internalQueryExecParallelCollectionScanDegree.load() <= 1 || !supportsDocLocking()) {
+        return false;
+    }
+    const auto level = repl::ReadConcernArgs::get(opCtx).getLevel();
+    return level == repl::ReadConcernLevel::kLocalReadConcern ||
+        level == repl::ReadConcernLevel::kAvailableReadConcern;
+}
+
 //prepareExecutionеóʼýṹ  ִQuerySolutionPlanStage.
 struct PrepareExecutionResult {
     PrepareExecutionResult(unique_ptr<CanonicalQuery> canonicalQuery,
@@ -307,6 +331,9 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
             std::move(canonicalQuery), std::move(querySolution), std::move(root));
     }
 
+    QueryStatsStore::noteQueryShape(
+        opCtx, *collection->infoCache()->getPlanCache(), *canonicalQuery);
+
     // Fill out the planning params.  We use these for both cached solutions and non-cached.
     QueryPlannerParams plannerParams;
     plannerParams.options = plannerOptions;
@@ -328,10 +355,28 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
 
     // If we have an _id index we can use an idhack plan.
     //_idѯ
-    if (descriptor && IDHackStage::supportsQuery(collection, *canonicalQuery)) {
+    const bool useIdHack = descriptor && IDHackStage::supportsQuery(collection, *canonicalQuery);
+
+    // Otherwise, equalities on every field of a unique index take the same fast path, unless an
+    // index filter restricts the indexes the query may use.
+    BSONObj uniqueIndexKey;
+    const IndexDescriptor* uniqueDescriptor = nullptr;
+    if (!useIdHack && internalQueryEnableUniqueIndexIdHack.load() &&
+        !plannerParams.indexFiltersApplied) {
+        uniqueDescriptor = IDHackStage::findUniqueIndexForQuery(
+            opCtx, collection, *canonicalQuery, &uniqueIndexKey);
+    }
+
+    if (useIdHack || uniqueDescriptor) {
         LOG(2) << "Using idhack: " << redact(canonicalQuery->toStringShort());
 
-        root = make_unique<IDHackStage>(opCtx, collection, canonicalQuery.get(), ws, descriptor);
+        if (useIdHack) {
+            root =
+                make_unique<IDHackStage>(opCtx, collection, canonicalQuery.get(), ws, descriptor);
+        } else {
+            root = make_unique<IDHackStage>(
+                opCtx, collection, canonicalQuery.get(), uniqueIndexKey, ws, uniqueDescriptor);
+        }
 
         // Might have to filter out orphaned docs.
         //˵¶ĵҲǲڸ÷Ƭĵ
@@ -498,6 +543,24 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         }
     }
 
+    // Leave out of plan ranking the candidates which the index statistics show to be far more
+    // expensive than another. The cost model assumes every result is consumed, so it is of no use
+    // when a limit may end the query early.
+    const auto& qr = canonicalQuery->getQueryRequest();
+    if (solutions.size() > 1 && internalQueryPlannerEnableCostBasedPruning.load() &&
+        !qr.getLimit() && !qr.getNToReturn()) {
+        PlanCostEstimator estimator(collection->infoCache()->getCollectionStatistics(),
+                                    collection->numRecords(opCtx),
+                                    internalQueryStatsMaxRecordCountChange.load());
+        const size_t numPruned =
+            estimator.pruneSolutions(&solutions, internalQueryPlannerCostPruningRatio.load());
+        if (numPruned > 0) {
+            LOG(2) << "Pruned " << numPruned << " of " << solutions.size() + numPruned
+                   << " candidate plans by estimated cost: "
+                   << redact(canonicalQuery->toStringShort());
+        }
+    }
+
 	//ǸQueryPlanner::planɵQuerySolutionPlanStage
     if (1 == solutions.size()) { //ֻһplan
         // Only one possible plan.  Run it.  Build the stages from the solution.
@@ -786,8 +849,21 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>>
 		//ƬģʽϸñǻͷڱƬݲӦڱƬɾ
         plannerOptions |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
-    return getExecutor( //pickBestPlanѡȡŵplan  CanonicalQueryõıʽ,getExecutorõյPlanExecutor
+
+    if (canScanInParallel(opCtx, collection, nss)) {
+        plannerOptions |= QueryPlannerParams::PARALLEL_COLLSCAN;
+    }
+
+    // Tailable and oplog cursors report their position after each result, so they can't read
+    // ahead of what they've returned.
+    const bool canBatch = !canonicalQuery->getQueryRequest().isTailable() && !nss.isOplog();
+
+    auto exec = getExecutor( //pickBestPlanѡȡŵplan  CanonicalQueryõıʽ,getExecutorõյPlanExecutor
         opCtx, collection, std::move(canonicalQuery), PlanExecutor::YIELD_AUTO, plannerOptions);
+    if (exec.isOK() && canBatch) {
+        exec.getValue()->enableBatchedExecution(internalQueryExecBatchSize.load());
+    }
+    return exec;
 }
 
 namespace {
@@ -1441,7 +1517,29 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorCount(
             opCtx, std::move(ws), std::move(root), request.getNs(), yieldPolicy);
     }
 
-    const size_t plannerOptions = QueryPlannerParams::IS_COUNT;
+    // An approximate count of a large collection tests a random sample of its documents against
+    // the query, rather than running the query. The count is then scaled up from the sample. $text
+    // and $near match every document outside of their index scans, so those are counted exactly.
+    const long long sampleSize = internalQueryExecApproximateCountSampleSize.load();
+    if (request.isApproximate() && sampleSize > 0 &&
+        collection->numRecords(opCtx) >= 10 * sampleSize &&
+        !QueryPlannerCommon::hasNode(cq->root(), MatchExpression::TEXT) &&
+        !QueryPlannerCommon::hasNode(cq->root(), MatchExpression::GEO_NEAR)) {
+        params.sampleCursor = collection->getRecordStore()->getRandomCursor(opCtx);
+        if (params.sampleCursor) {
+            params.sampleSize = sampleSize;
+            params.sampleFilter = cq->root();
+            unique_ptr<PlanStage> root =
+                make_unique<CountStage>(opCtx, collection, std::move(params), ws.get(), nullptr);
+            return PlanExecutor::make(
+                opCtx, std::move(ws), std::move(root), std::move(cq), collection, yieldPolicy);
+        }
+    }
+
+    size_t plannerOptions = QueryPlannerParams::IS_COUNT;
+    if (canScanInParallel(opCtx, collection, request.getNs())) {
+        plannerOptions |= QueryPlannerParams::PARALLEL_COLLSCAN;
+    }
     StatusWith<PrepareExecutionResult> executionResult =
         prepareExecution(opCtx, collection, ws.get(), std::move(cq), plannerOptions);
     if (!executionResult.isOK()) {
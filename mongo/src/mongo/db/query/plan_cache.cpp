@@ -33,6 +33,7 @@
 #include "mongo/db/query/plan_cache.h"
 
 #include <algorithm>
+#include <functional>
 #include <math.h>
 #include <memory>
 #include <vector>
@@ -46,6 +47,7 @@
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/transitional_tools_do_not_use/vector_spooling.h"
@@ -548,6 +550,10 @@ std::string SolutionCacheData::toString() const {
                                  << "tree=" << this->tree->toString() << ")";
         case COLLSCAN_SOLN:
             return "(collection scan)";
+        case SKIP_IXSCAN_SOLN:
+            verify(this->tree.get());
+            return str::stream() << "(skip scan solution: "
+                                 << "tree=" << this->tree->toString() << ")";
         case USE_INDEX_TAGS_SOLN:
             verify(this->tree.get());
             return str::stream() << "(index-tagged expression tree: "
@@ -560,9 +566,90 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+namespace {
+
+// How many stripes the cache of each collection is partitioned into.
+const size_t kNumCacheStripes = 16;
+
+// Source of the epochs identifying the index state of each plan cache. Starts above zero, which
+// marks a query without a memoized key.
+AtomicUInt64 nextIndexabilityEpoch(1);
+
+/**
+ * The counters summed over the plan caches of all collections. Constructed on first use, as they
+ * are registered with serverStatus during static initialization.
+ */
+PlanCacheCounters& globalCounters() {
+    static PlanCacheCounters counters;
+    return counters;
+}
+
+/**
+ * Returns 'proj' without its projections on $-prefixed fields. These are added by internal callers
+ * of the query system and are not considered part of the user projection.
+ */
+BSONObj userProjection(const BSONObj& proj) {
+    BSONObjBuilder projBuilder;
+    for (auto elem : proj) {
+        if (elem.fieldName()[0] == '$') {
+            continue;
+        }
+        projBuilder.append(elem);
+    }
+    return projBuilder.obj();
+}
+
+}  // namespace
+
+void PlanCacheCounters::appendTo(BSONObjBuilder* builder) const {
+    builder->append("hits", hits.get());
+    builder->append("misses", misses.get());
+    BSONObjBuilder replansBuilder(builder->subobjStart("replans"));
+    replansBuilder.append("worksExceeded", replansWorksExceeded.get());
+    replansBuilder.append("planFailed", replansPlanFailed.get());
+    replansBuilder.doneFast();
+    builder->append("multiPlans", multiPlans.get());
+    builder->append("multiPlanningMicros", multiPlanningMicros.get());
+    builder->append("trialWorks", trialWorks.get());
+}
+
+BSONObj PlanCacheShapeStats::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("query", query);
+    builder.append("sort", sort);
+    builder.append("projection", projection);
+    if (!collation.isEmpty()) {
+        builder.append("collation", collation);
+    }
+    builder.append("hits", hits);
+    builder.append("misses", misses);
+    builder.append("replans",
+                   BSON("worksExceeded" << replansWorksExceeded << "planFailed"
+                                        << replansPlanFailed));
+    builder.append("multiPlans", multiPlans);
+    builder.append("multiPlanningMicros", multiPlanningMicros);
+    builder.append("trialWorks", trialWorks);
+    return builder.obj();
+}
+
+// static
+const PlanCacheCounters& PlanCache::getGlobalCounters() {
+    return globalCounters();
+}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+PlanCache::PlanCache() : PlanCache("") {}
+
+PlanCache::PlanCache(const std::string& ns)
+    : _ns(ns), _indexabilityEpoch(nextIndexabilityEpoch.fetchAndAdd(1)) {
+    // Share internalQueryCacheSize out exactly, giving the remainder to the first stripes. A small
+    // cache has fewer stripes, so that none of them is too small to hold an entry.
+    const size_t maxSize = std::max(0, internalQueryCacheSize.load());
+    const size_t numStripes = std::max<size_t>(1, std::min(kNumCacheStripes, maxSize));
+    for (size_t i = 0; i < numStripes; ++i) {
+        const size_t stripeSize = maxSize / numStripes + (i < maxSize % numStripes ? 1 : 0);
+        _stripes.push_back(stdx::make_unique<Stripe>(stripeSize));
+    }
+}
 
 PlanCache::~PlanCache() {}
 
@@ -732,21 +819,13 @@ Status PlanCache::add(const CanonicalQuery& query,
         entry->collation = query.getCollator()->getSpec().toBSON();
     }
     entry->timeOfCreation = now;
+    entry->projection = userProjection(qr.getProj());
 
+    Stripe* stripe;
+    const PlanCacheKey& key = getKeyAndStripe(query, &stripe);
 
-    // Strip projections on $-prefixed fields, as these are added by internal callers of the query
-    // system and are not considered part of the user projection.
-    BSONObjBuilder projBuilder;
-    for (auto elem : qr.getProj()) {
-        if (elem.fieldName()[0] == '$') {
-            continue;
-        }
-        projBuilder.append(elem);
-    }
-    entry->projection = projBuilder.obj();
-
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+    std::unique_ptr<PlanCacheEntry> evictedEntry = stripe->cache.add(key, entry);
 
     if (NULL != evictedEntry.get()) {
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
@@ -761,18 +840,27 @@ Status PlanCache::add(const CanonicalQuery& query,
 //ԲοSubplanStage::planSubqueries    prepareExecutionеĵ÷ʽ
 //queryҶӦPlanCacheEntry PlanCache::addӣPlanCache::getȡ
 Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const {
-    PlanCacheKey key = computeKey(query);
     verify(crOut);
+    Stripe* stripe;
+    const PlanCacheKey& key = getKeyAndStripe(query, &stripe);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
     PlanCacheEntry* entry;
 	//_cacheӸkeyȡPlanCacheEntry
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = stripe->cache.get(key, &entry);
+    PlanCacheShapeStats* shapeStats = getShapeStats_inlock(stripe, key, query);
     if (!cacheStatus.isOK()) {
+        _counters.misses.increment();
+        globalCounters().misses.increment();
+        ++shapeStats->misses;
         return cacheStatus;
     }
     invariant(entry);
 
+    _counters.hits.increment();
+    globalCounters().hits.increment();
+    ++shapeStats->hits;
+
     *crOut = new CachedSolution(key, *entry);
 
     return Status::OK();
@@ -877,11 +965,12 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
         return Status(ErrorCodes::BadValue, "feedback is NULL");
     }
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
-    PlanCacheKey ck = computeKey(cq);
+    Stripe* stripe;
+    const PlanCacheKey& ck = getKeyAndStripe(cq, &stripe);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Status cacheStatus = stripe->cache.get(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -896,32 +985,53 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    Stripe* stripe;
+    const PlanCacheKey& key = getKeyAndStripe(canonicalQuery, &stripe);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+    return stripe->cache.remove(key);
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (auto&& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+        stripe->cache.clear();
+    }
 }
 
 //computeKey(cq)ΪgetPlansByQueryеĲѯdb.xx.getPlanCache().getPlansByQuery({"query" : {"create_time" : { "$gte" : "2020-12-27 00:00:00","$lte" : "2021-01-26 23:59:59"}},"sort" : { },"projection" : {}})
 //PlanCache::contains
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
-    StringBuilder keyBuilder;
-    encodeKeyForMatch(cq.root(), &keyBuilder);
-    encodeKeyForSort(cq.getQueryRequest().getSort(), &keyBuilder);
-    encodeKeyForProj(cq.getQueryRequest().getProj(), &keyBuilder);
-    return keyBuilder.str();
+    Stripe* stripe;
+    return getKeyAndStripe(cq, &stripe);
+}
+
+const PlanCacheKey& PlanCache::getKeyAndStripe(const CanonicalQuery& cq,
+                                               Stripe** stripeOut) const {
+    // Encoding the key walks the whole query, so it is done once per query for as long as the
+    // indexes the key depends on don't change.
+    if (cq._planCacheKeyEpoch != _indexabilityEpoch) {
+        StringBuilder keyBuilder;
+        encodeKeyForMatch(cq.root(), &keyBuilder);
+        encodeKeyForSort(cq.getQueryRequest().getSort(), &keyBuilder);
+        encodeKeyForProj(cq.getQueryRequest().getProj(), &keyBuilder);
+        cq._planCacheKey = keyBuilder.str();
+        cq._planCacheKeyHash = std::hash<std::string>()(cq._planCacheKey);
+        cq._planCacheKeyEpoch = _indexabilityEpoch;
+    }
+
+    *stripeOut = _stripes[cq._planCacheKeyHash % _stripes.size()].get();
+    return cq._planCacheKey;
 }
 
 Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOut) const {
-    PlanCacheKey key = computeKey(query);
     verify(entryOut);
+    Stripe* stripe;
+    const PlanCacheKey& key = getKeyAndStripe(query, &stripe);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = stripe->cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -934,12 +1044,14 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 
 //ȡеPlanCacheEntryϢ
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
     typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (auto&& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+        for (ConstIterator i = stripe->cache.begin(); i != stripe->cache.end(); i++) {
+            PlanCacheEntry* entry = i->second;
+            entries.push_back(entry->clone());
+        }
     }
 
     return entries;
@@ -948,19 +1060,96 @@ std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
 //computeKey(cq)ΪgetPlansByQueryеĲѯdb.xx.getPlanCache().getPlansByQuery({"query" : {"create_time" : { "$gte" : "2020-12-27 00:00:00","$lte" : "2021-01-26 23:59:59"}},"sort" : { },"projection" : {}})
 //鿴planǷcqPlanCacheListPlans::listе
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    Stripe* stripe;
+    const PlanCacheKey& key = getKeyAndStripe(cq, &stripe);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+    return stripe->cache.hasKey(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t size = 0;
+    for (auto&& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+        size += stripe->cache.size();
+    }
+    return size;
 }
 
 //CollectionInfoCacheImpl::updatePlanCacheIndexEntriesеã
 //CollectionInfoCacheImpl::updatePlanCacheIndexEntriesIndexEntryIndexDescriptorת
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
     _indexabilityState.updateDiscriminators(indexEntries);
+    _indexabilityEpoch = nextIndexabilityEpoch.fetchAndAdd(1);
+}
+
+void PlanCache::notifyOfReplan(const CanonicalQuery& cq, ReplanReason reason) {
+    Stripe* stripe;
+    const PlanCacheKey& key = getKeyAndStripe(cq, &stripe);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+    PlanCacheShapeStats* shapeStats = getShapeStats_inlock(stripe, key, cq);
+    switch (reason) {
+        case ReplanReason::WorksExceeded:
+            _counters.replansWorksExceeded.increment();
+            globalCounters().replansWorksExceeded.increment();
+            ++shapeStats->replansWorksExceeded;
+            break;
+        case ReplanReason::PlanFailed:
+            _counters.replansPlanFailed.increment();
+            globalCounters().replansPlanFailed.increment();
+            ++shapeStats->replansPlanFailed;
+            break;
+    }
+}
+
+void PlanCache::notifyOfMultiPlanning(const CanonicalQuery& cq, long long micros, long long works) {
+    _counters.multiPlans.increment();
+    _counters.multiPlanningMicros.increment(micros);
+    _counters.trialWorks.increment(works);
+    globalCounters().multiPlans.increment();
+    globalCounters().multiPlanningMicros.increment(micros);
+    globalCounters().trialWorks.increment(works);
+
+    Stripe* stripe;
+    const PlanCacheKey& key = getKeyAndStripe(cq, &stripe);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+    PlanCacheShapeStats* shapeStats = getShapeStats_inlock(stripe, key, cq);
+    ++shapeStats->multiPlans;
+    shapeStats->multiPlanningMicros += micros;
+    shapeStats->trialWorks += works;
+}
+
+std::vector<PlanCacheShapeStats> PlanCache::getShapeStats() const {
+    std::vector<PlanCacheShapeStats> shapeStats;
+    for (auto&& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> cacheLock(stripe->mutex);
+        for (auto&& keyAndStats : stripe->shapeStats) {
+            shapeStats.push_back(*keyAndStats.second);
+        }
+    }
+    return shapeStats;
+}
+
+PlanCacheShapeStats* PlanCache::getShapeStats_inlock(Stripe* stripe,
+                                                     const PlanCacheKey& key,
+                                                     const CanonicalQuery& cq) const {
+    PlanCacheShapeStats* shapeStats;
+    if (stripe->shapeStats.get(key, &shapeStats).isOK()) {
+        return shapeStats;
+    }
+
+    shapeStats = new PlanCacheShapeStats();
+    const QueryRequest& qr = cq.getQueryRequest();
+    shapeStats->query = qr.getFilter().getOwned();
+    shapeStats->sort = qr.getSort().getOwned();
+    shapeStats->projection = userProjection(qr.getProj());
+    if (cq.getCollator()) {
+        shapeStats->collation = cq.getCollator()->getSpec().toBSON();
+    }
+    stripe->shapeStats.add(key, shapeStats);
+    return shapeStats;
 }
 
 }  // namespace mongo
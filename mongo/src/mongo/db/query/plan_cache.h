@@ -28,9 +28,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <boost/optional/optional.hpp>
+#include <memory>
 #include <set>
+#include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
@@ -201,6 +205,10 @@ struct SolutionCacheData {
         //ȫɨ
         COLLSCAN_SOLN,   //οQueryPlanner::plan
 
+        // The plan skip scans the index stored in 'tree', see
+        // QueryPlannerAccess::makeSkipScan().
+        SKIP_IXSCAN_SOLN,
+
         // Build the solution by using 'tree'
         // to tag the match expression.
         //ߺѡSolutionCacheDataʹõĬֵ
@@ -520,6 +528,51 @@ public:
     std::vector<PlanCacheEntryFeedback*> feedback;
 };
 
+/**
+ * Counters of how a plan cache is used. Each collection's plan cache keeps a set, and so does the
+ * process for the plan caches of all collections. They are updated without taking any of the
+ * cache's locks, so that they can stay on in production.
+ */
+struct PlanCacheCounters {
+    void appendTo(BSONObjBuilder* builder) const;
+
+    // Lookups which found a cached plan, and lookups which did not.
+    Counter64 hits;
+    Counter64 misses;
+
+    // Cached plans which were replanned because their trial period needed more works than they
+    // were cached with, and cached plans which were replanned because they failed.
+    Counter64 replansWorksExceeded;
+    Counter64 replansPlanFailed;
+
+    // Runs of the multi planner, the time they took and the works spent in their trial periods.
+    Counter64 multiPlans;
+    Counter64 multiPlanningMicros;
+    Counter64 trialWorks;
+};
+
+/**
+ * The same counters for a single query shape. They are kept apart from the shape's cache entry,
+ * which a replan evicts, so that shapes flapping between plans show up as such.
+ */
+struct PlanCacheShapeStats {
+    BSONObj toBSON() const;
+
+    // The shape, as for PlanCacheEntry.
+    BSONObj query;
+    BSONObj sort;
+    BSONObj projection;
+    BSONObj collation;
+
+    long long hits = 0;
+    long long misses = 0;
+    long long replansWorksExceeded = 0;
+    long long replansPlanFailed = 0;
+    long long multiPlans = 0;
+    long long multiPlanningMicros = 0;
+    long long trialWorks = 0;
+};
+
 /**
  * Caches the best solution to a query.  Aside from the (CanonicalQuery -> QuerySolution)
  * mapping, the cache contains information on why that mapping was made and statistics on the
@@ -587,6 +640,22 @@ private:
     MONGO_DISALLOW_COPYING(PlanCache);
 
 public:
+    /**
+     * Why the CachedPlanStage gave up on a cached plan.
+     */
+    enum class ReplanReason {
+        // The trial period of the cached plan ran past the works it was cached with.
+        WorksExceeded,
+
+        // The cached plan failed during its trial period.
+        PlanFailed,
+    };
+
+    /**
+     * Returns the counters summed over the plan caches of all collections.
+     */
+    static const PlanCacheCounters& getGlobalCounters();
+
     /**
      * We don't want to cache every possible query. This function
      * encapsulates the criteria for what makes a canonical query
@@ -666,6 +735,9 @@ public:
      * This is provided in the public API simply as a convenience for consumers who need some
      * description of query shape (e.g. index filters).
      *
+     * The key is memoized in the query, and only computed again once the indexes of the
+     * collection change.
+     *
      * Callers must hold the collection lock when calling this method.
      */
     PlanCacheKey computeKey(const CanonicalQuery&) const;
@@ -709,18 +781,72 @@ public:
      */
     void notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries);
 
+    /**
+     * Records that the cached plan of 'cq' was replanned for 'reason'.
+     */
+    void notifyOfReplan(const CanonicalQuery& cq, ReplanReason reason);
+
+    /**
+     * Records that the multi planner ran for 'cq', taking 'micros' microseconds and 'works' works
+     * summed over all candidate plans.
+     */
+    void notifyOfMultiPlanning(const CanonicalQuery& cq, long long micros, long long works);
+
+    /**
+     * Returns the counters of this cache.
+     */
+    const PlanCacheCounters& getCounters() const {
+        return _counters;
+    }
+
+    /**
+     * Returns a copy of the counters of each query shape seen lately.
+     */
+    std::vector<PlanCacheShapeStats> getShapeStats() const;
+
 private:
+    /**
+     * A partition of the cache. Each query shape belongs to the stripe its key hashes to, so that
+     * queries of different shapes don't contend for a single mutex.
+     */
+    struct Stripe {
+        explicit Stripe(size_t maxSize)
+            : cache(maxSize), shapeStats(std::max<size_t>(1, 2 * maxSize)) {}
+
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry> cache;
+
+        // Outlives the entries of 'cache', hence twice its size. Holds at least one shape even
+        // when the cache is disabled, since the stats of a shape are updated right after adding it.
+        LRUKeyValue<PlanCacheKey, PlanCacheShapeStats> shapeStats;
+
+        // Protects 'cache' and 'shapeStats'.
+        stdx::mutex mutex;
+    };
+
+    /**
+     * Returns the cache key of 'cq', memoized in it, and sets 'stripeOut' to the stripe its entry
+     * belongs to.
+     */
+    const PlanCacheKey& getKeyAndStripe(const CanonicalQuery& cq, Stripe** stripeOut) const;
+
+    /**
+     * Returns the counters of the shape of 'cq', whose key is 'key', starting them if the shape
+     * isn't tracked yet. The caller must hold the mutex of 'stripe'.
+     */
+    PlanCacheShapeStats* getShapeStats_inlock(Stripe* stripe,
+                                              const PlanCacheKey& key,
+                                              const CanonicalQuery& cq) const;
+
     void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
-    
+
     //PlanCacheEntryPlanCacheKey浽֧LRU
     //ĳPlanCacheEntry, οPlanCache::get  PlanCache::getAllEntries()
     ////MultiPlanStage::pickBestPlanаѵ÷ָߵĺѡӵplancache
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
-
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    // The cache, partitioned by the hash of the key. The least recently used entry of a stripe is
+    // evicted once it holds its share of internalQueryCacheSize entries.
+    std::vector<std::unique_ptr<Stripe>> _stripes;
 
     // Full namespace of collection.
     std::string _ns;
@@ -731,6 +857,13 @@ private:
     // Concurrent access is synchronized by the collection lock.  Multiple concurrent readers
     // are allowed.
     PlanCacheIndexabilityState _indexabilityState;
+
+    // Identifies the current '_indexabilityState' among those of all plan caches, so that a query
+    // can tell whether the key it memoized is still valid. Synchronized like '_indexabilityState'.
+    unsigned long long _indexabilityEpoch;
+
+    // Mutable so that lookups, which are const, can count themselves.
+    mutable PlanCacheCounters _counters;
 };
 
 }  // namespace mongo
@@ -449,6 +449,159 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+// The key memoized in a query must not outlive a change to the indexes it depends on.
+TEST(PlanCacheTest, ComputeKeyAfterIndexesChange) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cqEqNull(canonicalize("{a: null}"));
+    const PlanCacheKey keyBefore = planCache.computeKey(*cqEqNull);
+    ASSERT_EQ(keyBefore, planCache.computeKey(*cqEqNull));
+
+    planCache.notifyOfIndexEntries({IndexEntry(BSON("a" << 1),
+                                               false,    // multikey
+                                               true,     // sparse
+                                               false,    // unique
+                                               "",       // name
+                                               nullptr,  // filterExpr
+                                               BSONObj())});
+
+    unique_ptr<CanonicalQuery> freshCqEqNull(canonicalize("{a: null}"));
+    ASSERT_NOT_EQUALS(keyBefore, planCache.computeKey(*cqEqNull));
+    ASSERT_EQ(planCache.computeKey(*freshCqEqNull), planCache.computeKey(*cqEqNull));
+}
+
+// Entries of many shapes are spread over the stripes of the cache, and found again.
+TEST(PlanCacheTest, AddManyShapes) {
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    const size_t numShapes = 100;
+    std::vector<unique_ptr<CanonicalQuery>> queries;
+    for (size_t i = 0; i < numShapes; ++i) {
+        queries.push_back(canonicalize(BSON("a" + std::to_string(i) << 1)));
+        ASSERT_OK(planCache.add(*queries.back(), solns, createDecision(1U), Date_t{}));
+    }
+
+    ASSERT_EQUALS(planCache.size(), numShapes);
+    for (auto&& cq : queries) {
+        ASSERT_TRUE(planCache.contains(*cq));
+    }
+
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ASSERT_EQUALS(entries.size(), numShapes);
+    for (auto entry : entries) {
+        delete entry;
+    }
+
+    ASSERT_OK(planCache.remove(*queries.front()));
+    ASSERT_FALSE(planCache.contains(*queries.front()));
+    ASSERT_EQUALS(planCache.size(), numShapes - 1);
+
+    planCache.clear();
+    ASSERT_EQUALS(planCache.size(), 0U);
+}
+
+// However the stripes divide it, the cache holds no more entries than internalQueryCacheSize.
+TEST(PlanCacheTest, StripesShareMaxSizeExactly) {
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    const int originalCacheSize = internalQueryCacheSize.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheSize.store(originalCacheSize); });
+
+    for (int maxSize : {1, 5, 20, 33}) {
+        internalQueryCacheSize.store(maxSize);
+        PlanCache planCache;
+
+        std::vector<unique_ptr<CanonicalQuery>> queries;
+        for (size_t i = 0; i < 100; ++i) {
+            queries.push_back(canonicalize(BSON("a" + std::to_string(i) << 1)));
+            ASSERT_OK(planCache.add(*queries.back(), solns, createDecision(1U), Date_t{}));
+            ASSERT_LTE(planCache.size(), static_cast<size_t>(maxSize));
+        }
+        ASSERT_GT(planCache.size(), 0U);
+    }
+}
+
+TEST(PlanCacheTest, ShapeStatsWithCacheDisabled) {
+    const int originalCacheSize = internalQueryCacheSize.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheSize.store(originalCacheSize); });
+    internalQueryCacheSize.store(0);
+
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    QueryTestServiceContext serviceContext;
+
+    CachedSolution* rawCS;
+    ASSERT_NOT_OK(planCache.get(*cqA, &rawCS));
+    planCache.notifyOfMultiPlanning(*cqA, 100, 20);
+    planCache.notifyOfReplan(*cqB, PlanCache::ReplanReason::PlanFailed);
+    planCache.notifyOfMultiPlanning(*cqB, 10, 2);
+    ASSERT_EQUALS(planCache.size(), 0U);
+
+    // Only the most recent shape is kept.
+    std::vector<PlanCacheShapeStats> shapeStats = planCache.getShapeStats();
+    ASSERT_EQUALS(shapeStats.size(), 1U);
+    ASSERT_BSONOBJ_EQ(shapeStats[0].query, fromjson("{b: 1}"));
+    ASSERT_EQUALS(shapeStats[0].replansPlanFailed, 1);
+    ASSERT_EQUALS(shapeStats[0].multiPlans, 1);
+    ASSERT_EQUALS(shapeStats[0].trialWorks, 2);
+}
+
+TEST(PlanCacheTest, CountersAndShapeStats) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    const long long globalHits = PlanCache::getGlobalCounters().hits.get();
+    const long long globalMisses = PlanCache::getGlobalCounters().misses.get();
+
+    CachedSolution* rawCS;
+    ASSERT_NOT_OK(planCache.get(*cq, &rawCS));
+    planCache.notifyOfMultiPlanning(*cq, 100, 20);
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    ASSERT_OK(planCache.get(*cq, &rawCS));
+    delete rawCS;
+
+    // A replan evicts the entry, but not the counters of its shape.
+    planCache.notifyOfReplan(*cq, PlanCache::ReplanReason::WorksExceeded);
+    ASSERT_OK(planCache.remove(*cq));
+
+    const PlanCacheCounters& counters = planCache.getCounters();
+    ASSERT_EQUALS(counters.hits.get(), 1);
+    ASSERT_EQUALS(counters.misses.get(), 1);
+    ASSERT_EQUALS(counters.replansWorksExceeded.get(), 1);
+    ASSERT_EQUALS(counters.replansPlanFailed.get(), 0);
+    ASSERT_EQUALS(counters.multiPlans.get(), 1);
+    ASSERT_EQUALS(counters.multiPlanningMicros.get(), 100);
+    ASSERT_EQUALS(counters.trialWorks.get(), 20);
+    ASSERT_EQUALS(PlanCache::getGlobalCounters().hits.get(), globalHits + 1);
+    ASSERT_EQUALS(PlanCache::getGlobalCounters().misses.get(), globalMisses + 1);
+
+    std::vector<PlanCacheShapeStats> shapeStats = planCache.getShapeStats();
+    ASSERT_EQUALS(shapeStats.size(), 1U);
+    ASSERT_BSONOBJ_EQ(shapeStats[0].query, fromjson("{a: 1}"));
+    ASSERT_EQUALS(shapeStats[0].hits, 1);
+    ASSERT_EQUALS(shapeStats[0].misses, 1);
+    ASSERT_EQUALS(shapeStats[0].replansWorksExceeded, 1);
+    ASSERT_EQUALS(shapeStats[0].multiPlans, 1);
+    ASSERT_EQUALS(shapeStats[0].trialWorks, 20);
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -0,0 +1,195 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Returns true if 'oil' holds every value of its field, in either direction.
+ */
+bool isUnbounded(const OrderedIntervalList& oil) {
+    if (oil.intervals.size() != 1) {
+        return false;
+    }
+    const Interval& interval = oil.intervals[0];
+    if (!interval.startInclusive || !interval.endInclusive) {
+        return false;
+    }
+    return (interval.start.type() == MinKey && interval.end.type() == MaxKey) ||
+        (interval.start.type() == MaxKey && interval.end.type() == MinKey);
+}
+
+}  // namespace
+
+boost::optional<double> PlanCostEstimator::estimateCost(const QuerySolutionNode* root) const {
+    auto result = estimate(root);
+    if (!result) {
+        return boost::none;
+    }
+    return result->cost;
+}
+
+boost::optional<PlanCostEstimator::Estimate> PlanCostEstimator::estimate(
+    const QuerySolutionNode* node) const {
+    switch (node->getType()) {
+        case STAGE_COLLSCAN:
+            return Estimate{static_cast<double>(_numRecords), static_cast<double>(_numRecords)};
+
+        case STAGE_IXSCAN: {
+            const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+            auto stats = _stats->get(ixn->index.name);
+
+            // The statistics may predate the index being rebuilt with another key pattern, or
+            // the collection may have changed too much since they were built.
+            if (!stats || ixn->bounds.isSimpleRange || ixn->bounds.fields.empty() ||
+                SimpleBSONObjComparator::kInstance.evaluate(stats->getKeyPattern() !=
+                                                            ixn->index.keyPattern) ||
+                stats->isStale(_numRecords, _maxRecordCountChange)) {
+                return boost::none;
+            }
+
+            // Bounds on later fields may skip most of the keys within the leading field's bounds,
+            // which the histogram of the leading field can't tell.
+            for (size_t i = 1; i < ixn->bounds.fields.size(); ++i) {
+                if (!isUnbounded(ixn->bounds.fields[i])) {
+                    return boost::none;
+                }
+            }
+
+            const double numKeys = _numRecords * stats->getKeysPerDocument() *
+                stats->estimateSelectivity(ixn->bounds.fields[0]);
+            return Estimate{numKeys, numKeys};
+        }
+
+        case STAGE_FETCH: {
+            auto child = estimate(node->children[0]);
+            if (!child) {
+                return boost::none;
+            }
+            return Estimate{child->cost + child->numResults, child->numResults};
+        }
+
+        case STAGE_SORT: {
+            const SortNode* sn = static_cast<const SortNode*>(node);
+            auto child = estimate(node->children[0]);
+            if (!child) {
+                return boost::none;
+            }
+
+            // Sorting takes about n log n comparisons, and a limit caps what comes out.
+            const double n = child->numResults;
+            const double numResults = sn->limit ? std::min(n, static_cast<double>(sn->limit)) : n;
+            return Estimate{child->cost + n * std::log2(std::max(n, 2.0)), numResults};
+        }
+
+        default:
+            break;
+    }
+
+    // Any other leaf, such as a text or geo stage, has no estimate.
+    if (node->children.empty()) {
+        return boost::none;
+    }
+
+    Estimate result{0.0, 0.0};
+    bool first = true;
+    for (auto&& child : node->children) {
+        auto childEstimate = estimate(child);
+        if (!childEstimate) {
+            return boost::none;
+        }
+
+        result.cost += childEstimate->cost;
+        switch (node->getType()) {
+            case STAGE_AND_HASH:
+            case STAGE_AND_SORTED:
+                // An intersection is no larger than its smallest input.
+                result.numResults = first
+                    ? childEstimate->numResults
+                    : std::min(result.numResults, childEstimate->numResults);
+                break;
+            default:
+                result.numResults += childEstimate->numResults;
+                break;
+        }
+        first = false;
+    }
+    return result;
+}
+
+size_t PlanCostEstimator::pruneSolutions(std::vector<QuerySolution*>* solutions,
+                                         double maxCostRatio) const {
+    std::vector<std::pair<boost::optional<double>, QuerySolution*>> costed;
+
+    // The cheapest cost among the solutions without a blocking stage, and among those with one.
+    boost::optional<double> minCost[2];
+    for (auto&& soln : *solutions) {
+        auto cost = estimateCost(soln->root.get());
+        auto& groupMinCost = minCost[soln->hasBlockingStage];
+        if (cost && (!groupMinCost || *cost < *groupMinCost)) {
+            groupMinCost = cost;
+        }
+        costed.emplace_back(cost, soln);
+    }
+
+    if (!minCost[false] && !minCost[true]) {
+        return 0;
+    }
+
+    std::stable_sort(costed.begin(), costed.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first && (!rhs.first || *lhs.first < *rhs.first);
+    });
+
+    solutions->clear();
+    size_t numPruned = 0;
+    for (auto&& entry : costed) {
+        // Every solution examines at least something, don't let an empty estimate prune all
+        // others.
+        const auto& groupMinCost = minCost[entry.second->hasBlockingStage];
+        if (entry.first && *entry.first > std::max(*groupMinCost, 1.0) * maxCostRatio) {
+            delete entry.second;
+            ++numPruned;
+        } else {
+            solutions->push_back(entry.second);
+        }
+    }
+    return numPruned;
+}
+
+}  // namespace mongo
@@ -0,0 +1,93 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+/**
+ * Estimates how much work query solutions do, in keys and documents examined, from the index
+ * statistics collected by the analyze command. This lets the planner leave out of the plan
+ * ranking those candidates which are clearly more expensive than another.
+ *
+ * The estimates disregard filters and early termination: every result of a scan is assumed to
+ * be consumed. The histograms only describe the leading field of each index, so scans which also
+ * bound later fields are not estimated.
+ */
+class PlanCostEstimator {
+public:
+    /**
+     * 'stats' must outlive the estimator. 'numRecords' is the current size of the collection.
+     * Statistics built when the record count differed by more than the fraction
+     * 'maxRecordCountChange' are ignored.
+     */
+    PlanCostEstimator(const CollectionStatistics* stats,
+                      long long numRecords,
+                      double maxRecordCountChange)
+        : _stats(stats), _numRecords(numRecords), _maxRecordCountChange(maxRecordCountChange) {}
+
+    /**
+     * Returns the estimated cost of the solution rooted at 'root', or boost::none if it uses an
+     * index without statistics or a stage the estimator doesn't know about.
+     */
+    boost::optional<double> estimateCost(const QuerySolutionNode* root) const;
+
+    /**
+     * Deletes from 'solutions' those whose estimated cost is more than 'maxCostRatio' times that of
+     * the cheapest one, and orders those left by increasing cost. Solutions which can't be
+     * estimated are kept, after the others. Returns how many solutions were deleted.
+     *
+     * Solutions with a blocking stage are only compared with each other, and so are those without
+     * one: a plan which streams its results in the requested order may win the trial period
+     * however much more it would cost to run to completion.
+     */
+    size_t pruneSolutions(std::vector<QuerySolution*>* solutions, double maxCostRatio) const;
+
+private:
+    struct Estimate {
+        // Keys and documents examined.
+        double cost;
+
+        // Results produced.
+        double numResults;
+    };
+
+    boost::optional<Estimate> estimate(const QuerySolutionNode* node) const;
+
+    const CollectionStatistics* const _stats;
+    const long long _numRecords;
+    const double _maxRecordCountChange;
+};
+
+}  // namespace mongo
@@ -0,0 +1,265 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/plan_cost_estimator.h
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/json.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const long long kNumRecords = 100;
+const double kMaxRecordCountChange = 0.2;
+
+/**
+ * Statistics of an index over a field holding 0 to 99 once each.
+ */
+std::shared_ptr<const IndexStatistics> uniformStats(const BSONObj& keyPattern) {
+    std::vector<BSONObj> values;
+    for (int i = 0; i < kNumRecords; ++i) {
+        values.push_back(BSON("" << i));
+    }
+    return std::make_shared<IndexStatistics>(
+        IndexStatistics::make(keyPattern, std::move(values), kNumRecords, kNumRecords, 10));
+}
+
+/**
+ * Makes a FETCH over an IXSCAN of the index 'keyPattern' named 'indexName', whose leading field
+ * is bounded by 'bounds'.
+ */
+QuerySolution* makeFetchSoln(const BSONObj& keyPattern,
+                             const std::string& indexName,
+                             const BSONObj& bounds) {
+    auto ixn = stdx::make_unique<IndexScanNode>(IndexEntry(keyPattern, indexName));
+    OrderedIntervalList oil(keyPattern.firstElementFieldName());
+    oil.intervals.push_back(Interval(bounds, true, true));
+    ixn->bounds.fields.push_back(oil);
+
+    auto fetch = stdx::make_unique<FetchNode>();
+    fetch->children.push_back(ixn.release());
+
+    auto soln = new QuerySolution();
+    soln->root = std::move(fetch);
+    return soln;
+}
+
+TEST(PlanCostEstimatorTest, CollectionScanCostsNumRecords) {
+    CollectionStatistics collStats;
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    CollectionScanNode csn;
+    auto cost = estimator.estimateCost(&csn);
+    ASSERT(cost);
+    ASSERT_EQ(static_cast<double>(kNumRecords), *cost);
+}
+
+TEST(PlanCostEstimatorTest, IndexScanWithoutStatisticsHasNoCost) {
+    CollectionStatistics collStats;
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::unique_ptr<QuerySolution> soln(
+        makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 5 << "" << 5)));
+    ASSERT_FALSE(estimator.estimateCost(soln->root.get()));
+}
+
+TEST(PlanCostEstimatorTest, IndexScanWithStaleKeyPatternHasNoCost) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: -1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::unique_ptr<QuerySolution> soln(
+        makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 5 << "" << 5)));
+    ASSERT_FALSE(estimator.estimateCost(soln->root.get()));
+}
+
+TEST(PlanCostEstimatorTest, IndexScanWithStaleStatisticsHasNoCost) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: 1}")));
+
+    std::unique_ptr<QuerySolution> soln(
+        makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 5 << "" << 5)));
+    ASSERT(PlanCostEstimator(&collStats, kNumRecords * 11 / 10, kMaxRecordCountChange)
+               .estimateCost(soln->root.get()));
+    ASSERT_FALSE(PlanCostEstimator(&collStats, kNumRecords * 2, kMaxRecordCountChange)
+                     .estimateCost(soln->root.get()));
+    ASSERT_FALSE(PlanCostEstimator(&collStats, kNumRecords / 2, kMaxRecordCountChange)
+                     .estimateCost(soln->root.get()));
+}
+
+TEST(PlanCostEstimatorTest, IndexScanBoundingLaterFieldsHasNoCost) {
+    CollectionStatistics collStats;
+    collStats.set("a_1_b_1", uniformStats(fromjson("{a: 1, b: 1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::unique_ptr<QuerySolution> soln(
+        makeFetchSoln(fromjson("{a: 1, b: 1}"), "a_1_b_1", BSON("" << 0 << "" << 49)));
+    IndexScanNode* ixn = static_cast<IndexScanNode*>(soln->root->children[0]);
+    OrderedIntervalList oil("b");
+    oil.intervals.push_back(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true));
+    ixn->bounds.fields.push_back(oil);
+    ASSERT(estimator.estimateCost(soln->root.get()));
+
+    ixn->bounds.fields[1].intervals[0] = Interval(BSON("" << 5 << "" << 5), true, true);
+    ASSERT_FALSE(estimator.estimateCost(soln->root.get()));
+}
+
+TEST(PlanCostEstimatorTest, FetchCostsKeysAndDocuments) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: 1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::unique_ptr<QuerySolution> soln(
+        makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 0 << "" << 49)));
+    auto cost = estimator.estimateCost(soln->root.get());
+    ASSERT(cost);
+    ASSERT_APPROX_EQUAL(100.0, *cost, 0.01);
+}
+
+TEST(PlanCostEstimatorTest, SortCostsMoreThanItsInput) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: 1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::unique_ptr<QuerySolution> soln(
+        makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 0 << "" << 49)));
+    auto fetchCost = estimator.estimateCost(soln->root.get());
+    ASSERT(fetchCost);
+
+    SortNode sort;
+    sort.children.push_back(soln->root.release());
+    auto sortCost = estimator.estimateCost(&sort);
+    ASSERT(sortCost);
+    ASSERT_GT(*sortCost, *fetchCost);
+}
+
+TEST(PlanCostEstimatorTest, PrunesSolutionsFarCostlierThanCheapest) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: 1}")));
+    collStats.set("b_1", uniformStats(fromjson("{b: 1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(
+        makeFetchSoln(fromjson("{b: 1}"), "b_1", BSON("" << MINKEY << "" << MAXKEY)));
+    solutions.push_back(makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 5 << "" << 5)));
+
+    ASSERT_EQ(1U, estimator.pruneSolutions(&solutions, 10.0));
+    ASSERT_EQ(1U, solutions.size());
+    const IndexScanNode* ixn =
+        static_cast<const IndexScanNode*>(solutions[0]->root->children[0]);
+    ASSERT_EQ("a_1", ixn->index.name);
+    delete solutions[0];
+}
+
+TEST(PlanCostEstimatorTest, KeepsSolutionsWithinRatioOrderedByCost) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: 1}")));
+    collStats.set("b_1", uniformStats(fromjson("{b: 1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(makeFetchSoln(fromjson("{b: 1}"), "b_1", BSON("" << 0 << "" << 49)));
+    solutions.push_back(makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 0 << "" << 19)));
+
+    ASSERT_EQ(0U, estimator.pruneSolutions(&solutions, 10.0));
+    ASSERT_EQ(2U, solutions.size());
+    ASSERT_EQ("a_1",
+              static_cast<const IndexScanNode*>(solutions[0]->root->children[0])->index.name);
+    ASSERT_EQ("b_1",
+              static_cast<const IndexScanNode*>(solutions[1]->root->children[0])->index.name);
+    for (auto soln : solutions) {
+        delete soln;
+    }
+}
+
+TEST(PlanCostEstimatorTest, KeepsSolutionsWithoutCostLast) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: 1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(makeFetchSoln(fromjson("{c: 1}"), "c_1", BSON("" << 5 << "" << 5)));
+    solutions.push_back(makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 5 << "" << 5)));
+
+    ASSERT_EQ(0U, estimator.pruneSolutions(&solutions, 10.0));
+    ASSERT_EQ(2U, solutions.size());
+    ASSERT_EQ("a_1",
+              static_cast<const IndexScanNode*>(solutions[0]->root->children[0])->index.name);
+    ASSERT_EQ("c_1",
+              static_cast<const IndexScanNode*>(solutions[1]->root->children[0])->index.name);
+    for (auto soln : solutions) {
+        delete soln;
+    }
+}
+
+TEST(PlanCostEstimatorTest, DoesNotPruneAcrossBlockingStages) {
+    CollectionStatistics collStats;
+    collStats.set("a_1", uniformStats(fromjson("{a: 1}")));
+    collStats.set("b_1", uniformStats(fromjson("{b: 1}")));
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    // A whole index scan which provides the sort competes with a cheap one which has to sort.
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(
+        makeFetchSoln(fromjson("{b: 1}"), "b_1", BSON("" << MINKEY << "" << MAXKEY)));
+    solutions.push_back(makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 5 << "" << 5)));
+    solutions.back()->hasBlockingStage = true;
+
+    ASSERT_EQ(0U, estimator.pruneSolutions(&solutions, 10.0));
+    ASSERT_EQ(2U, solutions.size());
+    for (auto soln : solutions) {
+        delete soln;
+    }
+}
+
+TEST(PlanCostEstimatorTest, NothingPrunedWithoutAnyCost) {
+    CollectionStatistics collStats;
+    PlanCostEstimator estimator(&collStats, kNumRecords, kMaxRecordCountChange);
+
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(makeFetchSoln(fromjson("{a: 1}"), "a_1", BSON("" << 5 << "" << 5)));
+    solutions.push_back(makeFetchSoln(fromjson("{b: 1}"), "b_1", BSON("" << 5 << "" << 5)));
+
+    ASSERT_EQ(0U, estimator.pruneSolutions(&solutions, 10.0));
+    ASSERT_EQ(2U, solutions.size());
+    for (auto soln : solutions) {
+        delete soln;
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -416,6 +416,15 @@ void PlanExecutor::invalidate(OperationContext* opCtx, const RecordId& dl, Inval
     if (!isMarkedAsKilled()) {
         _root->invalidate(opCtx, dl, type);
     }
+
+    // Buffered results already own their objects, so they only have to let go of the RecordId.
+    for (auto&& id : _batchedResults) {
+        WorkingSetMember* member = _workingSet->get(id);
+        if (member->hasRecordId() && member->recordId == dl && member->hasObj()) {
+            member->makeObjOwnedIfNeeded();
+            _workingSet->transitionToOwnedObj(id);
+        }
+    }
 }
 
 /*
@@ -586,6 +595,14 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         return PlanExecutor::ADVANCED;
     }
 
+    while (!_batchedResults.empty()) {
+        WorkingSetID id = _batchedResults.front();
+        _batchedResults.pop_front();
+        if (extractResult(id, objOut, dlOut)) {
+            return PlanExecutor::ADVANCED;
+        }
+    }
+
     // When a stage requests a yield for document fetch, it gives us back a RecordFetcher*
     // to use to pull the record into memory. We take ownership of the RecordFetcher here,
     // deleting it after we've had a chance to do the fetch. For timing-based yields, we
@@ -623,48 +640,51 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         fetcher.reset();
 
         WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState code;
+        if (_batchEndState) {
+            // The results of the batch have all been handed out, act on the state that ended it.
+            code = _batchEndState->first;
+            id = _batchEndState->second;
+            _batchEndState = boost::none;
+        } else if (_maxBatchWorks > 0) {
+            _batch.ids.clear();
+            _batch.stateId = WorkingSet::INVALID_ID;
+            _batch.works = 0;
+            code = _root->workBatch(_maxBatchWorks, &_batch);
+            id = _batch.stateId;
+
+            if (!_batch.ids.empty()) {
+                writeConflictsInARow = 0;
+                if (PlanStage::NEED_TIME != code) {
+                    _batchEndState = std::make_pair(code, id);
+                }
+
+                // Hand out the results before anything else, in particular before yielding.
+                auto it = _batch.ids.begin();
+                for (; it != _batch.ids.end(); ++it) {
+                    if (extractResult(*it, objOut, dlOut)) {
+                        break;
+                    }
+                }
+                if (it != _batch.ids.end()) {
+                    _batchedResults.assign(it + 1, _batch.ids.end());
+                    return PlanExecutor::ADVANCED;
+                }
+                continue;
+            }
+        } else {
+            code = _root->work(&id);
+        }
 		//PlanStage::work
 		//жһִMultiPlanStage::doWork
 		//ֻһһFetchStage::doWork
-        PlanStage::StageState code = _root->work(&id); //PlanStage::work  ִвѯƻ
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
 
 		//log() << "yang test PlanExecutor::getNextImpl:" << (int)code;
         if (PlanStage::ADVANCED == code) {//0
-            WorkingSetMember* member = _workingSet->get(id);  //ݶWorkingSetMember
-            bool hasRequestedData = true;
-
-            if (NULL != objOut) {
-                if (WorkingSetMember::RID_AND_IDX == member->getState()) { //ֻҪȡϢ
-                    if (1 != member->keyData.size()) {
-                        _workingSet->free(id);
-                        hasRequestedData = false;
-                    } else {
-                        // TODO: currently snapshot ids are only associated with documents, and
-                        // not with index keys.
-                        *objOut = Snapshotted<BSONObj>(SnapshotId(), member->keyData[0].keyData);
-                    }
-                } else if (member->hasObj()) {
-                    *objOut = member->obj;
-                } else {
-                    _workingSet->free(id);
-                    hasRequestedData = false;
-                }
-            }
-
-            if (NULL != dlOut) {
-                if (member->hasRecordId()) {
-                    *dlOut = member->recordId;
-                } else {
-                    _workingSet->free(id);
-                    hasRequestedData = false;
-                }
-            }
-
-            if (hasRequestedData) {
-                _workingSet->free(id);
+            if (extractResult(id, objOut, dlOut)) {
                 return PlanExecutor::ADVANCED;
             }
             // This result didn't have the data the caller wanted, try again.
@@ -714,9 +734,44 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
     }
 }
 
+bool PlanExecutor::extractResult(WorkingSetID id,
+                                 Snapshotted<BSONObj>* objOut,
+                                 RecordId* dlOut) {
+    WorkingSetMember* member = _workingSet->get(id);
+    bool hasRequestedData = true;
+
+    if (NULL != objOut) {
+        if (WorkingSetMember::RID_AND_IDX == member->getState()) {
+            if (1 != member->keyData.size()) {
+                hasRequestedData = false;
+            } else {
+                // TODO: currently snapshot ids are only associated with documents, and
+                // not with index keys.
+                *objOut = Snapshotted<BSONObj>(SnapshotId(), member->keyData[0].keyData);
+            }
+        } else if (member->hasObj()) {
+            *objOut = member->obj;
+        } else {
+            hasRequestedData = false;
+        }
+    }
+
+    if (hasRequestedData && NULL != dlOut) {
+        if (member->hasRecordId()) {
+            *dlOut = member->recordId;
+        } else {
+            hasRequestedData = false;
+        }
+    }
+
+    _workingSet->free(id);
+    return hasRequestedData;
+}
+
 bool PlanExecutor::isEOF() {
     invariant(_currentState == kUsable);
-    return isMarkedAsKilled() || (_stash.empty() && _root->isEOF());
+    return isMarkedAsKilled() ||
+        (_stash.empty() && _batchedResults.empty() && !_batchEndState && _root->isEOF());
 }
 
 void PlanExecutor::markAsKilled(string reason) {
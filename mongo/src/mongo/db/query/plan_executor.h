@@ -29,10 +29,12 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 #include <queue>
 
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/util/partitioned.h"
+#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
@@ -429,6 +431,19 @@ public:
      */
     void enqueue(const BSONObj& obj);
 
+    /**
+     * Makes getNext() pull results from the plan through PlanStage::workBatch(), performing up to
+     * 'maxBatchWorks' units of work at a time, and hand out the results of each batch one by one.
+     * A value of 0 or 1 restores the default of calling PlanStage::work() once per unit of work.
+     *
+     * Batches are only ever drained between yields, but the plan reads ahead of the results
+     * returned to the caller. This must therefore not be used for plans with side effects, or by
+     * callers which rely on the plan's position, such as tailable or oplog-tracking cursors.
+     */
+    void enableBatchedExecution(size_t maxBatchWorks) {
+        _maxBatchWorks = maxBatchWorks > 1 ? maxBatchWorks : 0;
+    }
+
     /**
      * Helper method which returns a set of BSONObj, where each represents a sort order of our
      * output.
@@ -498,6 +513,12 @@ private:
 
     ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut);
 
+    /**
+     * Extracts the data requested by the caller of getNextImpl() from the result 'id' and frees
+     * it. Returns false if the result does not have the requested data.
+     */
+    bool extractResult(WorkingSetID id, Snapshotted<BSONObj>* objOut, RecordId* dlOut);
+
     /**
      * New PlanExecutor instances are created with the static make() methods above.
      */
@@ -583,6 +604,15 @@ private:
     // stages.
     std::queue<BSONObj> _stash;
 
+    // Maximum units of work per PlanStage::workBatch() call, or 0 if batched execution is off.
+    size_t _maxBatchWorks = 0;
+
+    // Results of the last batch which haven't been returned yet. They are drained before the
+    // state which ended the batch, if any, is acted upon.
+    std::deque<WorkingSetID> _batchedResults;
+    boost::optional<std::pair<PlanStage::StageState, WorkingSetID>> _batchEndState;
+    PlanStage::Batch _batch;
+
     //planִ״̬Ϣ
     enum { kUsable, kSaved, kDetached, kDisposed } _currentState = kUsable;
 
@@ -70,7 +70,7 @@ public:
  */ //ֵMultiPlanStage::addPlan    ýṹմMultiPlanStage._candidatesԱ
 struct CandidatePlan { //תΪPlanStageͶӦQuerySolutionýṹ
     CandidatePlan(QuerySolution* s, PlanStage* r, WorkingSet* w)
-        : solution(s), root(r), ws(w), failed(false) {}
+        : solution(s), root(r), ws(w), failed(false), terminatedEarly(false) {}
 
     std::unique_ptr<QuerySolution> solution;
     //MultiPlanStage::workAllPlansִwork
@@ -83,6 +83,10 @@ struct CandidatePlan { //
     std::list<WorkingSetID> results;
 
     bool failed;
+
+    // Whether the plan stopped being worked during the trial period because it was clearly
+    // outperformed by another candidate.
+    bool terminatedEarly;
 };
 
 /**
@@ -27,10 +27,16 @@
 
 #pragma once
 
+#include <map>
+#include <set>
 #include <string>
 
+#include "mongo/bson/bsonobj.h"
+
 namespace mongo {
 
+struct IndexBounds;
+
 /**
  * A container for the summary statistics that the profiler, slow query log, and
  * other non-explain debug mechanisms may want to collect.
@@ -57,6 +63,24 @@ struct PlanSummaryStats { //
     // The names of each index used by the plan.
     std::set<std::string> indexesUsed;
 
+    // What the plan did with one of the indexes it used.
+    struct IndexAccessStats {
+        size_t keysExamined = 0U;
+
+        // Documents fetched right after being found in the index.
+        size_t docsExamined = 0U;
+
+        size_t seeks = 0U;
+
+        // The bounds of the first scan of the index, if it was a bounded scan. Points into the
+        // plan, so it is only valid while the PlanExecutor these stats were taken from is alive.
+        const IndexBounds* indexBounds = nullptr;
+    };
+
+    // Per-index breakdown for the indexes in 'indexesUsed' that were scanned by keys. Reported to
+    // the collection's index usage statistics.
+    std::map<std::string, IndexAccessStats> indexAccesses;
+
     // Was this plan a result of using the MultiPlanStage to select a winner among several
     // candidates?
     bool fromMultiPlanner = false;
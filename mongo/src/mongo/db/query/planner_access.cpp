@@ -45,6 +45,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/index_tag.h"
 #include "mongo/db/query/indexability.h"
+#include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
@@ -96,6 +97,26 @@ const IndexScanNode* getIndexScanNode(const QuerySolutionNode* node) {
     return nullptr;
 }
 
+/**
+ * Returns true if 'node' is an index scan, possibly beneath a fetch, whose bounds are made up
+ * entirely of point intervals. Such scans usually produce far fewer RecordIds than range scans.
+ */
+bool isPointIndexScan(const QuerySolutionNode* node) {
+    const IndexScanNode* ixscan = getIndexScanNode(node);
+    if (!ixscan || ixscan->bounds.isSimpleRange) {
+        return false;
+    }
+
+    for (auto&& oil : ixscan->bounds.fields) {
+        for (auto&& interval : oil.intervals) {
+            if (!interval.isPoint()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 /**
  * Takes as input two query solution nodes returned by processIndexScans(). If both are
  * IndexScanNode or FetchNode with an IndexScanNode child and the index scan nodes are identical
@@ -158,11 +179,13 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         params.options & QueryPlannerParams::TRACK_LATEST_OPLOG_TS;
 
     // If the hint is {$natural: +-1} this changes the direction of the collection scan.
+    bool isNaturalOrder = false;
     if (!query.getQueryRequest().getHint().isEmpty()) {
         BSONElement natural =
             dps::extractElementAtPath(query.getQueryRequest().getHint(), "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            isNaturalOrder = true;
         }
     }
 
@@ -173,9 +196,17 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
         BSONElement natural = dps::extractElementAtPath(sortObj, "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            isNaturalOrder = true;
         }
     }
 
+    // Only a scan whose results may come out in any order, and which doesn't stop after a given
+    // number of documents, can be split across threads. The collator is left out as it isn't
+    // known to be safe to use from several threads at once.
+    csn->parallel = (params.options & QueryPlannerParams::PARALLEL_COLLSCAN) && !isNaturalOrder &&
+        !tailable && !csn->shouldTrackLatestOplogTimestamp && 0 == csn->maxScan &&
+        !query.getCollator();
+
     return std::move(csn);
 }
 
@@ -1034,6 +1065,10 @@ QuerySolutionNode* QueryPlannerAccess::buildIndexedAnd(const CanonicalQuery& que
             AndHashNode* ahn = new AndHashNode();
             ahn->children.swap(ixscanNodes);
             andResult = ahn;
+            // The stage buffers every child but the last in memory, starting with the first, so
+            // put the children most likely to be small at the front.
+            std::stable_partition(
+                ahn->children.begin(), ahn->children.end(), isPointIndexScan);
             // The AndHashNode provides the sort order of its last child.  If any of the
             // possible subnodes of AndHashNode provides the sort order we care about, we put
             // that one last.
@@ -1079,8 +1114,12 @@ QuerySolutionNode* QueryPlannerAccess::buildIndexedAnd(const CanonicalQuery& que
     if ((params.options & QueryPlannerParams::CANNOT_TRIM_IXISECT) &&
         (andResult->getType() == STAGE_AND_HASH || andResult->getType() == STAGE_AND_SORTED)) {
         // We got an index intersection solution, and we aren't allowed to answer predicates
-        // using the index. We add a fetch with the entire filter.
+        // using the index. We add a fetch with the entire filter, which lets an AND_HASH drop its
+        // index keys, since the fetch re-validates every predicate.
         invariant(clonedRoot.get());
+        if (STAGE_AND_HASH == andResult->getType()) {
+            static_cast<AndHashNode*>(andResult)->canHoldRecordIdsOnly = true;
+        }
         FetchNode* fetch = new FetchNode();
         fetch->filter.reset(clonedRoot.release());
         // Takes ownership of 'andResult'.
@@ -1091,6 +1130,8 @@ QuerySolutionNode* QueryPlannerAccess::buildIndexedAnd(const CanonicalQuery& que
     // If there are any nodes still attached to the AND, we can't answer them using the
     // index, so we put a fetch with filter.
     if (root->numChildren() > 0) {
+        // The fetch only evaluates the predicates left over, so the AND_HASH must keep the index
+        // keys it relies on for the others.
         FetchNode* fetch = new FetchNode();
         verify(NULL != autoRoot.get());
         if (autoRoot->numChildren() == 1) {
@@ -1470,4 +1511,103 @@ QuerySolutionNode* QueryPlannerAccess::makeIndexScan(const IndexEntry& index,
     return solnRoot;
 }
 
+namespace {
+
+/**
+ * Returns true if 'node' is a comparison a skip scan can build the bounds of its field from.
+ */
+bool isSkipScanPredicate(const MatchExpression* node) {
+    switch (node->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::MATCH_IN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+// static
+QuerySolutionNode* QueryPlannerAccess::makeSkipScan(const IndexEntry& index,
+                                                    const CanonicalQuery& query,
+                                                    const QueryPlannerParams& params) {
+    // A partial index would need the query to be checked against its filter first.
+    if (INDEX_BTREE != index.type || index.filterExpr) {
+        return NULL;
+    }
+
+    // Only the predicates of a top-level AND, or a lone predicate, can bound the scan.
+    MatchExpression* root = query.root();
+    std::vector<MatchExpression*> preds;
+    if (MatchExpression::AND == root->matchType()) {
+        for (size_t i = 0; i < root->numChildren(); ++i) {
+            preds.push_back(root->getChild(i));
+        }
+    } else {
+        preds.push_back(root);
+    }
+
+    // Look for the first field of the index which has a predicate, within the number of leading
+    // fields we are willing to skip across.
+    const int maxPrefixFields = internalQueryPlannerMaxSkipScanPrefixFields.load();
+    int fieldPos = 0;
+    MatchExpression* boundsPred = NULL;
+    for (auto&& elt : index.keyPattern) {
+        if (fieldPos > maxPrefixFields) {
+            return NULL;
+        }
+
+        for (auto&& pred : preds) {
+            if (isSkipScanPredicate(pred) && pred->path() == elt.fieldNameStringData() &&
+                QueryPlannerIXSelect::compatible(elt, index, pred, query.getCollator())) {
+                boundsPred = pred;
+                break;
+            }
+        }
+
+        if (boundsPred) {
+            break;
+        }
+        ++fieldPos;
+    }
+
+    // A predicate on the leading field is left to the regular planning.
+    if (!boundsPred || 0 == fieldPos) {
+        return NULL;
+    }
+
+    unique_ptr<IndexScanNode> isn = make_unique<IndexScanNode>(index);
+    isn->maxScan = query.getQueryRequest().getMaxScan();
+    isn->addKeyMetadata = query.getQueryRequest().returnKey();
+    isn->queryCollator = query.getCollator();
+    isn->isSkipScan = true;
+
+    // The bounds checker seeks past every key outside of the bounds of the predicate's field, which
+    // moves the scan from one distinct value of the leading fields to the next.
+    isn->bounds.fields.resize(index.keyPattern.nFields());
+    int pos = 0;
+    for (auto&& elt : index.keyPattern) {
+        OrderedIntervalList* oil = &isn->bounds.fields[pos];
+        if (pos == fieldPos) {
+            IndexBoundsBuilder::BoundsTightness tightness;
+            IndexBoundsBuilder::translate(boundsPred, elt, index, oil, &tightness);
+        } else {
+            IndexBoundsBuilder::allValuesForField(elt, oil);
+        }
+        ++pos;
+    }
+    IndexBoundsBuilder::alignBounds(&isn->bounds, index.keyPattern);
+
+    // The fetch applies the whole query, the bounds only narrow down which documents reach it.
+    unique_ptr<FetchNode> fetch = make_unique<FetchNode>();
+    fetch->filter = query.root()->shallowClone();
+    fetch->children.push_back(isn.release());
+    return fetch.release();
+}
+
 }  // namespace mongo
@@ -213,6 +213,16 @@ public:
                                             const BSONObj& startKey,
                                             const BSONObj& endKey);
 
+    /**
+     * Return a plan that skip scans the provided index, or NULL if it can't. A skip scan uses a
+     * predicate on a field of a compound index which follows fields that 'query' doesn't
+     * constrain: its bounds take every value of those leading fields, and the index scan seeks
+     * from one distinct value of them to the next.
+     */
+    static QuerySolutionNode* makeSkipScan(const IndexEntry& index,
+                                           const CanonicalQuery& query,
+                                           const QueryPlannerParams& params);
+
     //
     // Indexed Data Access methods.
     //
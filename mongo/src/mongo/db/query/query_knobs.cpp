@@ -39,10 +39,22 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationCollFraction, double, 0
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationEarlyTermination, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMinWorksBeforeTermination, int, 500);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationTerminationStdDevs, double, 3.0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationScaleByCandidates, bool, true);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatsStoreEnabled, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatsStoreSize, int, 5000);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
@@ -59,16 +71,36 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableHashIntersection, bool,
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanOrChildrenIndependently, bool, true);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQuerySubplanMergeSameShapeBranches, bool, true);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecEnableSortLateFetch, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecBatchSize, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecEnableColumnarFilter, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecEnableCompiledFilter, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecEnableFetchPrefetch, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelCollectionScanDegree, int, 1);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelCollectionScanMinRecords, long long, 10000);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelCollectionScanRoundSize, int, 1000);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecApproximateCountSampleSize, int, 1000);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetBufferSizeBytes, int, 100 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetParallelExecution, bool, false);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
                               int,
                               internalQueryExecYieldIterations.load() / 2); //(128 / 2)
@@ -77,8 +109,37 @@ MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorBatchSizeBytes, int, 4
 
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupCacheSizeBytes, int, 100 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupHashJoinMinInputDocs, int, 1000);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupHashJoinMaxSizeBytes,
+                              int,
+                              100 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupEnableStreaming, bool, true);
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupParallelDegree, int, 1);
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupParallelRoundSize, int, 4096);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceProjectionBatchSize, int, 64);
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceProjectionBatchSizeBytes,
+                              int,
+                              4 * 1024 * 1024);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans, bool, false);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxSkipScanPrefixFields, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableCostBasedPruning, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerCostPruningRatio, double, 10.0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatsSampleSize, int, 10000);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatsMaxHistogramBuckets, int, 100);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatsMaxRecordCountChange, double, 0.2);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnableUniqueIndexIdHack, bool, true);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitBlockingMergeOnMongoS, bool, false);
@@ -49,6 +49,21 @@ extern AtomicDouble internalQueryPlanEvaluationCollFraction;
 //Ĭ101
 extern AtomicInt32 internalQueryPlanEvaluationMaxResults;
 
+// Whether to stop working a candidate plan during the trial period once its productivity is
+// statistically below that of the best candidate.
+extern AtomicBool internalQueryPlanEvaluationEarlyTermination;
+
+// Number of works a candidate plan is given before it may be stopped early.
+extern AtomicInt32 internalQueryPlanEvaluationMinWorksBeforeTermination;
+
+// How many standard deviations apart the productivities of two candidate plans must be for the
+// worse one to be stopped early.
+extern AtomicDouble internalQueryPlanEvaluationTerminationStdDevs;
+
+// Whether to share the works which internalQueryPlanEvaluationCollFraction adds for large
+// collections among the candidate plans, rather than give them to each.
+extern AtomicBool internalQueryPlanEvaluationScaleByCandidates;
+
 // Do we give a big ranking bonus to intersection plans?
 extern AtomicBool internalQueryForceIntersectionPlans;
 
@@ -65,6 +80,12 @@ extern AtomicBool internalQueryPlannerEnableHashIntersection;
 // How many entries in the cache?
 extern AtomicInt32 internalQueryCacheSize;
 
+// Do we accumulate the cost of the operations of each query shape in the QueryStatsStore?
+extern AtomicBool internalQueryStatsStoreEnabled;
+
+// How many query shapes does the QueryStatsStore track?
+extern AtomicInt32 internalQueryStatsStoreSize;
+
 // How many feedback entries do we collect before possibly evicting from the cache based on bad
 // performance?
 extern AtomicInt32 internalQueryCacheFeedbacksStored;
@@ -90,6 +111,10 @@ extern AtomicInt32 internalQueryEnumerationMaxIntersectPerAnd;
 // Do we want to plan each child of the OR independently?
 extern AtomicBool internalQueryPlanOrChildrenIndependently;
 
+// When planning the children of an OR independently, do we drop children identical to an earlier
+// one and plan each distinct child shape only once, reusing its index assignment for the others?
+extern AtomicBool internalQuerySubplanMergeSameShapeBranches;
+
 // How many index scans are we willing to produce in order to obtain a sort order
 // during explodeForSort?
 extern AtomicInt32 internalQueryMaxScansToExplode;
@@ -97,6 +122,35 @@ extern AtomicInt32 internalQueryMaxScansToExplode;
 // Allow the planner to generate covered whole index scans, rather than falling back to a COLLSCAN.
 extern AtomicBool internalQueryPlannerGenerateCoveredWholeIndexScans;
 
+// How many leading fields without predicates may a skip scan over a compound index step across?
+// Each one multiplies the number of seeks by its number of distinct values. Zero disables skip
+// scans, which is the default: there are no statistics on the number of distinct values to tell
+// when that number is small enough.
+extern AtomicInt32 internalQueryPlannerMaxSkipScanPrefixFields;
+
+// Do we leave out of plan ranking the candidates whose cost, estimated from the index statistics
+// collected by the analyze command, is far above that of the cheapest one? Off by default, since
+// the cost model only knows about the leading field of each index.
+extern AtomicBool internalQueryPlannerEnableCostBasedPruning;
+
+// How many times the estimated cost of the cheapest candidate plan may another one have before it
+// is pruned.
+extern AtomicDouble internalQueryPlannerCostPruningRatio;
+
+// How many documents the analyze command samples by default to build index statistics.
+extern AtomicInt32 internalQueryStatsSampleSize;
+
+// At most how many buckets the histogram of the leading field of an index has.
+extern AtomicInt32 internalQueryStatsMaxHistogramBuckets;
+
+// By what fraction of the record count at the time of the analyze command may a collection grow
+// or shrink before its index statistics are no longer used to estimate costs.
+extern AtomicDouble internalQueryStatsMaxRecordCountChange;
+
+// Do we answer equalities on every field of a unique index with a single index lookup, like an
+// equality on _id, rather than by planning the query?
+extern AtomicBool internalQueryEnableUniqueIndexIdHack;
+
 // Ignore unknown JSON Schema keywords.
 extern AtomicBool internalQueryIgnoreUnknownJSONSchemaKeywords;
 
@@ -106,6 +160,43 @@ extern AtomicBool internalQueryIgnoreUnknownJSONSchemaKeywords;
 
 extern AtomicInt32 internalQueryExecMaxBlockingSortBytes;
 
+// Whether a blocking sort with a limit may buffer only the sort keys and RecordIds of the
+// documents it reads, fetching the documents of the results once sorted. A result whose document
+// was deleted or changed in the meantime is dropped without being replaced, so the sort may return
+// fewer than 'limit' documents.
+extern AtomicBool internalQueryExecEnableSortLateFetch;
+
+// Maximum number of units of work a find or aggregation plan performs per batch when results are
+// pulled through PlanStage::workBatch(). Values of 0 or 1 disable batched execution.
+extern AtomicInt32 internalQueryExecBatchSize;
+
+// Whether batched collection scans may evaluate the simple comparisons of their filter a column
+// at a time, see ColumnarFilter.
+extern AtomicBool internalQueryExecEnableColumnarFilter;
+
+// Whether collection scans, fetches and $match stages evaluate their filter with a
+// CompiledMatchExpression rather than by walking the MatchExpression tree.
+extern AtomicBool internalQueryExecEnableCompiledFilter;
+
+// Whether a fetch stage under batched execution reads the documents of each batch of its child's
+// results in RecordId order, rather than one at a time in the order the child produced them.
+extern AtomicBool internalQueryExecEnableFetchPrefetch;
+
+// Number of threads a collection scan of a find, count or aggregation may be split across, see
+// GatherStage. Values of 0 or 1 disable parallel collection scans.
+extern AtomicInt32 internalQueryExecParallelCollectionScanDegree;
+
+// Collections with fewer records than this are always scanned by a single thread.
+extern AtomicInt64 internalQueryExecParallelCollectionScanMinRecords;
+
+// Number of records each thread of a parallel collection scan reads before handing its results
+// back to the query.
+extern AtomicInt32 internalQueryExecParallelCollectionScanRoundSize;
+
+// Number of documents an approximate count samples. Only collections with at least ten times as
+// many records are sampled; smaller ones are counted exactly.
+extern AtomicInt32 internalQueryExecApproximateCountSampleSize;
+
 // Yield after this many "should yield?" checks.
 //ۻֵ yieldĬΪ 128ϷӳǴ߱ϻȡ
 //˶ݺ yieldyield ֮ۻ㡣
@@ -122,6 +213,12 @@ const int64_t insertVectorMaxBytes = 256 * 1024;
 
 // The number of bytes to buffer at once during a $facet stage.
 extern AtomicInt32 internalQueryFacetBufferSizeBytes;
+
+// Whether $facet runs each of its sub-pipelines on its own thread when none of them reads from
+// other collections and the query may use disk. Input that the slower sub-pipelines have not read
+// yet is then written to a temporary file once it outgrows internalQueryFacetBufferSizeBytes,
+// rather than holding back the faster ones.
+extern AtomicBool internalQueryFacetParallelExecution;
 //AtomicInt32ͱͨinternalInsertMaxBatchSize.load()
 extern AtomicInt32 internalInsertMaxBatchSize;
 
@@ -129,5 +226,34 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// Number of input documents a $lookup on localField/foreignField joins by querying the foreign
+// collection before it switches to a hash join, see LookUpHashTable. Negative values disable hash
+// joins.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMinInputDocs;
+
+// Maximum size of the in-memory hash table of a $lookup hash join. A foreign collection that
+// outgrows it is joined by querying it once per input document.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMaxSizeBytes;
+
+// Whether a $group whose input is sorted on the fields of its _id outputs each group as soon as
+// the sort key changes, rather than building all the groups before outputting any.
+extern AtomicBool internalDocumentSourceGroupEnableStreaming;
+
+// Number of threads a $group which can't stream its input accumulates its groups with, each one
+// owning a hash partition of the groups. Values of 0 or 1 disable parallel $group.
+extern AtomicInt32 internalDocumentSourceGroupParallelDegree;
+
+// Number of input documents a parallel $group buffers before handing them to its threads.
+extern AtomicInt32 internalDocumentSourceGroupParallelRoundSize;
+
+// Maximum number of input documents a $project or $addFields with computed fields reads ahead and
+// evaluates its expressions over at once. Its first batch holds one document, and each batch after
+// that twice as many as the previous one, up to this number. Values of 0 or 1 disable batching.
+extern AtomicInt32 internalDocumentSourceProjectionBatchSize;
+
+// Approximate number of bytes of input documents above which a $project or $addFields stops
+// reading ahead, so that a batch of large documents doesn't hold too much memory.
+extern AtomicInt32 internalDocumentSourceProjectionBatchSizeBytes;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
 }  // namespace mongo
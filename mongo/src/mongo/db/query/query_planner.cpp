@@ -135,6 +135,13 @@ string optionString(size_t options) {
                 break;
             case QueryPlannerParams::TRACK_LATEST_OPLOG_TS:
                 ss << "TRACK_LATEST_OPLOG_TS ";
+                break;
+            case QueryPlannerParams::PARALLEL_COLLSCAN:
+                ss << "PARALLEL_COLLSCAN ";
+                break;
+            case QueryPlannerParams::GENERATE_SKIP_SCANS:
+                ss << "GENERATE_SKIP_SCANS ";
+                break;
             case QueryPlannerParams::DEFAULT:
                 MONGO_UNREACHABLE;
                 break;
@@ -304,6 +311,17 @@ QuerySolution* buildWholeIXSoln(const IndexEntry& index,
     return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
 }
 
+QuerySolution* buildSkipScanSoln(const IndexEntry& index,
+                                 const CanonicalQuery& query,
+                                 const QueryPlannerParams& params) {
+    std::unique_ptr<QuerySolutionNode> solnRoot(
+        QueryPlannerAccess::makeSkipScan(index, query, params));
+    if (!solnRoot) {
+        return NULL;
+    }
+    return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
+}
+
 // For example:
 // - Sparse index {a: 1, b: 1} should be able to provide a sort for
 //	 find({b: 1}).sort({a: 1}).  SERVER-13908.
@@ -509,6 +527,14 @@ Status QueryPlanner::planFromCache(const CanonicalQuery& query,
             *out = soln;
             return Status::OK();
         }
+    } else if (SolutionCacheData::SKIP_IXSCAN_SOLN == winnerCacheData.solnType) {
+        QuerySolution* soln = buildSkipScanSoln(*winnerCacheData.tree->entry, query, params);
+        if (soln == NULL) {
+            return Status(ErrorCodes::BadValue, "plan cache error: skip scan soln");
+        } else {
+            *out = soln;
+            return Status::OK();
+        }
     } else if (SolutionCacheData::COLLSCAN_SOLN == winnerCacheData.solnType) {
         // The cached solution is a collection scan. We don't cache collscans
         // with tailable==true, hence the false below.
@@ -1305,12 +1331,35 @@ Status QueryPlanner::plan(const CanonicalQuery& query,
         !QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR) &&
         !QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT) && hintIndex.isEmpty();
 
+    // Still no indexed plans? A compound index may be usable by skipping between the distinct
+    // values of leading fields the query doesn't constrain. Whether that beats a collection scan
+    // depends on how many distinct values there are, so the collection scan is kept as well and
+    // the plan ranker picks between them.
+    bool onlySkipScans = false;
+    if (params.options & QueryPlannerParams::GENERATE_SKIP_SCANS && 0 == out->size() &&
+        possibleToCollscan) {
+        for (auto&& index : params.indices) {
+            QuerySolution* soln = buildSkipScanSoln(index, query, params);
+            if (NULL != soln) {
+                PlanCacheIndexTree* indexTree = new PlanCacheIndexTree();
+                indexTree->setIndexEntry(index);
+                SolutionCacheData* scd = new SolutionCacheData();
+                scd->tree.reset(indexTree);
+                scd->solnType = SolutionCacheData::SKIP_IXSCAN_SOLN;
+                soln->cacheData.reset(scd);
+                LOG(2) << "Planner: outputting a skip scan:" << endl << redact(soln->toString());
+                out->push_back(soln);
+            }
+        }
+        onlySkipScans = out->size() > 0;
+    }
+
     // The caller can explicitly ask for a collscan.
     bool collscanRequested = (params.options & QueryPlannerParams::INCLUDE_COLLSCAN);
 
     // No indexed plans?  We must provide a collscan if possible or else we can't run the query.
     //ûкʵȫɨ
-    bool collscanNeeded = (0 == out->size() && canTableScan);
+    bool collscanNeeded = ((0 == out->size() || onlySkipScans) && canTableScan);
 
 	//ûкʵQuerySolutionȫɨ
     if (possibleToCollscan && (collscanRequested || collscanNeeded)) {
@@ -111,6 +111,14 @@ struct QueryPlannerParams {
 
         // Set this to track the most recent timestamp seen by this cursor while scanning the oplog.
         TRACK_LATEST_OPLOG_TS = 1 << 12,
+
+        // Set this to allow a collection scan to be split across several threads. Only reads
+        // which don't need a point-in-time view of the collection may set it.
+        PARALLEL_COLLSCAN = 1 << 13,
+
+        // Set this to generate skip scans over compound indexes when no index can otherwise
+        // answer the query.
+        GENERATE_SKIP_SCANS = 1 << 14,
     };
 
     // See Options enum above.
@@ -5445,4 +5445,77 @@ TEST_F(QueryPlannerTest, EmptyQueryWithProjectionUsesCollscanIfIndexCollationDif
         "{proj: {spec: {_id: 0, a: 1}, node: "
         "{cscan: {dir: 1}}}}");
 }
+
+/**
+ * Skip scans are off by default. These tests allow them to step across one leading field.
+ */
+class QueryPlannerSkipScanTest : public QueryPlannerTest {
+protected:
+    void setUp() override {
+        QueryPlannerTest::setUp();
+        _originalMaxPrefixFields = internalQueryPlannerMaxSkipScanPrefixFields.load();
+        internalQueryPlannerMaxSkipScanPrefixFields.store(1);
+        params.options = QueryPlannerParams::GENERATE_SKIP_SCANS;
+    }
+
+    void tearDown() override {
+        internalQueryPlannerMaxSkipScanPrefixFields.store(_originalMaxPrefixFields);
+    }
+
+private:
+    int _originalMaxPrefixFields = 0;
+};
+
+TEST_F(QueryPlannerSkipScanTest, PredicateOnSecondFieldUsesSkipScanIfEnabled) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(2);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: 5}, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[5,5,true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, PredicateOnSecondFieldDoesNotUseSkipScanIfDisabled) {
+    params.options &= ~QueryPlannerParams::GENERATE_SKIP_SCANS;
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanBoundsAreAlignedWithDescendingIndexFields) {
+    addIndex(BSON("a" << -1 << "b" << -1 << "c" << 1));
+    runQuery(fromjson("{b: {$gt: 5}, d: 1}"));
+    assertNumSolutions(2);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: {$gt: 5}, d: 1}}}");
+    assertSolutionExists(
+        "{fetch: {filter: {b: {$gt: 5}, d: 1}, node: {ixscan: {pattern: {a: -1, b: -1, c: 1}, "
+        "bounds: {a: [['MaxKey','MinKey',true,true]], b: [[Infinity,5,true,false]], "
+        "c: [['MinKey','MaxKey',true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanDoesNotSkipMoreLeadingFieldsThanAllowed) {
+    addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+    runQuery(fromjson("{c: 5}"));
+    assertNumSolutions(1);
+    assertSolutionExists("{cscan: {dir: 1, filter: {c: 5}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanNotGeneratedIfAnotherIndexApplies) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    addIndex(BSON("b" << 1));
+    runQuery(fromjson("{b: 5}"));
+    assertNumSolutions(1);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {b: 1}, bounds: {b: [[5,5,true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanNotGeneratedIfIndexCollationDiffers) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    addIndex(BSON("a" << 1 << "b" << 1), &collator);
+    runQuery(fromjson("{b: 'foo'}"));
+    assertNumSolutions(1);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 'foo'}}}");
+}
 }  // namespace
@@ -234,6 +234,7 @@ db.runCommand(
       "noCursorTimeout": <bool>,
       "awaitData": <bool>,
       "allowPartialResults": <bool>,
+      "allowDiskUse": <bool>,
       "collation": <document>
    }
 )
@@ -591,6 +592,15 @@ public:
         _allowPartialResults = allowPartialResults;
     }
 
+    // May a blocking sort write data to temporary files once it runs out of memory?
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
+    void setAllowDiskUse(bool allowDiskUse) {
+        _allowDiskUse = allowDiskUse;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -728,6 +738,8 @@ private:
     bool _exhaust = false;
     bool _allowPartialResults = false;
 
+    bool _allowDiskUse = false;
+
     boost::optional<long long> _replicationTerm;
 };
 
@@ -256,6 +256,7 @@ QuerySolutionNode* CollectionScanNode::clone() const {
     copy->direction = this->direction;
     copy->maxScan = this->maxScan;
     copy->shouldTrackLatestOplogTimestamp = this->shouldTrackLatestOplogTimestamp;
+    copy->parallel = this->parallel;
 
     return copy;
 }
@@ -311,6 +312,7 @@ QuerySolutionNode* AndHashNode::clone() const {
     cloneBaseData(copy);
 
     copy->_sort = this->_sort;
+    copy->canHoldRecordIdsOnly = this->canHoldRecordIdsOnly;
 
     return copy;
 }
@@ -545,6 +547,7 @@ IndexScanNode::IndexScanNode(IndexEntry index)
       direction(1),
       maxScan(0),
       addKeyMetadata(false),
+      isSkipScan(false),
       queryCollator(nullptr) {}
 
 void IndexScanNode::appendToString(mongoutils::str::stream* ss, int indent) const {
@@ -561,6 +564,10 @@ void IndexScanNode::appendToString(mongoutils::str::stream* ss, int indent) cons
     *ss << "direction = " << direction << '\n';
     addIndent(ss, indent + 1);
     *ss << "bounds = " << bounds.toString() << '\n';
+    if (isSkipScan) {
+        addIndent(ss, indent + 1);
+        *ss << "isSkipScan = true\n";
+    }
     addCommon(ss, indent);
 }
 
@@ -819,6 +826,7 @@ QuerySolutionNode* IndexScanNode::clone() const {
     copy->direction = this->direction;
     copy->maxScan = this->maxScan;
     copy->addKeyMetadata = this->addKeyMetadata;
+    copy->isSkipScan = this->isSkipScan;
     copy->bounds = this->bounds;
     copy->queryCollator = this->queryCollator;
 
@@ -842,7 +850,8 @@ bool filtersAreEquivalent(const MatchExpression* lhs, const MatchExpression* rhs
 bool IndexScanNode::operator==(const IndexScanNode& other) const {
     return filtersAreEquivalent(filter.get(), other.filter.get()) && index == other.index &&
         direction == other.direction && maxScan == other.maxScan &&
-        addKeyMetadata == other.addKeyMetadata && bounds == other.bounds;
+        addKeyMetadata == other.addKeyMetadata && isSkipScan == other.isSkipScan &&
+        bounds == other.bounds;
 }
 
 //
@@ -329,6 +329,10 @@ struct CollectionScanNode : public QuerySolutionNode {
     // across a sharded cluster.
     bool shouldTrackLatestOplogTimestamp = false;
 
+    // May the scan be split into ranges of RecordIds scanned by several threads? The results then
+    // come out in no particular order.
+    bool parallel = false;
+
     // Ǽ
     int direction;
 
@@ -374,6 +378,10 @@ struct AndHashNode : public QuerySolutionNode {
     QuerySolutionNode* clone() const;
 
     BSONObjSet _sort;
+
+    // True if this node's parent is a FETCH which evaluates the whole query on each document, so
+    // the stage may drop its children's index keys if it runs short of memory.
+    bool canHoldRecordIdsOnly = false;
 };
 
 /* ʹ
@@ -585,6 +593,10 @@ struct IndexScanNode : public QuerySolutionNode {
 
     // If there's a 'returnKey' projection we add key metadata.
     bool addKeyMetadata;
+
+    // True if the bounds cover every value of one or more leading fields of the index, so that the
+    // scan seeks from one distinct value of those fields to the next.
+    bool isSkipScan;
     //bounds = field #0['name']: ["yangyazhou2", "yangyazhou2"], field #1['male']: [MaxKey, MinKey]
     IndexBounds bounds; 
 
@@ -0,0 +1,255 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_stats_store.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+// How many stripes the store is partitioned into.
+const size_t kNumStripes = 16;
+
+const auto getQueryStatsStore = ServiceContext::declareDecoration<QueryStatsStore>();
+
+/**
+ * Describes the shape of 'cq' by its query, sort, projection and collation.
+ */
+BSONObj makeShape(const CanonicalQuery& cq) {
+    const QueryRequest& qr = cq.getQueryRequest();
+    BSONObjBuilder builder;
+    builder.append("query", qr.getFilter());
+    builder.append("sort", qr.getSort());
+
+    // Leave out the fields the server adds to the projection for its own use, such as $sortKey.
+    BSONObjBuilder projBuilder(builder.subobjStart("projection"));
+    for (auto&& elem : qr.getProj()) {
+        if (elem.fieldName()[0] != '$') {
+            projBuilder.append(elem);
+        }
+    }
+    projBuilder.doneFast();
+
+    if (cq.getCollator()) {
+        builder.append("collation", cq.getCollator()->getSpec().toBSON());
+    }
+    return builder.obj();
+}
+
+// OpDebug reports the metrics an operation doesn't have as -1.
+long long nonNegative(long long metric) {
+    return std::max(0LL, metric);
+}
+
+}  // namespace
+
+BSONObj QueryShapeStats::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("ns", ns);
+    builder.appendElements(shape);
+    builder.append("execCount", execCount);
+    builder.append("totalExecMicros", totalExecMicros);
+    {
+        BSONObjBuilder latencyBuilder(builder.subobjStart("latency"));
+        latency.append(true, &latencyBuilder);
+    }
+    builder.append("keysExamined", keysExamined);
+    builder.append("docsExamined", docsExamined);
+    builder.append("nreturned", nreturned);
+    builder.append("bytesReturned", bytesReturned);
+    builder.append("planSummary", planSummary);
+    builder.append("firstSeen", firstSeen);
+    builder.append("lastSeen", lastSeen);
+    return builder.obj();
+}
+
+// static
+QueryStatsStore& QueryStatsStore::get(ServiceContext* service) {
+    return getQueryStatsStore(service);
+}
+
+// static
+std::string QueryStatsStore::makeKey(StringData ns, const PlanCacheKey& planCacheKey) {
+    // Namespaces can't contain a null byte, so it separates them from the plan cache key.
+    std::string key;
+    key.reserve(ns.size() + 1 + planCacheKey.size());
+    key.append(ns.rawData(), ns.size());
+    key.push_back('\0');
+    key.append(planCacheKey);
+    return key;
+}
+
+// static
+void QueryStatsStore::noteQueryShape(OperationContext* opCtx,
+                                     const PlanCache& planCache,
+                                     const CanonicalQuery& cq) {
+    if (!internalQueryStatsStoreEnabled.load()) {
+        return;
+    }
+
+    OpDebug& debug = CurOp::get(opCtx)->debug();
+    if (!debug.queryStatsKey.empty()) {
+        return;
+    }
+
+    debug.queryStatsKey = makeKey(cq.ns(), planCache.computeKey(cq));
+
+    // Only a shape seen for the first time needs describing.
+    if (!get(opCtx->getServiceContext()).contains(debug.queryStatsKey)) {
+        debug.queryStatsShape = makeShape(cq);
+    }
+}
+
+// static
+void QueryStatsStore::recordOperation(OperationContext* opCtx) {
+    CurOp* curOp = CurOp::get(opCtx);
+    const OpDebug& debug = curOp->debug();
+    if (debug.queryStatsKey.empty() || !internalQueryStatsStoreEnabled.load()) {
+        return;
+    }
+
+    Execution execution;
+    execution.micros = debug.executionTimeMicros;
+    execution.readWriteType = curOp->getReadWriteType();
+    execution.keysExamined = nonNegative(debug.keysExamined);
+    execution.docsExamined = nonNegative(debug.docsExamined);
+    execution.nreturned = nonNegative(debug.nreturned);
+    execution.bytesReturned = nonNegative(debug.responseLength);
+    execution.planSummary = curOp->getPlanSummary().toString();
+    execution.now = opCtx->getServiceContext()->getFastClockSource()->now();
+
+    get(opCtx->getServiceContext())
+        .record(debug.queryStatsKey, curOp->getNS(), debug.queryStatsShape, execution);
+}
+
+QueryStatsStore::QueryStatsStore() {
+    for (size_t i = 0; i < kNumStripes; ++i) {
+        _stripes.push_back(stdx::make_unique<Stripe>());
+    }
+}
+
+QueryStatsStore::Stripe* QueryStatsStore::getStripe(const std::string& key) const {
+    return _stripes[std::hash<std::string>()(key) % _stripes.size()].get();
+}
+
+bool QueryStatsStore::contains(const std::string& key) const {
+    Stripe* stripe = getStripe(key);
+    stdx::lock_guard<stdx::mutex> lk(stripe->mutex);
+    return stripe->shapes.hasKey(key);
+}
+
+void QueryStatsStore::record(const std::string& key,
+                             StringData ns,
+                             const BSONObj& shape,
+                             const Execution& execution) {
+    Stripe* stripe = getStripe(key);
+    stdx::lock_guard<stdx::mutex> lk(stripe->mutex);
+
+    QueryShapeStats* stats;
+    if (!stripe->shapes.get(key, &stats).isOK()) {
+        // The shape was evicted since the operation found it in the store, and nothing describes
+        // it anymore.
+        if (shape.isEmpty()) {
+            return;
+        }
+
+        stats = new QueryShapeStats();
+        stats->ns = ns.toString();
+        stats->shape = shape.getOwned();
+        stats->firstSeen = execution.now;
+        stripe->shapes.add(key, stats);
+
+        // Every stripe holds at least one shape, so that the shape being recorded is never the
+        // one evicted.
+        const size_t maxSize = std::max(0, internalQueryStatsStoreSize.load());
+        const size_t stripeSize = std::max(size_t(1), (maxSize + kNumStripes - 1) / kNumStripes);
+        while (stripe->shapes.size() > stripeSize) {
+            const std::string evictedKey = std::prev(stripe->shapes.end())->first;
+            Status removed = stripe->shapes.remove(evictedKey);
+            invariant(removed.isOK());
+        }
+    }
+
+    ++stats->execCount;
+    stats->totalExecMicros += execution.micros;
+    stats->latency.increment(execution.micros, execution.readWriteType);
+    stats->keysExamined += execution.keysExamined;
+    stats->docsExamined += execution.docsExamined;
+    stats->nreturned += execution.nreturned;
+    stats->bytesReturned += execution.bytesReturned;
+    if (!execution.planSummary.empty()) {
+        stats->planSummary = execution.planSummary;
+    }
+    stats->lastSeen = execution.now;
+}
+
+std::vector<BSONObj> QueryStatsStore::getStats() const {
+    std::vector<BSONObj> stats;
+    for (auto&& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> lk(stripe->mutex);
+        for (auto it = stripe->shapes.begin(); it != stripe->shapes.end(); ++it) {
+            stats.push_back(it->second->toBSON());
+        }
+    }
+    return stats;
+}
+
+void QueryStatsStore::clear() {
+    for (auto&& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> lk(stripe->mutex);
+        stripe->shapes.clear();
+    }
+}
+
+size_t QueryStatsStore::size() const {
+    size_t size = 0;
+    for (auto&& stripe : _stripes) {
+        stdx::lock_guard<stdx::mutex> lk(stripe->mutex);
+        size += stripe->shapes.size();
+    }
+    return size;
+}
+
+}  // namespace mongo
@@ -0,0 +1,181 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class CanonicalQuery;
+class NamespaceString;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * What the operations of one query shape have cost so far.
+ */
+struct QueryShapeStats {
+    BSONObj toBSON() const;
+
+    std::string ns;
+
+    // The query, sort, projection and collation of the first operation of the shape.
+    BSONObj shape;
+
+    long long execCount = 0;
+    long long totalExecMicros = 0;
+    OperationLatencyHistogram latency;
+
+    long long keysExamined = 0;
+    long long docsExamined = 0;
+    long long nreturned = 0;
+    long long bytesReturned = 0;
+
+    // The plan summary of the latest operation.
+    std::string planSummary;
+
+    Date_t firstSeen;
+    Date_t lastSeen;
+};
+
+/**
+ * Accumulates the cost of the operations of each query shape of the server, so that the most
+ * expensive shapes can be found without enabling the profiler. Read through the $queryStats
+ * aggregation stage.
+ *
+ * A shape is identified by its namespace and its plan cache key. An operation takes the shape of
+ * the first query it plans; getMores take the shape of their cursor's query. Updates and deletes
+ * by _id don't plan a query and have no shape.
+ *
+ * The store is partitioned into stripes by the hash of the key, each with its own mutex and
+ * holding its share of internalQueryStatsStoreSize shapes. The least recently executed shapes of a
+ * stripe are evicted to make room for a new one.
+ */
+class QueryStatsStore {
+    MONGO_DISALLOW_COPYING(QueryStatsStore);
+
+public:
+    /**
+     * The cost of a single operation.
+     */
+    struct Execution {
+        long long micros = 0;
+        Command::ReadWriteType readWriteType = Command::ReadWriteType::kRead;
+        long long keysExamined = 0;
+        long long docsExamined = 0;
+        long long nreturned = 0;
+        long long bytesReturned = 0;
+        std::string planSummary;
+        Date_t now;
+    };
+
+    static QueryStatsStore& get(ServiceContext* service);
+
+    /**
+     * Returns the key identifying the shape whose plan cache key is 'planCacheKey' within the
+     * collection 'ns'.
+     */
+    static std::string makeKey(StringData ns, const PlanCacheKey& planCacheKey);
+
+    /**
+     * Attributes the operation 'opCtx' to the shape of 'cq', unless it already has a shape or the
+     * store is disabled. 'planCache' is the plan cache of the collection of 'cq'.
+     *
+     * Callers must hold the collection lock, as for PlanCache::computeKey().
+     */
+    static void noteQueryShape(OperationContext* opCtx,
+                               const PlanCache& planCache,
+                               const CanonicalQuery& cq);
+
+    /**
+     * Adds the cost of the completed operation 'opCtx', as reported in its CurOp, to the stats of
+     * its shape. Does nothing if the operation has no shape.
+     */
+    static void recordOperation(OperationContext* opCtx);
+
+    QueryStatsStore();
+
+    /**
+     * Returns true if the shape 'key' is tracked.
+     */
+    bool contains(const std::string& key) const;
+
+    /**
+     * Adds 'execution' to the stats of the shape 'key' of collection 'ns'. If the shape isn't
+     * tracked yet, starts tracking it as described by 'shape', or drops 'execution' if 'shape' is
+     * empty.
+     */
+    void record(const std::string& key,
+                StringData ns,
+                const BSONObj& shape,
+                const Execution& execution);
+
+    /**
+     * Returns the stats of each shape tracked.
+     */
+    std::vector<BSONObj> getStats() const;
+
+    /**
+     * Forgets every shape.
+     */
+    void clear();
+
+    /**
+     * Returns the number of shapes tracked.
+     */
+    size_t size() const;
+
+private:
+    struct Stripe {
+        // Bounded by the stripe's share of internalQueryStatsStoreSize rather than by its own
+        // maximum size, so that the knob can change at runtime.
+        LRUKeyValue<std::string, QueryShapeStats> shapes{std::numeric_limits<size_t>::max()};
+
+        // Protects 'shapes'.
+        stdx::mutex mutex;
+    };
+
+    Stripe* getStripe(const std::string& key) const;
+
+    std::vector<std::unique_ptr<Stripe>> _stripes;
+};
+
+}  // namespace mongo
@@ -0,0 +1,132 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/query_stats_store.h
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_stats_store.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+const BSONObj kShape =
+    BSON("query" << BSON("a" << 1) << "sort" << BSONObj() << "projection" << BSONObj());
+
+QueryStatsStore::Execution makeExecution(long long micros, long long keysExamined) {
+    QueryStatsStore::Execution execution;
+    execution.micros = micros;
+    execution.keysExamined = keysExamined;
+    execution.docsExamined = keysExamined;
+    execution.nreturned = 1;
+    execution.bytesReturned = 100;
+    execution.planSummary = "IXSCAN { a: 1 }";
+    execution.now = Date_t::fromMillisSinceEpoch(micros);
+    return execution;
+}
+
+TEST(QueryStatsStoreTest, KeySeparatesNamespaceFromShape) {
+    ASSERT_NE(QueryStatsStore::makeKey("test.a", "eqb"), QueryStatsStore::makeKey("test.ae", "qb"));
+}
+
+TEST(QueryStatsStoreTest, AccumulatesExecutionsOfAShape) {
+    QueryStatsStore store;
+    const std::string key = QueryStatsStore::makeKey("test.coll", "eqa");
+    ASSERT_FALSE(store.contains(key));
+
+    store.record(key, "test.coll", kShape, makeExecution(10, 5));
+    ASSERT_TRUE(store.contains(key));
+
+    // Later executions don't need to describe the shape again.
+    store.record(key, "test.coll", BSONObj(), makeExecution(30, 7));
+
+    std::vector<BSONObj> stats = store.getStats();
+    ASSERT_EQ(1U, stats.size());
+    ASSERT_EQ("test.coll", stats[0]["ns"].str());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1), stats[0]["query"].Obj());
+    ASSERT_EQ(2, stats[0]["execCount"].numberLong());
+    ASSERT_EQ(40, stats[0]["totalExecMicros"].numberLong());
+    ASSERT_EQ(12, stats[0]["keysExamined"].numberLong());
+    ASSERT_EQ(12, stats[0]["docsExamined"].numberLong());
+    ASSERT_EQ(2, stats[0]["nreturned"].numberLong());
+    ASSERT_EQ(200, stats[0]["bytesReturned"].numberLong());
+    ASSERT_EQ("IXSCAN { a: 1 }", stats[0]["planSummary"].str());
+    ASSERT_EQ(Date_t::fromMillisSinceEpoch(10), stats[0]["firstSeen"].date());
+    ASSERT_EQ(Date_t::fromMillisSinceEpoch(30), stats[0]["lastSeen"].date());
+    ASSERT_EQ(2, stats[0]["latency"]["reads"]["ops"].numberLong());
+}
+
+TEST(QueryStatsStoreTest, DropsExecutionOfAnUndescribedShape) {
+    QueryStatsStore store;
+    const std::string key = QueryStatsStore::makeKey("test.coll", "eqa");
+    store.record(key, "test.coll", BSONObj(), makeExecution(10, 5));
+    ASSERT_FALSE(store.contains(key));
+    ASSERT_EQ(0U, store.size());
+}
+
+TEST(QueryStatsStoreTest, ClearForgetsEveryShape) {
+    QueryStatsStore store;
+    for (auto&& planCacheKey : {"eqa", "eqb"}) {
+        store.record(QueryStatsStore::makeKey("test.coll", planCacheKey),
+                     "test.coll",
+                     kShape,
+                     makeExecution(1, 1));
+    }
+    ASSERT_EQ(2U, store.size());
+
+    store.clear();
+    ASSERT_EQ(0U, store.size());
+    ASSERT_TRUE(store.getStats().empty());
+}
+
+TEST(QueryStatsStoreTest, EvictsLeastRecentlyExecutedShapes) {
+    const int oldSize = internalQueryStatsStoreSize.load();
+    internalQueryStatsStoreSize.store(0);
+    ON_BLOCK_EXIT([&] { internalQueryStatsStoreSize.store(oldSize); });
+
+    // Each of the 16 stripes holds a single shape.
+    QueryStatsStore store;
+    std::string key;
+    for (int i = 0; i < 100; ++i) {
+        key = QueryStatsStore::makeKey("test.coll", str::stream() << "eqa" << i);
+        store.record(key, "test.coll", kShape, makeExecution(1, 1));
+    }
+    ASSERT_LTE(store.size(), 16U);
+    ASSERT_TRUE(store.contains(key));
+}
+
+}  // namespace
+}  // namespace mongo
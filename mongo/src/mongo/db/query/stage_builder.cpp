@@ -43,6 +43,7 @@
 #include "mongo/db/exec/distinct_scan.h"
 #include "mongo/db/exec/ensure_sorted.h"
 #include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/gather.h"
 #include "mongo/db/exec/geo_near.h"
 #include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/keep_mutations.h"
@@ -57,6 +58,7 @@
 #include "mongo/db/exec/text.h"
 #include "mongo/db/index/fts_access_method.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -76,6 +78,12 @@ PlanStage* buildStages(OperationContext* opCtx,     //
     switch (root->getType()) {
         case STAGE_COLLSCAN: { 
             const CollectionScanNode* csn = static_cast<const CollectionScanNode*>(root);
+            const int degreeOfParallelism = internalQueryExecParallelCollectionScanDegree.load();
+            if (csn->parallel && degreeOfParallelism > 1 && nullptr != collection &&
+                GatherStage::canScanInParallel(opCtx, collection, csn->filter.get())) {
+                return new GatherStage(
+                    opCtx, collection, degreeOfParallelism, ws, csn->filter.get());
+            }
             CollectionScanParams params;
             params.collection = collection;
             params.tailable = csn->tailable;
@@ -103,6 +111,7 @@ PlanStage* buildStages(OperationContext* opCtx,     //
             params.direction = ixn->direction;
             params.maxScan = ixn->maxScan;
             params.addKeyMetadata = ixn->addKeyMetadata;
+            params.isSkipScan = ixn->isSkipScan;
             return new IndexScan(opCtx, params, ws, ixn->filter.get());
         }
         case STAGE_FETCH: {
@@ -125,6 +134,8 @@ PlanStage* buildStages(OperationContext* opCtx,     //
             params.collection = collection;
             params.pattern = sn->pattern;
             params.limit = sn->limit;
+            params.allowDiskUse = cq.getQueryRequest().allowDiskUse();
+            params.fetchLate = internalQueryExecEnableSortLateFetch.load();
             return new SortStage(opCtx, params, ws, childStage);
         }
         case STAGE_SORT_KEY_GENERATOR: {
@@ -185,6 +196,9 @@ PlanStage* buildStages(OperationContext* opCtx,     //
         case STAGE_AND_HASH: {
             const AndHashNode* ahn = static_cast<const AndHashNode*>(root);
             auto ret = make_unique<AndHashStage>(opCtx, ws, collection);
+            if (ahn->canHoldRecordIdsOnly) {
+                ret->allowRecordIdsOnly();
+            }
             for (size_t i = 0; i < ahn->children.size(); ++i) {
 				//ݹ
                 PlanStage* childStage =
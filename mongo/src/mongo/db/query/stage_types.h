@@ -128,6 +128,9 @@ enum StageType { //
     STAGE_TEXT_OR,
     STAGE_TEXT_MATCH, //35
 
+    // Splits a collection scan into ranges of RecordIds which are scanned by several threads.
+    STAGE_GATHER,
+
     STAGE_UNKNOWN,
 
     STAGE_UPDATE,
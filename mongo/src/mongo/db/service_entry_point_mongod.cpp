@@ -55,6 +55,7 @@
 #include "mongo/db/ops/write_ops.h"
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/query/find.h"
+#include "mongo/db/query/query_stats_store.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/repl/read_concern_args.h"
@@ -1323,6 +1324,11 @@ DbResponse ServiceEntryPointMongod::handleRequest(OperationContext* opCtx, const
             durationCount<Microseconds>(currentOp.elapsedTimeExcludingPauses()),
             currentOp.getReadWriteType());
 
+    // Charge the operation to the shape of its query, if it planned one.
+    if (!c.isInDirectClient()) {
+        QueryStatsStore::recordOperation(opCtx);
+    }
+
     const bool shouldSample = serverGlobalParams.sampleRate == 1.0
         ? true
         : c.getPrng().nextCanonicalDouble() < serverGlobalParams.sampleRate;
@@ -447,6 +447,9 @@ public:
     size_t memUsed() const {
         return _memUsed;
     }
+    size_t bytesSpilled() const {
+        return _bytesSpilled;
+    }
 
 private:
     class STLComparator {
@@ -499,6 +502,7 @@ private:
         }
 
         _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+        _bytesSpilled += writer.bytesWritten();
 
         _memUsed = 0;
     }
@@ -507,6 +511,7 @@ private:
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
+    size_t _bytesSpilled = 0;
 	//KVӵqueue
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
@@ -556,6 +561,9 @@ public:
     size_t memUsed() const {
         return _best.first.memUsageForSorter() + _best.second.memUsageForSorter();
     }
+    size_t bytesSpilled() const {
+        return 0;
+    }
 
 private:
     const Comparator _comp;
@@ -655,6 +663,9 @@ public:
     size_t memUsed() const {
         return _memUsed;
     }
+    size_t bytesSpilled() const {
+        return _bytesSpilled;
+    }
 
 private:
     class STLComparator {
@@ -789,6 +800,7 @@ private:
         std::vector<Data>().swap(_data);
 
         _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+        _bytesSpilled += writer.bytesWritten();
 
         _memUsed = 0;
     }
@@ -797,6 +809,7 @@ private:
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
+    size_t _bytesSpilled = 0;
     std::vector<Data> _data;  // the "current" data. Organized as max-heap if size == limit.
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
 
@@ -908,6 +921,7 @@ void SortedFileWriter<Key, Value>::spill() {
     try {
         _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
         _file.write(outBuffer, std::abs(size));
+        _bytesWritten += sizeof(size) + std::abs(size);
 
     } catch (const std::exception&) {
         msgasserted(16821,
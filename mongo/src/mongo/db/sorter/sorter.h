@@ -188,6 +188,9 @@ public:
     virtual int numFiles() const = 0;
     virtual size_t memUsed() const = 0;
 
+    /// Number of bytes written to disk so far, after compression.
+    virtual size_t bytesSpilled() const = 0;
+
 protected:
     Sorter() {}  // can only be constructed as a base
 };
@@ -209,6 +212,11 @@ public:
     void addAlreadySorted(const Key&, const Value&);
     Iterator* done();  /// Can't add more data after calling done()
 
+    /// Number of bytes written to the file so far, all of them once done() has been called.
+    size_t bytesWritten() const {
+        return _bytesWritten;
+    }
+
 private:
     void spill();
 
@@ -217,6 +225,7 @@ private:
     std::shared_ptr<sorter::FileDeleter> _fileDeleter;  // Must outlive _file
     std::ofstream _file;
     BufBuilder _buffer;
+    size_t _bytesWritten = 0;
 };
 }
 
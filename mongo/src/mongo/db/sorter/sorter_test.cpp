@@ -500,6 +500,7 @@ public:
             // don't do this check in subclasses since they may set a limit
             ASSERT_GREATER_THAN_OR_EQUALS(static_cast<size_t>(sorter->numFiles()),
                                           (NUM_ITEMS * sizeof(IWPair)) / MEM_LIMIT);
+            ASSERT_GREATER_THAN(sorter->bytesSpilled(), 0U);
         }
     }
 
@@ -273,6 +273,15 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Positions the cursor so that the next call to next() returns the first Record at or after
+     * the provided id in the direction of the cursor, which need not exist. Returns false
+     * without moving the cursor if seeking to an arbitrary id is not supported.
+     */
+    virtual bool seekNear(const RecordId& id) {
+        return false;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
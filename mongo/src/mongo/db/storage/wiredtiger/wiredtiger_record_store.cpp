@@ -1851,6 +1851,36 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
 }
 
+bool WiredTigerRecordStoreCursorBase::seekNear(const RecordId& id) {
+    _skipNextAdvance = false;
+    WT_CURSOR* c = _cursor->get();
+    setKey(c, id);
+    int cmp;
+    // Nothing after the next line can throw WCEs.
+    int ret = WT_READ_CHECK(c->search_near(c, &cmp));
+    if (ret == WT_NOTFOUND) {
+        _eof = true;
+        return true;
+    }
+    invariantWTOK(ret);
+
+    // search_near() lands on a neighbor of 'id' on either side. A record ahead of 'id' in the
+    // direction of the cursor is the next one to return, otherwise next() has to move past it.
+    const bool landedAhead = cmp == 0 || (_forward ? cmp > 0 : cmp < 0);
+    RecordId landedId;
+    if (landedAhead && hasWrongPrefix(c, &landedId)) {
+        _eof = true;
+        return true;
+    }
+
+    _eof = false;
+    _skipNextAdvance = landedAhead;
+
+    // Act as if the record just before 'id' was returned so that restore() resumes from 'id'.
+    _lastReturnedId = RecordId(_forward ? id.repr() - 1 : id.repr() + 1);
+    return true;
+}
+
 
 void WiredTigerRecordStoreCursorBase::save() {
     try {
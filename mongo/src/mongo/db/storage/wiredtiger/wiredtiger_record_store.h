@@ -425,6 +425,8 @@ public:
 
     boost::optional<Record> seekExact(const RecordId& id);
 
+    bool seekNear(const RecordId& id);
+
     void save();
 
     void saveUnpositioned();
@@ -261,6 +261,59 @@ TEST(WiredTigerRecordStoreTest, CappedCursorRollover) {
     ASSERT(!cursor->next());
 }
 
+TEST(WiredTigerRecordStoreTest, SeekNear) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    std::vector<RecordId> ids;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int i = 0; i < 10; ++i) {
+            WriteUnitOfWork uow(opCtx.get());
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, Timestamp(), false);
+            ASSERT_OK(res.getStatus());
+            ids.push_back(res.getValue());
+            uow.commit();
+        }
+        WriteUnitOfWork uow(opCtx.get());
+        rs->deleteRecord(opCtx.get(), ids[4]);
+        uow.commit();
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+    // An existing record is returned next.
+    auto cursor = rs->getCursor(opCtx.get());
+    ASSERT(cursor->seekNear(ids[2]));
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[2], record->id);
+
+    // A missing record is skipped in the direction of the cursor.
+    ASSERT(cursor->seekNear(ids[4]));
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[5], record->id);
+
+    auto reverseCursor = rs->getCursor(opCtx.get(), false);
+    ASSERT(reverseCursor->seekNear(ids[4]));
+    record = reverseCursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[3], record->id);
+
+    // The position survives a save and restore.
+    ASSERT(cursor->seekNear(ids[4]));
+    cursor->save();
+    ASSERT(cursor->restore());
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[5], record->id);
+
+    // Past the last record.
+    ASSERT(cursor->seekNear(RecordId(ids[9].repr() + 1)));
+    ASSERT(!cursor->next());
+}
+
 RecordId _oplogOrderInsertOplog(OperationContext* opCtx,
                                 const unique_ptr<RecordStore>& rs,
                                 int inc) {
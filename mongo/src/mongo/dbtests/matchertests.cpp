@@ -31,13 +31,18 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/json.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
 #include "mongo/dbtests/dbtests.h"
@@ -272,6 +277,125 @@ public:
     }
 };
 
+/**
+ * Compares the time taken to match documents by walking the MatchExpression tree and by its
+ * CompiledMatchExpression.
+ */
+template <typename M>
+class CompiledTiming {
+public:
+    void run() {
+        dotime("eq", BSON("x" << 5), BSON("x" << 5));
+        dotime("range",
+               fromjson("{x: {$gt: 1, $lt: 10}, y: 'foo'}"),
+               fromjson("{w: 1, x: 5, y: 'foo'}"));
+        dotime("dotted",
+               fromjson("{'a.b.c': {$gte: 3}, 'a.d': {$exists: true}}"),
+               fromjson("{a: {b: {c: 4}, d: 1}}"));
+        dotime("selective",
+               fromjson("{x: {$gte: 0}, y: {$in: [1, 2, 3]}, z: 'bar'}"),
+               fromjson("{x: 1, y: 2, z: 'foo'}"));
+        dotime("generic",
+               fromjson("{x: 5, $or: [{y: 1}, {z: 1}]}"),
+               fromjson("{x: 5, y: 2, z: 1}"));
+        dotime("array", fromjson("{x: 5, y: {$gt: 0}}"), fromjson("{x: [1, 5], y: 1}"));
+    }
+
+private:
+    void dotime(StringData name, const BSONObj& patt, const BSONObj& obj) {
+        boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+        M m(patt, expCtx);
+        const MatchExpression* expr = m.getMatchExpression();
+        auto compiledExpr = CompiledMatchExpression::compile(expr);
+        ASSERT(compiledExpr);
+        const bool expected = expr->matchesBSON(obj);
+
+        Timer treeTimer;
+        for (int i = 0; i < 900000; i++) {
+            if (expr->matchesBSON(obj) != expected) {
+                ASSERT(0);
+            }
+        }
+        long tree = treeTimer.millis();
+
+        Timer compiledTimer;
+        for (int i = 0; i < 900000; i++) {
+            if (compiledExpr->matchesBSON(obj) != expected) {
+                ASSERT(0);
+            }
+        }
+        long compiled = compiledTimer.millis();
+
+        cout << "CompiledTiming " << name << " tree: " << tree << " compiled: " << compiled
+             << endl;
+    }
+};
+
+/**
+ * Compares the time taken to evaluate representative expression trees against one document at a
+ * time and against batches of documents.
+ */
+class EvaluateBatchTiming {
+public:
+    void run() {
+        std::vector<Document> roots;
+        for (int i = 0; i < 1000; ++i) {
+            roots.push_back(Document{{"price", 1.5 + i},
+                                     {"qty", i % 100},
+                                     {"tax", 8},
+                                     {"ts", Date_t::fromMillisSinceEpoch(1500000000000LL + i)},
+                                     {"name", "widget"_sd},
+                                     {"sku", "ABCD-1234"_sd}});
+        }
+
+        dotime("arithmetic",
+               fromjson("{e: {$add: [{$multiply: ['$price', '$qty']}, {$divide: ['$tax', 100]}]}}"),
+               roots);
+        dotime("comparison", fromjson("{e: {$gte: ['$qty', 10]}}"), roots);
+        dotime("cond",
+               fromjson("{e: {$cond: [{$gt: ['$qty', 50]}, {$multiply: ['$price', 0.9]}, "
+                        "'$price']}}"),
+               roots);
+        dotime("date",
+               fromjson("{e: {$month: {date: '$ts', timezone: 'America/New_York'}}}"),
+               roots);
+        dotime("string",
+               fromjson("{e: {$concat: [{$toUpper: '$name'}, '-', {$substrBytes: ['$sku', 0, "
+                        "4]}]}}"),
+               roots);
+    }
+
+private:
+    void dotime(StringData name, const BSONObj& spec, const std::vector<Document>& roots) {
+        boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+        auto expression =
+            Expression::parseOperand(expCtx, spec.firstElement(), expCtx->variablesParseState);
+        const size_t batchSize = 64;
+
+        Timer oneAtATimeTimer;
+        for (int i = 0; i < 100; ++i) {
+            for (auto&& root : roots) {
+                expression->evaluate(root);
+            }
+        }
+        long oneAtATime = oneAtATimeTimer.millis();
+
+        std::vector<Value> results;
+        Timer batchTimer;
+        for (int i = 0; i < 100; ++i) {
+            for (size_t begin = 0; begin < roots.size(); begin += batchSize) {
+                const size_t end = std::min(begin + batchSize, roots.size());
+                const std::vector<Document> batch(roots.begin() + begin, roots.begin() + end);
+                expression->evaluateBatch(batch, &results);
+            }
+        }
+        long batch = batchTimer.millis();
+
+        cout << "EvaluateBatchTiming " << name << " oneAtATime: " << oneAtATime
+             << " batch: " << batch << endl;
+    }
+};
+
 /** Test that 'collator' is passed to MatchExpressionParser::parse(). */
 template <typename M>
 class NullCollator {
@@ -319,6 +443,8 @@ public:
         ADD_BOTH(ElemMatchKey);
         ADD_BOTH(WhereSimple1);
         ADD_BOTH(AllTiming);
+        ADD_BOTH(CompiledTiming);
+        add<EvaluateBatchTiming>();
         ADD_BOTH(WithinBox);
         ADD_BOTH(WithinCenter);
         ADD_BOTH(WithinPolygon);
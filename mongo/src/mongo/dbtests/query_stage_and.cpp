@@ -461,6 +461,63 @@ public:
     }
 };
 
+// Like QueryStageAndHashTwoLeafFirstChildLargeKeys, but the stage may drop the buffered keys
+// and hold only RecordIds when it runs out of memory.
+class QueryStageAndHashTwoLeafFirstChildLargeKeysRecordIdsOnly : public QueryStageAndBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = ctx.getCollection();
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        // Generate large keys for {foo: 1, big: 1} index.
+        std::string big(512, 'a');
+        for (int i = 0; i < 50; ++i) {
+            insert(BSON("foo" << i << "bar" << i << "big" << big));
+        }
+
+        addIndex(BSON("foo" << 1 << "big" << 1));
+        addIndex(BSON("bar" << 1));
+
+        // Lower buffer limit to 20 * sizeof(big) so that the keys of the first
+        // child don't fit, but its RecordIds do.
+        WorkingSet ws;
+        auto ah = make_unique<AndHashStage>(&_opCtx, &ws, coll, 20 * big.size());
+        ah->allowRecordIdsOnly();
+
+        // Foo <= 20
+        IndexScanParams params;
+        params.descriptor = getIndex(BSON("foo" << 1 << "big" << 1), coll);
+        params.bounds.isSimpleRange = true;
+        params.bounds.startKey = BSON("" << 20 << "" << big);
+        params.bounds.endKey = BSONObj();
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        params.direction = -1;
+        ah->addChild(new IndexScan(&_opCtx, params, &ws, NULL));
+
+        // Bar >= 10
+        params.descriptor = getIndex(BSON("bar" << 1), coll);
+        params.bounds.startKey = BSON("" << 10);
+        params.bounds.endKey = BSONObj();
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        params.direction = 1;
+        ah->addChild(new IndexScan(&_opCtx, params, &ws, NULL));
+
+        // foo == bar, and foo<=20, bar>=10, so our values are:
+        // foo == 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20.
+        ASSERT_EQUALS(11, countResults(ah.get()));
+
+        const AndHashStats* stats = static_cast<const AndHashStats*>(ah->getSpecificStats());
+        ASSERT(stats->recordIdsOnly);
+        ASSERT_LTE(ah->getMemUsage(), 20 * big.size());
+    }
+};
+
 // An AND with three children.
 // Add large keys (512 bytes) to index of last child to verify that
 // keys in last child are not buffered
@@ -637,6 +694,73 @@ public:
     }
 };
 
+// Like QueryStageAndHashThreeLeafMiddleChildLargeKeys, but the stage may drop the buffered
+// keys and hold only RecordIds when it runs out of memory.
+class QueryStageAndHashThreeLeafMiddleChildLargeKeysRecordIdsOnly : public QueryStageAndBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = ctx.getCollection();
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        // Generate large keys for {bar: 1, big: 1} index.
+        std::string big(512, 'a');
+        for (int i = 0; i < 50; ++i) {
+            insert(BSON("foo" << i << "bar" << i << "baz" << i << "big" << big));
+        }
+
+        addIndex(BSON("foo" << 1));
+        addIndex(BSON("bar" << 1 << "big" << 1));
+        addIndex(BSON("baz" << 1));
+
+        // Lower buffer limit to 10 * sizeof(big) so that the stage runs out of
+        // memory while it is reading the second child.
+        WorkingSet ws;
+        auto ah = make_unique<AndHashStage>(&_opCtx, &ws, coll, 10 * big.size());
+        ah->allowRecordIdsOnly();
+
+        // Foo <= 20
+        IndexScanParams params;
+        params.descriptor = getIndex(BSON("foo" << 1), coll);
+        params.bounds.isSimpleRange = true;
+        params.bounds.startKey = BSON("" << 20);
+        params.bounds.endKey = BSONObj();
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        params.direction = -1;
+        ah->addChild(new IndexScan(&_opCtx, params, &ws, NULL));
+
+        // Bar >= 10
+        params.descriptor = getIndex(BSON("bar" << 1 << "big" << 1), coll);
+        params.bounds.startKey = BSON("" << 10 << "" << big);
+        params.bounds.endKey = BSONObj();
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        params.direction = 1;
+        ah->addChild(new IndexScan(&_opCtx, params, &ws, NULL));
+
+        // 5 <= baz <= 15
+        params.descriptor = getIndex(BSON("baz" << 1), coll);
+        params.bounds.startKey = BSON("" << 5);
+        params.bounds.endKey = BSON("" << 15);
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        params.direction = 1;
+        ah->addChild(new IndexScan(&_opCtx, params, &ws, NULL));
+
+        // foo == bar == baz, and foo<=20, bar>=10, 5<=baz<=15, so our values are:
+        // foo == 10, 11, 12, 13, 14, 15.
+        ASSERT_EQUALS(6, countResults(ah.get()));
+
+        const AndHashStats* stats = static_cast<const AndHashStats*>(ah->getSpecificStats());
+        ASSERT(stats->recordIdsOnly);
+        ASSERT_EQUALS(2U, stats->mapAfterChild.size());
+        ASSERT_EQUALS(11U, stats->mapAfterChild[1]);
+    }
+};
+
 // An AND with an index scan that returns nothing.
 class QueryStageAndHashWithNothing : public QueryStageAndBase {
 public:
@@ -1456,9 +1580,11 @@ public:
         add<QueryStageAndHashInvalidation>();
         add<QueryStageAndHashTwoLeaf>();
         add<QueryStageAndHashTwoLeafFirstChildLargeKeys>();
+        add<QueryStageAndHashTwoLeafFirstChildLargeKeysRecordIdsOnly>();
         add<QueryStageAndHashTwoLeafLastChildLargeKeys>();
         add<QueryStageAndHashThreeLeaf>();
         add<QueryStageAndHashThreeLeafMiddleChildLargeKeys>();
+        add<QueryStageAndHashThreeLeafMiddleChildLargeKeysRecordIdsOnly>();
         add<QueryStageAndHashWithNothing>();
         add<QueryStageAndHashProducesNothing>();
         add<QueryStageAndHashInvalidateLookahead>();
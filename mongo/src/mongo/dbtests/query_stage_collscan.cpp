@@ -78,11 +78,17 @@ public:
         _client.dropCollection(nss.ns());
     }
 
+    void insert(const BSONObj& obj) {
+        _client.insert(nss.ns(), obj);
+    }
+
     void remove(const BSONObj& obj) {
         _client.remove(nss.ns(), obj);
     }
 
-    int countResults(CollectionScanParams::Direction direction, const BSONObj& filterObj) {
+    int countResults(CollectionScanParams::Direction direction,
+                     const BSONObj& filterObj,
+                     size_t maxBatchWorks = 0) {
         AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
 
         // Configure the scan.
@@ -109,6 +115,7 @@ public:
             &_opCtx, std::move(ws), std::move(ps), params.collection, PlanExecutor::NO_YIELD);
         ASSERT_OK(statusWithPlanExecutor.getStatus());
         auto exec = std::move(statusWithPlanExecutor.getValue());
+        exec->enableBatchedExecution(maxBatchWorks);
 
         // Use the runner to count the number of objects scanned.
         int count = 0;
@@ -200,10 +207,73 @@ public:
     }
 };
 
+//
+// Match half the docs, pulling results from the scan in batches.
+//
+
+class QueryStageCollscanBatchedWithMatch : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        BSONObj obj = BSON("foo" << BSON("$lt" << 25));
+        for (size_t maxBatchWorks : {2, 7, 64}) {
+            ASSERT_EQUALS(25, countResults(CollectionScanParams::FORWARD, obj, maxBatchWorks));
+            ASSERT_EQUALS(25, countResults(CollectionScanParams::BACKWARD, obj, maxBatchWorks));
+        }
+    }
+};
+
 //
 // Get objects in the order we inserted them.
 //
 
+class QueryStageCollscanColumnarBatchEndsAtByteLimit : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        // Each of these documents is a quarter of the byte limit of a columnar batch.
+        const std::string padding(1024 * 1024, 'x');
+        for (int i = 0; i < 8; ++i) {
+            insert(BSON("foo" << 100 + i << "pad" << padding));
+        }
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        params.tailable = false;
+
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, nullptr));
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(fromjson("{foo: {$gte: 100}}"), expCtx);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        CollectionScan scan(&_opCtx, params, &ws, filterExpr.get());
+
+        int count = 0;
+        while (!scan.isEOF()) {
+            PlanStage::Batch batch;
+            PlanStage::StageState state = scan.workBatch(1000, &batch);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            ASSERT_NOT_EQUALS(PlanStage::DEAD, state);
+            ASSERT_LTE(batch.ids.size(), 4U);
+
+            for (auto&& id : batch.ids) {
+                WorkingSetMember* member = ws.get(id);
+                ASSERT_EQUALS(100 + count++, member->obj.value()["foo"].numberInt());
+                ASSERT_EQUALS(padding, member->obj.value()["pad"].String());
+                ws.free(id);
+            }
+        }
+        ASSERT_EQUALS(8, count);
+
+        const CollectionScanStats* stats =
+            static_cast<const CollectionScanStats*>(scan.getSpecificStats());
+        ASSERT_TRUE(stats->columnarFilter);
+    }
+};
+
 class QueryStageCollscanObjectsInOrderForward : public QueryStageCollectionScanBase {
 public:
     void run() {
@@ -410,6 +480,8 @@ public:
         add<QueryStageCollscanBasicBackward>();
         add<QueryStageCollscanBasicForwardWithMatch>();
         add<QueryStageCollscanBasicBackwardWithMatch>();
+        add<QueryStageCollscanBatchedWithMatch>();
+        add<QueryStageCollscanColumnarBatchEndsAtByteLimit>();
         add<QueryStageCollscanObjectsInOrderForward>();
         add<QueryStageCollscanObjectsInOrderBackward>();
         add<QueryStageCollscanInvalidateUpcomingObject>();
@@ -42,7 +42,10 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageCount {
 
@@ -356,6 +359,94 @@ public:
     }
 };
 
+class QueryStageCountApproximate : public CountStageTest {
+public:
+    void run() {
+        setup();
+
+        // Not every storage engine can sample a collection.
+        if (!_coll->getRecordStore()->getRandomCursor(&_opCtx)) {
+            return;
+        }
+
+        // Everything matches, so the estimate is exact however the sample falls.
+        ASSERT_EQUALS(kDocuments, approximateCount(BSON("x" << GTE << 0), 0, 0));
+        ASSERT_EQUALS(0, approximateCount(BSON("x" << LT << 0), 0, 0));
+
+        // The skip and limit apply to the estimate.
+        ASSERT_EQUALS(kDocuments - 10, approximateCount(BSON("x" << GTE << 0), 10, 0));
+        ASSERT_EQUALS(5, approximateCount(BSON("x" << GTE << 0), 0, 5));
+    }
+
+    // Returns the estimate of a count which samples 'kSampleSize' documents.
+    long long approximateCount(const BSONObj& query, long long skip, long long limit) {
+        const long long kSampleSize = 200;
+
+        CountRequest request(NamespaceString(ns()), query);
+        request.setSkip(skip);
+        request.setLimit(limit);
+
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, nullptr));
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(request.getQuery(), expCtx);
+        ASSERT(statusWithMatcher.isOK());
+        unique_ptr<MatchExpression> expression = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        const bool useRecordStoreCount = false;
+        CountStageParams params(request, useRecordStoreCount);
+        params.sampleCursor = _coll->getRecordStore()->getRandomCursor(&_opCtx);
+        params.sampleSize = kSampleSize;
+        params.sampleFilter = expression.get();
+        CountStage countStage(&_opCtx, _coll, std::move(params), &ws, nullptr);
+
+        const CountStats* stats = runCount(countStage);
+        ASSERT(stats->approximate);
+        ASSERT_EQUALS(kSampleSize, stats->nSampled);
+        // Even a sample which all or none matched leaves some uncertainty.
+        ASSERT_GT(stats->errorBound, 0);
+        ASSERT_LT(stats->errorBound, kDocuments / 10);
+        return stats->nCounted;
+    }
+};
+
+class QueryStageCountApproximateIsExactForTextAndNear : public CountStageTest {
+public:
+    void run() {
+        setup();
+        ASSERT_OK(dbtests::createIndex(&_opCtx, ns(), BSON("t"
+                                                          << "text")));
+        ASSERT_OK(dbtests::createIndex(&_opCtx, ns(), BSON("loc"
+                                                          << "2d")));
+        for (int i = 0; i < kDocuments; i++) {
+            insert(BSON(GENOID << "t" << (i < 5 ? "apple" : "pear") << "loc"
+                               << BSON_ARRAY(i << 0)));
+        }
+
+        const int oldSampleSize = internalQueryExecApproximateCountSampleSize.load();
+        ON_BLOCK_EXIT([&] { internalQueryExecApproximateCountSampleSize.store(oldSampleSize); });
+        internalQueryExecApproximateCountSampleSize.store(10);
+
+        // A sample tested against $text or $near would match every document it drew.
+        ASSERT_EQUALS(5, approximateCount(fromjson("{$text: {$search: 'apple'}}")));
+        ASSERT_EQUALS(5, approximateCount(fromjson("{loc: {$near: [0, 0], $maxDistance: 4.5}}")));
+    }
+
+    long long approximateCount(const BSONObj& query) {
+        CountRequest request(NamespaceString(ns()), query);
+        request.setApproximate(true);
+        auto exec = uassertStatusOK(
+            getExecutorCount(&_opCtx, _coll, request, false, PlanExecutor::NO_YIELD));
+        ASSERT_OK(exec->executePlan());
+
+        const CountStats* stats =
+            static_cast<const CountStats*>(exec->getRootStage()->getSpecificStats());
+        ASSERT_FALSE(stats->approximate);
+        return stats->nCounted;
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_count") {}
@@ -368,6 +459,8 @@ public:
         add<QueryStageCountDeleteDuringYield>();
         add<QueryStageCountUpdateDuringYield>();
         add<QueryStageCountMultiKeyDuringYield>();
+        add<QueryStageCountApproximate>();
+        add<QueryStageCountApproximateIsExactForTextAndNear>();
     }
 } QueryStageCountAll;
 
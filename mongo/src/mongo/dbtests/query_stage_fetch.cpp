@@ -35,10 +35,12 @@
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
@@ -219,6 +221,69 @@ public:
     }
 };
 
+//
+// Test that a batched fetch over an index scan reads each batch ahead of time, and still returns
+// the documents in index order.
+//
+class FetchStagePrefetchBatch : public QueryStageFetchBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(&_opCtx, ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        for (int i = 0; i < 50; ++i) {
+            insert(BSON("foo" << i));
+        }
+        ASSERT_OK(dbtests::createIndex(&_opCtx, ns(), BSON("foo" << 1)));
+
+        std::vector<IndexDescriptor*> indexes;
+        coll->getIndexCatalog()->findIndexesByKeyPattern(
+            &_opCtx, BSON("foo" << 1), false, &indexes);
+        ASSERT_EQUALS(size_t(1), indexes.size());
+
+        WorkingSet ws;
+
+        // Scan the index backwards, so that its order is the reverse of the RecordId order.
+        IndexScanParams params;
+        params.descriptor = indexes[0];
+        params.bounds.isSimpleRange = true;
+        params.bounds.startKey = BSON("" << 49);
+        params.bounds.endKey = BSON("" << 0);
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        params.direction = -1;
+
+        unique_ptr<FetchStage> fetchStage = make_unique<FetchStage>(
+            &_opCtx, &ws, new IndexScan(&_opCtx, params, &ws, NULL), nullptr, coll);
+
+        int expected = 49;
+        while (!fetchStage->isEOF()) {
+            PlanStage::Batch batch;
+            PlanStage::StageState state = fetchStage->workBatch(16, &batch);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            ASSERT_NOT_EQUALS(PlanStage::DEAD, state);
+
+            for (auto&& id : batch.ids) {
+                WorkingSetMember* member = ws.get(id);
+                ASSERT_TRUE(member->hasObj());
+                ASSERT_EQUALS(expected--, member->obj.value()["foo"].numberInt());
+                ws.free(id);
+            }
+        }
+        ASSERT_EQUALS(-1, expected);
+
+        const FetchStats* stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_GT(stats->prefetched, size_t(0));
+        ASSERT_EQUALS(size_t(0), stats->alreadyHasObj);
+        ASSERT_EQUALS(size_t(50), stats->docsExamined);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_fetch") {}
@@ -226,6 +291,7 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStagePrefetchBatch>();
     }
 };
 
@@ -0,0 +1,223 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file tests db/exec/gather.cpp.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/gather.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/dbtests/dbtests.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/scopeguard.h"
+
+namespace QueryStageGather {
+
+using std::unique_ptr;
+using stdx::make_unique;
+
+static const NamespaceString nss{"unittests.QueryStageGather"};
+
+class QueryStageGatherBase {
+public:
+    QueryStageGatherBase()
+        : _client(&_opCtx),
+          _minRecords(internalQueryExecParallelCollectionScanMinRecords.load()),
+          _roundSize(internalQueryExecParallelCollectionScanRoundSize.load()) {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+
+        for (int i = 0; i < numObj(); ++i) {
+            _client.insert(nss.ns(), BSON("foo" << i));
+        }
+
+        // Make the partitions take several rounds.
+        internalQueryExecParallelCollectionScanMinRecords.store(0);
+        internalQueryExecParallelCollectionScanRoundSize.store(7);
+    }
+
+    virtual ~QueryStageGatherBase() {
+        internalQueryExecParallelCollectionScanMinRecords.store(_minRecords);
+        internalQueryExecParallelCollectionScanRoundSize.store(_roundSize);
+
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+        _client.dropCollection(nss.ns());
+    }
+
+    static int numObj() {
+        return 100;
+    }
+
+    unique_ptr<MatchExpression> parse(const BSONObj& filterObj) {
+        const CollatorInterface* collator = nullptr;
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, collator));
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(filterObj, expCtx);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        return std::move(statusWithMatcher.getValue());
+    }
+
+    /**
+     * Runs a GatherStage with 'degreeOfParallelism' threads and returns the values of "foo" of
+     * the documents it produced, checking that none is produced twice.
+     */
+    std::set<int> gather(size_t degreeOfParallelism, const BSONObj& filterObj) {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        unique_ptr<MatchExpression> filterExpr = parse(filterObj);
+        ASSERT(GatherStage::canScanInParallel(&_opCtx, collection, filterExpr.get()));
+
+        unique_ptr<WorkingSet> ws = make_unique<WorkingSet>();
+        unique_ptr<PlanStage> ps = make_unique<GatherStage>(
+            &_opCtx, collection, degreeOfParallelism, ws.get(), filterExpr.get());
+
+        auto statusWithPlanExecutor = PlanExecutor::make(
+            &_opCtx, std::move(ws), std::move(ps), collection, PlanExecutor::NO_YIELD);
+        ASSERT_OK(statusWithPlanExecutor.getStatus());
+        auto exec = std::move(statusWithPlanExecutor.getValue());
+
+        std::set<int> values;
+        PlanExecutor::ExecState state;
+        for (BSONObj obj; PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL));) {
+            ASSERT(values.insert(obj["foo"].numberInt()).second);
+        }
+        ASSERT_EQUALS(PlanExecutor::IS_EOF, state);
+        return values;
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _txnPtr = cc().makeOperationContext();
+    OperationContext& _opCtx = *_txnPtr;
+
+private:
+    DBDirectClient _client;
+    const long long _minRecords;
+    const int _roundSize;
+};
+
+// Every document is returned once, whatever the number of partitions.
+class QueryStageGatherAllDocuments : public QueryStageGatherBase {
+public:
+    void run() {
+        for (size_t degree : {1, 2, 3, 8, 200}) {
+            ASSERT_EQUALS(static_cast<size_t>(numObj()), gather(degree, BSONObj()).size());
+        }
+    }
+};
+
+class QueryStageGatherWithMatch : public QueryStageGatherBase {
+public:
+    void run() {
+        std::set<int> values = gather(4, fromjson("{foo: {$gte: 20, $lt: 70}}"));
+        ASSERT_EQUALS(50U, values.size());
+        ASSERT_EQUALS(20, *values.begin());
+        ASSERT_EQUALS(69, *values.rbegin());
+    }
+};
+
+// Partition boundaries which fall on deleted records.
+class QueryStageGatherWithHoles : public QueryStageGatherBase {
+public:
+    void run() {
+        {
+            OldClientWriteContext ctx(&_opCtx, nss.ns());
+            DBDirectClient client(&_opCtx);
+            client.remove(nss.ns(), fromjson("{foo: {$gte: 10, $lt: 60}}"));
+        }
+        ASSERT_EQUALS(static_cast<size_t>(numObj() - 50), gather(4, BSONObj()).size());
+    }
+};
+
+class QueryStageGatherUnsafeFilter : public QueryStageGatherBase {
+public:
+    void run() {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        unique_ptr<MatchExpression> filterExpr = parse(fromjson("{$expr: {$eq: ['$foo', 1]}}"));
+        ASSERT_FALSE(
+            GatherStage::canScanInParallel(&_opCtx, ctx.getCollection(), filterExpr.get()));
+    }
+};
+
+// Killing the operation stops the workers, which scan with operation contexts of their own.
+class QueryStageGatherKilled : public QueryStageGatherBase {
+public:
+    void run() {
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        Status status = Status::OK();
+        stdx::thread([&] {
+            Client::initThread("QueryStageGatherKilled");
+            ON_BLOCK_EXIT([] { Client::destroy(); });
+            auto opCtx = cc().makeOperationContext();
+            AutoGetCollectionForReadCommand ctx(opCtx.get(), nss);
+            WorkingSet ws;
+            GatherStage stage(opCtx.get(), ctx.getCollection(), 4, &ws, nullptr);
+            opCtx->markKilled();
+
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            while (PlanStage::NEED_TIME == (state = stage.work(&id))) {
+            }
+            if (PlanStage::FAILURE == state) {
+                status = WorkingSetCommon::getMemberStatus(*ws.get(id));
+            }
+        }).join();
+
+        ASSERT_EQUALS(PlanStage::FAILURE, state);
+        ASSERT_EQUALS(ErrorCodes::Interrupted, status.code());
+    }
+};
+
+class All : public Suite {
+public:
+    All() : Suite("QueryStageGather") {}
+
+    void setupTests() {
+        add<QueryStageGatherAllDocuments>();
+        add<QueryStageGatherWithMatch>();
+        add<QueryStageGatherWithHoles>();
+        add<QueryStageGatherUnsafeFilter>();
+        add<QueryStageGatherKilled>();
+    }
+};
+
+SuiteInstance<All> all;
+}  // namespace QueryStageGather
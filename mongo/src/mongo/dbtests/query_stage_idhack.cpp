@@ -0,0 +1,247 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file tests the idhack fast path over unique secondary indexes.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/json.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/dbtests/dbtests.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+namespace {
+
+static const NamespaceString nss("unittests.QueryStageIDHack");
+
+class QueryStageIDHackTest : public unittest::Test {
+public:
+    QueryStageIDHackTest() : _client(_opCtx.get()) {
+        OldClientWriteContext ctx(_opCtx.get(), nss.ns());
+        _client.dropCollection(nss.ns());
+        for (int i = 0; i < 50; ++i) {
+            _client.insert(nss.ns(), BSON("_id" << i << "a" << i << "b" << i % 3));
+        }
+    }
+
+    virtual ~QueryStageIDHackTest() {
+        OldClientWriteContext ctx(_opCtx.get(), nss.ns());
+        _client.dropCollection(nss.ns());
+    }
+
+    void addIndex(const BSONObj& obj, bool unique) {
+        ASSERT_OK(dbtests::createIndex(_opCtx.get(), nss.ns(), obj, unique));
+    }
+
+    /**
+     * Runs the query 'filter', returning the stage type of the root of its plan and appending the
+     * documents it returns to 'results'.
+     */
+    StageType runQuery(const BSONObj& filter,
+                       std::vector<BSONObj>* results,
+                       const BSONObj& collation = BSONObj()) {
+        AutoGetCollectionForReadCommand ctx(_opCtx.get(), nss);
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(filter);
+        qr->setCollation(collation);
+        auto cq = uassertStatusOK(CanonicalQuery::canonicalize(_opCtx.get(), std::move(qr)));
+        auto exec = uassertStatusOK(getExecutor(
+            _opCtx.get(), ctx.getCollection(), std::move(cq), PlanExecutor::NO_YIELD, 0));
+
+        const StageType rootType = exec->getRootStage()->stageType();
+        BSONObj obj;
+        while (PlanExecutor::ADVANCED == exec->getNext(&obj, nullptr)) {
+            results->push_back(obj.getOwned());
+        }
+        return rootType;
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _opCtx = cc().makeOperationContext();
+    DBDirectClient _client;
+};
+
+TEST_F(QueryStageIDHackTest, EqualityOnUniqueIndex) {
+    addIndex(BSON("a" << 1), true);
+
+    std::vector<BSONObj> results;
+    ASSERT_EQ(STAGE_IDHACK, runQuery(BSON("a" << 7), &results));
+    ASSERT_EQ(1U, results.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 7 << "a" << 7 << "b" << 1), results[0]);
+
+    // A numerically equal value of another type finds the same document.
+    results.clear();
+    ASSERT_EQ(STAGE_IDHACK, runQuery(BSON("a" << 7.0), &results));
+    ASSERT_EQ(1U, results.size());
+}
+
+TEST_F(QueryStageIDHackTest, EqualityOnUniqueIndexFindsNothing) {
+    addIndex(BSON("a" << 1), true);
+
+    std::vector<BSONObj> results;
+    ASSERT_EQ(STAGE_IDHACK, runQuery(BSON("a" << 500), &results));
+    ASSERT_EQ(0U, results.size());
+}
+
+TEST_F(QueryStageIDHackTest, EqualitiesOnCompoundUniqueIndexInAnyOrder) {
+    addIndex(BSON("a" << 1 << "b" << -1), true);
+
+    std::vector<BSONObj> results;
+    ASSERT_EQ(STAGE_IDHACK, runQuery(BSON("b" << 2 << "a" << 8), &results));
+    ASSERT_EQ(1U, results.size());
+    ASSERT_EQ(8, results[0]["_id"].numberInt());
+
+    // The document with a: 8 has b: 2, so no document matches.
+    results.clear();
+    ASSERT_EQ(STAGE_IDHACK, runQuery(BSON("a" << 8 << "b" << 1), &results));
+    ASSERT_EQ(0U, results.size());
+}
+
+TEST_F(QueryStageIDHackTest, ProjectionCoveredByUniqueIndexIsPlanned) {
+    addIndex(BSON("a" << 1), true);
+
+    AutoGetCollectionForReadCommand ctx(_opCtx.get(), nss);
+    auto qr = stdx::make_unique<QueryRequest>(nss);
+    qr->setFilter(BSON("a" << 5));
+    qr->setProj(BSON("_id" << 0 << "a" << 1));
+    auto cq = uassertStatusOK(CanonicalQuery::canonicalize(_opCtx.get(), std::move(qr)));
+    auto exec = uassertStatusOK(getExecutor(
+        _opCtx.get(), ctx.getCollection(), std::move(cq), PlanExecutor::NO_YIELD, 0));
+
+    BSONObjBuilder bob;
+    Explain::explainStages(
+        exec.get(), ctx.getCollection(), ExplainOptions::Verbosity::kExecStats, &bob);
+    BSONObj explained = bob.done();
+
+    BSONObj winningPlan = explained["queryPlanner"]["winningPlan"].Obj();
+    ASSERT_EQ("PROJECTION", winningPlan["stage"].String());
+    ASSERT_EQ("IXSCAN", winningPlan["inputStage"]["stage"].String());
+    ASSERT_EQ(1, explained["executionStats"]["nReturned"].numberInt());
+    ASSERT_EQ(0, explained["executionStats"]["totalDocsExamined"].numberInt());
+}
+
+TEST_F(QueryStageIDHackTest, PrefixOfUniqueIndexIsPlanned) {
+    addIndex(BSON("a" << 1 << "b" << 1), true);
+
+    std::vector<BSONObj> results;
+    ASSERT_NOT_EQUALS(STAGE_IDHACK, runQuery(BSON("a" << 8), &results));
+    ASSERT_EQ(1U, results.size());
+}
+
+TEST_F(QueryStageIDHackTest, NonUniqueIndexIsPlanned) {
+    addIndex(BSON("b" << 1), false);
+
+    std::vector<BSONObj> results;
+    ASSERT_NOT_EQUALS(STAGE_IDHACK, runQuery(BSON("b" << 1), &results));
+    ASSERT_EQ(17U, results.size());
+}
+
+TEST_F(QueryStageIDHackTest, NullAndRangePredicatesArePlanned) {
+    addIndex(BSON("a" << 1), true);
+
+    std::vector<BSONObj> results;
+    ASSERT_NOT_EQUALS(STAGE_IDHACK, runQuery(fromjson("{a: null}"), &results));
+    ASSERT_EQ(0U, results.size());
+    ASSERT_NOT_EQUALS(STAGE_IDHACK, runQuery(fromjson("{a: {$gte: 48}}"), &results));
+    ASSERT_EQ(2U, results.size());
+}
+
+TEST_F(QueryStageIDHackTest, UniqueIndexWithCollationIsPlanned) {
+    {
+        OldClientWriteContext ctx(_opCtx.get(), nss.ns());
+        _client.remove(nss.ns(), BSONObj());
+        _client.insert(nss.ns(), BSON("_id" << 0 << "s"
+                                            << "abc"));
+        _client.insert(nss.ns(), BSON("_id" << 1 << "s"
+                                            << "xyz"));
+    }
+    const BSONObj caseInsensitive = BSON("locale"
+                                         << "en_US"
+                                         << "strength"
+                                         << 2);
+    ASSERT_OK(dbtests::createIndexFromSpec(_opCtx.get(),
+                                           nss.ns(),
+                                           BSON("name"
+                                                << "s_1"
+                                                << "ns"
+                                                << nss.ns()
+                                                << "key"
+                                                << BSON("s" << 1)
+                                                << "unique"
+                                                << true
+                                                << "collation"
+                                                << caseInsensitive)));
+
+    std::vector<BSONObj> results;
+    ASSERT_NOT_EQUALS(STAGE_IDHACK,
+                      runQuery(BSON("s"
+                                    << "ABC"),
+                               &results,
+                               caseInsensitive));
+    ASSERT_EQ(1U, results.size());
+    ASSERT_EQ(0, results[0]["_id"].numberInt());
+
+    // Without the index's collation, only an exact match is found.
+    results.clear();
+    ASSERT_NOT_EQUALS(STAGE_IDHACK,
+                      runQuery(BSON("s"
+                                    << "ABC"),
+                               &results));
+    ASSERT_EQ(0U, results.size());
+    ASSERT_NOT_EQUALS(STAGE_IDHACK,
+                      runQuery(BSON("s"
+                                    << "abc"),
+                               &results));
+    ASSERT_EQ(1U, results.size());
+}
+
+TEST_F(QueryStageIDHackTest, DisabledByKnob) {
+    addIndex(BSON("a" << 1), true);
+
+    internalQueryEnableUniqueIndexIdHack.store(false);
+    std::vector<BSONObj> results;
+    const StageType rootType = runQuery(BSON("a" << 7), &results);
+    internalQueryEnableUniqueIndexIdHack.store(true);
+
+    ASSERT_NOT_EQUALS(STAGE_IDHACK, rootType);
+    ASSERT_EQ(1U, results.size());
+}
+
+}  // namespace
+}  // namespace mongo
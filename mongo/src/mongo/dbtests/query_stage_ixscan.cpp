@@ -31,12 +31,16 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
+#include "mongo/db/collection_index_usage_tracker.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace QueryStageIxscan {
@@ -314,6 +318,59 @@ public:
     }
 };
 
+// The key ranges of $indexStats must be recorded for plain queries, which never call getStats().
+class QueryStageIxscanRecordsKeyRangesWithoutExplain : public IndexScanTest {
+public:
+    void run() {
+        setup();
+
+        insert(fromjson("{_id: 1, x: 1}"));
+        insert(fromjson("{_id: 2, x: 2}"));
+        insert(fromjson("{_id: 3, x: 3}"));
+
+        IndexCatalog* catalog = _coll->getIndexCatalog();
+        std::vector<IndexDescriptor*> indexes;
+        catalog->findIndexesByKeyPattern(&_opCtx, BSON("x" << 1), false, &indexes);
+        ASSERT_EQ(indexes.size(), 1U);
+
+        IndexScanParams params;
+        params.descriptor = indexes[0];
+        params.direction = 1;
+        OrderedIntervalList oil("x");
+        oil.intervals.push_back(Interval(BSON("" << 1 << "" << 2), true, true));
+        params.bounds.fields.push_back(oil);
+
+        auto ws = stdx::make_unique<WorkingSet>();
+        auto ixscan = stdx::make_unique<IndexScan>(&_opCtx, params, ws.get(), nullptr);
+        auto statusWithExec = PlanExecutor::make(
+            &_opCtx, std::move(ws), std::move(ixscan), _coll, PlanExecutor::NO_YIELD);
+        ASSERT_OK(statusWithExec.getStatus());
+        auto exec = std::move(statusWithExec.getValue());
+
+        BSONObj obj;
+        int numResults = 0;
+        while (PlanExecutor::ADVANCED == exec->getNext(&obj, nullptr)) {
+            ++numResults;
+        }
+        ASSERT_EQ(2, numResults);
+
+        PlanSummaryStats stats;
+        Explain::getSummaryStats(*exec, &stats);
+        const std::string indexName = indexes[0]->indexName();
+        ASSERT_EQ(1U, stats.indexAccesses.count(indexName));
+        ASSERT(stats.indexAccesses[indexName].indexBounds);
+
+        // Only one access in kKeyRangeSamplePeriod records its key range.
+        for (long long i = 0; i < CollectionIndexUsageTracker::kKeyRangeSamplePeriod; ++i) {
+            _coll->infoCache()->notifyOfQuery(&_opCtx, stats);
+        }
+        CollectionIndexUsageMap usageStats = _coll->infoCache()->getIndexUsageStats();
+        const auto& keyRanges = usageStats[indexName].keyRanges;
+        ASSERT_EQ(1U, keyRanges.size());
+        ASSERT_BSONOBJ_EQ(fromjson("{x: ['[1, 2]']}"), keyRanges[0].bounds);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_ixscan") {}
@@ -324,6 +381,7 @@ public:
         add<QueryStageIxscanInsertDuringSaveExclusive>();
         add<QueryStageIxscanInsertDuringSaveExclusive2>();
         add<QueryStageIxscanInsertDuringSaveReverse>();
+        add<QueryStageIxscanRecordsKeyRangesWithoutExplain>();
     }
 } QueryStageIxscanAll;
 
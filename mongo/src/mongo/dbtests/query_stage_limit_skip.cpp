@@ -87,6 +87,18 @@ int countResults(PlanStage* stage) {
     return count;
 }
 
+int countResultsBatched(PlanStage* stage, size_t maxBatchWorks) {
+    int count = 0;
+    while (!stage->isEOF()) {
+        PlanStage::Batch batch;
+        stage->workBatch(maxBatchWorks, &batch);
+        ASSERT_LTE(batch.ids.size(), maxBatchWorks);
+        count += batch.ids.size();
+    }
+    ASSERT_EQUALS(count, static_cast<int>(stage->getCommonStats()->advanced));
+    return count;
+}
+
 //
 // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
 //
@@ -110,12 +122,39 @@ protected:
     OperationContext* const _opCtx = _uniqOpCtx.get();
 };
 
+//
+// Same as above, pulling results through workBatch().
+//
+class QueryStageLimitSkipBatchedTest {
+public:
+    void run() {
+        for (int i = 0; i < 2 * N; ++i) {
+            for (size_t maxBatchWorks : {1, 4, 64}) {
+                WorkingSet ws;
+
+                unique_ptr<PlanStage> skip =
+                    make_unique<SkipStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(max(0, N - i), countResultsBatched(skip.get(), maxBatchWorks));
+
+                unique_ptr<PlanStage> limit =
+                    make_unique<LimitStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(min(N, i), countResultsBatched(limit.get(), maxBatchWorks));
+            }
+        }
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _uniqOpCtx = cc().makeOperationContext();
+    OperationContext* const _opCtx = _uniqOpCtx.get();
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_limit_skip") {}
 
     void setupTests() {
         add<QueryStageLimitSkipBasicTest>();
+        add<QueryStageLimitSkipBatchedTest>();
     }
 };
 
@@ -385,6 +385,61 @@ TEST_F(QueryStageMultiPlanTest, MPSExplainAllPlans) {
     }
 }
 
+// Test that a plan which clearly produces fewer results per work than another stops being worked
+// before the end of the trial period, and that the trial period ends once it is the last loser.
+TEST_F(QueryStageMultiPlanTest, MPSTerminatesDominatedPlanEarly) {
+    // Insert a document to create the collection.
+    insert(BSON("x" << 1));
+
+    const size_t minWorks = internalQueryPlanEvaluationMinWorksBeforeTermination.load();
+    const size_t nDocs = 10 * minWorks;
+
+    for (bool earlyTermination : {true, false}) {
+        auto ws = stdx::make_unique<WorkingSet>();
+        auto firstPlan = stdx::make_unique<QueuedDataStage>(_opCtx.get(), ws.get());
+        auto secondPlan = stdx::make_unique<QueuedDataStage>(_opCtx.get(), ws.get());
+
+        // The first plan produces a result every ten works, the second plan none.
+        for (size_t i = 0; i < nDocs; ++i) {
+            if (i % 10 == 0) {
+                addMember(firstPlan.get(), ws.get(), BSON("x" << 1));
+            } else {
+                firstPlan->pushBack(PlanStage::NEED_TIME);
+            }
+            secondPlan->pushBack(PlanStage::NEED_TIME);
+        }
+
+        AutoGetCollectionForReadCommand ctx(_opCtx.get(), nss);
+
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(BSON("x" << 1));
+        auto cq = uassertStatusOK(CanonicalQuery::canonicalize(opCtx(), std::move(qr)));
+        unique_ptr<MultiPlanStage> mps =
+            make_unique<MultiPlanStage>(_opCtx.get(), ctx.getCollection(), cq.get());
+        mps->addPlan(new QuerySolution(), firstPlan.release(), ws.get());
+        mps->addPlan(new QuerySolution(), secondPlan.release(), ws.get());
+
+        const bool earlyTerminationOldValue = internalQueryPlanEvaluationEarlyTermination.load();
+        internalQueryPlanEvaluationEarlyTermination.store(earlyTermination);
+        PlanYieldPolicy yieldPolicy(PlanExecutor::NO_YIELD, _clock);
+        ASSERT_OK(mps->pickBestPlan(&yieldPolicy));
+        internalQueryPlanEvaluationEarlyTermination.store(earlyTerminationOldValue);
+
+        ASSERT_EQ(mps->bestPlanIdx(), 0);
+        auto stats = mps->getStats();
+        ASSERT_EQ(stats->children.size(), 2U);
+        if (earlyTermination) {
+            ASSERT_EQ(stats->children[1]->common.works, minWorks);
+            ASSERT_EQ(stats->children[0]->common.works, minWorks);
+        } else {
+            // The trial period ran until the first plan returned enough results.
+            ASSERT_GT(stats->children[1]->common.works, minWorks);
+            ASSERT_EQ(stats->children[0]->common.advanced,
+                      static_cast<size_t>(internalQueryPlanEvaluationMaxResults.load()));
+        }
+    }
+}
+
 // Test that the plan summary only includes stats from the winning plan.
 //
 // This is a regression test for SERVER-20111.
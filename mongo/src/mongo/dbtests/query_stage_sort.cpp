@@ -39,8 +39,10 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/exec/sort.h"
+#include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/json.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 
@@ -118,6 +120,7 @@ public:
         params.collection = coll;
         params.pattern = BSON("foo" << 1);
         params.limit = limit();
+        params.fetchLate = fetchLate();
 
         auto keyGenStage = make_unique<SortKeyGeneratorStage>(
             &_opCtx, queuedDataStage.release(), ws.get(), params.pattern, nullptr);
@@ -157,11 +160,14 @@ public:
         params.collection = coll;
         params.pattern = BSON("foo" << direction);
         params.limit = limit();
+        params.allowDiskUse = allowDiskUse();
+        params.fetchLate = fetchLate();
 
         auto keyGenStage = make_unique<SortKeyGeneratorStage>(
             &_opCtx, queuedDataStage.release(), ws.get(), params.pattern, nullptr);
 
         auto sortStage = make_unique<SortStage>(&_opCtx, params, ws.get(), keyGenStage.release());
+        const SortStage* sortStagePtr = sortStage.get();
 
         auto fetchStage =
             make_unique<FetchStage>(&_opCtx, ws.get(), sortStage.release(), nullptr, coll);
@@ -193,6 +199,15 @@ public:
         }
         ASSERT_EQUALS(PlanExecutor::IS_EOF, state);
         checkCount(count);
+
+        auto sortStats = static_cast<const SortStats*>(sortStagePtr->getSpecificStats());
+        ASSERT_EQUALS(allowDiskUse(), sortStats->usedDisk);
+        ASSERT_EQUALS(sortStats->usedDisk, sortStats->spilledBytes > 0);
+        if (!fetchLate()) {
+            ASSERT_EQUALS(0U, sortStats->lateFetches);
+        } else if (!allowDiskUse() && limit() > 0) {
+            ASSERT_EQUALS(static_cast<size_t>(count), sortStats->lateFetches);
+        }
     }
 
     /**
@@ -216,6 +231,16 @@ public:
         return 0;
     };
 
+    // Returns whether the sort may write data to disk.
+    virtual bool allowDiskUse() const {
+        return false;
+    }
+
+    // Returns whether the sort may buffer only the sort keys of documents.
+    virtual bool fetchLate() const {
+        return false;
+    }
+
 
     static const char* ns() {
         return "unittests.QueryStageSort";
@@ -303,6 +328,133 @@ public:
     }
 };
 
+// Sort more objects than fit in the memory limit by writing them to disk.
+class QueryStageSortSpillToDisk : public QueryStageSortExt {
+public:
+    QueryStageSortSpillToDisk()
+        : _originalMaxBytes(internalQueryExecMaxBlockingSortBytes.load()) {
+        internalQueryExecMaxBlockingSortBytes.store(10 * 1024);
+    }
+
+    ~QueryStageSortSpillToDisk() {
+        internalQueryExecMaxBlockingSortBytes.store(_originalMaxBytes);
+    }
+
+    bool allowDiskUse() const final {
+        return true;
+    }
+
+private:
+    const int _originalMaxBytes;
+};
+
+// Spill to disk while keeping only the first 'LIMIT' results.
+template <int LIMIT>
+class QueryStageSortSpillToDiskWithLimit : public QueryStageSortSpillToDisk {
+public:
+    int limit() const final {
+        return LIMIT;
+    }
+};
+
+// Sort with limit, buffering only the sort keys and fetching the results once sorted.
+template <int LIMIT>
+class QueryStageSortFetchLate : public QueryStageSortDec {
+public:
+    int limit() const final {
+        return LIMIT;
+    }
+
+    bool fetchLate() const final {
+        return true;
+    }
+};
+
+// Spill to disk after buffering only the sort keys.
+class QueryStageSortFetchLateSpillToDisk : public QueryStageSortSpillToDiskWithLimit<5000> {
+public:
+    bool fetchLate() const final {
+        return true;
+    }
+};
+
+// Deletion of a doc that was buffered without its contents. Storage engines with invalidations
+// fetch it on deletion, others drop it from the results and return a spare in its place.
+class QueryStageSortFetchLateDeletion : public QueryStageSortTestBase {
+public:
+    virtual int numObj() {
+        return 100;
+    }
+    virtual int limit() const {
+        return 10;
+    }
+    virtual bool fetchLate() const {
+        return true;
+    }
+
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(&_opCtx, ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, ns());
+            wuow.commit();
+        }
+
+        fillData();
+
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+
+        auto exec = makePlanExecutorWithSortStage(coll);
+        SortStage* ss = static_cast<SortStage*>(exec->getRootStage());
+        SortKeyGeneratorStage* keyGenStage =
+            static_cast<SortKeyGeneratorStage*>(ss->getChildren()[0].get());
+        QueuedDataStage* queuedDataStage =
+            static_cast<QueuedDataStage*>(keyGenStage->getChildren()[0].get());
+
+        // Read in all of the data.
+        while (!queuedDataStage->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState status = ss->work(&id);
+            ASSERT_NOT_EQUALS(PlanStage::ADVANCED, status);
+        }
+
+        // Delete the doc with the smallest 'foo', which is the first result.
+        exec->saveState();
+        OpDebug* const nullOpDebug = nullptr;
+        {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll->deleteDocument(&_opCtx, kUninitializedStmtId, *recordIds.begin(), nullOpDebug);
+            wuow.commit();
+        }
+        ASSERT_OK(exec->restoreState());
+
+        int count = 0;
+        while (!ss->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState status = ss->work(&id);
+            if (PlanStage::ADVANCED != status) {
+                ASSERT_NE(status, PlanStage::FAILURE);
+                ASSERT_NE(status, PlanStage::DEAD);
+                continue;
+            }
+            WorkingSetMember* member = exec->getWorkingSet()->get(id);
+            ASSERT(member->hasObj());
+            ++count;
+        }
+
+        ASSERT_EQUALS(limit(), count);
+        auto sortStats = static_cast<const SortStats*>(ss->getSpecificStats());
+        if (supportsDocLocking()) {
+            ASSERT_EQUALS(1U, sortStats->lateFetchDrops);
+        } else {
+            ASSERT_EQUALS(0U, sortStats->lateFetchDrops);
+        }
+    }
+};
+
 // Mutation invalidation of docs fed to sort.
 class QueryStageSortMutationInvalidation : public QueryStageSortTestBase {
 public:
@@ -590,6 +742,12 @@ public:
         // and a special case for limit == 1
         add<QueryStageSortDecWithLimit<1>>();
         add<QueryStageSortExt>();
+        add<QueryStageSortSpillToDisk>();
+        add<QueryStageSortSpillToDiskWithLimit<5000>>();
+        add<QueryStageSortFetchLate<10>>();
+        add<QueryStageSortFetchLate<1>>();
+        add<QueryStageSortFetchLateSpillToDisk>();
+        add<QueryStageSortFetchLateDeletion>();
         add<QueryStageSortMutationInvalidation>();
         add<QueryStageSortDeletionInvalidation>();
         add<QueryStageSortDeletionInvalidationWithLimit<10>>();
@@ -199,6 +199,71 @@ TEST_F(QueryStageSubplanTest, QueryStageSubplanPlanFromCache) {
     ASSERT_FALSE(subplan->branchPlannedFromCache(1));
 }
 
+/**
+ * Test that the SubplanStage drops duplicate branches and plans each branch shape only once.
+ */
+TEST_F(QueryStageSubplanTest, QueryStageSubplanMergeSameShapeBranches) {
+    OldClientWriteContext ctx(opCtx(), nss.ns());
+
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("a" << 1 << "b" << 1));
+    addIndex(BSON("c" << 1));
+
+    for (int i = 0; i < 10; i++) {
+        insert(BSON("a" << 1 << "b" << i << "c" << i));
+    }
+
+    // The third branch is identical to the first. The second has the same shape as the first, and
+    // the fourth has a shape of its own.
+    BSONObj query = fromjson("{$or: [{a: 1, b: 3}, {a: 1, b: 4}, {a: 1, b: 3}, {c: 1}]}");
+
+    Collection* collection = ctx.getCollection();
+
+    auto qr = stdx::make_unique<QueryRequest>(nss);
+    qr->setFilter(query);
+    auto statusWithCQ = CanonicalQuery::canonicalize(opCtx(), std::move(qr));
+    ASSERT_OK(statusWithCQ.getStatus());
+    std::unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    // Get planner params.
+    QueryPlannerParams plannerParams;
+    fillOutPlannerParams(opCtx(), collection, cq.get(), &plannerParams);
+
+    WorkingSet ws;
+    std::unique_ptr<SubplanStage> subplan(
+        new SubplanStage(opCtx(), collection, &ws, plannerParams, cq.get()));
+
+    PlanYieldPolicy yieldPolicy(PlanExecutor::NO_YIELD, _clock);
+    ASSERT_OK(subplan->pickBestPlan(&yieldPolicy));
+    ASSERT(subplan->compositeSolution());
+
+    auto stats = static_cast<const SubplanStats*>(subplan->getSpecificStats());
+    ASSERT_EQ(1U, stats->duplicateBranches);
+    ASSERT_EQ(3U, stats->branches.size());
+
+    // Only the first branch was multi-planned; the second took its index assignment.
+    ASSERT_FALSE(subplan->branchPlannedFromSameShape(0));
+    ASSERT_GT(stats->branches[0].numCandidates, 1U);
+    ASSERT_GT(stats->branches[0].trialWorks, 0U);
+    ASSERT_TRUE(subplan->branchPlannedFromSameShape(1));
+    ASSERT_EQ(0, stats->branches[1].sameShapeAs);
+    ASSERT_EQ(0U, stats->branches[1].numCandidates);
+    ASSERT_FALSE(subplan->branchPlannedFromSameShape(2));
+    ASSERT_EQ(1U, stats->branches[2].numCandidates);
+
+    // The query returns the documents matched by the three distinct branches.
+    size_t numResults = 0;
+    PlanStage::StageState state = PlanStage::NEED_TIME;
+    while (state != PlanStage::IS_EOF) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        state = subplan->work(&id);
+        if (state == PlanStage::ADVANCED) {
+            ++numResults;
+        }
+    }
+    ASSERT_EQ(3U, numResults);
+}
+
 /**
  * Ensure that the subplan stage doesn't create a plan cache entry if there are no query results.
  */
@@ -130,7 +130,8 @@ public:
         }
 
         const std::initializer_list<StringData> passthroughFields = {
-            "$queryOptions", "collation", "hint", "readConcern", QueryRequest::cmdOptionMaxTimeMS,
+            "$queryOptions", "approximate", "collation", "hint", "readConcern",
+            QueryRequest::cmdOptionMaxTimeMS,
         };
         for (auto name : passthroughFields) {
             if (auto field = cmdObj[name]) {
@@ -208,6 +209,8 @@ public:
         }
 
         long long total = 0;
+        bool approximate = false;
+        long long errorBound = 0;
         BSONObjBuilder shardSubTotal(result.subobjStart("shards"));
 
         for (const auto& response : shardResponses) {
@@ -215,9 +218,16 @@ public:
             if (status.isOK()) {
                 status = getStatusFromCommandResult(response.swResponse.getValue().data);
                 if (status.isOK()) {
-                    long long shardCount = response.swResponse.getValue().data["n"].numberLong();
+                    const BSONObj& data = response.swResponse.getValue().data;
+                    long long shardCount = data["n"].numberLong();
                     shardSubTotal.appendNumber(response.shardId.toString(), shardCount);
                     total += shardCount;
+
+                    // Each shard bounds its own estimate. Adding the bounds is conservative.
+                    if (data["approximate"].trueValue()) {
+                        approximate = true;
+                        errorBound += data["errorBound"].numberLong();
+                    }
                     continue;
                 }
             }
@@ -234,6 +244,10 @@ public:
         shardSubTotal.doneFast();
         total = applySkipLimit(total, cmdObj);
         result.appendNumber("n", total);
+        if (approximate) {
+            result.appendBool("approximate", true);
+            result.appendNumber("errorBound", errorBound);
+        }
         return true;
     }
 
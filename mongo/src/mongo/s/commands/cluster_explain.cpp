@@ -99,6 +99,24 @@ bool appendElementsIfRoom(BSONObjBuilder* bob, const BSONObj& toAppend) {
     return false;
 }
 
+/**
+ * Adds up the 'spilledBytes' reported by the stages of the explained plan rooted at 'stage'.
+ */
+long long sumSpilledBytes(const BSONObj& stage) {
+    long long spilledBytes = stage["spilledBytes"].numberLong();
+    if (stage["inputStage"].type() == BSONType::Object) {
+        spilledBytes += sumSpilledBytes(stage["inputStage"].Obj());
+    }
+    if (stage["inputStages"].type() == BSONType::Array) {
+        for (auto&& inputStage : stage["inputStages"].Obj()) {
+            if (inputStage.type() == BSONType::Object) {
+                spilledBytes += sumSpilledBytes(inputStage.Obj());
+            }
+        }
+    }
+    return spilledBytes;
+}
+
 }  // namespace
 
 // static
@@ -274,8 +292,12 @@ void ClusterExplain::buildExecStats(const vector<Strategy::CommandResult>& shard
     long long keysExamined = 0;
     long long docsExamined = 0;
     long long totalChildMillis = 0;
+    long long spilledBytes = 0;
     for (size_t i = 0; i < shardResults.size(); i++) {
         BSONObj execStats = shardResults[i].result["executionStats"].Obj();
+        if (execStats["executionStages"].type() == BSONType::Object) {
+            spilledBytes += sumSpilledBytes(execStats["executionStages"].Obj());
+        }
         if (execStats.hasField("nReturned")) {
             nReturned += execStats["nReturned"].numberLong();
         }
@@ -306,6 +328,10 @@ void ClusterExplain::buildExecStats(const vector<Strategy::CommandResult>& shard
     executionStatsBob.appendNumber("totalKeysExamined", keysExamined);
     executionStatsBob.appendNumber("totalDocsExamined", docsExamined);
     executionStagesBob.append("totalChildMillis", totalChildMillis);
+    if (spilledBytes > 0) {
+        executionStagesBob.appendBool("usedDisk", true);
+        executionStagesBob.appendNumber("spilledBytes", spilledBytes);
+    }
 
     BSONArrayBuilder execShardsBuilder(executionStagesBob.subarrayStart("shards"));
     for (size_t i = 0; i < shardResults.size(); i++) {
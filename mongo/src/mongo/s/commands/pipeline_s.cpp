@@ -119,6 +119,16 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    std::vector<BSONObj> getPlanCacheStats(OperationContext* opCtx,
+                                           const NamespaceString& ns,
+                                           bool totals) final {
+        MONGO_UNREACHABLE;
+    }
+
+    std::vector<BSONObj> getQueryStats(OperationContext* opCtx, bool clear) final {
+        MONGO_UNREACHABLE;
+    }
+
     void appendLatencyStats(const NamespaceString& nss,
                             bool includeHistograms,
                             BSONObjBuilder* builder) const final {